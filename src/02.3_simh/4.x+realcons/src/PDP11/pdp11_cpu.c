@@ -268,6 +268,150 @@ typedef struct {
     uint16              inst[HIST_ILNT];
     } InstHistory;
 
+/* Fast history (SET CPU FASTHISTORY): a power of two ring of separate
+   PC, PSW, IR, IR physical address and write log position arrays, filled
+   inline at instruction fetch.  The other instruction words are not read;
+   SHOW CPU HISTORY rebuilds them from a copy of memory by undoing the
+   logged writes (HIST_WRITE in pdp11_defs.h) back to each entry. */
+
+#define HIST_WLOG       4                               /* write log / ring */
+
+#define PSW_NOW         ((cm << PSW_V_CM) | (pm << PSW_V_PM) | \
+                         (rs << PSW_V_RS) | (fpd << PSW_V_FPD) | \
+                         (ipl << PSW_V_IPL) | (tbit << PSW_V_TBIT) | \
+                         (N << PSW_V_N) | (Z << PSW_V_Z) | \
+                         (V << PSW_V_V) | (C << PSW_V_C))
+
+/* Software TLB: one entry per APRFILE index (mode, I/D space, page).
+   An entry caches the outcome of relocR/relocW for the part of the page
+   which passes the page length test. Entries are only made for ACF 2/6
+   (no traps), a write entry only after PDR<W> has been set, and only if
+   the page maps linearly; TLB_MEM additionally says the whole range is
+   main memory. Any write to an APR, MMR0 or MMR3 drops the entries. */
+
+#define TLB_R           1                               /* read ok */
+#define TLB_W           2                               /* write ok */
+#define TLB_MEM         4                               /* range is memory */
+
+typedef struct {
+    int32               flags;
+    int32               bn_lo;                          /* first valid va<12:6> */
+    uint32              bn_span;                        /* valid blocks, in va<12:6> */
+    int32               pa;                             /* pa of va<12:0> = 0 */
+    } RELOC_TLB;
+
+#define TLB_HIT(t,va,f) (((t)->flags & (f)) == (f) && \
+                         ((uint32) (((va) & VA_BN) - (t)->bn_lo)) <= (t)->bn_span)
+
+/* Execution engines. SWITCH decodes IR with the nested switch statements
+   in sim_instr. TABLE looks IR up in cpu_optab, built for the current
+   model and options, and jumps to the label "opc_<name>" in the same
+   switch statements: via a label address table with GCC, else via a flat
+   switch. The table resolves whatever depends only on IR and the model,
+   e.g. unimplemented instructions go straight to opc_ILL, and the double
+   operand instructions have separate entries for the IS_SDSD R,not R
+   operand order. BLOCK dispatches like TABLE, but fetches IR and its
+   table entry from the block cache below. */
+
+#define CPU_ENGINE_SWITCH       0
+#define CPU_ENGINE_TABLE        1
+#define CPU_ENGINE_BLOCK        2
+
+#define CPU_OPS \
+    CPU_OP (ILL) CPU_OP (HALT) CPU_OP (WAIT) CPU_OP (BPT) CPU_OP (IOT) \
+    CPU_OP (RESET) CPU_OP (RTI) CPU_OP (MFPT) CPU_OP (JMP) CPU_OP (RTS) \
+    CPU_OP (SPL) CPU_OP (CCC) CPU_OP (SCC) CPU_OP (SWAB) CPU_OP (BR_F) \
+    CPU_OP (BR_B) CPU_OP (BNE_F) CPU_OP (BNE_B) CPU_OP (BEQ_F) \
+    CPU_OP (BEQ_B) CPU_OP (BGE_F) CPU_OP (BGE_B) CPU_OP (BLT_F) \
+    CPU_OP (BLT_B) CPU_OP (BGT_F) CPU_OP (BGT_B) CPU_OP (BLE_F) \
+    CPU_OP (BLE_B) CPU_OP (JSR) CPU_OP (CLR) CPU_OP (COM) CPU_OP (INC) \
+    CPU_OP (DEC) CPU_OP (NEG) CPU_OP (ADC) CPU_OP (SBC) CPU_OP (TST) \
+    CPU_OP (ROR) CPU_OP (ROL) CPU_OP (ASR) CPU_OP (ASL) CPU_OP (MARK) \
+    CPU_OP (MFPI) CPU_OP (MTPI) CPU_OP (SXT) CPU_OP (CSM) \
+    CPU_OP (TSTSET) CPU_OP (WRTLCK) CPU_OP (MOV_SDSD) CPU_OP (MOV) \
+    CPU_OP (CMP_SDSD) CPU_OP (CMP) CPU_OP (BIT_SDSD) CPU_OP (BIT) \
+    CPU_OP (BIC_SDSD) CPU_OP (BIC) CPU_OP (BIS_SDSD) CPU_OP (BIS) \
+    CPU_OP (ADD_SDSD) CPU_OP (ADD) CPU_OP (EIS) CPU_OP (BPL_F) \
+    CPU_OP (BPL_B) CPU_OP (BMI_F) CPU_OP (BMI_B) CPU_OP (BHI_F) \
+    CPU_OP (BHI_B) CPU_OP (BLOS_F) CPU_OP (BLOS_B) CPU_OP (BVC_F) \
+    CPU_OP (BVC_B) CPU_OP (BVS_F) CPU_OP (BVS_B) CPU_OP (BCC_F) \
+    CPU_OP (BCC_B) CPU_OP (BCS_F) CPU_OP (BCS_B) CPU_OP (EMT) \
+    CPU_OP (TRAP) CPU_OP (CLRB) CPU_OP (COMB) CPU_OP (INCB) \
+    CPU_OP (DECB) CPU_OP (NEGB) CPU_OP (ADCB) CPU_OP (SBCB) \
+    CPU_OP (TSTB) CPU_OP (RORB) CPU_OP (ROLB) CPU_OP (ASRB) \
+    CPU_OP (ASLB) CPU_OP (MTPS) CPU_OP (MFPD) CPU_OP (MTPD) \
+    CPU_OP (MFPS) CPU_OP (MOVB_SDSD) CPU_OP (MOVB) CPU_OP (CMPB_SDSD) \
+    CPU_OP (CMPB) CPU_OP (BITB_SDSD) CPU_OP (BITB) CPU_OP (BICB_SDSD) \
+    CPU_OP (BICB) CPU_OP (BISB_SDSD) CPU_OP (BISB) CPU_OP (SUB_SDSD) \
+    CPU_OP (SUB) CPU_OP (FP)
+
+#define CPU_OP(n)       OPC_##n,
+enum { CPU_OPS OPC_N };
+#undef CPU_OP
+
+/* Sampling profiler (SET CPU PROFILE=n).  cpu_prof_unit is scheduled every
+   n instructions, +-1/8 so that it does not lock step with guest loops,
+   and samples the instruction about to be executed.  Nothing is done per
+   instruction.  Samples are counted by mode, physical PC and OPC_xxx;
+   the class is taken at sample time, memory is not read again later. */
+
+#define PROF_MIN        10                              /* min interval */
+#define PROF_INIHASH    1024                            /* initial table size */
+#define PROF_NOPA       MAXMEMSIZE                      /* PC not in memory */
+
+#define PROF_INT        0                               /* opcode classes */
+#define PROF_BRANCH     1
+#define PROF_TRAP       2
+#define PROF_PSW        3
+#define PROF_EIS        4
+#define PROF_CIS        5
+#define PROF_FP         6
+#define PROF_WAIT       7
+#define PROF_NOMAP      8
+#define PROF_NCLASS     9
+
+typedef struct {
+    int32               pa;                             /* physical PC */
+    uint16              va;                             /* virtual PC */
+    uint8               mode;                           /* cm */
+    uint8               opc;                            /* OPC_xxx */
+    uint8               cls;                            /* PROF_xxx class */
+    uint32              cnt;                            /* samples, 0 = free */
+    } PROF_ENT;
+
+/* Block cache, for the BLOCK engine. A block is a run of instructions up
+   to the next change of flow, with IR and OPC_xxx of each instruction.
+   It is looked up by PC | isenable and stays valid while
+   - cpu_blk_mmgen[] of its APR index is unchanged: bumped whenever that
+     TLB entry is dropped, i.e. whenever its relocation may have changed,
+     and for all APRs on entry to sim_instr;
+   - the generation of its physical chunk is unchanged: WrMemW/WrMemB
+     bump it on a write to a chunk that has its bit in cpu_code_map.
+   A block never crosses a chunk, and is made only of memory that the
+   TLB (or 16b mapping with management off) resolves without a trap.
+   Operand words are not cached, they are read as usual. */
+
+#define BLK_N           4096                            /* cache entries */
+#define BLK_MAXOP       32                              /* instr per block */
+#define BLK_HASH(va)    ((((va) >> 1) ^ ((va) >> VA_V_APF)) & (BLK_N - 1))
+#define BLK_SPEC(s)     ((((s) & 060) == 060) || (((s) & 067) == 027))
+
+typedef struct {
+    uint16              ir;
+    uint8               opc;                            /* OPC_xxx */
+    uint8               len;                            /* words, with operands */
+    } BLK_OP;
+
+typedef struct {
+    int32               va;                             /* PC | isenable, -1 = free */
+    int32               pa;
+    uint32              mmgen;                          /* cpu_blk_mmgen[] when made */
+    uint32              chunk;                          /* pa >> CODE_V_CHUNK */
+    uint32              cgen;                           /* cpu_code_gen[chunk] when made */
+    int32               n;                              /* instructions */
+    BLK_OP              op[BLK_MAXOP];
+    } CPU_BLOCK;
+
 /* Global state */
 
 uint16 *M = NULL;                                       /* memory */
@@ -293,6 +437,17 @@ int32 FPS = 0;                                          /* fp status */
 int32 FEC = 0;                                          /* fp exception code */
 int32 FEA = 0;                                          /* fp exception addr */
 int32 APRFILE[64] = { 0 };                              /* PARs/PDRs */
+RELOC_TLB reloc_tlb[64] = { { 0 } };                    /* APRFILE translations */
+int32 reloc_tlb_enb = 1;                                /* TLB enable */
+int32 cpu_engine = CPU_ENGINE_TABLE;                    /* execution engine */
+uint8 cpu_optab[65536];                                 /* IR -> OPC_xxx */
+uint32 cpu_optab_type = 0, cpu_optab_opt = 0;           /* cpu_optab built for */
+CPU_BLOCK cpu_blk[BLK_N];                               /* block cache */
+CPU_BLOCK *cpu_blk_cur = NULL;                          /* block being executed */
+int32 cpu_blk_i = 0, cpu_blk_va = 0;                    /* its next instr, va */
+uint32 cpu_blk_mmgen[64] = { 0 };                       /* relocation generation */
+uint32 cpu_code_map[CODE_NCHUNK >> 5] = { 0 };          /* chunk has blocks */
+uint32 cpu_code_gen[CODE_NCHUNK] = { 0 };               /* chunk generation */
 int32 MMR0 = 0;                                         /* MMR0 - status */
 int32 MMR1 = 0;                                         /* MMR1 - R+/-R */
 int32 MMR2 = 0;                                         /* MMR2 - saved PC */
@@ -315,11 +470,31 @@ jmp_buf save_env;                                       /* abort handler */
 int32 hst_p = 0;                                        /* history pointer */
 int32 hst_lnt = 0;                                      /* history length */
 InstHistory *hst = NULL;                                /* instruction history */
+uint32 hst_fmask = 0;                                   /* fast history ring mask */
+uint32 hst_fn = 0;                                      /* fast history count */
+uint16 *hst_fpc = NULL;                                 /* fast history PC | HIST_VLD */
+uint16 *hst_fpsw = NULL;                                /* fast history PSW */
+uint16 *hst_fir = NULL;                                 /* fast history IR */
+uint32 *hst_fpa = NULL;                                 /* fast history pa of IR */
+uint32 *hst_fwn = NULL;                                 /* fast history write log pos */
+uint32 hst_wlog_mask = 0;                               /* write log ring mask */
+uint32 hst_wlog_n = 0;                                  /* write log count */
+uint32 *hst_wlog_pa = NULL;                             /* write log word address */
+uint16 *hst_wlog_old = NULL;                            /* write log old contents */
 int32 dsmask[4] = { MMR3_KDS, MMR3_SDS, 0, MMR3_UDS };  /* dspace enables */
 int16 inst_pc;                                          /* PC of current instr */
 int32 inst_psw;                                         /* PSW at instr. start */
 int16 reg_mods;                                         /* reg deltas */
 int32 last_pa;                                          /* pa from ReadMW/ReadMB */
+int32 fetch_pa;                                         /* pa from ReadE */
+int32 cpu_prof_int = 0;                                 /* profiler interval */
+uint32 cpu_prof_seed = 1;                               /* profiler jitter */
+t_uint64 cpu_prof_n = 0;                                /* samples */
+t_uint64 cpu_prof_mode[4];                              /* samples by mode */
+t_uint64 cpu_prof_class[PROF_NCLASS];                   /* samples by class */
+t_uint64 cpu_prof_opc[OPC_N];                           /* samples by OPC_xxx */
+PROF_ENT *cpu_prof_tab = NULL;                          /* samples by PC */
+uint32 cpu_prof_size = 0, cpu_prof_used = 0;
 int32 saved_sim_interval;                               /* saved at inst start */
 t_stat reason;                                          /* stop reason */
 
@@ -335,6 +510,16 @@ t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat cpu_set_tlb (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_tlb (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat cpu_set_engine (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_engine (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+void cpu_optab_build (void);
+static int32 cpu_blk_fetch (int32 va, int32 *opc);
+t_stat cpu_prof_svc (UNIT *uptr);
+t_stat cpu_set_prof (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_prof (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat cpu_export_prof (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 int32 GeteaB (int32 spec);
 int32 GeteaW (int32 spec);
 int32 relocR (int32 addr);
@@ -343,6 +528,9 @@ void relocR_test (int32 va, int32 apridx);
 void relocW_test (int32 va, int32 apridx);
 t_bool PLF_test (int32 va, int32 apr);
 void reloc_abort (int32 err, int32 apridx);
+void reloc_tlb_flush (void);
+void reloc_tlb_fill (int32 apridx);
+static int32 reloc_tlb_mem (int32 va, int32 acc);
 int32 ReadE (int32 addr);
 int32 ReadW (int32 addr);
 int32 ReadB (int32 addr);
@@ -405,6 +593,7 @@ int32 trap_clear[TRAP_V_MAX] = {                        /* trap clears */
 */
 
 UNIT cpu_unit = { UDATA (NULL, UNIT_FIX|UNIT_BINK, INIMEMSIZE) };
+UNIT cpu_prof_unit = { UDATA (&cpu_prof_svc, UNIT_DIS | UNIT_IDLE, 0) };
 
 const char *psw_modes[] = {"K", "S", "E", "U"};
 
@@ -668,8 +857,20 @@ MTAB cpu_mod[] = {
       NULL, &show_iospace },
     { MTAB_XTD|MTAB_VDV, 0, "IDLE", "IDLE", &sim_set_idle, &sim_show_idle },
     { MTAB_XTD|MTAB_VDV, 0, NULL, "NOIDLE", &sim_clr_idle, NULL },
+    { MTAB_XTD|MTAB_VDV, 1, "TLB", "TLB",
+      &cpu_set_tlb, &cpu_show_tlb, NULL, "Cache MMU page translations" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOTLB",
+      &cpu_set_tlb, NULL, NULL, "Relocate every access through the APRs" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "ENGINE", "ENGINE={TABLE|BLOCK|SWITCH}",
+      &cpu_set_engine, &cpu_show_engine, NULL, "Instruction dispatch" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "HISTORY", "HISTORY",
       &cpu_set_hist, &cpu_show_hist },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 1, NULL, "FASTHISTORY",
+      &cpu_set_hist, NULL, NULL, "History of PC, PSW and IR only, for long runs" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "PROFILE", "PROFILE",
+      &cpu_set_prof, &cpu_show_prof, NULL, "Sample PC every n instructions, 0 = off" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_NC, 0, NULL, "PROFEXPORT",
+      &cpu_export_prof, NULL, NULL, "Write profile as folded stacks for flame graphs" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "VIRTUAL", NULL,
       NULL, &cpu_show_virt },
     { 0 }
@@ -696,6 +897,16 @@ DEVICE cpu_dev = {
     cpu_breakpoints
     };
 
+/* Internal device, so that the profiler's event has a name in SHOW QUEUE */
+
+DEVICE cpu_prof_dev = {
+    "CPU-PROFILE", &cpu_prof_unit, NULL, NULL,
+    1, 8, 22, 2, 8, 16,
+    NULL, NULL, NULL,
+    NULL, NULL, NULL,
+    NULL, 0, 0
+    };
+
 
 #ifdef USE_REALCONS
 // extended cpu state for panel logic
@@ -740,6 +951,14 @@ console_controller_event_func_t	realcons_event_opcode_wait; // triggered after e
 //#define RETURN_REALCONS_CPU_PDP11_MEMACCESS_INTERN(realcons,va,pa,data_expr,write)	 return (data_expr)
 
 
+   // feed address and data bits into lamp duty cycle accumulator, see REALCONS_ACTIVITY_ADD()
+#define REALCONS_CPU_PDP11_MEMACCESS_ACTIVITY(realcons,pa) do { \
+				  if ((realcons)->activity.active) \
+				    REALCONS_ACTIVITY_ADD(&(realcons)->activity, \
+				      ((t_uint64)(pa) & 0x3fffff) \
+				      | ((t_uint64)(realcons_memory_data_register & 0xffff) << REALCONS_ACTIVITY_DATA_BITOFFSET)) ; \
+			  } while(0)
+
 #define REALCONS_CPU_PDP11_MEMACCESS_INTERN(realcons,va,pa,data_expr,write)	 do { \
  				  realcons_bus_ID_mode = ((va) & 0x10000)? 1 : 0 ; \
 				  realcons_memory_address_phys_register = (pa) ; \
@@ -747,6 +966,7 @@ console_controller_event_func_t	realcons_event_opcode_wait; // triggered after e
 				    realcons_memory_address_virt_register = (va) & 0xffff ; \
 				  realcons_memory_data_register = (data_expr) ; \
 				  realcons_memory_write_access = (write) ; \
+				  REALCONS_CPU_PDP11_MEMACCESS_ACTIVITY(realcons,pa) ; \
 /*printf("%s M[va=%o, pa=%o] = %o, line #%d\n", realcons_memory_write_access?"WRITE":"READ", realcons_memory_address_virt_register, realcons_memory_address_phys_register, realcons_memory_data_register, __LINE__) ;/**/ \
 			  } while(0)
 
@@ -758,6 +978,7 @@ console_controller_event_func_t	realcons_event_opcode_wait; // triggered after e
 				    realcons_memory_address_virt_register = (va) & 0xffff ; \
 				  realcons_memory_write_access = (write) ; \
 				  realcons_memory_data_register = (data_expr) ; \
+				  REALCONS_CPU_PDP11_MEMACCESS_ACTIVITY(realcons,pa) ; \
 /*printf("RETURN %s M[va=%o, pa=%o] = %o, line #%d\n", realcons_memory_write_access?"WRITE":"READ", realcons_memory_address_virt_register, realcons_memory_address_phys_register, realcons_memory_data_register, __LINE__) ;/**/ \
   				  return realcons_memory_data_register ; /* eval data_expr only once!!*/ \
 			  } while(0)
@@ -836,6 +1057,11 @@ t_stat sim_instr (void)
 int abortval, i;
 volatile int32 trapea;                                  /* used by setjmp */
 InstHistory *hst_ent = NULL;
+#if defined (__GNUC__)
+#define CPU_OP(n)       &&opc_##n,
+static void *opc_label[OPC_N] = { CPU_OPS };            /* OPC_xxx -> label */
+#undef CPU_OP
+#endif
 
 sim_vm_pc_value = &pdp11_pc_value;
 
@@ -854,6 +1080,8 @@ if (reason != SCPE_OK)
 if (MEMSIZE >= (cpu_tab[cpu_model].maxm - IOPAGESIZE))  /* mem size >= max - io page? */
     MEMSIZE = cpu_tab[cpu_model].maxm - IOPAGESIZE;     /* max - io page */
 cpu_type = 1u << cpu_model;                             /* reset type mask */
+if ((cpu_optab_type != cpu_type) || (cpu_optab_opt != cpu_opt))
+    cpu_optab_build ();                                 /* model changed? */
 cpu_bme = (MMR3 & MMR3_BME) && (cpu_opt & OPT_UBM);     /* map enabled? */
 PC = saved_PC;
 put_PSW (PSW, 0);                                       /* set PSW, call calc_xs */
@@ -865,6 +1093,7 @@ dsenable = calc_ds (cm);
 put_PIRQ (PIRQ);                                        /* rewrite PIRQ */
 STKLIM = STKLIM & STKLIM_RW;                            /* clean up STKLIM */
 MMR0 = MMR0 | MMR0_IC;                                  /* usually on */
+reloc_tlb_flush ();                                     /* console may have changed APRs */
 
 trap_req = calc_ints (ipl, trap_req);                   /* upd int req */
 trapea = 0;
@@ -943,7 +1172,7 @@ else {
 
 while (reason == 0)  {
 
-    int32 IR, srcspec, srcreg, dstspec, dstreg;
+    int32 IR, opc, srcspec, srcreg, dstspec, dstreg;
     int32 src, src2, dst, ea;
     int32 i, t, sign, oldrs, trapnum;
 
@@ -1089,13 +1318,23 @@ while (reason == 0)  {
         MMR1 = 0;
         MMR2 = PC;
         }
-    IR = ReadE (PC | isenable);                         /* fetch instruction */
+    if (cpu_engine == CPU_ENGINE_BLOCK)                 /* block cache? */
+        IR = cpu_blk_fetch (PC | isenable, &opc);
+    else IR = ReadE (PC | isenable);                    /* fetch instruction */
     sim_interval = sim_interval - 1;
     srcspec = (IR >> 6) & 077;                          /* src, dst specs */
     dstspec = IR & 077;
     srcreg = (srcspec <= 07);                           /* src, dst = rmode? */
     dstreg = (dstspec <= 07);
-    if (hst_lnt) {                                      /* record history? */
+    if (hst_fmask) {                                    /* fast history? */
+        uint32 hi = hst_fn++ & hst_fmask;
+        hst_fpc[hi] = (uint16) (PC | HIST_VLD);
+        hst_fpsw[hi] = (uint16) PSW_NOW;
+        hst_fir[hi] = (uint16) IR;
+        hst_fpa[hi] = fetch_pa;
+        hst_fwn[hi] = hst_wlog_n;
+        }
+    else if (hst_lnt) {                                 /* record history? */
         t_value val;
         uint32 i;
         static int32 swmap[4] = {
@@ -1121,6 +1360,19 @@ while (reason == 0)  {
 #ifdef USE_REALCONS
     saved_PC = PC ; // saved_PC used in panel
 #endif
+    if (cpu_engine != CPU_ENGINE_SWITCH) {              /* pre-decoded? */
+        if (cpu_engine == CPU_ENGINE_TABLE)
+            opc = cpu_optab[IR];
+#if defined (__GNUC__)
+        goto *opc_label[opc];
+#else
+        switch (opc) {
+#define CPU_OP(n)       case OPC_##n: goto opc_##n;
+        CPU_OPS
+#undef CPU_OP
+            }
+#endif
+        }
     switch ((IR >> 12) & 017) {                         /* decode IR<15:12> */
 
 /* Opcode 0: no operands, specials, branches, JSR, SOPs */
@@ -1134,6 +1386,7 @@ while (reason == 0)  {
                 }
             switch (IR) {                               /* decode IR<2:0> */
             case 0:                                     /* HALT */
+opc_HALT:
                 if ((cm == MD_KER) &&
                     (!CPUT (CPUT_J) || ((MAINT & MAINT_HTRAP) == 0)))
 #if USE_REALCONS
@@ -1148,24 +1401,29 @@ while (reason == 0)  {
                 else setTRAP (TRAP_ILL);                /* no, ill inst */
                 break;
             case 1:                                     /* WAIT */
+opc_WAIT:
                 wait_state = 1;
 #if USE_REALCONS
 					REALCONS_EVENT(cpu_realcons, realcons_event_opcode_wait);
 #endif
                 break;
             case 3:                                     /* BPT */
+opc_BPT:
                 setTRAP (TRAP_BPT);
                 break;
             case 4:                                     /* IOT */
+opc_IOT:
                 setTRAP (TRAP_IOT);
                 break;
             case 5:                                     /* RESET */
+opc_RESET:
                 if (cm == MD_KER) {
                     reset_all (2);                      /* skip CPU, sys reg */
                     PIRQ = 0;                           /* clear PIRQ */
                     STKLIM = 0;                         /* clear STKLIM */
                     MMR0 = 0;                           /* clear MMR0 */
                     MMR3 = 0;                           /* clear MMR3 */
+                    reloc_tlb_flush ();
                     cpu_bme = 0;                        /* (also clear bme) */
                     for (i = 0; i < IPL_HLVL; i++)
                         int_req[i] = 0;
@@ -1183,6 +1441,7 @@ while (reason == 0)  {
                     break;
                     }
             case 2:                                     /* RTI */
+opc_RTI:
                 src = ReadW (SP | dsenable);
                 src2 = ReadW (((SP + 2) & 0177777) | dsenable);
                 STACKFILE[cm] = SP = (SP + 4) & 0177777;
@@ -1204,6 +1463,7 @@ while (reason == 0)  {
                     setTRAP (TRAP_TRC);                 /* RTI immed trap */
                 break;
             case 7:                                     /* MFPT */
+opc_MFPT:
                 if (CPUT (HAS_MFPT))                    /* implemented? */
                     R[0] = cpu_tab[cpu_model].mfpt;     /* get type */
                 else setTRAP (TRAP_ILL);
@@ -1212,6 +1472,7 @@ while (reason == 0)  {
             break;                                      /* end case no ops */
 
         case 001:                                       /* JMP */
+opc_JMP:
             if (dstreg)
                 setTRAP (CPUT (HAS_JREG4)? TRAP_PRV: TRAP_ILL);
             else {
@@ -1227,6 +1488,7 @@ while (reason == 0)  {
 
         case 002:                                       /* RTS et al*/
             if (IR < 000210) {                          /* RTS */
+opc_RTS:
                 dstspec = dstspec & 07;
                 if (hst_ent)
                     hst_ent->dst = R[dstspec];
@@ -1242,6 +1504,7 @@ while (reason == 0)  {
                 }
             if (IR < 000240) {                          /* SPL */
                 if (CPUT (HAS_SPL)) {
+opc_SPL:
                     if (cm == MD_KER)
                         ipl = IR & 07;
                     trap_req = calc_ints (ipl, trap_req);
@@ -1250,6 +1513,7 @@ while (reason == 0)  {
                 break;
                 }                                       /* end if SPL */
             if (IR < 000260) {                          /* clear CC */
+opc_CCC:
                 if (IR & 010)
                     N = 0;
                 if (IR & 004)
@@ -1260,6 +1524,7 @@ while (reason == 0)  {
                     C = 0;
                 break;
                 }                                       /* end if clear CCs */
+opc_SCC:
             if (IR & 010)                               /* set CC */
                 N = 1;
             if (IR & 004)
@@ -1271,6 +1536,7 @@ while (reason == 0)  {
             break;                                      /* end case RTS et al */
 
         case 003:                                       /* SWAB */
+opc_SWAB:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = ((dst & 0377) << 8) | ((dst >> 8) & 0377);
             N = GET_SIGN_B (dst & 0377);
@@ -1286,78 +1552,92 @@ while (reason == 0)  {
             break;                                      /* end SWAB */
 
         case 004: case 005:                             /* BR */
+opc_BR_F:
             BRANCH_F (IR);
             break;
 
         case 006: case 007:                             /* BR */
+opc_BR_B:
             BRANCH_B (IR);
             break;
 
         case 010: case 011:                             /* BNE */
+opc_BNE_F:
             if (Z == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 012: case 013:                             /* BNE */
+opc_BNE_B:
             if (Z == 0) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 014: case 015:                             /* BEQ */
+opc_BEQ_F:
             if (Z) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 016: case 017:                             /* BEQ */
+opc_BEQ_B:
             if (Z) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 020: case 021:                             /* BGE */
+opc_BGE_F:
             if ((N ^ V) == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 022: case 023:                             /* BGE */
+opc_BGE_B:
             if ((N ^ V) == 0) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 024: case 025:                             /* BLT */
+opc_BLT_F:
             if (N ^ V) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 026: case 027:                             /* BLT */
+opc_BLT_B:
             if (N ^ V) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 030: case 031:                             /* BGT */
+opc_BGT_F:
             if ((Z | (N ^ V)) == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 032: case 033:                             /* BGT */
+opc_BGT_B:
             if ((Z | (N ^ V)) == 0) { BRANCH_B (IR); }
             break;
 
         case 034: case 035:                             /* BLE */
+opc_BLE_F:
             if (Z | (N ^ V)) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 036: case 037:                             /* BLE */
+opc_BLE_B:
             if (Z | (N ^ V)) {
                 BRANCH_B (IR);
                 }
@@ -1365,6 +1645,7 @@ while (reason == 0)  {
 
         case 040: case 041: case 042: case 043:         /* JSR */
         case 044: case 045: case 046: case 047:
+opc_JSR:
             if (dstreg)
                 setTRAP (CPUT (HAS_JREG4)? TRAP_PRV: TRAP_ILL);
             else {
@@ -1388,6 +1669,7 @@ while (reason == 0)  {
             break;                                      /* end JSR */
 
         case 050:                                       /* CLR */
+opc_CLR:
             N = V = C = 0;
             Z = 1;
             if (hst_ent)
@@ -1398,6 +1680,7 @@ while (reason == 0)  {
             break;
 
         case 051:                                       /* COM */
+opc_COM:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = dst ^ 0177777;
             N = GET_SIGN_W (dst);
@@ -1412,6 +1695,7 @@ while (reason == 0)  {
             break;
 
         case 052:                                       /* INC */
+opc_INC:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (dst + 1) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1425,6 +1709,7 @@ while (reason == 0)  {
             break;
 
         case 053:                                       /* DEC */
+opc_DEC:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (dst - 1) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1438,6 +1723,7 @@ while (reason == 0)  {
             break;
 
         case 054:                                       /* NEG */
+opc_NEG:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (-dst) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1452,6 +1738,7 @@ while (reason == 0)  {
             break;
 
         case 055:                                       /* ADC */
+opc_ADC:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (dst + C) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1466,6 +1753,7 @@ while (reason == 0)  {
             break;
 
         case 056:                                       /* SBC */
+opc_SBC:
             dst = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (dst - C) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1480,6 +1768,7 @@ while (reason == 0)  {
             break;
 
         case 057:                                       /* TST */
+opc_TST:
             dst = dstreg? R[dstspec]: ReadW (GeteaW (dstspec));
             if (hst_ent)
                 hst_ent->dst = dst;
@@ -1489,6 +1778,7 @@ while (reason == 0)  {
             break;
 
         case 060:                                       /* ROR */
+opc_ROR:
             src = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (src >> 1) | (C << 15);
             N = GET_SIGN_W (dst);
@@ -1503,6 +1793,7 @@ while (reason == 0)  {
             break;
 
         case 061:                                       /* ROL */
+opc_ROL:
             src = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = ((src << 1) | C) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1517,6 +1808,7 @@ while (reason == 0)  {
             break;
 
         case 062:                                       /* ASR */
+opc_ASR:
             src = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (src >> 1) | (src & 0100000);
             N = GET_SIGN_W (dst);
@@ -1531,6 +1823,7 @@ while (reason == 0)  {
             break;
 
         case 063:                                       /* ASL */
+opc_ASL:
             src = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             dst = (src << 1) & 0177777;
             N = GET_SIGN_W (dst);
@@ -1551,6 +1844,7 @@ while (reason == 0)  {
 
         case 064:                                       /* MARK */
             if (CPUT (HAS_MARK)) {
+opc_MARK:
                 i = (PC + dstspec + dstspec) & 0177777;
                 JMP_PC (R[5]);
                 R[5] = ReadW (i | dsenable);
@@ -1561,6 +1855,7 @@ while (reason == 0)  {
 
         case 065:                                       /* MFPI */
             if (CPUT (HAS_MXPY)) {
+opc_MFPI:
                 if (dstreg) {
                     if ((dstspec == 6) && (cm != pm))
                         dst = STACKFILE[pm];
@@ -1588,6 +1883,7 @@ while (reason == 0)  {
 
         case 066:                                       /* MTPI */
             if (CPUT (HAS_MXPY)) {
+opc_MTPI:
                 dst = ReadW (SP | dsenable);
                 N = GET_SIGN_W (dst);
                 Z = GET_Z (dst);
@@ -1609,6 +1905,7 @@ while (reason == 0)  {
 
         case 067:                                       /* SXT */
             if (CPUT (HAS_SXS)) {
+opc_SXT:
                 dst = N? 0177777: 0;
                 Z = N ^ 1;
                 V = 0;
@@ -1622,6 +1919,7 @@ while (reason == 0)  {
             break;
 
         case 070:                                       /* CSM */
+opc_CSM:
             if (CPUT (HAS_CSM) && (MMR3 & MMR3_CSM) && (cm != MD_KER)) {
                 dst = dstreg? R[dstspec]: ReadW (GeteaW (dstspec));
                 PSW = get_PSW () & ~PSW_CC;             /* PSW, cc = 0 */
@@ -1642,6 +1940,7 @@ while (reason == 0)  {
 
         case 072:                                       /* TSTSET */
             if (CPUT (HAS_TSWLK) && !dstreg) {
+opc_TSTSET:
                 dst = ReadMW (GeteaW (dstspec));
                 N = GET_SIGN_W (dst);
                 Z = GET_Z (dst);
@@ -1657,6 +1956,7 @@ while (reason == 0)  {
 
         case 073:                                       /* WRTLCK */
             if (CPUT (HAS_TSWLK) && !dstreg) {
+opc_WRTLCK:
                 N = GET_SIGN_W (R[0]);
                 Z = GET_Z (R[0]);
                 V = 0;
@@ -1668,6 +1968,7 @@ while (reason == 0)  {
             break;
 
         default:
+opc_ILL:
             setTRAP (TRAP_ILL);
             break;
             }                                           /* end switch SOPs */
@@ -1686,10 +1987,12 @@ while (reason == 0)  {
 
     case 001:                                           /* MOV */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_MOV_SDSD:
             ea = GeteaW (dstspec);
             dst = R[srcspec];
             }
         else {
+opc_MOV:
             dst = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             if (!dstreg)
                 ea = GeteaW (dstspec);
@@ -1708,10 +2011,12 @@ while (reason == 0)  {
 
     case 002:                                           /* CMP */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_CMP_SDSD:
             src2 = ReadW (GeteaW (dstspec));
             src = R[srcspec];
             }
         else {
+opc_CMP:
             src = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             src2 = dstreg? R[dstspec]: ReadW (GeteaW (dstspec));
             }
@@ -1728,10 +2033,12 @@ while (reason == 0)  {
 
     case 003:                                           /* BIT */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_BIT_SDSD:
             src2 = ReadW (GeteaW (dstspec));
             src = R[srcspec];
             }
         else {
+opc_BIT:
             src = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             src2 = dstreg? R[dstspec]: ReadW (GeteaW (dstspec));
             }
@@ -1747,10 +2054,12 @@ while (reason == 0)  {
 
     case 004:                                           /* BIC */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_BIC_SDSD:
             src2 = ReadMW (GeteaW (dstspec));
             src = R[srcspec];
             }
         else {
+opc_BIC:
             src = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             src2 = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             }
@@ -1769,10 +2078,12 @@ while (reason == 0)  {
 
     case 005:                                           /* BIS */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_BIS_SDSD:
             src2 = ReadMW (GeteaW (dstspec));
             src = R[srcspec];
             }
         else {
+opc_BIS:
             src = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             src2 = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             }
@@ -1791,10 +2102,12 @@ while (reason == 0)  {
 
     case 006:                                           /* ADD */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_ADD_SDSD:
             src2 = ReadMW (GeteaW (dstspec));
             src = R[srcspec];
             }
         else {
+opc_ADD:
             src = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             src2 = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             }
@@ -1830,6 +2143,7 @@ while (reason == 0)  {
 */
 
     case 007:
+opc_EIS:
         srcspec = srcspec & 07;
         switch ((IR >> 9) & 07)  {                      /* decode IR<11:9> */
 
@@ -2039,110 +2353,129 @@ while (reason == 0)  {
         switch ((IR >> 6) & 077) {                      /* decode IR<11:6> */
 
         case 000: case 001:                             /* BPL */
+opc_BPL_F:
             if (N == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 002: case 003:                             /* BPL */
+opc_BPL_B:
             if (N == 0) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 004: case 005:                             /* BMI */
+opc_BMI_F:
             if (N) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 006: case 007:                             /* BMI */
+opc_BMI_B:
             if (N) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 010: case 011:                             /* BHI */
+opc_BHI_F:
             if ((C | Z) == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 012: case 013:                             /* BHI */
+opc_BHI_B:
             if ((C | Z) == 0) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 014: case 015:                             /* BLOS */
+opc_BLOS_F:
             if (C | Z) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 016: case 017:                             /* BLOS */
+opc_BLOS_B:
             if (C | Z) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 020: case 021:                             /* BVC */
+opc_BVC_F:
             if (V == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 022: case 023:                             /* BVC */
+opc_BVC_B:
             if (V == 0) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 024: case 025:                             /* BVS */
+opc_BVS_F:
             if (V) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 026: case 027:                             /* BVS */
+opc_BVS_B:
             if (V) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 030: case 031:                             /* BCC */
+opc_BCC_F:
             if (C == 0) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 032: case 033:                             /* BCC */
+opc_BCC_B:
             if (C == 0) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 034: case 035:                             /* BCS */
+opc_BCS_F:
             if (C) {
                 BRANCH_F (IR);
                 }
             break;
 
         case 036: case 037:                             /* BCS */
+opc_BCS_B:
             if (C) {
                 BRANCH_B (IR);
                 }
             break;
 
         case 040: case 041: case 042: case 043:         /* EMT */
+opc_EMT:
             setTRAP (TRAP_EMT);
             break;
 
         case 044: case 045: case 046: case 047:         /* TRAP */
+opc_TRAP:
             setTRAP (TRAP_TRAP);
             break;
 
         case 050:                                       /* CLRB */
+opc_CLRB:
             N = V = C = 0;
             Z = 1;
             if (dstreg)
@@ -2156,6 +2489,7 @@ while (reason == 0)  {
             break;
 
         case 051:                                       /* COMB */
+opc_COMB:
             dst = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (dst ^ 0377) & 0377;
             N = GET_SIGN_B (dst);
@@ -2173,6 +2507,7 @@ while (reason == 0)  {
             break;
 
         case 052:                                       /* INCB */
+opc_INCB:
             dst = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (dst + 1) & 0377;
             N = GET_SIGN_B (dst);
@@ -2189,6 +2524,7 @@ while (reason == 0)  {
             break;
 
         case 053:                                       /* DECB */
+opc_DECB:
             dst = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (dst - 1) & 0377;
             N = GET_SIGN_B (dst);
@@ -2205,6 +2541,7 @@ while (reason == 0)  {
             break;
 
         case 054:                                       /* NEGB */
+opc_NEGB:
             dst = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (-dst) & 0377;
             N = GET_SIGN_B (dst);
@@ -2222,6 +2559,7 @@ while (reason == 0)  {
             break;
 
         case 055:                                       /* ADCB */
+opc_ADCB:
             dst = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (dst + C) & 0377;
             N = GET_SIGN_B (dst);
@@ -2239,6 +2577,7 @@ while (reason == 0)  {
             break;
 
         case 056:                                       /* SBCB */
+opc_SBCB:
             dst = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (dst - C) & 0377;
             N = GET_SIGN_B (dst);
@@ -2256,6 +2595,7 @@ while (reason == 0)  {
             break;
 
         case 057:                                       /* TSTB */
+opc_TSTB:
             dst = dstreg? R[dstspec] & 0377: ReadB (GeteaB (dstspec));
             if (hst_ent)
                 hst_ent->dst = dst;
@@ -2265,6 +2605,7 @@ while (reason == 0)  {
             break;
 
         case 060:                                       /* RORB */
+opc_RORB:
             src = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = ((src & 0377) >> 1) | (C << 7);
             N = GET_SIGN_B (dst);
@@ -2282,6 +2623,7 @@ while (reason == 0)  {
             break;
 
         case 061:                                       /* ROLB */
+opc_ROLB:
             src = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = ((src << 1) | C) & 0377;
             N = GET_SIGN_B (dst);
@@ -2299,6 +2641,7 @@ while (reason == 0)  {
             break;
 
         case 062:                                       /* ASRB */
+opc_ASRB:
             src = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = ((src & 0377) >> 1) | (src & 0200);
             N = GET_SIGN_B (dst);
@@ -2316,6 +2659,7 @@ while (reason == 0)  {
             break;
 
         case 063:                                       /* ASLB */
+opc_ASLB:
             src = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             dst = (src << 1) & 0377;
             N = GET_SIGN_B (dst);
@@ -2340,6 +2684,7 @@ while (reason == 0)  {
 
         case 064:                                       /* MTPS */
             if (CPUT (HAS_MXPS)) {
+opc_MTPS:
                 dst = dstreg? R[dstspec]: ReadB (GeteaB (dstspec));
                 if (cm == MD_KER) {
                     ipl = (dst >> PSW_V_IPL) & 07;
@@ -2355,6 +2700,7 @@ while (reason == 0)  {
 
         case 065:                                       /* MFPD */
             if (CPUT (HAS_MXPY)) {
+opc_MFPD:
                 if (dstreg) {
                     if ((dstspec == 6) && (cm != pm))
                         dst = STACKFILE[pm];
@@ -2379,6 +2725,7 @@ while (reason == 0)  {
 
         case 066:                                       /* MTPD */
             if (CPUT (HAS_MXPY)) {
+opc_MTPD:
                 dst = ReadW (SP | dsenable);
                 N = GET_SIGN_W (dst);
                 Z = GET_Z (dst);
@@ -2401,6 +2748,7 @@ while (reason == 0)  {
 
         case 067:                                       /* MFPS */
             if (CPUT (HAS_MXPS)) {
+opc_MFPS:
                 dst = get_PSW () & 0377;
                 N = GET_SIGN_B (dst);
                 Z = GET_Z (dst);
@@ -2426,10 +2774,12 @@ while (reason == 0)  {
 
     case 011:                                           /* MOVB */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_MOVB_SDSD:
             ea = GeteaB (dstspec);
             dst = R[srcspec] & 0377;
             }
         else {
+opc_MOVB:
             dst = srcreg? R[srcspec] & 0377: ReadB (GeteaB (srcspec));
             if (!dstreg)
                 ea = GeteaB (dstspec);
@@ -2448,10 +2798,12 @@ while (reason == 0)  {
 
     case 012:                                           /* CMPB */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_CMPB_SDSD:
             src2 = ReadB (GeteaB (dstspec));
             src = R[srcspec] & 0377;
             }
         else {
+opc_CMPB:
             src = srcreg? R[srcspec] & 0377: ReadB (GeteaB (srcspec));
             src2 = dstreg? R[dstspec] & 0377: ReadB (GeteaB (dstspec));
             }
@@ -2468,10 +2820,12 @@ while (reason == 0)  {
 
     case 013:                                           /* BITB */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_BITB_SDSD:
             src2 = ReadB (GeteaB (dstspec));
             src = R[srcspec] & 0377;
             }
         else {
+opc_BITB:
             src = srcreg? R[srcspec] & 0377: ReadB (GeteaB (srcspec));
             src2 = dstreg? R[dstspec] & 0377: ReadB (GeteaB (dstspec));
             }
@@ -2487,10 +2841,12 @@ while (reason == 0)  {
 
     case 014:                                           /* BICB */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_BICB_SDSD:
             src2 = ReadMB (GeteaB (dstspec));
             src = R[srcspec];
             }
         else {
+opc_BICB:
             src = srcreg? R[srcspec]: ReadB (GeteaB (srcspec));
             src2 = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             }
@@ -2509,10 +2865,12 @@ while (reason == 0)  {
 
     case 015:                                           /* BISB */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_BISB_SDSD:
             src2 = ReadMB (GeteaB (dstspec));
             src = R[srcspec];
             }
         else {
+opc_BISB:
             src = srcreg? R[srcspec]: ReadB (GeteaB (srcspec));
             src2 = dstreg? R[dstspec]: ReadMB (GeteaB (dstspec));
             }
@@ -2531,10 +2889,12 @@ while (reason == 0)  {
 
     case 016:                                           /* SUB */
         if (CPUT (IS_SDSD) && srcreg && !dstreg) {      /* R,not R */
+opc_SUB_SDSD:
             src2 = ReadMW (GeteaW (dstspec));
             src = R[srcspec];
             }
         else {
+opc_SUB:
             src = srcreg? R[srcspec]: ReadW (GeteaW (srcspec));
             src2 = dstreg? R[dstspec]: ReadMW (GeteaW (dstspec));
             }
@@ -2555,8 +2915,10 @@ while (reason == 0)  {
 /* Opcode 17: floating point */
 
     case 017:
-        if (CPUO (OPT_FPP))
+        if (CPUO (OPT_FPP)) {
+opc_FP:
             fp11 (IR);                  /* call fpp */
+            }
         else setTRAP (TRAP_ILL);
         break;                                          /* end case 017 */
         }                                               /* end switch op */
@@ -2818,7 +3180,9 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     setCPUERR (CPUE_ODD);
     ABORT (TRAP_ODD);
     }
-pa = relocR (va);                                       /* relocate */
+if ((pa = reloc_tlb_mem (va, TLB_R)) < 0)              /* not a cached page? */
+    pa = relocR (va);                                   /* relocate */
+fetch_pa = pa;
 if (BPT_SUMM_RD &&
     (sim_brk_test (va & 0177777, BPT_RDVIR) ||
      sim_brk_test (pa, BPT_RDPHY)))                     /* read breakpoint? */
@@ -2853,6 +3217,17 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     setCPUERR (CPUE_ODD);
     ABORT (TRAP_ODD);
     }
+if ((pa = reloc_tlb_mem (va, TLB_R)) >= 0) {            /* cached memory page? */
+    if (BPT_SUMM_RD &&
+        (sim_brk_test (va & 0177777, BPT_RDVIR) ||
+         sim_brk_test (pa, BPT_RDPHY)))                 /* read breakpoint? */
+        ABORT (ABRT_BKPT);                              /* stop simulation */
+#ifdef USE_REALCONS
+	RETURN_REALCONS_CPU_PDP11_MEMACCESS_VA_PA_READ(cpu_realcons, va, pa, RdMemW (pa));
+#else
+    return RdMemW (pa);
+#endif
+    }
 pa = relocR (va);                                       /* relocate */
 if (BPT_SUMM_RD &&
     (sim_brk_test (va & 0177777, BPT_RDVIR) ||
@@ -3002,6 +3377,17 @@ if ((va & 1) && CPUT (HAS_ODD)) {                       /* odd address? */
     setCPUERR (CPUE_ODD);
     ABORT (TRAP_ODD);
     }
+if ((pa = reloc_tlb_mem (va, TLB_W)) >= 0) {            /* cached memory page? */
+    if (BPT_SUMM_WR &&
+        (sim_brk_test (va & 0177777, BPT_WRVIR) ||
+         sim_brk_test (pa, BPT_WRPHY)))                 /* write breakpoint? */
+        ABORT (ABRT_BKPT);                              /* stop simulation */
+#ifdef USE_REALCONS
+	REALCONS_CPU_PDP11_MEMACCESS_VA_PA_WRITE(cpu_realcons, va, pa, data);
+#endif
+    WrMemW (pa, data);
+    return;
+    }
 pa = relocW (va);                                       /* relocate */
 if (BPT_SUMM_WR &&
     (sim_brk_test (va & 0177777, BPT_WRVIR) ||
@@ -3115,9 +3501,13 @@ return;
 int32 relocR (int32 va)
 {
 int32 apridx, apr, pa;
+RELOC_TLB *tlb;
 
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
     apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
+    tlb = &reloc_tlb[apridx];
+    if (TLB_HIT (tlb, va, TLB_R))                       /* cached? */
+        return tlb->pa + (va & VA_DF);
     apr = APRFILE[apridx];                              /* with va<18:13> */
     if ((apr & PDR_PRD) != 2)                           /* not 2, 6? */
          relocR_test (va, apridx);                      /* long test */
@@ -3129,6 +3519,8 @@ if (MMR0 & MMR0_MME) {                                  /* if mmgt */
         if (pa >= 0760000)
             pa = 017000000 | pa;
         }
+    if (reloc_tlb_enb)
+        reloc_tlb_fill (apridx);
     }
 else {
     pa = va & 0177777;                                  /* mmgt off */
@@ -3222,9 +3614,13 @@ return;
 int32 relocW (int32 va)
 {
 int32 apridx, apr, pa;
+RELOC_TLB *tlb;
 
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
     apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
+    tlb = &reloc_tlb[apridx];
+    if (TLB_HIT (tlb, va, TLB_W))                       /* cached, W set? */
+        return tlb->pa + (va & VA_DF);
     apr = APRFILE[apridx];                              /* with va<18:13> */
     if ((apr & PDR_ACF) != 6)                           /* not writeable? */
         relocW_test (va, apridx);                       /* long test */
@@ -3237,6 +3633,8 @@ if (MMR0 & MMR0_MME) {                                  /* if mmgt */
         if (pa >= 0760000)
             pa = 017000000 | pa;
         }
+    if (reloc_tlb_enb)
+        reloc_tlb_fill (apridx);
     }
 else {
     pa = va & 0177777;                                  /* mmgt off */
@@ -3296,6 +3694,434 @@ reloc_abort (err, apridx);
 return;
 }
 
+/* Build cpu_optab for the current model and options
+
+   Decodes like the switch statements in sim_instr. Conditions which
+   depend only on IR and the model are resolved here, everything else
+   (modes, MMR3, the operands) is still tested by the instruction code.
+*/
+
+static int32 cpu_optab_decode (int32 IR)
+{
+static const uint8 br0[16] = {                          /* IR<11:7>, opcode 00 */
+    OPC_ILL, OPC_ILL, OPC_BR_F, OPC_BR_B, OPC_BNE_F, OPC_BNE_B,
+    OPC_BEQ_F, OPC_BEQ_B, OPC_BGE_F, OPC_BGE_B, OPC_BLT_F, OPC_BLT_B,
+    OPC_BGT_F, OPC_BGT_B, OPC_BLE_F, OPC_BLE_B
+    };
+static const uint8 br1[16] = {                          /* IR<11:7>, opcode 10 */
+    OPC_BPL_F, OPC_BPL_B, OPC_BMI_F, OPC_BMI_B, OPC_BHI_F, OPC_BHI_B,
+    OPC_BLOS_F, OPC_BLOS_B, OPC_BVC_F, OPC_BVC_B, OPC_BVS_F, OPC_BVS_B,
+    OPC_BCC_F, OPC_BCC_B, OPC_BCS_F, OPC_BCS_B
+    };
+static const uint8 sop0[12] = {                         /* 0050 - 0063 */
+    OPC_CLR, OPC_COM, OPC_INC, OPC_DEC, OPC_NEG, OPC_ADC,
+    OPC_SBC, OPC_TST, OPC_ROR, OPC_ROL, OPC_ASR, OPC_ASL
+    };
+static const uint8 sop1[12] = {                         /* 1050 - 1063 */
+    OPC_CLRB, OPC_COMB, OPC_INCB, OPC_DECB, OPC_NEGB, OPC_ADCB,
+    OPC_SBCB, OPC_TSTB, OPC_RORB, OPC_ROLB, OPC_ASRB, OPC_ASLB
+    };
+static const uint8 dop[16][2] = {                       /* IR<15:12>, R,not R */
+    { 0 }, { OPC_MOV, OPC_MOV_SDSD }, { OPC_CMP, OPC_CMP_SDSD },
+    { OPC_BIT, OPC_BIT_SDSD }, { OPC_BIC, OPC_BIC_SDSD },
+    { OPC_BIS, OPC_BIS_SDSD }, { OPC_ADD, OPC_ADD_SDSD }, { 0 },
+    { 0 }, { OPC_MOVB, OPC_MOVB_SDSD }, { OPC_CMPB, OPC_CMPB_SDSD },
+    { OPC_BITB, OPC_BITB_SDSD }, { OPC_BICB, OPC_BICB_SDSD },
+    { OPC_BISB, OPC_BISB_SDSD }, { OPC_SUB, OPC_SUB_SDSD }, { 0 }
+    };
+int32 op = (IR >> 6) & 077;
+int32 srcreg = (op <= 07);
+int32 dstreg = ((IR & 077) <= 07);
+
+switch ((IR >> 12) & 017) {                             /* decode IR<15:12> */
+
+    case 000:
+        if (op == 000) {                                /* no operand */
+            switch (IR) {
+            case 0: return OPC_HALT;
+            case 1: return OPC_WAIT;
+            case 2: return OPC_RTI;
+            case 3: return OPC_BPT;
+            case 4: return OPC_IOT;
+            case 5: return OPC_RESET;
+            case 6: return CPUT (HAS_RTT)? OPC_RTI: OPC_ILL;
+            case 7: return CPUT (HAS_MFPT)? OPC_MFPT: OPC_ILL;
+                }
+            return OPC_ILL;
+            }
+        if (op == 001)
+            return OPC_JMP;
+        if (op == 002) {
+            if (IR < 000210)
+                return OPC_RTS;
+            if (IR < 000230)
+                return OPC_ILL;
+            if (IR < 000240)
+                return CPUT (HAS_SPL)? OPC_SPL: OPC_ILL;
+            return (IR < 000260)? OPC_CCC: OPC_SCC;
+            }
+        if (op == 003)
+            return OPC_SWAB;
+        if (op < 040)
+            return br0[op >> 1];
+        if (op < 050)
+            return OPC_JSR;
+        if (op < 064)
+            return sop0[op - 050];
+        switch (op) {
+        case 064: return CPUT (HAS_MARK)? OPC_MARK: OPC_ILL;
+        case 065: return CPUT (HAS_MXPY)? OPC_MFPI: OPC_ILL;
+        case 066: return CPUT (HAS_MXPY)? OPC_MTPI: OPC_ILL;
+        case 067: return CPUT (HAS_SXS)? OPC_SXT: OPC_ILL;
+        case 070: return OPC_CSM;
+        case 072: return (CPUT (HAS_TSWLK) && !dstreg)? OPC_TSTSET: OPC_ILL;
+        case 073: return (CPUT (HAS_TSWLK) && !dstreg)? OPC_WRTLCK: OPC_ILL;
+            }
+        return OPC_ILL;
+
+    case 007:                                           /* EIS, FIS, CIS */
+        switch ((IR >> 9) & 07) {
+        case 0: case 1: case 2: case 3:
+            return CPUO (OPT_EIS)? OPC_EIS: OPC_ILL;
+        case 4: case 7:
+            return CPUT (HAS_SXS)? OPC_EIS: OPC_ILL;
+        case 5:
+            return CPUO (OPT_FIS)? OPC_EIS: OPC_ILL;
+            }
+        return OPC_EIS;                                 /* CIS, 11/60 MED */
+
+    case 010:
+        if (op < 040)
+            return br1[op >> 1];
+        if (op < 044)
+            return OPC_EMT;
+        if (op < 050)
+            return OPC_TRAP;
+        if (op < 064)
+            return sop1[op - 050];
+        switch (op) {
+        case 064: return CPUT (HAS_MXPS)? OPC_MTPS: OPC_ILL;
+        case 065: return CPUT (HAS_MXPY)? OPC_MFPD: OPC_ILL;
+        case 066: return CPUT (HAS_MXPY)? OPC_MTPD: OPC_ILL;
+        case 067: return CPUT (HAS_MXPS)? OPC_MFPS: OPC_ILL;
+            }
+        return OPC_ILL;
+
+    case 017:                                           /* floating point */
+        return CPUO (OPT_FPP)? OPC_FP: OPC_ILL;
+        }
+
+return dop[(IR >> 12) & 017][CPUT (IS_SDSD) && srcreg && !dstreg];
+}
+
+void cpu_optab_build (void)
+{
+int32 i;
+
+for (i = 0; i < 65536; i++)
+    cpu_optab[i] = (uint8) cpu_optab_decode (i);
+cpu_optab_type = cpu_type;
+cpu_optab_opt = cpu_opt;
+return;
+}
+
+t_stat cpu_set_engine (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr == NULL)
+    return SCPE_ARG;
+if (MATCH_CMD (cptr, "TABLE") == 0)
+    cpu_engine = CPU_ENGINE_TABLE;
+else if (MATCH_CMD (cptr, "BLOCK") == 0) {
+#if defined (UC15)
+    return SCPE_NOFNC;                                  /* PDP-15 writes memory too */
+#else
+    cpu_engine = CPU_ENGINE_BLOCK;
+#endif
+    }
+else if (MATCH_CMD (cptr, "SWITCH") == 0)
+    cpu_engine = CPU_ENGINE_SWITCH;
+else return SCPE_ARG;
+cpu_blk_cur = NULL;
+return SCPE_OK;
+}
+
+t_stat cpu_show_engine (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+static const char *engine[] = { "SWITCH", "TABLE", "BLOCK" };
+int32 i, n;
+
+fprintf (st, "engine=%s", engine[cpu_engine]);
+if (cpu_engine == CPU_ENGINE_BLOCK) {
+    for (i = n = 0; i < BLK_N; i++) {
+        if ((cpu_blk[i].n != 0) &&
+            (cpu_blk[i].mmgen == cpu_blk_mmgen[(cpu_blk[i].va >> VA_V_APF) & 077]) &&
+            (cpu_blk[i].cgen == cpu_code_gen[cpu_blk[i].chunk]))
+            n++;
+        }
+    fprintf (st, ", %d of %d blocks valid", n, BLK_N);
+    }
+return SCPE_OK;
+}
+
+/* Block cache
+
+   cpu_blk_fetch replaces ReadE for the BLOCK engine. If va is the next
+   instruction of the current block, or starts a valid block, IR and its
+   OPC_xxx come from the block; REALCONS still sees the fetch. Otherwise
+   the instruction is fetched with ReadE, and a block is made at va for
+   the next time. With read breakpoints set every fetch goes to ReadE.
+*/
+
+static int32 cpu_blk_pa (int32 va)
+{
+int32 pa;
+
+if (MMR0 & MMR0_MME)
+    return reloc_tlb_mem (va, TLB_R);
+pa = va & 0177777;                                      /* mmgt off */
+if ((pa >= 0160000) || !ADDR_IS_MEM (pa))               /* I/O page, NXM? */
+    return -1;
+return pa;
+}
+
+static int32 cpu_blk_oplen (int32 IR)
+{
+int32 op = (IR >> 6) & 077;
+
+switch ((IR >> 12) & 017) {
+
+    case 000: case 010:                                 /* SOPs, branches, ... */
+        if ((op >= 050) || (((IR & 0100000) == 0) &&
+            ((op == 001) || (op == 003) || (op >= 040))))
+            return 1 + BLK_SPEC (IR & 077);
+        return 1;
+
+    case 007:                                           /* EIS, FIS, CIS */
+        if (((IR >> 9) & 07) == 7)                      /* SOB */
+            return 1;
+    case 017:                                           /* floating point */
+        return 1 + BLK_SPEC (IR & 077);
+        }
+
+return 1 + BLK_SPEC (op) + BLK_SPEC (IR & 077);         /* double operand */
+}
+
+static t_bool cpu_blk_end (int32 IR, int32 opc)
+{
+switch (opc) {
+
+    case OPC_ILL: case OPC_HALT: case OPC_WAIT: case OPC_BPT: case OPC_IOT:
+    case OPC_RESET: case OPC_RTI: case OPC_JMP: case OPC_RTS: case OPC_JSR:
+    case OPC_MARK: case OPC_CSM: case OPC_EMT: case OPC_TRAP: case OPC_MTPS:
+    case OPC_BR_F: case OPC_BR_B: case OPC_BNE_F: case OPC_BNE_B:
+    case OPC_BEQ_F: case OPC_BEQ_B: case OPC_BGE_F: case OPC_BGE_B:
+    case OPC_BLT_F: case OPC_BLT_B: case OPC_BGT_F: case OPC_BGT_B:
+    case OPC_BLE_F: case OPC_BLE_B: case OPC_BPL_F: case OPC_BPL_B:
+    case OPC_BMI_F: case OPC_BMI_B: case OPC_BHI_F: case OPC_BHI_B:
+    case OPC_BLOS_F: case OPC_BLOS_B: case OPC_BVC_F: case OPC_BVC_B:
+    case OPC_BVS_F: case OPC_BVS_B: case OPC_BCC_F: case OPC_BCC_B:
+    case OPC_BCS_F: case OPC_BCS_B:
+        return TRUE;
+
+    case OPC_EIS:
+        return (((IR >> 9) & 07) >= 6);                 /* CIS, SOB */
+        }
+
+return ((IR & 077) == 007);                             /* dst = PC? */
+}
+
+static CPU_BLOCK *cpu_blk_make (CPU_BLOCK *b, int32 va)
+{
+int32 pa, n, IR, opc, len;
+
+b->n = 0;
+if ((va & 1) || ((pa = cpu_blk_pa (va)) < 0))
+    return NULL;
+b->va = va;
+b->pa = pa;
+b->mmgen = cpu_blk_mmgen[(va >> VA_V_APF) & 077];
+b->chunk = ((uint32) pa) >> CODE_V_CHUNK;
+b->cgen = cpu_code_gen[b->chunk];
+for (n = 0; n < BLK_MAXOP; ) {
+    IR = RdMemW (pa);
+    opc = cpu_optab[IR];
+    len = cpu_blk_oplen (IR);
+    b->op[n].ir = (uint16) IR;
+    b->op[n].opc = (uint8) opc;
+    b->op[n++].len = (uint8) len;
+    if (cpu_blk_end (IR, opc))
+        break;
+    if ((((va + (len << 1)) ^ va) >> VA_V_APF) ||      /* next page? */
+        (((uint32) (pa + (len << 1)) >> CODE_V_CHUNK) != b->chunk))
+        break;
+    va = va + (len << 1);
+    pa = pa + (len << 1);
+    if (cpu_blk_pa (va) != pa)                          /* page length? */
+        break;
+    }
+b->n = n;
+cpu_code_map[b->chunk >> 5] |= 1u << (b->chunk & 037);
+return b;
+}
+
+static int32 cpu_blk_fetch (int32 va, int32 *opc)
+{
+CPU_BLOCK *b = cpu_blk_cur;
+BLK_OP *op;
+int32 IR;
+
+if ((b == NULL) || (va != cpu_blk_va) ||
+    (b->mmgen != cpu_blk_mmgen[(va >> VA_V_APF) & 077]) ||
+    (b->cgen != cpu_code_gen[b->chunk])) {              /* not next in block? */
+    b = &cpu_blk[BLK_HASH (va)];
+    if ((b->n == 0) || (b->va != va) ||
+        (b->mmgen != cpu_blk_mmgen[(va >> VA_V_APF) & 077]) ||
+        (b->cgen != cpu_code_gen[b->chunk]) || BPT_SUMM_RD) {
+        IR = ReadE (va);                                /* fetch as usual */
+        *opc = cpu_optab[IR];
+        cpu_blk_cur = BPT_SUMM_RD? NULL: cpu_blk_make (b, va);
+        if (cpu_blk_cur != NULL) {                      /* instr 0 done */
+            cpu_blk_i = 1;
+            cpu_blk_va = va + (b->op[0].len << 1);
+            if (b->n <= 1)
+                cpu_blk_cur = NULL;
+            }
+        return IR;
+        }
+    cpu_blk_cur = b;
+    cpu_blk_i = 0;
+    }
+op = &b->op[cpu_blk_i];
+IR = op->ir;
+*opc = op->opc;
+fetch_pa = b->pa + (va - b->va);
+#ifdef USE_REALCONS
+REALCONS_CPU_PDP11_MEMACCESS_VA_PA_READ(cpu_realcons, va, b->pa + (va - b->va), IR);
+#endif
+cpu_blk_va = va + (op->len << 1);
+if (++cpu_blk_i >= b->n)
+    cpu_blk_cur = NULL;
+return IR;
+}
+
+/* Write to a chunk holding blocks: drop them */
+
+void cpu_code_write (int32 pa)
+{
+uint32 chunk = ((uint32) pa) >> CODE_V_CHUNK;
+
+cpu_code_map[chunk >> 5] &= ~(1u << (chunk & 037));
+cpu_code_gen[chunk]++;
+return;
+}
+
+/* Software TLB
+
+   reloc_tlb_fill is called after relocR/relocW relocated an address
+   through APRFILE[apridx] without abort. Cacheable are ACF 2 and 6:
+   these never trap, and the only side effect, PDR<W> on write, is sticky
+   until the APR is written again. The valid block range comes from the
+   page length field; it is cached only if pa is linear over that range,
+   i.e. neither wraps at 2**22 (2**18) nor runs into the 18b I/O page.
+*/
+
+void reloc_tlb_fill (int32 apridx)
+{
+RELOC_TLB *tlb = &reloc_tlb[apridx];
+int32 apr = APRFILE[apridx];
+int32 plf = (apr & PDR_PLF) >> 2;                       /* page length, as va<12:6> */
+int32 base = (apr >> 10) & 017777700;
+int32 lo, hi, pa_lo, pa_hi, flags;
+
+if ((apr & PDR_PRD) != 2) {                             /* not 2, 6? */
+    tlb->flags = 0;
+    return;
+    }
+flags = TLB_R;
+if ((apr & (PDR_ACF | PDR_W)) == (6 | PDR_W))           /* r/w, W already set? */
+    flags = flags | TLB_W;
+if (apr & PDR_ED) {                                     /* expand down? */
+    lo = plf;
+    hi = VA_DF;
+    }
+else {
+    lo = 0;
+    hi = plf | (VA_DF & ~VA_BN);
+    }
+pa_lo = (lo + base) & PAMASK;
+pa_hi = (hi + base) & PAMASK;
+if ((MMR3 & MMR3_M22E) == 0) {
+    pa_lo = pa_lo & 0777777;
+    pa_hi = pa_hi & 0777777;
+    if (pa_hi >= 0760000) {                             /* I/O page in range? */
+        tlb->flags = 0;
+        return;
+        }
+    }
+if ((pa_hi - pa_lo) != (hi - lo)) {                     /* wraps? */
+    tlb->flags = 0;
+    return;
+    }
+if (ADDR_IS_MEM (pa_hi))                                /* all memory? */
+    flags = flags | TLB_MEM;
+tlb->bn_lo = lo;
+tlb->bn_span = (uint32) ((hi & VA_BN) - lo);
+tlb->pa = pa_lo - lo;
+tlb->flags = flags;
+return;
+}
+
+void reloc_tlb_flush (void)
+{
+int32 i;
+
+for (i = 0; i < 64; i++) {
+    reloc_tlb[i].flags = 0;
+    cpu_blk_mmgen[i]++;                                 /* drop blocks */
+    }
+return;
+}
+
+/* TLB lookup for the memory fast paths of ReadW and WriteW
+
+   Returns the pa of va if its page is cached with access "acc" and maps
+   to main memory, else -1; then the caller takes the full path.
+*/
+
+static int32 reloc_tlb_mem (int32 va, int32 acc)
+{
+RELOC_TLB *tlb = &reloc_tlb[(va >> VA_V_APF) & 077];
+
+if ((MMR0 & MMR0_MME) && TLB_HIT (tlb, va, acc | TLB_MEM))
+    return tlb->pa + (va & VA_DF);
+return -1;
+}
+
+t_stat cpu_set_tlb (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr != NULL)
+    return SCPE_ARG;
+reloc_tlb_enb = val;
+reloc_tlb_flush ();
+return SCPE_OK;
+}
+
+t_stat cpu_show_tlb (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+int32 i, n;
+
+if (!reloc_tlb_enb) {
+    fprintf (st, "NOTLB");
+    return SCPE_OK;
+    }
+for (i = n = 0; i < 64; i++) {
+    if (reloc_tlb[i].flags)
+        n++;
+    }
+fprintf (st, "TLB, %d of 64 pages cached", n);
+return SCPE_OK;
+}
+
 /* Relocate virtual address, console access
 
    Inputs:
@@ -3387,6 +4213,7 @@ switch ((pa >> 1) & 3) {                                /* decode pa<2:1> */
             data = (pa & 1)? (MMR0 & 0377) | (data << 8): (MMR0 & ~0377) | data;
         data = data & cpu_tab[cpu_model].mm0;
         MMR0 = (MMR0 & ~MMR0_WR) | (data & MMR0_WR);
+        reloc_tlb_flush ();
         return SCPE_OK;
 
     default:                                            /* MMR1, MMR2 */
@@ -3405,6 +4232,7 @@ t_stat MMR3_wr (int32 data, int32 pa, int32 access)     /* MMR3 */
 if (pa & 1)
     return SCPE_OK;
 MMR3 = data & cpu_tab[cpu_model].mm3;
+reloc_tlb_flush ();
 cpu_bme = (MMR3 & MMR3_BME) && (cpu_opt & OPT_UBM);
 dsenable = calc_ds (cm);
 return SCPE_OK;
@@ -3464,6 +4292,8 @@ if (left)
         (((uint32) (data & cpu_tab[cpu_model].par)) << 16)) & ~(PDR_A|PDR_W);
 else APRFILE[idx] = ((APRFILE[idx] & ~0177777) |
     (data & cpu_tab[cpu_model].pdr)) & ~(PDR_A|PDR_W);
+reloc_tlb[idx].flags = 0;                               /* only this page changed */
+cpu_blk_mmgen[idx]++;
 return SCPE_OK;
 }
 
@@ -3481,11 +4311,7 @@ return SCPE_OK;
 
 int32 get_PSW (void)
 {
-return (cm << PSW_V_CM) | (pm << PSW_V_PM) |
-    (rs << PSW_V_RS) | (fpd << PSW_V_FPD) |
-    (ipl << PSW_V_IPL) | (tbit << PSW_V_TBIT) |
-    (N << PSW_V_N) | (Z << PSW_V_Z) |
-    (V << PSW_V_V) | (C << PSW_V_C);
+return PSW_NOW;
 }
 
 /* Explicit PSW write - T-bit may be protected */
@@ -3627,6 +4453,7 @@ MMR0 = 0;
 MMR1 = 0;
 MMR2 = 0;
 MMR3 = 0;
+reloc_tlb_flush ();
 trap_req = 0;
 wait_state = 0;
 if (M == NULL) {                    /* First time init */
@@ -3656,6 +4483,8 @@ else
     REALCONS_EVENT(cpu_realcons, realcons_event_cpu_reset);
 #endif
 set_r_display (0, MD_KER);
+if (cpu_prof_int)                   /* RUN/BOOT cancel events */
+    sim_activate (&cpu_prof_unit, cpu_prof_int);
 return build_dib_tab ();            /* build, chk dib_tab */
 }
 
@@ -3784,7 +4613,26 @@ rptr->loc = (void *) &STACKFILE[cm];
 return;
 }
 
-/* Set history */
+/* Set history, val = 1 for the fast history */
+
+static void cpu_free_hist (void)
+{
+free (hst);
+hst = NULL;
+free (hst_fpc);
+free (hst_fpsw);
+free (hst_fir);
+free (hst_fpa);
+free (hst_fwn);
+free (hst_wlog_pa);
+free (hst_wlog_old);
+hst_fpc = hst_fpsw = hst_fir = hst_wlog_old = NULL;
+hst_fpa = hst_fwn = hst_wlog_pa = NULL;
+hst_fmask = hst_wlog_mask = 0;
+hst_fn = hst_wlog_n = 0;
+hst_lnt = 0;
+hst_p = 0;
+}
 
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
@@ -3792,26 +4640,119 @@ int32 i, lnt;
 t_stat r;
 
 if (cptr == NULL) {
-    for (i = 0; i < hst_lnt; i++)
-        hst[i].pc = 0;
+    for (i = 0; i < hst_lnt; i++) {
+        if (hst_fmask)
+            hst_fpc[i] = 0;
+        else hst[i].pc = 0;
+        }
     hst_p = 0;
     return SCPE_OK;
     }
 lnt = (int32) get_uint (cptr, 10, HIST_MAX, &r);
 if ((r != SCPE_OK) || (lnt && (lnt < HIST_MIN)))
     return SCPE_ARG;
-hst_p = 0;
-if (hst_lnt) {
-    free (hst);
-    hst_lnt = 0;
-    hst = NULL;
+cpu_free_hist ();
+if (lnt == 0)
+    return SCPE_OK;
+if (val) {                                              /* fast history? */
+    for (i = HIST_MIN; i < lnt; i = i << 1) ;           /* power of 2 */
+    lnt = i;
+    hst_fpc = (uint16 *) calloc (lnt, sizeof (uint16));
+    hst_fpsw = (uint16 *) calloc (lnt, sizeof (uint16));
+    hst_fir = (uint16 *) calloc (lnt, sizeof (uint16));
+    hst_fpa = (uint32 *) calloc (lnt, sizeof (uint32));
+    hst_fwn = (uint32 *) calloc (lnt, sizeof (uint32));
+    hst_wlog_pa = (uint32 *) calloc (lnt * HIST_WLOG, sizeof (uint32));
+    hst_wlog_old = (uint16 *) calloc (lnt * HIST_WLOG, sizeof (uint16));
+    if ((hst_fpc == NULL) || (hst_fpsw == NULL) || (hst_fir == NULL) ||
+        (hst_fpa == NULL) || (hst_fwn == NULL) ||
+        (hst_wlog_pa == NULL) || (hst_wlog_old == NULL)) {
+        cpu_free_hist ();
+        return SCPE_MEM;
+        }
+    hst_fmask = lnt - 1;
+    hst_wlog_mask = (lnt * HIST_WLOG) - 1;
     }
-if (lnt) {
+else {
     hst = (InstHistory *) calloc (lnt, sizeof (InstHistory));
     if (hst == NULL)
         return SCPE_MEM;
-    hst_lnt = lnt;
     }
+hst_lnt = lnt;
+return SCPE_OK;
+}
+
+/* Show fast history.  Memory is copied and the write log is undone
+   backwards from the newest entry, so when an entry is reached the copy
+   holds memory as it was at its fetch.  Instruction words are only known
+   while the log reaches back that far, and on the same page as the IR. */
+
+static t_stat cpu_show_fhist (FILE *st, int32 lnt)
+{
+int32 j, k, used, ir;
+uint32 hi, w, pc, pa;
+uint16 *mc, *iw;
+uint8 *ik;
+t_value sim_eval[HIST_ILNT];
+t_stat r;
+
+mc = (uint16 *) malloc (MEMSIZE);
+iw = (uint16 *) calloc (lnt * HIST_ILNT, sizeof (uint16));
+ik = (uint8 *) calloc (lnt * HIST_ILNT, sizeof (uint8));
+if ((mc == NULL) || (iw == NULL) || (ik == NULL)) {
+    free (mc);
+    free (iw);
+    free (ik);
+    return SCPE_MEM;
+    }
+memcpy (mc, M, MEMSIZE);
+w = hst_wlog_n;
+for (k = lnt - 1; k >= 0; k--) {                        /* newest first */
+    hi = (hst_fn - lnt + k) & hst_fmask;
+    if ((hst_fpc[hi] & HIST_VLD) == 0)
+        break;
+    if ((hst_wlog_n - hst_fwn[hi]) > (hst_wlog_mask + 1))
+        break;                                          /* log too short */
+    while (w != hst_fwn[hi]) {                          /* undo later writes */
+        w = w - 1;
+        mc[hst_wlog_pa[w & hst_wlog_mask]] = hst_wlog_old[w & hst_wlog_mask];
+        }
+    pc = hst_fpc[hi] & ~HIST_VLD;
+    pa = hst_fpa[hi];
+    for (j = 1; j < HIST_ILNT; j++) {
+        if (((pc & 017777) + (j << 1) <= 017777) &&     /* same page, memory? */
+            ADDR_IS_MEM (pa + (j << 1))) {
+            iw[(k * HIST_ILNT) + j] = mc[(pa >> 1) + j];
+            ik[(k * HIST_ILNT) + j] = 1;
+            }
+        }
+    }
+fprintf (st, "PC     PSW    IR\n\n");
+for (k = 0; k < lnt; k++) {
+    hi = (hst_fn - lnt + k) & hst_fmask;
+    if ((hst_fpc[hi] & HIST_VLD) == 0)
+        continue;
+    ir = hst_fir[hi];
+    fprintf (st, "%06o %06o|", hst_fpc[hi] & ~HIST_VLD, hst_fpsw[hi]);
+    sim_eval[0] = ir;
+    for (j = 1; j < HIST_ILNT; j++)
+        sim_eval[j] = iw[(k * HIST_ILNT) + j];
+    r = fprint_sym (st, hst_fpc[hi] & ~HIST_VLD, sim_eval, &cpu_unit, SWMASK ('M'));
+    if (r > 0)
+        fprintf (st, "(undefined) %06o", ir);
+    else {
+        for (j = 1, used = (1 - r) >> 1; j < used; j++) {   /* r = -(bytes - 1) */
+            if (!ik[(k * HIST_ILNT) + j]) {
+                fprintf (st, " (operand words lost)");
+                break;
+                }
+            }
+        }
+    fputc ('\n', st);
+    }
+free (mc);
+free (iw);
+free (ik);
 return SCPE_OK;
 }
 
@@ -3833,6 +4774,8 @@ if (cptr) {
         return SCPE_ARG;
     }
 else lnt = hst_lnt;
+if (hst_fmask)                                          /* fast history? */
+    return cpu_show_fhist (st, lnt);
 di = hst_p - lnt;                                       /* work forward */
 if (di < 0)
     di = di + hst_lnt;
@@ -3860,6 +4803,323 @@ for (k = 0; k < lnt; k++) {                             /* print specified */
 return SCPE_OK;
 }
 
+/* Profiler */
+
+static const char *cpu_prof_mname[4] = { "kernel", "supervisor", "mode2", "user" };
+
+static const char *cpu_prof_cname[PROF_NCLASS] = {
+    "integer", "branch", "trap", "psw_mmu", "eis_fis",
+    "cis", "fp11", "wait_halt", "unmapped"
+    };
+
+#define CPU_OP(n)       #n,
+static const char *cpu_prof_oname[OPC_N] = { CPU_OPS };
+#undef CPU_OP
+
+static int32 cpu_prof_classof (int32 opc, int32 IR)
+{
+switch (opc) {
+    case OPC_FP:
+        return PROF_FP;
+    case OPC_EIS:
+        if ((IR & 0177000) == 0077000)                  /* SOB */
+            return PROF_BRANCH;
+        return ((IR & 0177000) == 0076000)? PROF_CIS: PROF_EIS;
+    case OPC_WAIT: case OPC_HALT:
+        return PROF_WAIT;
+    case OPC_ILL: case OPC_BPT: case OPC_IOT: case OPC_EMT:
+    case OPC_TRAP: case OPC_RTI: case OPC_CSM:
+        return PROF_TRAP;
+    case OPC_RESET: case OPC_MFPT: case OPC_SPL: case OPC_CCC:
+    case OPC_SCC: case OPC_MFPI: case OPC_MTPI: case OPC_MFPD:
+    case OPC_MTPD: case OPC_MTPS: case OPC_MFPS:
+        return PROF_PSW;
+    case OPC_JMP: case OPC_RTS: case OPC_JSR: case OPC_MARK:
+        return PROF_BRANCH;
+    default:
+        if (((IR & 0074000) == 0) && ((IR & 0003400) != 0))
+            return PROF_BRANCH;                         /* BR, Bxx */
+        return PROF_INT;
+        }
+}
+
+static uint32 cpu_prof_hash (int32 pa, int32 mode, int32 opc)
+{
+uint32 h = ((uint32) pa * 2654435761u) ^ ((mode << 7) | opc);
+
+return h ^ (h >> 15);
+}
+
+static PROF_ENT *cpu_prof_find (int32 pa, int32 mode, int32 opc)
+{
+uint32 i = cpu_prof_hash (pa, mode, opc) & (cpu_prof_size - 1);
+PROF_ENT *e;
+
+for (;; i = (i + 1) & (cpu_prof_size - 1)) {
+    e = &cpu_prof_tab[i];
+    if ((e->cnt == 0) ||
+        ((e->pa == pa) && (e->mode == mode) && (e->opc == opc)))
+        return e;
+    }
+}
+
+static t_stat cpu_prof_grow (void)
+{
+PROF_ENT *old = cpu_prof_tab, *e;
+uint32 i, osize = cpu_prof_size;
+
+cpu_prof_size = osize? osize << 1: PROF_INIHASH;
+cpu_prof_tab = (PROF_ENT *) calloc (cpu_prof_size, sizeof (PROF_ENT));
+if (cpu_prof_tab == NULL) {
+    cpu_prof_tab = old;
+    cpu_prof_size = osize;
+    return SCPE_MEM;
+    }
+for (i = 0; i < osize; i++) {                           /* rehash */
+    if (old[i].cnt) {
+        e = cpu_prof_find (old[i].pa, old[i].mode, old[i].opc);
+        *e = old[i];
+        }
+    }
+free (old);
+return SCPE_OK;
+}
+
+/* Take a sample: the instruction at PC, about to be executed */
+
+t_stat cpu_prof_svc (UNIT *uptr)
+{
+static const int32 swmap[4] = {
+    SWMASK ('K'), SWMASK ('S'), SWMASK ('U'), SWMASK ('U')
+    };
+int32 pa, ir, opc, cls, jitter;
+PROF_ENT *e;
+
+if (cpu_prof_int == 0)
+    return SCPE_OK;
+cpu_prof_seed = cpu_prof_seed * 1103515245 + 12345;
+jitter = (int32) ((cpu_prof_seed >> 16) % ((cpu_prof_int >> 2) + 1)) - (cpu_prof_int >> 3);
+sim_activate (uptr, cpu_prof_int + jitter);
+pa = relocC (PC, swmap[cm]);
+if (ADDR_IS_MEM (pa)) {
+    ir = RdMemW (pa);
+    opc = wait_state? OPC_WAIT: cpu_optab[ir];
+    cls = cpu_prof_classof (opc, ir);
+    }
+else {                                                  /* I/O page, NXM, unmapped */
+    pa = PROF_NOPA;
+    ir = 0;
+    opc = OPC_ILL;
+    cls = PROF_NOMAP;
+    }
+if (((cpu_prof_used + 1) << 1) > cpu_prof_size) {       /* keep half free */
+    if (cpu_prof_grow () != SCPE_OK)
+        return SCPE_OK;
+    }
+e = cpu_prof_find (pa, cm, opc);
+if (e->cnt++ == 0) {
+    e->pa = pa;
+    e->va = (uint16) PC;
+    e->mode = (uint8) cm;
+    e->opc = (uint8) opc;
+    e->cls = (uint8) cls;
+    cpu_prof_used++;
+    }
+cpu_prof_n++;
+cpu_prof_mode[cm]++;
+cpu_prof_class[cls]++;
+cpu_prof_opc[opc]++;
+return SCPE_OK;
+}
+
+static void cpu_prof_clear (void)
+{
+free (cpu_prof_tab);
+cpu_prof_tab = NULL;
+cpu_prof_size = cpu_prof_used = 0;
+cpu_prof_n = 0;
+memset (cpu_prof_mode, 0, sizeof (cpu_prof_mode));
+memset (cpu_prof_class, 0, sizeof (cpu_prof_class));
+memset (cpu_prof_opc, 0, sizeof (cpu_prof_opc));
+}
+
+/* Set profiler: interval, 0 = off, no value = clear samples */
+
+t_stat cpu_set_prof (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+int32 n;
+t_stat r;
+
+if (cptr == NULL) {
+    cpu_prof_clear ();
+    return SCPE_OK;
+    }
+n = (int32) get_uint (cptr, 10, 100000000, &r);
+if ((r != SCPE_OK) || (n && (n < PROF_MIN)))
+    return SCPE_ARG;
+if (n == 0) {
+    sim_cancel (&cpu_prof_unit);
+    cpu_prof_clear ();
+    }
+else {
+    sim_register_internal_device (&cpu_prof_dev);
+    sim_cancel (&cpu_prof_unit);
+    sim_activate (&cpu_prof_unit, n);
+    }
+cpu_prof_int = n;
+return SCPE_OK;
+}
+
+/* Sort by physical PC, then mode and opcode */
+
+static int cpu_prof_cmp_pa (const void *a, const void *b)
+{
+const PROF_ENT *ea = (const PROF_ENT *) a, *eb = (const PROF_ENT *) b;
+
+if (ea->pa != eb->pa)
+    return (ea->pa < eb->pa)? -1: 1;
+if (ea->mode != eb->mode)
+    return (ea->mode < eb->mode)? -1: 1;
+return (int) ea->opc - (int) eb->opc;
+}
+
+static int cpu_prof_cmp_cnt (const void *a, const void *b)
+{
+uint32 ca = *(const uint32 *) a, cb = *(const uint32 *) b;
+
+return (ca > cb)? -1: (ca < cb);
+}
+
+/* Samples by PC in physical address order, compacted; caller frees */
+
+static PROF_ENT *cpu_prof_sorted (void)
+{
+PROF_ENT *l;
+uint32 i, n;
+
+l = (PROF_ENT *) malloc ((cpu_prof_used + 1) * sizeof (PROF_ENT));
+if (l == NULL)
+    return NULL;
+for (i = n = 0; i < cpu_prof_size; i++) {
+    if (cpu_prof_tab[i].cnt)
+        l[n++] = cpu_prof_tab[i];
+    }
+qsort (l, n, sizeof (PROF_ENT), cpu_prof_cmp_pa);
+return l;
+}
+
+/* Show profile: totals by mode, class and opcode, then the physical pages
+   in address order, each with its hottest PCs (SHOW CPU PROFILE=n for the
+   n hottest PCs overall, default 40) */
+
+t_stat cpu_show_prof (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+const char *cptr = (const char *) desc;
+PROF_ENT *l;
+uint32 *cnts, i, j, top, min;
+uint32 opcs[OPC_N];
+double pct;
+t_uint64 psum;
+t_stat r;
+
+if (cpu_prof_int == 0)
+    return SCPE_NOFNC;
+top = 40;
+if (cptr) {
+    top = (uint32) get_uint (cptr, 10, 1000000, &r);
+    if ((r != SCPE_OK) || (top == 0))
+        return SCPE_ARG;
+    }
+fprintf (st, "%.0f samples, one per %d instructions\n", (double) cpu_prof_n, cpu_prof_int);
+if (cpu_prof_n == 0)
+    return SCPE_OK;
+pct = 100.0 / (double) cpu_prof_n;
+fprintf (st, "\nMode         samples      %%\n");
+for (i = 0; i < 4; i++) {
+    if (cpu_prof_mode[i])
+        fprintf (st, "%-10s %9.0f %6.2f\n", cpu_prof_mname[i],
+                 (double) cpu_prof_mode[i], cpu_prof_mode[i] * pct);
+    }
+fprintf (st, "\nClass        samples      %%\n");
+for (i = 0; i < PROF_NCLASS; i++) {
+    if (cpu_prof_class[i])
+        fprintf (st, "%-10s %9.0f %6.2f\n", cpu_prof_cname[i],
+                 (double) cpu_prof_class[i], cpu_prof_class[i] * pct);
+    }
+for (i = 0; i < OPC_N; i++)
+    opcs[i] = i;
+for (i = 1; i < OPC_N; i++) {                           /* sort opcodes by count */
+    uint32 o = opcs[i];
+
+    for (j = i; (j > 0) && (cpu_prof_opc[opcs[j - 1]] < cpu_prof_opc[o]); j--)
+        opcs[j] = opcs[j - 1];
+    opcs[j] = o;
+    }
+fprintf (st, "\nOpcode       samples      %%\n");
+for (i = 0; (i < 10) && cpu_prof_opc[opcs[i]]; i++)
+    fprintf (st, "%-10s %9.0f %6.2f\n", cpu_prof_oname[opcs[i]],
+             (double) cpu_prof_opc[opcs[i]], cpu_prof_opc[opcs[i]] * pct);
+l = cpu_prof_sorted ();
+cnts = (uint32 *) malloc ((cpu_prof_used + 1) * sizeof (uint32));
+if ((l == NULL) || (cnts == NULL)) {
+    free (l);
+    free (cnts);
+    return SCPE_MEM;
+    }
+for (i = 0; i < cpu_prof_used; i++)                     /* count of n-th hottest PC */
+    cnts[i] = l[i].cnt;
+qsort (cnts, cpu_prof_used, sizeof (uint32), cpu_prof_cmp_cnt);
+min = cnts[((top < cpu_prof_used)? top: cpu_prof_used) - 1];
+fprintf (st, "\nPhys page    samples      %%    PC      mode\n");
+for (i = 0; i < cpu_prof_used; i = j) {
+    for (j = i, psum = 0; (j < cpu_prof_used) &&
+         ((l[j].pa >> 13) == (l[i].pa >> 13)); j++)
+        psum = psum + l[j].cnt;
+    if (l[i].pa == PROF_NOPA)
+        fprintf (st, "unmapped   %9.0f %6.2f\n", (double) psum, psum * pct);
+    else fprintf (st, "%08o   %9.0f %6.2f\n", l[i].pa & ~017777, (double) psum, psum * pct);
+    for (; i < j; i++) {
+        if (l[i].cnt >= min)
+            fprintf (st, "  %08o %9u %6.2f    %06o  %s  %s\n", l[i].pa, l[i].cnt,
+                     l[i].cnt * pct, l[i].va, psw_modes[l[i].mode],
+                     cpu_prof_oname[l[i].opc]);
+        }
+    }
+free (l);
+free (cnts);
+return SCPE_OK;
+}
+
+/* Export profile as folded stacks: mode;class;page;PC opcode count */
+
+t_stat cpu_export_prof (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+FILE *f;
+PROF_ENT *l;
+uint32 i;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+if (cpu_prof_int == 0)
+    return SCPE_NOFNC;
+if ((l = cpu_prof_sorted ()) == NULL)
+    return SCPE_MEM;
+if ((f = sim_fopen (cptr, "w")) == NULL) {
+    free (l);
+    return SCPE_OPENERR;
+    }
+for (i = 0; i < cpu_prof_used; i++) {
+    fprintf (f, "%s;%s;", cpu_prof_mname[l[i].mode], cpu_prof_cname[l[i].cls]);
+    if (l[i].pa == PROF_NOPA)
+        fprintf (f, "unmapped;%06o %u\n", l[i].va, l[i].cnt);
+    else fprintf (f, "page_%08o;%06o_%s %u\n", l[i].pa & ~017777, l[i].va,
+                  cpu_prof_oname[l[i].opc], l[i].cnt);
+    }
+fclose (f);
+free (l);
+return SCPE_OK;
+}
+
 /* Virtual address translation */
 
 t_stat cpu_show_virt (FILE *of, UNIT *uptr, int32 val, CONST void *desc)
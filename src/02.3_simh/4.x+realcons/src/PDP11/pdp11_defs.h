@@ -878,6 +878,32 @@ extern uint16 *M;                                       /* Memory */
 extern DEVICE cpu_dev;
 extern UNIT cpu_unit;
 
+/* Memory writes check the block cache's "has code" bitmap, one bit per
+   128 byte chunk of physical memory (see pdp11_cpu.c) */
+
+#define CODE_V_CHUNK    7                               /* 128 byte chunks */
+#define CODE_NCHUNK     (MAXMEMSIZE >> CODE_V_CHUNK)
+#define CODE_WRITE(pa)  (((cpu_code_map[(pa) >> (CODE_V_CHUNK + 5)] >> \
+                            (((pa) >> CODE_V_CHUNK) & 037)) & 1)? \
+                            cpu_code_write (pa): (void) 0)
+
+extern uint32 cpu_code_map[CODE_NCHUNK >> 5];
+void cpu_code_write (int32 pa);
+
+/* With the fast instruction history on, memory writes are logged with the
+   word they overwrite, so SHOW CPU HISTORY can rebuild the instruction
+   words as they were when fetched (see pdp11_cpu.c) */
+
+#define HIST_WRITE(pa)  ((hst_wlog_mask)? \
+                            (hst_wlog_pa[hst_wlog_n & hst_wlog_mask] = (pa) >> 1, \
+                             hst_wlog_old[hst_wlog_n++ & hst_wlog_mask] = M[(pa) >> 1], \
+                             (void) 0): (void) 0)
+
+extern uint32 hst_wlog_mask;
+extern uint32 hst_wlog_n;
+extern uint32 *hst_wlog_pa;
+extern uint16 *hst_wlog_old;
+
 #if defined (UC15)                                      /* UC15 */
 #define INIMODEL        MOD_1105
 #define INIOPTNS        SOP_1105
@@ -906,10 +932,10 @@ int32 Map_Write18 (uint32 ba, int32 bc, uint32 *buf);
 
 #define RdMemW(pa)      (M[(pa) >> 1])
 #define RdMemB(pa)      ((((pa) & 1)? M[(pa) >> 1] >> 8: M[(pa) >> 1]) & 0377)
-#define WrMemW(pa,d)    M[(pa) >> 1] = (d)
-#define WrMemB(pa,d)    M[(pa) >> 1] = ((pa) & 1)? \
+#define WrMemW(pa,d)    (CODE_WRITE (pa), HIST_WRITE (pa), M[(pa) >> 1] = (d))
+#define WrMemB(pa,d)    (CODE_WRITE (pa), HIST_WRITE (pa), M[(pa) >> 1] = ((pa) & 1)? \
                             ((M[(pa) >> 1] & 0377) | (((d) & 0377) << 8)): \
-                            ((M[(pa) >> 1] & ~0377) | ((d) & 0377))
+                            ((M[(pa) >> 1] & ~0377) | ((d) & 0377)))
 
 #endif
 
@@ -335,6 +335,8 @@ MTAB dz_mod[] = {
         NULL, &tmxr_show_cstat, (void *) &dz_desc, "Display current connections" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATISTICS", NULL,
         NULL, &tmxr_show_cstat, (void *) &dz_desc, "Display multiplexer statistics" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NC, 0, NULL, "STATISTICS=file",
+        &tmxr_set_stats, NULL, (void *) &dz_desc, "Write line statistics to a file" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 010, "ADDRESS", "ADDRESS",
         &set_addr, &show_addr, NULL, "Bus address" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, DZ_LINES, "VECTOR", "VECTOR",
@@ -962,6 +964,7 @@ fprintf (st, "DETACH %s command.\n\n", dptr->name);
 fprintf (st, "Other special %s commands:\n\n", dptr->name);
 fprintf (st, "   sim> SHOW %s CONNECTIONS           show current connections\n", dptr->name);
 fprintf (st, "   sim> SHOW %s STATISTICS            show statistics for active connections\n", dptr->name);
+fprintf (st, "   sim> SET %s STATISTICS=file        write line statistics to a file\n", dptr->name);
 fprintf (st, "   sim> SET %s DISCONNECT=linenumber  disconnects the specified line.\n\n\n", dptr->name);
 fprintf (st, "All open connections are lost when the simulator shuts down or the %s is\n", dptr->name);
 fprintf (st, "detached.\n\n");
@@ -602,7 +602,7 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
     if (pbc > (bc - i))                                 /* limit to rem xfr */
         pbc = bc - i;
     for (j = 0; j < pbc; j = j + 2) {                   /* loop by words */
-        M[pa >> 1] = *buf++;                            /* put word */
+        WrMemW (pa, *buf++);                            /* put word */
         if (!(massbus[mb].cs2 & CS2_UAI)) {             /* if not inhb */
             ba = ba + 2;                                /* incr ba, pa */
             pa = pa + 2;
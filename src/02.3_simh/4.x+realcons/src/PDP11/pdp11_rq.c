@@ -172,6 +172,8 @@ extern int32 MMR2;
 #define cnum            wait                            /* controller index */
 #define io_status       u5                              /* io status from callback */
 #define io_complete     u6                              /* io completion flag */
+#define io_state        u3                              /* tag disk state */
+#define io_seq          u4                              /* tag disk issue order */
 #define rqxb            filebuf                         /* xfer buffer */
 #define UNIT_WPRT       (UNIT_WLK | UNIT_RO)            /* write prot */
 #define RQ_RMV(u)       ((drv_tab[GET_DTYPE (u->flags)].flgs & RQDF_RMV)? \
@@ -195,6 +197,20 @@ extern int32 MMR2;
 #define RQ_TIMER        (RQ_NUMDR)
 #define RQ_QUEUE        (RQ_TIMER + 1)
 
+/* Tagged queueing.  Each drive can have up to RQ_MAXQD transfer commands
+   in progress.  Tag 0 is the drive unit itself; tags 1 to RQ_MAXQD - 1
+   are hidden units after the timer and queue units, each with its own
+   current packet, transfer buffer and completion state. */
+
+#define RQ_MAXQD        8                               /* max xfers per drive */
+#define RQ_TAGS         (RQ_QUEUE + 1)                  /* first tag unit */
+#define RQ_NUMTAG       (RQ_NUMDR * (RQ_MAXQD - 1))     /* # tag units */
+#define RQ_NUMUN        (RQ_TAGS + RQ_NUMTAG)           /* # units */
+#define RQ_TAG(d,t)     (RQ_TAGS + ((d) * (RQ_MAXQD - 1)) + (t) - 1)
+
+#define RQ_IOBSY        1                               /* tag xfer on disk */
+#define RQ_IOWAIT       2                               /* tag waits for disk */
+
 /* Internal packet management.  The real RQDX3 manages its packets as true
    linked lists.  However, use of actual addresses in structures won't work
    with save/restore.  Accordingly, the packets are an arrayed structure,
@@ -776,6 +792,8 @@ typedef struct {
     uint32              hat;                            /* host timer */
     uint32              htmo;                           /* host timeout */
     uint32              ctype;                          /* controller type */
+    uint32              qdepth;                         /* xfers per drive */
+    uint32              dseq;                           /* disk issue count */
     struct uq_ring      cq;                             /* cmd ring */
     struct uq_ring      rq;                             /* rsp ring */
     struct rqpkt        pak[RQ_NPKTS];                  /* packet queue */
@@ -847,6 +865,8 @@ t_stat rq_show_ctype (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_wlk (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_ctrl (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_show_unitq (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat rq_set_qdepth (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat rq_show_qdepth (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat rq_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr);
 const char *rq_description (DEVICE *dptr);
 
@@ -887,6 +907,11 @@ void rq_init_int (MSC *cp);
 void rq_ring_int (MSC *cp, struct uq_ring *ring);
 t_bool rq_fatal (MSC *cp, uint16 err);
 UNIT *rq_getucb (MSC *cp, uint16 lu);
+UNIT *rq_tagucb (UNIT *uptr, int32 t);
+UNIT *rq_drvucb (UNIT *uptr);
+UNIT *rq_freetag (MSC *cp, UNIT *uptr);
+t_bool rq_busy (UNIT *uptr);
+t_bool rq_ready (MSC *cp, UNIT *uptr, uint16 pkt);
 int32 rq_map_pa (uint32 pa);
 void rq_setint (MSC *cp);
 void rq_clrint (MSC *cp);
@@ -904,6 +929,10 @@ MSC rq_ctx = { 0 };
 
 #define IOLN_RQ         004
 
+#define RQ_TAGUNIT      { UDATA (&rq_svc, UNIT_DIS, 0) }
+#define RQ_TAGUNITS     RQ_TAGUNIT, RQ_TAGUNIT, RQ_TAGUNIT, RQ_TAGUNIT, \
+                        RQ_TAGUNIT, RQ_TAGUNIT, RQ_TAGUNIT  /* RQ_MAXQD - 1 */
+
 DIB rq_dib = {
     IOBA_AUTO, IOLN_RQ, &rq_rd, &rq_wr,
     1, IVCL (RQ), 0, { &rq_inta }, IOLN_RQ
@@ -919,7 +948,8 @@ UNIT rq_unit[] = {
     { UDATA (&rq_svc, UNIT_FIX+UNIT_ATTABLE+UNIT_DISABLE+UNIT_ROABLE+
             (RX50_DTYPE << UNIT_V_DTYPE), RQ_SIZE (RX50)) },
     { UDATA (&rq_tmrsvc, UNIT_IDLE|UNIT_DIS, 0) },
-    { UDATA (&rq_quesvc, UNIT_DIS, 0) }
+    { UDATA (&rq_quesvc, UNIT_DIS, 0) },
+    RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS
     };
 
 REG rq_reg[] = {
@@ -958,6 +988,8 @@ REG rq_reg[] = {
     { URDATAD (PKTQ,    rq_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
     { URDATAD (UFLG,    rq_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rq_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
+    { DRDATA  (QDEPTH,  rq_ctx.qdepth,             4), REG_HRO },
+    { URDATA  (TCPKT,   rq_unit[RQ_TAGS].cpkt, 10, 5, 0, RQ_NUMTAG, REG_HRO) },
     { GRDATA  (DEVADDR, rq_dib.ba,      DEV_RDX, 32, 0), REG_HRO },
     { GRDATA  (DEVVEC,  rq_dib.vec,     DEV_RDX, 16, 0), REG_HRO },
     { DRDATA  (DEVLBN,  drv_tab[RA8U_DTYPE].lbn, 22), REG_HRO },
@@ -995,6 +1027,8 @@ MTAB rq_mod[] = {
       &rq_set_ctype, NULL, NULL, "Set KLESI (RC25) Controller Type"  },
     { MTAB_XTD|MTAB_VDV, RUX50_CTYPE, NULL, "RUX50",
       &rq_set_ctype, NULL, NULL, "Set RUX50 (UNIBUS RX50) Controller Type" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "QDEPTH", "QDEPTH=n",
+      &rq_set_qdepth, &rq_show_qdepth, NULL, "Set/Display transfers in progress per drive (1-8)" },
     { MTAB_XTD|MTAB_VUN|MTAB_NMO, 0, "UNITQ", NULL,
       NULL, &rq_show_unitq, NULL, "Display unit queue" },
     { MTAB_XTD|MTAB_VUN, RX50_DTYPE, NULL, "RX50",
@@ -1067,7 +1101,7 @@ MTAB rq_mod[] = {
 
 DEVICE rq_dev = {
     "RQ", rq_unit, rq_reg, rq_mod,
-    RQ_NUMDR + 2, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
+    RQ_NUMUN, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
     NULL, NULL, &rq_reset,
     &rq_boot, &rq_attach, &rq_detach,
     &rq_dib, DEV_DISABLE | DEV_UBUS | DEV_QBUS | DEV_DEBUG | DEV_DISK | DEV_SECTORS,
@@ -1100,7 +1134,8 @@ UNIT rqb_unit[] = {
     { UDATA (&rq_svc, UNIT_FIX+UNIT_ATTABLE+UNIT_DISABLE+UNIT_ROABLE+
             (RD54_DTYPE << UNIT_V_DTYPE), RQ_SIZE (RD54)) },
     { UDATA (&rq_tmrsvc, UNIT_IDLE|UNIT_DIS, 0) },
-    { UDATA (&rq_quesvc, UNIT_DIS, 0) }
+    { UDATA (&rq_quesvc, UNIT_DIS, 0) },
+    RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS
     };
 
 REG rqb_reg[] = {
@@ -1135,6 +1170,8 @@ REG rqb_reg[] = {
     { URDATAD (PKTQ,    rqb_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
     { URDATAD (UFLG,    rqb_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rqb_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
+    { DRDATA  (QDEPTH,  rqb_ctx.qdepth,             4), REG_HRO },
+    { URDATA  (TCPKT,   rqb_unit[RQ_TAGS].cpkt, 10, 5, 0, RQ_NUMTAG, REG_HRO) },
     { GRDATA  (DEVADDR, rqb_dib.ba,      DEV_RDX, 32, 0), REG_HRO },
     { GRDATA  (DEVVEC,  rqb_dib.vec,     DEV_RDX, 16, 0), REG_HRO },
     { NULL }
@@ -1142,7 +1179,7 @@ REG rqb_reg[] = {
 
 DEVICE rqb_dev = {
     "RQB", rqb_unit, rqb_reg, rq_mod,
-    RQ_NUMDR + 2, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
+    RQ_NUMUN, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
     NULL, NULL, &rq_reset,
     &rq_boot, &rq_attach, &rq_detach,
     &rqb_dib, DEV_DISABLE | DEV_DIS | DEV_UBUS | DEV_QBUS | DEV_DEBUG | DEV_DISK | DEV_SECTORS,
@@ -1175,7 +1212,8 @@ UNIT rqc_unit[] = {
     { UDATA (&rq_svc, UNIT_FIX+UNIT_ATTABLE+UNIT_DISABLE+UNIT_ROABLE+
             (RD54_DTYPE << UNIT_V_DTYPE), RQ_SIZE (RD54)) },
     { UDATA (&rq_tmrsvc, UNIT_IDLE|UNIT_DIS, 0) },
-    { UDATA (&rq_quesvc, UNIT_DIS, 0) }
+    { UDATA (&rq_quesvc, UNIT_DIS, 0) },
+    RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS
     };
 
 REG rqc_reg[] = {
@@ -1210,6 +1248,8 @@ REG rqc_reg[] = {
     { URDATAD (PKTQ,    rqc_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
     { URDATAD (UFLG,    rqc_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rqc_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
+    { DRDATA  (QDEPTH,  rqc_ctx.qdepth,             4), REG_HRO },
+    { URDATA  (TCPKT,   rqc_unit[RQ_TAGS].cpkt, 10, 5, 0, RQ_NUMTAG, REG_HRO) },
     { GRDATA  (DEVADDR, rqc_dib.ba,      DEV_RDX, 32, 0), REG_HRO },
     { GRDATA  (DEVVEC,  rqc_dib.vec,     DEV_RDX, 16, 0), REG_HRO },
     { NULL }
@@ -1217,7 +1257,7 @@ REG rqc_reg[] = {
 
 DEVICE rqc_dev = {
     "RQC", rqc_unit, rqc_reg, rq_mod,
-    RQ_NUMDR + 2, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
+    RQ_NUMUN, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
     NULL, NULL, &rq_reset,
     &rq_boot, &rq_attach, &rq_detach,
     &rqc_dib, DEV_DISABLE | DEV_DIS | DEV_UBUS | DEV_QBUS | DEV_DEBUG | DEV_DISK | DEV_SECTORS,
@@ -1250,7 +1290,8 @@ UNIT rqd_unit[] = {
     { UDATA (&rq_svc, UNIT_FIX+UNIT_ATTABLE+UNIT_DISABLE+UNIT_ROABLE+
             (RD54_DTYPE << UNIT_V_DTYPE), RQ_SIZE (RD54)) },
     { UDATA (&rq_tmrsvc, UNIT_IDLE|UNIT_DIS, 0) },
-    { UDATA (&rq_quesvc, UNIT_DIS, 0) }
+    { UDATA (&rq_quesvc, UNIT_DIS, 0) },
+    RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS, RQ_TAGUNITS
     };
 
 REG rqd_reg[] = {
@@ -1285,6 +1326,8 @@ REG rqd_reg[] = {
     { URDATAD (PKTQ,    rqd_unit[0].pktq, 10, 5, 0, RQ_NUMDR, 0, "packet queue, units 0 to 3") },
     { URDATAD (UFLG,    rqd_unit[0].uf,  DEV_RDX, 16, 0, RQ_NUMDR, 0, "unit flags, units 0 to 3") },
     { URDATA  (CAPAC,   rqd_unit[0].capac, 10, T_ADDR_W, 0, RQ_NUMDR, PV_LEFT | REG_HRO) },
+    { DRDATA  (QDEPTH,  rqd_ctx.qdepth,             4), REG_HRO },
+    { URDATA  (TCPKT,   rqd_unit[RQ_TAGS].cpkt, 10, 5, 0, RQ_NUMTAG, REG_HRO) },
     { GRDATA  (DEVADDR, rqd_dib.ba,      DEV_RDX, 32, 0), REG_HRO },
     { GRDATA  (DEVVEC,  rqd_dib.vec,     DEV_RDX, 16, 0), REG_HRO },
     { NULL }
@@ -1292,7 +1335,7 @@ REG rqd_reg[] = {
 
 DEVICE rqd_dev = {
     "RQD", rqd_unit, rqd_reg, rq_mod,
-    RQ_NUMDR + 2, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
+    RQ_NUMUN, DEV_RDX, T_ADDR_W, 2, DEV_RDX, 16,
     NULL, NULL, &rq_reset,
     &rq_boot, &rq_attach, &rq_detach,
     &rqd_dib, DEV_DISABLE | DEV_DIS | DEV_UBUS | DEV_QBUS | DEV_DEBUG | DEV_DISK | DEV_SECTORS,
@@ -1519,7 +1562,8 @@ if (cp->csta < CST_UP) {                                /* still init? */
 
 for (i = 0; i < RQ_NUMDR; i++) {                        /* chk unit q's */
     nuptr = dptr->units + i;                            /* ptr to unit */
-    if (nuptr->cpkt || (nuptr->pktq == 0))
+    if ((nuptr->pktq == 0) ||                           /* empty or head */
+        !rq_ready (cp, nuptr, nuptr->pktq))             /* must wait? */
         continue;
     pkt = rq_deqh (cp, &nuptr->pktq);                   /* get top of q */
     if (!rq_mscp (cp, pkt, FALSE))                      /* process */
@@ -1654,19 +1698,28 @@ uint16 lu = cp->pak[pkt].d[CMD_UN];                     /* unit # */
 uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* opcode */
 uint32 ref = GETP32 (pkt, ABO_REFL);                    /* cmd ref # */
 uint16 tpkt, prv;
-UNIT *uptr;
+int32 t;
+UNIT *uptr, *tuptr;
 DEVICE *dptr = rq_devmap[cp->cnum];
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_abo\n");
 
 tpkt = 0;                                               /* set no mtch */
 if ((uptr = rq_getucb (cp, lu))) {                      /* get unit */
-    if (uptr->cpkt &&                                   /* curr pkt? */
-        (GETP32 (uptr->cpkt, CMD_REFL) == ref)) {       /* match ref? */
-        tpkt = uptr->cpkt;                              /* save match */
-        uptr->cpkt = 0;                                 /* gonzo */
-        sim_cancel (uptr);                              /* cancel unit */
-        sim_activate (dptr->units + RQ_QUEUE, rq_qtime);
+    for (t = 0; t < RQ_MAXQD; t++) {                    /* srch tags */
+        tuptr = rq_tagucb (uptr, t);
+        if (tuptr->cpkt &&                              /* curr pkt? */
+            (GETP32 (tuptr->cpkt, CMD_REFL) == ref))    /* match ref? */
+            break;
+        }
+    if (t < RQ_MAXQD) {                                 /* found? */
+        if (tuptr->io_state != RQ_IOBSY) {              /* not on disk? */
+            tpkt = tuptr->cpkt;                         /* save match */
+            tuptr->cpkt = 0;                            /* gonzo */
+            tuptr->io_state = 0;
+            sim_cancel (tuptr);                         /* cancel unit */
+            sim_activate (dptr->units + RQ_QUEUE, rq_qtime);
+            }                                           /* else let it end */
         }
     else if (uptr->pktq &&                              /* head of q? */
         (GETP32 (uptr->pktq, CMD_REFL) == ref)) {       /* match ref? */
@@ -1706,7 +1759,7 @@ UNIT *uptr;
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_avl\n");
 
 if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
-    if (q && uptr->cpkt) {                              /* need to queue? */
+    if (q && rq_busy (uptr)) {                          /* need to queue? */
         rq_enqt (cp, &uptr->pktq, pkt);                 /* do later */
         return OK;
         }
@@ -1728,14 +1781,21 @@ t_bool rq_gcs (MSC *cp, uint16 pkt, t_bool q)
 uint16 lu = cp->pak[pkt].d[CMD_UN];                     /* unit # */
 uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* opcode */
 uint32 ref = GETP32 (pkt, GCS_REFL);                    /* ref # */
-int32 tpkt;
+int32 tpkt = 0, t;
 UNIT *uptr;
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_gcs\n");
 
-if ((uptr = rq_getucb (cp, lu)) &&                      /* valid lu? */
-    (tpkt = uptr->cpkt) &&                              /* queued pkt? */
-    (GETP32 (tpkt, CMD_REFL) == ref) &&                 /* match ref? */
+if ((uptr = rq_getucb (cp, lu))) {                      /* valid lu? */
+    for (t = 0; t < RQ_MAXQD; t++) {                    /* srch tags */
+        tpkt = rq_tagucb (uptr, t)->cpkt;
+        if (tpkt && (GETP32 (tpkt, CMD_REFL) == ref))   /* match ref? */
+            break;
+        }
+    if (t == RQ_MAXQD)                                  /* none? */
+        tpkt = 0;
+    }
+if (tpkt &&                                             /* active pkt? */
     (GETP (tpkt, CMD_OPC, OPC) >= OP_ACC)) {            /* rd/wr cmd? */
     cp->pak[pkt].d[GCS_STSL] = cp->pak[tpkt].d[RW_WBCL];
     cp->pak[pkt].d[GCS_STSH] = cp->pak[tpkt].d[RW_WBCH];
@@ -1803,7 +1863,7 @@ UNIT *uptr;
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_onl\n");
 
 if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
-    if (q && uptr->cpkt) {                              /* need to queue? */
+    if (q && rq_busy (uptr)) {                          /* need to queue? */
         rq_enqt (cp, &uptr->pktq, pkt);                 /* do later */
         return OK;
         }
@@ -1875,7 +1935,7 @@ UNIT *uptr;
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_suc\n");
 
 if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
-    if (q && uptr->cpkt) {                              /* need to queue? */
+    if (q && rq_busy (uptr)) {                          /* need to queue? */
         rq_enqt (cp, &uptr->pktq, pkt);                 /* do later */
         return OK;
         }
@@ -1906,7 +1966,7 @@ UNIT *uptr;
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_fmt\n");
 
 if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
-    if (q && uptr->cpkt) {                              /* need to queue? */
+    if (q && rq_busy (uptr)) {                          /* need to queue? */
         rq_enqt (cp, &uptr->pktq, pkt);                 /* do later */
         return OK;
         }
@@ -1937,22 +1997,26 @@ t_bool rq_rw (MSC *cp, uint16 pkt, t_bool q)
 uint16 lu = cp->pak[pkt].d[CMD_UN];                     /* unit # */
 uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* opcode */
 uint16 sts;
-UNIT *uptr;
+UNIT *uptr, *tuptr;
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw(lu=%d, pkt=%d, queue=%s)\n", lu, pkt, q?"yes" : "no");
 
 if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
-    if (q && uptr->cpkt) {                              /* need to queue? */
+    tuptr = rq_freetag (cp, uptr);                      /* get free tag */
+    if ((tuptr == NULL) || (q && uptr->pktq)) {         /* need to queue? */
         uint16 tpktq = uptr->pktq;
 
         sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw - queued\n");
 
-        rq_enqt (cp, &tpktq, pkt);                      /* do later */
+        if (q)
+            rq_enqt (cp, &tpktq, pkt);                  /* do later */
+        else rq_enqh (cp, &tpktq, pkt);                 /* keep place */
         uptr->pktq = tpktq;
         return OK;
         }
     sts = rq_rw_valid (cp, pkt, uptr, cmd);             /* validity checks */
     if (sts == 0) {                                     /* ok? */
+        uptr = tuptr;                                   /* run on tag */
         uptr->cpkt = pkt;                               /* op in progress */
         cp->pak[pkt].d[RW_WBAL] = cp->pak[pkt].d[RW_BAL];
         cp->pak[pkt].d[RW_WBAH] = cp->pak[pkt].d[RW_BAH];
@@ -2014,18 +2078,50 @@ if ((cmd == OP_WR) || (cmd == OP_ERS)) {                /* write op? */
 return 0;                                               /* success! */
 }
 
-/* I/O completion callback */
+/* I/O completion callback
+
+   sim_disk completes transfers in the order they were issued, so the
+   callback belongs to the oldest tag on the disk.  Each tag then waits
+   out its own transfer time, so responses can go back to the host in a
+   different order from the commands.  Tags that found the disk full are
+   restarted. */
 
 void rq_io_complete (UNIT *uptr, t_stat status)
 {
 MSC *cp = rq_ctxmap[uptr->cnum];
+UNIT *tuptr, *ouptr = NULL;
+int32 t;
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_io_complete(status=%d)\n", status);
 
-uptr->io_status = status;
-uptr->io_complete = 1;
+for (t = 0; t < RQ_MAXQD; t++) {                        /* find oldest */
+    tuptr = rq_tagucb (uptr, t);
+    if ((tuptr->io_state == RQ_IOBSY) &&
+        ((ouptr == NULL) || ((int32) (tuptr->io_seq - ouptr->io_seq) < 0)))
+        ouptr = tuptr;
+    }
+if (ouptr == NULL)                                      /* reset since? */
+    return;
+ouptr->io_state = 0;
+ouptr->io_status = status;
+ouptr->io_complete = 1;
 /* Reschedule for the appropriate delay */
-sim_activate_notbefore (uptr, uptr->iostarttime+rq_xtime);
+sim_activate_notbefore (ouptr, ouptr->iostarttime+rq_xtime);
+for (t = 0; t < RQ_MAXQD; t++) {                        /* restart waiters */
+    tuptr = rq_tagucb (uptr, t);
+    if (tuptr->io_state == RQ_IOWAIT) {
+        tuptr->io_state = 0;
+        sim_activate (tuptr, 0);
+        }
+    }
+}
+
+/* Start a transfer on the disk */
+
+void rq_io_start (MSC *cp, UNIT *uptr)
+{
+uptr->io_state = RQ_IOBSY;                              /* on the disk */
+uptr->io_seq = (int32) cp->dseq++;                      /* in this order */
 }
 
 /* Map buffer address */
@@ -2127,13 +2223,19 @@ return Map_WriteW (ba, bc, buf);                        /* unmapped xfer */
 t_stat rq_svc (UNIT *uptr)
 {
 MSC *cp = rq_ctxmap[uptr->cnum];
+UNIT *duptr = rq_drvucb (uptr);                         /* drive of tag */
 uint32 i, t, tbc, abc, wwc;
 uint32 err = 0;
 int32 pkt = uptr->cpkt;                                 /* get packet */
 uint32 cmd, ba, bc, bl, ma;
 
-if ((cp == NULL) || (pkt == 0))                         /* what??? */
+if ((cp == NULL) || (pkt == 0)) {                       /* what??? */
+    if (cp && (uptr == duptr) && (cp->qdepth > 1))      /* sim_disk woke the */
+        return SCPE_OK;                                 /* drive for a tag */
     return STOP_RQ;
+    }
+if (uptr->io_state == RQ_IOBSY)                         /* on the disk? */
+    return SCPE_OK;                                     /* wait for callback */
 cmd = GETP (pkt, CMD_OPC, OPC);                         /* get cmd */
 ba = GETP32 (pkt, RW_WBAL);                             /* buf addr */
 bc = GETP32 (pkt, RW_WBCL);                             /* byte count */
@@ -2146,7 +2248,7 @@ sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_svc(unit=%d, pkt=%d, cmd=%s, lbn=%0
 
 tbc = (bc > RQ_MAXFR)? RQ_MAXFR: bc;                    /* trim cnt to max */
 
-if ((uptr->flags & UNIT_ATT) == 0) {                    /* not attached? */
+if ((duptr->flags & UNIT_ATT) == 0) {                   /* not attached? */
     rq_rw_end (cp, uptr, 0, ST_OFL | SB_OFL_NV);        /* offl no vol */
     return SCPE_OK;
     }
@@ -2156,22 +2258,29 @@ if (bc == 0) {                                          /* no xfer? */
     }
 
 if ((cmd == OP_ERS) || (cmd == OP_WR)) {                /* write op? */
-    if (RQ_WPH (uptr)) {
+    if (RQ_WPH (duptr)) {
         rq_rw_end (cp, uptr, 0, ST_WPR | SB_WPR_HW);
         return SCPE_OK;
         }
-    if (uptr->uf & UF_WPS) {
+    if (duptr->uf & UF_WPS) {
         rq_rw_end (cp, uptr, 0, ST_WPR | SB_WPR_SW);
         return SCPE_OK;
         }
     }
 
 if (!uptr->io_complete) { /* Top End (I/O Initiation) Processing */
+    for (i = t = 0; t < RQ_MAXQD; t++)                  /* count xfers on disk */
+        i += (rq_tagucb (duptr, t)->io_state == RQ_IOBSY);
+    if (i >= sim_disk_queue_depth (duptr)) {            /* disk full? */
+        uptr->io_state = RQ_IOWAIT;                     /* wait for completion */
+        return SCPE_OK;
+        }
     if (cmd == OP_ERS) {                                /* erase? */
         wwc = ((tbc + (RQ_NUMBY - 1)) & ~(RQ_NUMBY - 1)) >> 1;
         memset (uptr->rqxb, 0, wwc * sizeof(uint16));   /* clr buf */
-        sim_disk_data_trace(uptr, (uint8 *)uptr->rqxb, bl, wwc << 1, "sim_disk_wrsect-ERS", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
-        err = sim_disk_wrsect_a (uptr, bl, (uint8 *)uptr->rqxb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
+        sim_disk_data_trace(duptr, (uint8 *)uptr->rqxb, bl, wwc << 1, "sim_disk_wrsect-ERS", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+        rq_io_start (cp, uptr);
+        err = sim_disk_wrsect_a (duptr, bl, (uint8 *)uptr->rqxb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
         }
 
     else if (cmd == OP_WR) {                            /* write? */
@@ -2180,13 +2289,15 @@ if (!uptr->io_complete) { /* Top End (I/O Initiation) Processing */
             wwc = ((abc + (RQ_NUMBY - 1)) & ~(RQ_NUMBY - 1)) >> 1;
             for (i = (abc >> 1); i < wwc; i++)
                 ((uint16 *)(uptr->rqxb))[i] = 0;
-            sim_disk_data_trace(uptr, (uint8 *)uptr->rqxb, bl, wwc << 1, "sim_disk_wrsect-WR", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
-            err = sim_disk_wrsect_a (uptr, bl, (uint8 *)uptr->rqxb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
+            sim_disk_data_trace(duptr, (uint8 *)uptr->rqxb, bl, wwc << 1, "sim_disk_wrsect-WR", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+            rq_io_start (cp, uptr);
+            err = sim_disk_wrsect_a (duptr, bl, (uint8 *)uptr->rqxb, NULL, (wwc << 1) / RQ_NUMBY, rq_io_complete);
             }
         }
 
     else {  /* OP_RD & OP_CMP */
-        err = sim_disk_rdsect_a (uptr, bl, (uint8 *)uptr->rqxb, NULL, (tbc + RQ_NUMBY - 1) / RQ_NUMBY, rq_io_complete);
+        rq_io_start (cp, uptr);
+        err = sim_disk_rdsect_a (duptr, bl, (uint8 *)uptr->rqxb, NULL, (tbc + RQ_NUMBY - 1) / RQ_NUMBY, rq_io_complete);
         }                                               /* end else read */
     return SCPE_OK;                                     /* done for now until callback */    
     }
@@ -2209,7 +2320,7 @@ else { /* Bottom End (After I/O processing) */
         }
 
     else {
-        sim_disk_data_trace(uptr, (uint8 *)uptr->rqxb, bl, tbc, "sim_disk_rdsect", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
+        sim_disk_data_trace(duptr, (uint8 *)uptr->rqxb, bl, tbc, "sim_disk_rdsect", DBG_DAT & rq_devmap[cp->cnum]->dctrl, DBG_REQ);
         if ((cmd == OP_RD) && !err) {                   /* read? */
             if ((t = rq_writew (ba, tbc, ma, (uint16 *)uptr->rqxb))) {/* store, nxm? */
                 PUTP32 (pkt, RW_WBCL, bc - (tbc - t));  /* adj bc */
@@ -2242,8 +2353,8 @@ else { /* Bottom End (After I/O processing) */
 if (err != 0) {                                         /* error? */
     if (rq_dte (cp, uptr, ST_DRV))                      /* post err log */
         rq_rw_end (cp, uptr, EF_LOG, ST_DRV);           /* if ok, report err */
-    sim_disk_perror (uptr, "RQ I/O error");
-    sim_disk_clearerr (uptr);
+    sim_disk_perror (duptr, "RQ I/O error");
+    sim_disk_clearerr (duptr);
     return SCPE_IOERR;
     }
 ba = ba + tbc;                                          /* incr bus addr */
@@ -2283,7 +2394,7 @@ cp->pak[pkt].d[RW_WMPH] = 0;
 rq_putr (cp, pkt, cmd | OP_END, flg, sts, RW_LNT_D, UQ_TYP_SEQ); /* fill pkt */
 if (!rq_putpkt (cp, pkt, TRUE))                         /* send pkt */
     return ERR;
-if (uptr->pktq)                                         /* more to do? */
+if (rq_drvucb (uptr)->pktq)                             /* more to do? */
     sim_activate (dptr->units + RQ_QUEUE, rq_qtime);    /* activate thread */
 return OK;
 }
@@ -2305,7 +2416,7 @@ if (!rq_deqf (cp, &pkt))                                /* get log pkt */
 tpkt = uptr->cpkt;                                      /* rw pkt */
 lu = cp->pak[tpkt].d[CMD_UN];                           /* unit # */
 lbn = GETP32 (tpkt, RW_WBLL);                           /* recent LBN */
-dtyp = GET_DTYPE (uptr->flags);                         /* drv type */
+dtyp = GET_DTYPE (rq_drvucb (uptr)->flags);             /* drv type */
 if (drv_tab[dtyp].flgs & RQDF_SDI)                      /* SDI? ovhd @ end */
     t = 0;
 else t = (drv_tab[dtyp].xbn + drv_tab[dtyp].dbn) /      /* ovhd cylinders */
@@ -2603,6 +2714,75 @@ if (uptr->flags & UNIT_DIS)
 return uptr;
 }
 
+/* Tag t of a drive; tag 0 is the drive itself */
+
+UNIT *rq_tagucb (UNIT *uptr, int32 t)
+{
+DEVICE *dptr = rq_devmap[uptr->cnum];
+int32 d = (int32) (uptr - dptr->units);
+
+return t? dptr->units + RQ_TAG (d, t): uptr;
+}
+
+/* Drive of a tag */
+
+UNIT *rq_drvucb (UNIT *uptr)
+{
+DEVICE *dptr = rq_devmap[uptr->cnum];
+int32 u = (int32) (uptr - dptr->units);
+
+if (u < RQ_TAGS)
+    return uptr;
+return dptr->units + ((u - RQ_TAGS) / (RQ_MAXQD - 1));
+}
+
+/* Free tag within the queue depth, NULL if none */
+
+UNIT *rq_freetag (MSC *cp, UNIT *uptr)
+{
+UNIT *tuptr;
+uint32 t;
+
+for (t = 0; t < cp->qdepth; t++) {
+    tuptr = rq_tagucb (uptr, t);
+    if (tuptr->cpkt == 0)                               /* free? */
+        return tuptr;
+    }
+return NULL;
+}
+
+/* Any command in progress on a drive */
+
+t_bool rq_busy (UNIT *uptr)
+{
+int32 t;
+
+for (t = 0; t < RQ_MAXQD; t++) {
+    if (rq_tagucb (uptr, t)->cpkt)
+        return TRUE;
+    }
+return FALSE;
+}
+
+/* Can the packet at the head of a drive queue start now?  Transfers
+   need a free tag, anything else needs an idle drive */
+
+t_bool rq_ready (MSC *cp, UNIT *uptr, uint16 pkt)
+{
+switch (GETP (pkt, CMD_OPC, OPC)) {
+
+    case OP_ACC:
+    case OP_CMP:
+    case OP_ERS:
+    case OP_RD:
+    case OP_WR:
+        return (rq_freetag (cp, uptr) != NULL);
+
+    default:
+        return !rq_busy (uptr);
+        }
+}
+
 /* Hack unit flags */
 
 void rq_setf_unit (MSC *cp, uint16 pkt, UNIT *uptr)
@@ -2877,6 +3057,8 @@ cp = rq_ctxmap[cidx];                                   /* get context */
 cp->cnum = cidx;                                        /* init index */
 if (cp->ctype == DEFAULT_CTYPE)
     cp->ctype = (UNIBUS? UDA50_CTYPE : RQDX3_CTYPE);
+if ((cp->qdepth < 1) || (cp->qdepth > RQ_MAXQD))
+    cp->qdepth = 1;                                     /* one xfer per drive */
 
 #if defined (VM_VAX)                                    /* VAX */
 cp->ubase = 0;                                          /* unit base = 0 */
@@ -2909,7 +3091,7 @@ cp->rspq = 0;                                           /* no q'd rsp pkts */
 cp->pbsy = 0;                                           /* all pkts free */
 cp->pip = 0;                                            /* not polling */
 rq_clrint (cp);                                         /* clr intr req */
-for (i = 0; i < (RQ_NUMDR + 2); i++) {                  /* init units */
+for (i = 0; i < RQ_NUMUN; i++) {                        /* init units */
     uptr = dptr->units + i;
     sim_cancel (uptr);                                  /* clr activity */
     sim_disk_reset (uptr);
@@ -2917,6 +3099,9 @@ for (i = 0; i < (RQ_NUMDR + 2); i++) {                  /* init units */
     uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_ATP);
     uptr->uf = 0;                                       /* clr unit flags */
     uptr->cpkt = uptr->pktq = 0;                        /* clr pkt q's */
+    uptr->io_state = 0;                                 /* not on disk */
+    if (i >= RQ_TAGS)                                   /* tag? */
+        uptr->io_complete = 0;
     uptr->rqxb = (uint16 *) realloc (uptr->rqxb, (RQ_MAXFR >> 1) * sizeof (uint16));
     if (uptr->rqxb == NULL)
         return SCPE_MEM;
@@ -3076,7 +3261,7 @@ t_stat rq_show_unitq (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
 {
 MSC *cp = rq_ctxmap[uptr->cnum];
 DEVICE *dptr = rq_devmap[uptr->cnum];
-int32 pkt, u;
+int32 pkt, u, t;
 
 u = (int32) (uptr - dptr->units);
 if (cp->csta != CST_UP) {
@@ -3089,9 +3274,13 @@ if ((uptr->flags & UNIT_ONL) == 0) {
     else fprintf (st, "Unit %d is offline\n", u);
     return SCPE_OK;
     }
-if (uptr->cpkt) {
-    fprintf (st, "Unit %d current ", u);
-    rq_show_pkt (st, cp, uptr->cpkt);
+if (rq_busy (uptr)) {
+    for (t = 0; t < RQ_MAXQD; t++) {
+        if ((pkt = rq_tagucb (uptr, t)->cpkt)) {
+            fprintf (st, "Unit %d current ", u);
+            rq_show_pkt (st, cp, pkt);
+            }
+        }
     if ((pkt = uptr->pktq)) {
         do {
             fprintf (st, "Unit %d queued ", u);
@@ -3103,6 +3292,31 @@ else fprintf (st, "Unit %d queues are empty\n", u);
 return SCPE_OK;
 }
 
+/* Set/show queue depth */
+
+t_stat rq_set_qdepth (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+MSC *cp = rq_ctxmap[uptr->cnum];
+uint32 qd;
+t_stat r;
+
+if (cptr == NULL)
+    return SCPE_ARG;
+qd = (uint32) get_uint (cptr, 10, RQ_MAXQD, &r);
+if ((r != SCPE_OK) || (qd < 1))
+    return SCPE_ARG;
+cp->qdepth = qd;
+return SCPE_OK;
+}
+
+t_stat rq_show_qdepth (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+MSC *cp = rq_ctxmap[uptr->cnum];
+
+fprintf (st, "queue depth=%d", cp->qdepth);
+return SCPE_OK;
+}
+
 t_stat rq_show_ctrl (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
 {
 MSC *cp = rq_ctxmap[uptr->cnum];
@@ -3177,6 +3391,12 @@ fprint_reg_help (st, dptr);
 fprintf (st, "\nWhile VMS is not timing sensitive, most of the BSD-derived operating systems\n");
 fprintf (st, "(NetBSD, OpenBSD, etc) are.  The QTIME and XTIME parameters are set to values\n");
 fprintf (st, "that allow these operating systems to run correctly.\n\n");
+fprintf (st, "By default each drive works on one data transfer command at a time and\n");
+fprintf (st, "queues the rest, in order.  SET %s QDEPTH=n (1 to %d) lets each drive\n", dptr->name, RQ_MAXQD);
+fprintf (st, "have up to n transfers in progress, as a real controller could.  They\n");
+fprintf (st, "are passed to the attached disk together when it runs asynchronously,\n");
+fprintf (st, "and each completes XTIME after it started, so responses can return to\n");
+fprintf (st, "the host in a different order from the commands.\n\n");
 fprintf (st, "\nError handling is as follows:\n\n");
 fprintf (st, "    error         processed as\n");
 fprintf (st, "    not attached  disk not ready\n");
@@ -341,6 +341,7 @@ BITFIELD vh_tbuffad1_bits[] = {
 #define TB2_M_TBUFFAD       (077)
 #define TB2_TX_DMA_START    (1 << 7)
 #define TB2_TX_ENA      (1 << 15)
+#define VH_DMA_CHUNK    (256)               /* bytes per DMA transfer to TMXR */
 
 BITFIELD vh_tbuffad2_bits[] = {
   BITF(TBUFFAD,6),                          /* Transmit DMA Address */
@@ -468,6 +469,7 @@ static t_stat vh_show_detail (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
 static t_stat vh_show_rbuf (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 static t_stat vh_show_txq (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 static t_stat vh_putc (int32 vh, TMLX *lp, int32 chan, int32 data);
+static t_stat vh_putbuf (int32 vh, TMLX *lp, int32 chan, uint8 *buf, int32 n, int32 *sent);
 static void vh_set_config (TMLX *lp );
 static void doDMA (int32 vh, int32 chan);
 static t_stat vh_setmode (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
@@ -553,6 +555,8 @@ static const MTAB vh_mod[] = {
         NULL, &tmxr_show_cstat, (void *) &vh_desc, "Display current connections" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATISTICS", NULL,
         NULL, &tmxr_show_cstat, (void *) &vh_desc, "Display multiplexer statistics" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NC, 0, NULL, "STATISTICS=file",
+        &tmxr_set_stats, NULL, (void *) &vh_desc, "Write line statistics to a file" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 1, NULL, "DISCONNECT",
         &tmxr_dscln, NULL, &vh_desc, "Disconnect a specific line" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "DETAIL", NULL,
@@ -897,6 +901,45 @@ static t_stat vh_putc ( int32   vh,
     return (status);
 }
 
+/* TX a buffer of characters on a line, stopping where vh_putc would */
+
+static t_stat vh_putbuf ( int32 vh,
+            TMLX    *lp,
+            int32   chan,
+            uint8   *buf,
+            int32   n,
+            int32   *sent   )
+{
+    int32   i, mask, count;
+    t_stat  status = SCPE_OK;
+
+    *sent = 0;
+    if (((lp->lnctrl >> LNCTRL_V_MAINT) & LNCTRL_M_MAINT) != 0) {
+        while ((*sent < n) &&
+               ((status = vh_putc (vh, lp, chan, buf[*sent])) == SCPE_OK))
+            ++*sent;
+        return (status);
+    }
+    /* truncate to desired character length */
+    mask = bitmask[(lp->lpr >> LPR_V_CHAR_LGTH) & LPR_M_CHAR_LGTH];
+    if (mask != 0377) {
+        for (i = 0; i < n; i++)
+            buf[i] &= mask;
+    }
+    status = tmxr_put_buf_ln (lp->tmln, buf, n, sent);
+    if (status == SCPE_STALL) {
+        /* let's flush and try again */
+        tmxr_send_buffered_data (lp->tmln);
+        status = tmxr_put_buf_ln (lp->tmln, buf + *sent, n - *sent, &count);
+        *sent += count;
+    }
+    if (status == SCPE_LOST) {
+        tmxr_reset_ln (lp->tmln);
+        HangupModem (vh, lp, chan);
+    }
+    return (status);
+}
+
 /* Retrieve all stored input from TMXR and place in RX FIFO */
 
 static void vh_getc (   int32   vh  )
@@ -1314,7 +1357,7 @@ static t_stat vh_wr (   int32   ldata,
 static void doDMA ( int32   vh,
             int32   chan    )
 {
-    int32   line, status;
+    int32   line, status, chunk = VH_DMA_CHUNK;
     uint32  pa;
     TMLX    *lp;
 
@@ -1326,17 +1369,26 @@ static void doDMA ( int32   vh,
         pa |= (lp->tbuf2 & TB2_M_TBUFFAD) << 16;
         status = chan << CSR_V_TX_LINE;
         while (lp->tbuffct) {
-            uint8   buf;
-            if (Map_ReadB (pa, 1, &buf)) {
+            uint8   buf[VH_DMA_CHUNK];
+            int32   n, sent;
+            t_stat  r;
+            n = (lp->tbuffct < chunk) ? lp->tbuffct : chunk;
+            if (Map_ReadB (pa, n, buf)) {
+                if (n > 1) {
+                    /* byte at a time up to the bad address */
+                    chunk = 1;
+                    continue;
+                }
                 status |= CSR_TX_DMA_ERR;
                 lp->tbuffct = 0;
                 break;
             }
-            if (vh_putc (vh, lp, chan, buf) != SCPE_OK)
+            r = vh_putbuf (vh, lp, chan, buf, n, &sent);
+            /* pa = (pa + sent) & PAMASK; */
+            pa = (pa + sent) & ((1 << 22) - 1);
+            lp->tbuffct -= sent;
+            if (r != SCPE_OK)
                 break;
-            /* pa = (pa + 1) & PAMASK; */
-            pa = (pa + 1) & ((1 << 22) - 1);
-            lp->tbuffct--;
         }
         lp->tbuf1 = pa & 0177777;
         lp->tbuf2 = (lp->tbuf2 & ~TB2_M_TBUFFAD) |
@@ -1769,6 +1821,7 @@ fprintf (st, "command, or a DETACH %s command.\n\n", dptr->name);
 fprintf (st, "Other special %s commands:\n\n", dptr->name);
 fprintf (st, "   sim> SHOW %s CONNECTIONS       show current connections\n", dptr->name);
 fprintf (st, "   sim> SHOW %s STATISTICS        show statistics for active connections\n", dptr->name);
+fprintf (st, "   sim> SET %s STATISTICS=file    write line statistics to a file\n", dptr->name);
 fprintf (st, "   sim> SET %s DISCONNECT=linenumber  disconnects the specified line.\n\n", dptr->name);
 fprintf (st, "The %s does not support save and restore.  All open connections are lost\n", devtype);
 fprintf (st, "when the simulator shuts down or the %s is detached.\n\n", dptr->name);
@@ -150,6 +150,16 @@ void realcons_init(realcons_t *_this)
 	_this->service_highspeed_prescaler = 0;
 	_this->service_next_time_msec = 0;
 
+	_this->activity_enabled = 1;
+	realcons_activity_clear(&_this->activity);
+	for (i = 0; i < 256; i++) {
+		unsigned bitidx;
+		realcons_activity_spread[i] = 0;
+		for (bitidx = 0; bitidx < 8; bitidx++)
+			if (i & (1 << bitidx))
+				realcons_activity_spread[i] |= (t_uint64)1 << (8 * bitidx);
+	}
+
 	/* Intializes random number generator */
 	srand((unsigned)time(NULL));
 
@@ -205,6 +215,10 @@ t_stat realcons_connect(realcons_t *_this, char *consolelogic_name, char *server
 	_this->service_highspeed_prescaler = 0;
 	_this->service_next_time_msec = 0;
 	_this->service_cycle_count = 0;
+	memset(&_this->latency_detect, 0, sizeof(_this->latency_detect));
+	memset(&_this->latency_visible, 0, sizeof(_this->latency_visible));
+	memset(&_this->latency_total, 0, sizeof(_this->latency_total));
+	_this->service_event_count = 0;
 	_this->lamp_test = 0;
 	for (i = 0; i < REALCONS_TIMER_COUNT; i++)
 		_this->timer_running_msec[i] = 0;
@@ -360,6 +374,10 @@ t_stat realcons_connect(realcons_t *_this, char *consolelogic_name, char *server
 	_this->connected = 1;
 	_this->force_output_update = 1; // transmit output control to console panel regardless of changes
 
+	// start lamp duty cycle accumulation
+	realcons_activity_clear(&_this->activity);
+	_this->activity.active = _this->activity_enabled;
+
 	// tell server to enable the output driver of the BlinkenBoards.
 	// The BlinkenBoards are tristate, if they had a power loss since
 	// start of the server.
@@ -403,6 +421,7 @@ t_stat realcons_disconnect(realcons_t *_this)
 	// NO rpc_clientfree()/destroy() needed???
 	_this->console_model = NULL;
 	_this->connected = 0;
+	_this->activity.active = 0;
 	// now EVENT() does not call any callbacks. The
 
 	// cleanup rpc subsystem
@@ -419,6 +438,59 @@ t_stat realcons_disconnect(realcons_t *_this)
 	return SCPE_OK;
 }
 
+/*
+ * Switch event latency histograms.
+ */
+void realcons_latency_add(realcons_latency_t *latency, t_uint64 usec)
+{
+	unsigned bucket = 0;
+	t_uint64 limit = REALCONS_LATENCY_BUCKET0_USEC;
+	while (bucket < REALCONS_LATENCY_BUCKETS - 1 && usec >= limit) {
+		bucket++;
+		limit *= 2;
+	}
+	latency->count[bucket]++;
+	latency->samples++;
+	latency->sum_usec += usec;
+	if (usec > latency->max_usec)
+		latency->max_usec = usec;
+}
+
+void realcons_latency_print(realcons_latency_t *latency, FILE *st)
+{
+	unsigned bucket;
+	t_uint64 limit = REALCONS_LATENCY_BUCKET0_USEC;
+	if (latency->samples == 0) {
+		fprintf(st, "no events");
+		return;
+	}
+	fprintf(st, "%u events, mean %u us, max %u us, histogram", latency->samples,
+		(unsigned)(latency->sum_usec / latency->samples), (unsigned)latency->max_usec);
+	for (bucket = 0; bucket < REALCONS_LATENCY_BUCKETS; bucket++, limit *= 2) {
+		if (bucket < REALCONS_LATENCY_BUCKETS - 1)
+			fprintf(st, " <%.1fms:%u", limit / 1000.0, latency->count[bucket]);
+		else
+			fprintf(st, " more:%u", latency->count[bucket]);
+	}
+}
+
+// console logic has seen the inputs of a server switch event: record latency
+static void realcons_service_latency(realcons_t *_this)
+{
+	blinkenlight_panel_t *p = _this->console_model;
+	t_uint64 visible_us;
+	if (!p->input_event_received)
+		return;
+	p->input_event_received = 0;
+	visible_us = p->input_event_receive_us;
+	if (p->input_event_scan_us == 0 || p->input_event_detect_us < p->input_event_scan_us
+		|| visible_us < p->input_event_detect_us)
+		return; // clocks not comparable
+	realcons_latency_add(&_this->latency_detect, p->input_event_detect_us - p->input_event_scan_us);
+	realcons_latency_add(&_this->latency_visible, visible_us - p->input_event_detect_us);
+	realcons_latency_add(&_this->latency_total, visible_us - p->input_event_scan_us);
+}
+
 /*
  * Scheduling:
  * Provide realcons with computing time.
@@ -448,47 +520,57 @@ void realcons_service(realcons_t *_this, int highspeed)
 			&& _this->timer_running_msec[i] < _this->service_cur_time_msec)
 			_this->timer_running_msec[i] = 0; // timer expired
 
-	if (_this->service_next_time_msec >= _this->service_cur_time_msec)
-		return;
-	///// Time for next service operation /////
-
-	if (_this->connected)
-		_this->service_cycle_count++;
-	//// do your jobs only if not disconnected
-	if (_this->connected) {
-		// 1) query new input values from console
-		if (blinkenlight_api_client_get_inputcontrols_values(_this->blinkenlight_api_client,
+	// switch changes pushed by server are processed at once, else wait for interval
+	if (blinkenlight_api_client_input_event_pending(_this->console_model)) {
+		_this->service_event_count++;
+		// get new input values now, not with the exchange after the console logic.
+		// Read from shared memory only: outputs go with that exchange,
+		// so an event costs one round trip like a periodic service.
+		if (blinkenlight_api_client_receive_inputcontrols_values(_this->blinkenlight_api_client,
 			_this->console_model) != 0) {
-			// error in service: disconnect
 			realcons_printf(_this, stderr,
 				blinkenlight_api_client_get_error_text(_this->blinkenlight_api_client));
 			realcons_disconnect(_this);
+			return;
 		}
-	}
+	} else if (_this->service_next_time_msec >= _this->service_cur_time_msec)
+		return;
+	///// Time for next service operation /////
 
+	if (_this->connected)
+		_this->service_cycle_count++;
+	//// do your jobs only if not disconnected
 	if (_this->connected) {
-		// 2) process console state. operates only "panel" model data struct
+		// 1) convert memory accesses since last service into lamp brightness,
+		// then process console state. operates only "panel" model data struct.
+		// Input values were received by the exchange of the previous service
+		// (or by realcons_connect()): without a pushed input event, switch changes
+		// are seen one service interval later than with a separate "get inputs".
+		// That saves a round trip per service.
+		realcons_activity_eval(&_this->activity);
 		_this->console_controller_interface.service_func(_this->console_controller);
+		realcons_service_latency(_this);
 	}
 
 	if (_this->connected) {
-		unsigned n = blinkenlight_panels_get_control_value_changes(
-			_this->blinkenlight_api_client->panel_list, _this->console_model, /*output*/0);
-		if (n > 0 || _this->force_output_update) {
-			if (_this->debug)
-				printf("realcons_server(): outputcontrols\n");
-			// 3) transmit output control values to panel
-			// Transmit not if nothing changed.
-			//always: server panel simulation may relay on display clock!
-			_this->force_output_update = 0; // done
-			if (blinkenlight_api_client_set_outputcontrols_values(_this->blinkenlight_api_client,
+		// 2) transmit output control values to panel and query new input values
+		// in one round trip. Only changed outputs are transmitted, so the first
+		// service after connect sends all of them once: the panel may still show
+		// lamps of a previous session.
+		// Against older servers this falls back to "set outputs if changed" + "get inputs".
+		if (_this->debug)
+			printf("realcons_server(): exchange controls\n");
+		if ((_this->force_output_update
+			&& blinkenlight_api_client_set_outputcontrols_values(_this->blinkenlight_api_client,
+				_this->console_model) != 0)
+			|| blinkenlight_api_client_exchange_controls_values(_this->blinkenlight_api_client,
 				_this->console_model) != 0) {
-				// error in service: disconnect
-				realcons_printf(_this, stderr,
-					blinkenlight_api_client_get_error_text(_this->blinkenlight_api_client));
-				realcons_disconnect(_this);
-			}
-		}
+			// error in service: disconnect
+			realcons_printf(_this, stderr,
+				blinkenlight_api_client_get_error_text(_this->blinkenlight_api_client));
+			realcons_disconnect(_this);
+		} else
+			_this->force_output_update = 0; // done
 	}
 
 	// 2 options
@@ -508,6 +590,68 @@ void realcons_service(realcons_t *_this, int highspeed)
 ;
 }
 
+/*
+ * Lamp activity accumulator, see REALCONS_ACTIVITY_ADD()
+ */
+t_uint64 realcons_activity_spread[256];
+
+void realcons_activity_clear(realcons_activity_t *activity)
+{
+	int active = activity->active;
+	memset(activity, 0, sizeof(*activity));
+	activity->active = active;
+	activity->samples_left = REALCONS_ACTIVITY_DRAIN_SAMPLES;
+}
+
+// add byte lanes to per-bit sums. called every 255 accesses
+// and before evaluation.
+void realcons_activity_drain(realcons_activity_t *activity)
+{
+	unsigned bitidx;
+	for (bitidx = 0; bitidx < REALCONS_ACTIVITY_BITS; bitidx++)
+		activity->sum[bitidx] += (activity->lanes[bitidx / 8] >> (8 * (bitidx % 8))) & 0xff;
+	memset(activity->lanes, 0, sizeof(activity->lanes));
+	activity->samples += REALCONS_ACTIVITY_DRAIN_SAMPLES - activity->samples_left;
+	activity->samples_left = REALCONS_ACTIVITY_DRAIN_SAMPLES;
+}
+
+// called once per service cycle: convert sums into brightness, restart counting
+void realcons_activity_eval(realcons_activity_t *activity)
+{
+	unsigned bitidx;
+	realcons_activity_drain(activity);
+	activity->samples_per_cycle = activity->samples;
+	// CPU halted or accumulator disabled: panel logic shows register snapshot
+	activity->valid = (activity->samples > 0);
+	if (activity->valid)
+		for (bitidx = 0; bitidx < REALCONS_ACTIVITY_BITS; bitidx++)
+			activity->brightness[bitidx] = (uint8)(((t_uint64)255 * activity->sum[bitidx])
+				/ activity->samples);
+	memset(activity->sum, 0, sizeof(activity->sum));
+	activity->samples = 0;
+}
+
+/*
+ * Get a lamp value for 'bitlen' bits at 'bitoffset' of the accumulator.
+ * The Blinkenlight API transmits only ON/OFF per lamp, brightness is produced by the
+ * low pass on the server. So every bit is sigma-delta modulated over successive
+ * service cycles: ON in "brightness/255" of all calls.
+ */
+t_uint64 realcons_activity_lamps(realcons_activity_t *activity, unsigned bitoffset, unsigned bitlen)
+{
+	t_uint64 result = 0;
+	unsigned i;
+	for (i = 0; i < bitlen; i++) {
+		unsigned bitidx = bitoffset + i;
+		activity->dither[bitidx] += activity->brightness[bitidx];
+		if (activity->dither[bitidx] >= 255) {
+			activity->dither[bitidx] -= 255;
+			result |= (t_uint64)1 << i;
+		}
+	}
+	return result;
+}
+
 /*
  * stop simulated cpu, but keep console logic running
  * (needed for PDP-11 RESET opcode)
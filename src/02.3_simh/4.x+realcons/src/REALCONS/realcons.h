@@ -105,6 +105,77 @@ typedef int(*console_controller_test_func_t)(void *console_controller, int arg);
 	} while(0)
 
 
+/*
+ * Lamp activity accumulator.
+ * ADDRESS and DATA lamps of a running machine should show how often each bit
+ * was set between two service cycles, not the snapshot of the last memory access.
+ * Every memory access adds its 22 address and 16 data bits into per-bit 8 bit counters,
+ * packed as byte lanes into 64 bit words: lane i of lanes[w] counts bit 8*w+i.
+ * A table spreads each pattern byte into 8 lanes, so an access costs five lookups
+ * and adds without data dependent branches. Every 255 accesses the lanes are drained
+ * into sum[], on every service cycle sum[] is converted into brightness 0..255.
+ */
+#define REALCONS_ACTIVITY_ADDRESS_BITS	22
+#define REALCONS_ACTIVITY_DATA_BITS	16
+#define REALCONS_ACTIVITY_BITS	(REALCONS_ACTIVITY_ADDRESS_BITS + REALCONS_ACTIVITY_DATA_BITS)
+#define REALCONS_ACTIVITY_DATA_BITOFFSET	REALCONS_ACTIVITY_ADDRESS_BITS
+#define REALCONS_ACTIVITY_LANEWORDS	((REALCONS_ACTIVITY_BITS + 7) / 8)
+#define REALCONS_ACTIVITY_DRAIN_SAMPLES	255 // drain before byte lanes overflow
+
+typedef struct realcons_activity_struct
+{
+	int active; // 1: accumulate. "set realcons activity" and connected
+	t_uint64 lanes[REALCONS_ACTIVITY_LANEWORDS]; // 8 bit counter per bit
+	int samples_left; // accesses until lanes must be drained
+	uint32 samples; // accesses drained into sum[]
+	uint32 sum[REALCONS_ACTIVITY_BITS]; // per bit: count of accesses with bit set
+
+	// result of last service cycle
+	int valid; // 0: no memory accesses in last service interval
+	uint32 samples_per_cycle; // accesses in last service interval, for diag
+	uint8 brightness[REALCONS_ACTIVITY_BITS]; // 0 = never set .. 255 = always set
+	uint16 dither[REALCONS_ACTIVITY_BITS]; // sigma-delta error in realcons_activity_lamps()
+} realcons_activity_t;
+
+// bit i of byte -> lane i := 1
+extern t_uint64 realcons_activity_spread[256];
+
+// add one memory access. pattern = address | data << REALCONS_ACTIVITY_DATA_BITOFFSET
+#define REALCONS_ACTIVITY_ADD(activity,pattern) do {	\
+		t_uint64 _pattern = (pattern) ;	\
+		(activity)->lanes[0] += realcons_activity_spread[_pattern & 0xff] ;	\
+		(activity)->lanes[1] += realcons_activity_spread[(_pattern >> 8) & 0xff] ;	\
+		(activity)->lanes[2] += realcons_activity_spread[(_pattern >> 16) & 0xff] ;	\
+		(activity)->lanes[3] += realcons_activity_spread[(_pattern >> 24) & 0xff] ;	\
+		(activity)->lanes[4] += realcons_activity_spread[(_pattern >> 32) & 0xff] ;	\
+		if (--(activity)->samples_left <= 0)	\
+			realcons_activity_drain(activity) ;	\
+	} while(0)
+
+/*
+ * Latency of switch events pushed by the server (shared memory only),
+ * log2 histogram: bucket i counts latencies < 2^i * 100us, the last all above.
+ */
+#define REALCONS_LATENCY_BUCKETS	10 // 0.1 .. 25.6 ms, more
+#define REALCONS_LATENCY_BUCKET0_USEC	100
+
+typedef struct realcons_latency_struct
+{
+	uint32 count[REALCONS_LATENCY_BUCKETS];
+	uint32 samples;
+	t_uint64 sum_usec;
+	t_uint64 max_usec;
+} realcons_latency_t;
+
+void realcons_latency_add(realcons_latency_t *latency, t_uint64 usec);
+void realcons_latency_print(realcons_latency_t *latency, FILE *st);
+
+void realcons_activity_clear(realcons_activity_t *activity);
+void realcons_activity_drain(realcons_activity_t *activity);
+void realcons_activity_eval(realcons_activity_t *activity);
+t_uint64 realcons_activity_lamps(realcons_activity_t *activity, unsigned bitoffset, unsigned bitlen);
+
+
 typedef struct realcons_console_controller_interface_struct
 {
 	char *name; /* name, like in config file */
@@ -192,10 +263,14 @@ typedef struct realcons_struct
 
 	// int machine_state; // result of last call to machine_set_state()
 
-	int force_output_update; // 0: transmit outputs to real console panel only if values have changed
+	int force_output_update; // 1: next service transmits all outputs, else only changed ones
 
 	int lamp_test; // 1, if console panel should switch all lamps ON
 
+	// duty cycle of ADDRESS/DATA lamp bits, fed by CPU memory accesses
+	int activity_enabled; // 1: "set realcons activity"
+	realcons_activity_t activity;
+
 	// panel logic (functional behaviour of lights & switches)
 	realcons_console_controller_interface_t console_controller_interface; // description of logic module
 
@@ -220,6 +295,12 @@ typedef struct realcons_struct
 	// array of general purpose timers for use by console_controller. 0 = expired
 	t_uint64 timer_running_msec[REALCONS_TIMER_COUNT];
 
+	// switch event latencies: hardware scan -> debounced on server -> console logic
+	realcons_latency_t latency_detect; // scan -> detect
+	realcons_latency_t latency_visible; // detect -> SimH
+	realcons_latency_t latency_total; // scan -> SimH
+	uint32 service_event_count; // service cycles started early by switch event
+
 } realcons_t;
 
 #ifndef REALCONS_C_
@@ -1051,6 +1051,11 @@ fclose(bootfil);
             }
             break;
         case ADDR_SELECT_VALUE_PROG_PHY:
+            if (!console_mode && _this->realcons->activity.valid)
+                // running: duty cycle of all addresses since last service
+                _this->leds_ADDRESS->value = realcons_activity_lamps(&_this->realcons->activity,
+                    0, REALCONS_ACTIVITY_ADDRESS_BITS);
+            else
             // show last physical UNIBUS address
             _this->leds_ADDRESS->value = SIGNAL_GET(cpusignal_memory_address_phys_register);
             break;
@@ -1093,6 +1098,10 @@ fclose(bootfil);
         if (console_mode)
             // when halted, BUS_REG shows switches
             _this->leds_DATA->value = _this->switch_SR->value;
+        else if (_this->realcons->activity.valid)
+            // running: duty cycle of all bus data since last service
+            _this->leds_DATA->value = realcons_activity_lamps(&_this->realcons->activity,
+                REALCONS_ACTIVITY_DATA_BITOFFSET, REALCONS_ACTIVITY_DATA_BITS);
         else
             _this->leds_DATA->value = SIGNAL_GET(cpusignal_memory_data_register);
         break;
@@ -44,6 +44,8 @@ static CTAB set_realcons_tab[] =
 { "TEST", &realcons_simh_test, 0 },
 { "DEBUG", &realcons_simh_set_debug, 1 },
 { "NODEBUG", &realcons_simh_set_debug, 0 },
+{ "ACTIVITY", &realcons_simh_set_activity, 1 },
+{ "NOACTIVITY", &realcons_simh_set_activity, 0 },
 
 { NULL, NULL, 0 } };
 
@@ -56,6 +58,8 @@ static SHTAB show_realcons_tab[] =
 		{ "CONNECTED", &realcons_simh_show_connected, 0 },
         { "BOOTIMAGE", &realcons_simh_show_boot_image, 0 },
         { "DEBUG", &realcons_simh_show_debug, 0 },
+        { "ACTIVITY", &realcons_simh_show_activity, 0 },
+        { "LATENCY", &realcons_simh_show_latency, 0 },
 		{ "SERVER", &realcons_simh_show_server, 0 }, // the last, multiline outout
 //	{ "CYCLES", &realcons_simh_show_cycles, 0 }, // debug
 		{ NULL, NULL, 0 } };
@@ -68,6 +72,8 @@ static SHTAB show_realcons_tab[] =
  * set realcons bootimage=<filename>
  * set realcons debug
  * set realcons nodebug
+ * set realcons activity
+ * set realcons noactivity
 
  */
 t_stat sim_set_realcons(int32 flag, CONST char *cptr)
@@ -174,6 +180,19 @@ t_stat realcons_simh_set_debug(int32 flg, CONST char *cptr)
 	return SCPE_OK;
 }
 
+/*
+ * set realcons activity / noactivity
+ * ADDRESS/DATA lamps show duty cycle of all memory accesses, or only the last one.
+ * Compare instructions/sec with both settings to see the cost of the accumulator.
+ */
+t_stat realcons_simh_set_activity(int32 flg, CONST char *cptr)
+{
+	cpu_realcons->activity_enabled = flg;
+	realcons_activity_clear(&cpu_realcons->activity);
+	cpu_realcons->activity.active = flg && cpu_realcons->connected;
+	return SCPE_OK;
+}
+
 /* SHOW realcons command */
 
 t_stat sim_show_realcons(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
@@ -299,6 +318,33 @@ t_stat realcons_simh_show_debug(FILE *st, DEVICE *dunused, UNIT *uunused, int32
 	return SCPE_OK;
 }
 
+t_stat realcons_simh_show_activity(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr)
+{
+	if (cptr && (*cptr != 0))
+		return SCPE_2MARG;
+	if (cpu_realcons->activity_enabled)
+		fprintf(st, "activity (%u memory accesses in last interval)",
+				cpu_realcons->activity.samples_per_cycle);
+	else
+		fputs("noactivity", st);
+	return SCPE_OK;
+}
+
+// switch event latencies. Multi line
+t_stat realcons_simh_show_latency(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr)
+{
+	if (cptr && (*cptr != 0))
+		return SCPE_2MARG;
+	fprintf(st, "switch event latency (%u early service cycles)", cpu_realcons->service_event_count);
+	fprintf(st, "\n  scan->detect: ");
+	realcons_latency_print(&cpu_realcons->latency_detect, st);
+	fprintf(st, "\n  detect->simh: ");
+	realcons_latency_print(&cpu_realcons->latency_visible, st);
+	fprintf(st, "\n  scan->simh:   ");
+	realcons_latency_print(&cpu_realcons->latency_total, st);
+	return SCPE_OK;
+}
+
 t_stat realcons_simh_show_cycles(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr)
 {
 	if (cptr && (*cptr != 0))
@@ -35,6 +35,7 @@ t_stat realcons_simh_set_connect(int32 flg, CONST char *cptr);
 t_stat realcons_simh_set_boot_image(int32 flg, CONST char *cptr);
 t_stat realcons_simh_test(int32 flg, CONST char *cptr);
 t_stat realcons_simh_set_debug(int32 flg, CONST char *cptr);
+t_stat realcons_simh_set_activity(int32 flg, CONST char *cptr);
 
 t_stat sim_show_realcons(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat realcons_simh_show_hostname(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag,
@@ -48,6 +49,8 @@ t_stat realcons_simh_show_connected(FILE *st, DEVICE *dunused, UNIT *uunused, in
 t_stat realcons_simh_show_boot_image(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag,
     CONST char *cptr);
 t_stat realcons_simh_show_debug(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr);
+t_stat realcons_simh_show_activity(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr);
+t_stat realcons_simh_show_latency(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr);
 t_stat realcons_simh_show_cycles(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr) ;
 
 t_stat realcons_simh_show_server(FILE *st, DEVICE *dunused, UNIT *uunused, int32 flag, CONST char *cptr);
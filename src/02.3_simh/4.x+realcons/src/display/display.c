@@ -268,6 +268,8 @@ extern "C" {
 extern double *colmap;
 extern int32 pxval;
 extern t_stat vid_setpixel(int ix,int iy,int level,int color);
+extern void vid_setpixels(const int32 *xy, int32 n);
+extern void vid_line(int32 x0, int32 y0, int32 x1, int32 y1);
 
 #ifdef  __cplusplus
 }
@@ -521,6 +523,113 @@ display_point(int x,        /* 0..xpixels (unscaled) */
     return lx*lx + ly*ly <= scaled_pen_radius_squared;
 } /* display_point */
 
+int
+display_lp_active(void)
+{
+    return ws_lp_x != -1 && ws_lp_y != -1;
+}
+
+/* points handed to vid_setpixels() at a time */
+#define POINT_BATCH 256
+
+void
+display_points(int n,               /* number of points */
+          const int *xy,            /* x,y pairs, 0..x/ypixels (unscaled) */
+          int level,                /* DISPLAY_INT_xxx */
+          int color)                /* for VR20! 0 or 1 */
+{
+    int32 buf[2 * POINT_BATCH * PIX_SIZE * PIX_SIZE];
+    int i, j, x, y, m = 0;
+
+    if (!initialized)
+        return;
+
+    for (; n > 0; n--, xy += 2) {
+        x = xy[0];
+        y = xy[1];
+        if (scale == 2) {           /* as display_point() */
+            x >>= 1;
+            y >>= 1;
+            }
+        else if (scale > 1) {
+            x /= scale;
+            y /= scale;
+            }
+        if (x < 0 || x >= xpixels || y < PIX_SIZE-1 || y >= ypixels)
+            continue;               /* as intensify() */
+        for (i = 0; i < PIX_SIZE; i++)
+            for (j = 0; j < PIX_SIZE; j++) {
+                buf[m++] = i + x;
+                buf[m++] = j + ypixels - y - 1;
+                }
+        if (m == ELEMENTS(buf)) {
+            vid_setpixels(buf, m / 2);
+            m = 0;
+            }
+        }
+    if (m)
+        vid_setpixels(buf, m / 2);
+} /* display_points */
+
+void
+display_vector(int x0,              /* 0..xpixels (unscaled) */
+          int y0,                   /* 0..ypixels (unscaled) */
+          int x1,
+          int y1,
+          int level,                /* DISPLAY_INT_xxx */
+          int color)                /* for VR20! 0 or 1 */
+{
+    int dx, dy, sx, sy, e, n;
+
+    if (!initialized)
+        return;
+
+    if (scale == 2) {
+        x0 >>= 1;
+        y0 >>= 1;
+        x1 >>= 1;
+        y1 >>= 1;
+        }
+    else if (scale > 1) {
+        x0 /= scale;
+        y0 /= scale;
+        x1 /= scale;
+        y1 /= scale;
+        }
+
+#if PIX_SIZE == 1
+    if (x0 >= 0 && x0 < xpixels && y0 >= 0 && y0 < ypixels
+        && x1 >= 0 && x1 < xpixels && y1 >= 0 && y1 < ypixels) {
+        vid_line(x0, ypixels - y0 - 1, x1, ypixels - y1 - 1);
+        return;
+        }
+#endif
+
+    /* off the display, or fat pixels: same steps, clipped by intensify() */
+    dx = abs(x1 - x0);
+    dy = abs(y1 - y0);
+    sx = x1 < x0 ? -1 : 1;
+    sy = y1 < y0 ? -1 : 1;
+    if (dx >= dy) {
+        for (e = 2*dy - dx, n = dx; n >= 0; n--, x0 += sx, e += 2*dy) {
+            intensify(x0, y0, level, color);
+            if (e >= 0) {
+                y0 += sy;
+                e -= 2*dx;
+                }
+            }
+        }
+    else {
+        for (e = 2*dx - dy, n = dy; n >= 0; n--, y0 += sy, e += 2*dx) {
+            intensify(x0, y0, level, color);
+            if (e >= 0) {
+                x0 += sx;
+                e -= 2*dy;
+                }
+            }
+        }
+} /* display_vector */
+
 
 
 static struct display *
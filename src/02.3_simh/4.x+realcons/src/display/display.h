@@ -98,6 +98,26 @@ extern int display_age(int,int);
  */
 extern int display_point(int,int,int,int);
 
+/*
+ * true while the light pen could see a point (mouse button down).
+ * display_points() and display_vector() do no light pen checks,
+ * callers use display_point() for each point while this is true.
+ */
+extern int display_lp_active(void);
+
+/*
+ * plot a list of n points given as x,y pairs, all with the same
+ * intensity and color; same units and clipping as display_point().
+ */
+extern void display_points(int n, const int *xy, int level, int color);
+
+/*
+ * draw a vector from (x0,y0) to (x1,y1), both ends included;
+ * same units as display_point().  Rasterized straight into the
+ * window surface when both ends are on the display.
+ */
+extern void display_vector(int x0, int y0, int x1, int y1, int level, int color);
+
 /*
  * force window system to output bits to screen;
  * call after adding points, or aging the screen
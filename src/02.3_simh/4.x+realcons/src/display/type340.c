@@ -167,6 +167,23 @@ ty340_reset(void)
     return u->status;
 }
 
+#ifndef TY340_NODISPLAY
+/*
+ * while the light pen is idle, points of a character are
+ * collected here and handed to display_points() together
+ */
+static int batch;
+static int batch_xy[2*5*7], nbatch;
+#endif
+
+static int
+intens(struct type340 *u)
+{
+    int i = DISPLAY_INT_MAX-7+u->intensity;
+
+    return i <= 0 ? 1 : i;
+}
+
 static int
 point(int x, int y, int seq)
 {
@@ -177,9 +194,7 @@ point(int x, int y, int seq)
     DEBUGF(("type340 point %d %d %d\r\n", x, y, seq));
 #endif
 
-    i = DISPLAY_INT_MAX-7+u->intensity;
-    if (i <= 0)
-        i = 1;
+    i = intens(u);
 
     if (x < 0 || x > 1023) {
         /* XXX clip? wrap?? */
@@ -193,7 +208,11 @@ point(int x, int y, int seq)
     }
 
 #ifndef TY340_NODISPLAY
-    if (display_point(x, y, i, 0)) {
+    if (batch) {
+        batch_xy[nbatch++] = x;
+        batch_xy[nbatch++] = y;
+    }
+    else if (display_point(x, y, i, 0)) {
         /*
          * in real life: type340 pauses
          * until CPU reads coordinates
@@ -492,8 +511,15 @@ vector(int i, int sy, int dy, int sx, int dx)
     }
 
     DEBUGF(("vector i%d (%d,%d) to (%d,%d)\r\n", i, x0, y0, x1, y1));
-    if (i)                              /* XXX need OLD value??? */
-        lineTwoStep(x0, y0, x1, y1);
+    if (i) {                            /* XXX need OLD value??? */
+#ifndef TY340_NODISPLAY
+        /* ends are clamped to the display, so is every point between */
+        if (!display_lp_active())
+            display_vector(x0, y0, x1, y1, intens(u), 0);
+        else
+#endif
+            lineTwoStep(x0, y0, x1, y1);
+    }
 
     u->xpos = x1;
     u->ypos = y1;
@@ -733,6 +759,10 @@ character(int n, unsigned char c)
         return 1;
     }
     /* plot character from character set selected by "shift" */
+#ifndef TY340_NODISPLAY
+    batch = !display_lp_active();
+    nbatch = 0;
+#endif
     for (x = 0; x < 5; x++) {           /* column: 0 to 4, left to right */
         for (y = 0; y < 7; y++) {       /* row: 0 to 6, bottom to top */
             if (chars[c|u->shift][x] & (2<<y)) {
@@ -741,6 +771,11 @@ character(int n, unsigned char c)
             }
         }
     }
+#ifndef TY340_NODISPLAY
+    if (nbatch)
+        display_points(nbatch / 2, batch_xy, intens(u), 0);
+    batch = 0;
+#endif
     u->xpos += 7*s;
     if (u->xpos > 1023) {
         u->xpos = 1023;
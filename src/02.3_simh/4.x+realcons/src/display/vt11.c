@@ -1378,6 +1378,23 @@ lineTwoStep(int32 x0, int32 y0, int32 z0, int32 x1, int32 y1, int32 z1)
     y1 /= reduce;
     /* note: Z coords remain in virtual CRT units */
 
+    /*
+     * Nothing for the light pen to see, a visible solid line, constant
+     * intensity and both ends on the CRT: lpoint() would just illuminate
+     * every point, so let the display draw the whole vector.  The pixels
+     * are the same as below except for some exact midway cases, and a
+     * start point in skip_start mode is illuminated again (no visible
+     * difference, all points have the same color).
+     */
+    if (!display_lp_active() && (line_type == SOLID || stroking)
+        && (!lphit_irq || stroking) && int0_scope && !(blink_ena && blink_off)
+        && !depth_cue_proc && ONCRT(x0 * reduce, y0 * reduce)
+        && ONCRT(x1 * reduce, y1 * reduce)) {
+        display_vector((int)(x0 * reduce), (int)(y0 * reduce),
+                       (int)(x1 * reduce), (int)(y1 * reduce), dintens(z0), 0);
+        return;
+    }
+
     dx = x1 - x0;
     dy = y1 - y0;
     dz = z1 - z0;
@@ -2893,6 +2910,16 @@ character(int c)
 
     if (VT11) {
         unsigned char col, prvcol;
+        /* without light pen, the dots are collected and plotted together */
+        int batch = !display_lp_active() && int0_scope
+                    && !(blink_ena && blink_off);
+        int dots_xy[2*6*8*4], ndots = 0;
+
+#define DOT(x,y) do { if (!batch) illum2(x, y); \
+                      else if (ONCRT(x, y)) { \
+                          dots_xy[ndots++] = (x); dots_xy[ndots++] = (y); \
+                      } \
+                 } while (0)
 
         /* plot a graphic symbol (unscaled, unrotated) using a dot matrix */
 
@@ -2923,9 +2950,9 @@ character(int c)
                 int dot = col & (1<<y), nxtdot;
 
                 if (dot) {
-                    illum2(xbase + xllc, ybase + yllc);
+                    DOT(xbase + xllc, ybase + yllc);
                     if (!compress || (nxtdot = nxtcol & (1<<y)) == 0)
-                        illum2(xbase + xllc + 1, ybase + yllc);
+                        DOT(xbase + xllc + 1, ybase + yllc);
                 }
                 if (italics) {
                     delay_skew = 0;
@@ -2935,9 +2962,9 @@ character(int c)
                 }
                 ++yllc;
                 if (dot) {
-                    illum2(xbase + xllc, ybase + yllc);
+                    DOT(xbase + xllc, ybase + yllc);
                     if (!compress || nxtdot == 0)
-                        illum2(xbase + xllc + 1, ybase + yllc);
+                        DOT(xbase + xllc + 1, ybase + yllc);
                 }
                 if (italics && delay_skew)
                     ++xllc;             /* shift between selected dots */
@@ -2950,6 +2977,9 @@ character(int c)
             col = nxtcol;
         }
         lp_suppress = 0;
+        if (ndots)
+            display_points(ndots / 2, dots_xy, dintens(PNORM(zpos)), 0);
+#undef DOT
 
     } else {                            /* VS60 */
         const unsigned char *p;         /* -> stroke data */
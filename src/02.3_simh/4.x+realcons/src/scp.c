@@ -281,6 +281,7 @@
             _x = sim_clock_queue->time;                         \
         sim_time = sim_time + (_x - sim_interval);              \
         sim_rtime = sim_rtime + ((uint32) (_x - sim_interval)); \
+        sim_queue_time = sim_queue_time + (_x - sim_interval);  \
         if (sim_clock_queue == QUEUE_LIST_END)                  \
             noqueue_time = sim_interval;                        \
         else                                                    \
@@ -526,6 +527,7 @@ t_stat set_prompt (int32 flag, CONST char *cptr);
 t_stat sim_set_asynch (int32 flag, CONST char *cptr);
 t_stat sim_set_environment (int32 flag, CONST char *cptr);
 static const char *get_dbg_verb (uint32 dbits, DEVICE* dptr);
+static UNIT **sim_queue_sorted (void);
 
 /* Global data */
 
@@ -567,6 +569,11 @@ size_t *sim_sub_instr_off = NULL;
 static double sim_time;
 static uint32 sim_rtime;
 static int32 noqueue_time;
+static double sim_queue_time;                           /* event queue clock */
+static t_uint64 sim_queue_seq;                          /* activation count */
+static UNIT **sim_queue_heap = NULL;                    /* pending events */
+static int32 sim_queue_cnt = 0;
+static int32 sim_queue_max = 0;
 volatile t_bool stop_cpu = FALSE;
 static unsigned int sim_stop_sleep_ms = 250;
 static char **sim_argv;
@@ -2339,6 +2346,8 @@ stop_cpu = FALSE;
 sim_interval = 0;
 sim_time = sim_rtime = 0;
 noqueue_time = 0;
+sim_queue_time = 0;
+sim_queue_cnt = 0;
 sim_clock_queue = QUEUE_LIST_END;
 sim_is_running = FALSE;
 sim_log = NULL;
@@ -5335,8 +5344,8 @@ return SCPE_OK;
 t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
 {
 DEVICE *dptr;
-UNIT *uptr;
-int32 accum;
+UNIT *uptr, **list;
+int32 i;
 MEMFILE buf;
 
 memset (&buf, 0, sizeof (buf));
@@ -5350,8 +5359,14 @@ else {
 
     fprintf (st, "%s event queue status, time = %.0f, executing %s instructions/sec\n",
              sim_name, sim_time, sim_fmt_numeric (sim_timer_inst_per_sec ()));
-    accum = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    list = sim_queue_sorted ();
+    if (list == NULL)
+        return SCPE_MEM;
+    for (i = 0; i < sim_queue_cnt; i++) {
+        int32 due;
+
+        uptr = list[i];
+        due = (int32)(uptr->qtime - sim_queue_time);
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
@@ -5365,17 +5380,17 @@ else {
                     }
                 else
                     fprintf (st, "  Unknown");
-        tim = sim_fmt_secs(((accum + uptr->time) / sim_timer_inst_per_sec ()) + (uptr->usecs_remaining / 1000000.0));
+        tim = sim_fmt_secs((due / sim_timer_inst_per_sec ()) + (uptr->usecs_remaining / 1000000.0));
         if (uptr->usecs_remaining)
-            fprintf (st, " at %d plus %.0f usecs%s%s%s%s\n", accum + uptr->time, uptr->usecs_remaining,
+            fprintf (st, " at %d plus %.0f usecs%s%s%s%s\n", due, uptr->usecs_remaining,
                                             (*tim) ? " (" : "", tim, (*tim) ? " total)" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         else
-            fprintf (st, " at %d%s%s%s%s\n", accum + uptr->time,
+            fprintf (st, " at %d%s%s%s%s\n", due,
                                             (*tim) ? " (" : "", tim, (*tim) ? ")" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
-        accum = accum + uptr->time;
         }
+    free (list);
     }
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
 #if defined (SIM_ASYNCH_IO)
@@ -6709,7 +6724,9 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
         WRITE_I (uptr->capac);                          /* [V3.5] capacity */
         fprintf (sfile, "%.0f\n", uptr->usecs_remaining);/* [V4.0] remaining wait */
         if (uptr->flags & UNIT_ATT) {
-            fputs (uptr->filename, sfile);
+            const char *snap = sim_disk_snapshot (uptr);/* disk overlay generation? */
+
+            fputs (snap ? snap : uptr->filename, sfile);
             if ((uptr->flags & UNIT_BUF) &&             /* writable buffered */
                 uptr->hwmark &&                         /* files need to be */
                 ((uptr->flags & UNIT_RO) == 0)) {       /* written on save */
@@ -7476,6 +7493,7 @@ noqueue_time = 0;                                       /* reset queue */
 while (sim_clock_queue != QUEUE_LIST_END)
     sim_cancel (sim_clock_queue);
 noqueue_time = sim_interval = 0;
+sim_queue_time = 0;
 r = reset_all (0);
 if ((r == SCPE_OK) && (flag == RU_RUN)) {
     if ((run_cmd_did_reset) && (0 == (sim_switches & SWMASK ('Q')))) {
@@ -10107,10 +10125,148 @@ return buf;
    and to see if further events need to be processed, or sim_interval
    reset to count the next one.
 
-   The event queue is maintained in clock order; entry timeouts are
-   RELATIVE to the time in the previous entry.
+   The event queue is a binary heap of units ordered by due time, an
+   absolute value of sim_queue_time, the number of instructions the queue
+   has counted down.  Entries with the same due time stay in the order
+   they were activated.  sim_clock_queue always points to the first entry
+   (or is QUEUE_LIST_END); its time field holds the timeout loaded into
+   sim_interval, so UPDATE_SIM_TIME and code peeking at the head see
+   the same RELATIVE times as with a list in clock order.
+*/
+
+/* Heap order: due time, then activation order */
+
+static t_bool sim_queue_before (UNIT *a, UNIT *b)
+{
+if (a->qtime != b->qtime)
+    return (a->qtime < b->qtime);
+return (a->qseq < b->qseq);
+}
+
+static void sim_queue_put (int32 i, UNIT *uptr)
+{
+sim_queue_heap[i] = uptr;
+uptr->qidx = i;
+}
+
+static void sim_queue_up (int32 i)
+{
+UNIT *uptr = sim_queue_heap[i];
+
+while (i > 0) {
+    int32 p = (i - 1) >> 1;
+
+    if (!sim_queue_before (uptr, sim_queue_heap[p]))
+        break;
+    sim_queue_put (i, sim_queue_heap[p]);
+    i = p;
+    }
+sim_queue_put (i, uptr);
+}
+
+static void sim_queue_down (int32 i)
+{
+UNIT *uptr = sim_queue_heap[i];
+
+for (;;) {
+    int32 c = (i << 1) + 1;
+
+    if (c >= sim_queue_cnt)
+        break;
+    if (((c + 1) < sim_queue_cnt) &&
+        sim_queue_before (sim_queue_heap[c + 1], sim_queue_heap[c]))
+        c = c + 1;
+    if (!sim_queue_before (sim_queue_heap[c], uptr))
+        break;
+    sim_queue_put (i, sim_queue_heap[c]);
+    i = c;
+    }
+sim_queue_put (i, uptr);
+}
+
+/* Test whether a unit is on the event queue (not a coschedule queue) */
+
+static t_bool sim_queue_member (UNIT *uptr)
+{
+return ((uptr->qidx >= 0) && (uptr->qidx < sim_queue_cnt) &&
+        (sim_queue_heap[uptr->qidx] == uptr));
+}
+
+static t_stat sim_queue_insert (UNIT *uptr, double qtime)
+{
+if (sim_queue_cnt >= sim_queue_max) {
+    int32 max = sim_queue_max ? 2 * sim_queue_max : 64;
+    UNIT **heap = (UNIT **)realloc (sim_queue_heap, max * sizeof (*heap));
+
+    if (heap == NULL)
+        return SCPE_MEM;
+    sim_queue_heap = heap;
+    sim_queue_max = max;
+    }
+uptr->qtime = qtime;
+uptr->qseq = sim_queue_seq++;
+uptr->next = QUEUE_LIST_END;                            /* mark active */
+sim_queue_put (sim_queue_cnt, uptr);
+sim_queue_up (sim_queue_cnt++);
+return SCPE_OK;
+}
+
+static void sim_queue_remove (UNIT *uptr)
+{
+int32 i = uptr->qidx;
+UNIT *lptr = sim_queue_heap[--sim_queue_cnt];
+
+uptr->next = NULL;
+if (lptr != uptr) {                                     /* fill the hole */
+    sim_queue_put (i, lptr);
+    if ((i > 0) && sim_queue_before (lptr, sim_queue_heap[(i - 1) >> 1]))
+        sim_queue_up (i);
+    else
+        sim_queue_down (i);
+    }
+}
+
+/* Make the first entry the head and load its timeout, sim time must be current */
+
+static void sim_queue_load (void)
+{
+if (sim_queue_cnt == 0) {
+    sim_clock_queue = QUEUE_LIST_END;
+    sim_interval = noqueue_time = NOQUEUE_WAIT;
+    return;
+    }
+sim_clock_queue = sim_queue_heap[0];
+sim_clock_queue->time = (int32)(sim_clock_queue->qtime - sim_queue_time);
+sim_interval = sim_clock_queue->time;
+}
+
+/* Compare units by due time, for walking the queue in clock order */
 
-   sim_process_event - process event
+static int sim_queue_cmp (const void *a, const void *b)
+{
+UNIT *ua = *(UNIT * const *)a;
+UNIT *ub = *(UNIT * const *)b;
+
+if (ua == ub)
+    return 0;
+return sim_queue_before (ua, ub) ? -1 : 1;
+}
+
+/* Return the queue entries sorted in clock order, caller frees */
+
+static UNIT **sim_queue_sorted (void)
+{
+UNIT **list = (UNIT **)malloc ((sim_queue_cnt + 1) * sizeof (*list));
+
+if (list == NULL)
+    return NULL;
+if (sim_queue_cnt)
+    memcpy (list, sim_queue_heap, sim_queue_cnt * sizeof (*list));
+qsort (list, sim_queue_cnt, sizeof (*list), sim_queue_cmp);
+return list;
+}
+
+/* sim_process_event - process event
 
    Inputs:
         none
@@ -10139,13 +10295,10 @@ if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
 sim_processing_event = TRUE;
 do {
     uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
-    uptr->next = NULL;                                  /* hygiene */
+    sim_queue_time = uptr->qtime;                       /* rest is relative to it */
+    sim_queue_remove (uptr);                            /* remove first */
     uptr->time = 0;
-    if (sim_clock_queue != QUEUE_LIST_END)
-        sim_interval = sim_clock_queue->time;
-    else
-        sim_interval = noqueue_time = NOQUEUE_WAIT;
+    sim_queue_load ();
     sim_debug (SIM_DBG_EVENT, sim_dflt_dev, "Processing Event for %s\n", sim_uname (uptr));
     AIO_EVENT_BEGIN(uptr);
     if (uptr->usecs_remaining)
@@ -10195,8 +10348,7 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
+t_stat r;
 
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
@@ -10205,27 +10357,10 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, sim_dflt_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
-if (cptr != QUEUE_LIST_END)
-    cptr->time = cptr->time - uptr->time;
-sim_interval = sim_clock_queue->time;
-return SCPE_OK;
+r = sim_queue_insert (uptr, sim_queue_time + event_time);
+uptr->time = event_time;
+sim_queue_load ();
+return r;
 }
 
 /* sim_activate_abs - activate (queue) event even if event already scheduled
@@ -10323,8 +10458,6 @@ return sim_timer_activate_after (uptr, usec_delay);
 
 t_stat sim_cancel (UNIT *uptr)
 {
-UNIT *cptr, *nptr;
-
 AIO_VALIDATE;
 if ((uptr->cancel) && uptr->cancel (uptr))
     return SCPE_OK;
@@ -10338,29 +10471,12 @@ sim_debug (SIM_DBG_EVENT, sim_dflt_dev, "Canceling Event for %s\n", sim_uname(up
 UPDATE_SIM_TIME;                                        /* update sim time */
 if (!sim_is_active (uptr))
     return SCPE_OK;
-nptr = QUEUE_LIST_END;
-
-if (sim_clock_queue == uptr) {
-    nptr = sim_clock_queue = uptr->next;
-    uptr->next = NULL;                                  /* hygiene */
-    }
-else {
-    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-        if (cptr->next == uptr) {
-            nptr = cptr->next = uptr->next;
-            uptr->next = NULL;                          /* hygiene */
-            break;                                      /* end queue scan */
-            }
-        }
-    }
-if (nptr != QUEUE_LIST_END)
-    nptr->time += (uptr->next) ? 0 : uptr->time;
-if (!uptr->next)
+if (sim_queue_member (uptr)) {
+    sim_queue_remove (uptr);
     uptr->time = 0;
+    }
 uptr->usecs_remaining = 0;
-if (sim_clock_queue != QUEUE_LIST_END)
-    sim_interval = sim_clock_queue->time;
-else sim_interval = noqueue_time = NOQUEUE_WAIT;
+sim_queue_load ();
 if (uptr->next) {
     sim_printf ("Cancel failed for %s\n", sim_uname(uptr));
     if (sim_deb)
@@ -10393,22 +10509,21 @@ return (((uptr->next) || AIO_IS_ACTIVE(uptr) || ((uptr->dynflags & UNIT_TMR_UNIT
         result =        absolute activation time + 1, 0 if inactive
 */
 
-int32 _sim_activate_time (UNIT *uptr)
+/* Time from now until an entry is due, late events delay all that follow */
+
+static int32 sim_queue_delay (UNIT *uptr)
 {
-UNIT *cptr;
-int32 accum;
+int32 accum = (int32)(uptr->qtime - sim_clock_queue->qtime);
 
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return accum + 1 + (int32)((uptr->usecs_remaining * sim_timer_inst_per_sec ()) / 1000000.0);
-    }
+if (sim_interval > 0)
+    accum = accum + sim_interval;
+return accum;
+}
+
+int32 _sim_activate_time (UNIT *uptr)
+{
+if (sim_queue_member (uptr))
+    return sim_queue_delay (uptr) + 1 + (int32)((uptr->usecs_remaining * sim_timer_inst_per_sec ()) / 1000000.0);
 return 0;
 }
 
@@ -10425,25 +10540,14 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
-int32 accum;
 double result;
 
 AIO_VALIDATE;
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
+if (sim_queue_member (uptr))
+    return 1.0 + uptr->usecs_remaining + ((1000000.0 * sim_queue_delay (uptr)) / sim_timer_inst_per_sec ());
 return 0.0;
 }
 
@@ -10478,13 +10582,7 @@ return sim_rtime;
 
 int32 sim_qcount (void)
 {
-int32 cnt;
-UNIT *uptr;
-
-cnt = 0;
-for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
-    cnt++;
-return cnt;
+return sim_queue_cnt;
 }
 
 /* Breakpoint package.  This module replaces the VM-implemented one
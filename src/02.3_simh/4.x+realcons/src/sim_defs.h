@@ -580,6 +580,9 @@ struct UNIT {
     t_bool              (*cancel)(UNIT *);
     double              usecs_remaining;                /* time balance for long delays */
     char                *uname;                         /* Unit name */
+    double              qtime;                          /* event queue due time */
+    t_uint64            qseq;                           /* event queue activation order */
+    int32               qidx;                           /* event queue heap index */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
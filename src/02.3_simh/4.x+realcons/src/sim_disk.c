@@ -80,8 +80,23 @@ Internal routines:
 #include <ctype.h>
 #include <sys/stat.h>
 
+#if !defined (_WIN32) && !defined (VMS)
+#define SIM_DISK_MMAP   1                   /* ATTACH -P available */
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
 #if defined SIM_ASYNCH_IO
 #include <pthread.h>
+#if defined (HAVE_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
 #endif
 
 struct disk_context {
@@ -95,6 +110,11 @@ struct disk_context {
     uint32              is_cdrom;           /* Host system CDROM Device */
     uint32              media_removed;      /* Media not available flag */
     uint32              auto_format;        /* Format determined dynamically */
+    uint8               *map;               /* SIMH image mapped (ATTACH -P), else NULL */
+    t_offset            map_size;           /* bytes mapped */
+    t_offset            map_lo, map_hi;     /* range written since last msync */
+    uint32              map_time;           /* sim_os_msec of last msync */
+    struct disk_overlay *ovl;               /* copy-on-write overlay (ATTACH -W), else NULL */
 #if defined _WIN32
     HANDLE              disk_handle;        /* OS specific Raw device handle */
 #endif
@@ -114,6 +134,7 @@ struct disk_context {
     t_lba               lba;
     DISK_PCALLBACK      callback;
     t_stat              io_status;
+    struct disk_uring   *uring;             /* io_uring backend, NULL = I/O thread */
 #endif
     };
 
@@ -126,6 +147,10 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
 if ((!callback) || !ctx->asynch_io)
 
 #define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
+    if (ctx->asynch_io && _disk_uring_active (ctx))             \
+        _disk_uring_submit (uptr, op, _lba, _buf, _rsects,      \
+                            _sects, _callback);                 \
+    else                                                        \
     if (ctx->asynch_io) {                                       \
         struct disk_context *ctx =                              \
                       (struct disk_context *)uptr->disk_ctx;    \
@@ -157,6 +182,443 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
+#if defined (HAVE_IO_URING)
+/* io_uring backend
+
+   Used in place of the I/O thread for SIMH format images when the host
+   kernel has io_uring.  Each transfer is a single vectored read or write
+   at an explicit offset, straight between the caller's buffer and the
+   image file descriptor, so there is no seek+stdio sequence to serialize
+   and up to URING_DEPTH requests may be outstanding on a unit.  A reaper
+   thread per unit sleeps in io_uring_enter until completions arrive and
+   then activates the unit; the callbacks run in the simulator thread, in
+   the order the requests were issued, when the unit's event is processed.
+   Requests which need no transfer go through the ring as a NOP, so their
+   callbacks are never run from inside the issuing call.  A transfer that
+   overlaps a transfer in flight, and either of them writes, is issued with
+   IOSQE_IO_DRAIN: the kernel does not reorder it against earlier ones.
+
+   Only the simulator thread touches the submission ring and the order
+   list; io_lock protects the request states shared with the reaper.
+   While a ring exists, the synchronous sim_disk_rdsect/wrsect paths use
+   pread/pwrite on the same descriptor, so stdio never holds stale data. */
+
+#define URING_DEPTH     16                  /* requests in flight per unit */
+#define URING_WAKE      0xFFFFFFFF          /* user_data of shutdown NOP */
+
+#define URQ_FREE        0                   /* request states */
+#define URQ_BUSY        1
+#define URQ_DONE        2
+
+struct disk_uring_req {
+    int                 state;
+    int                 dop;                /* DOP_RSEC, DOP_WSEC, DOP_DONE = no I/O */
+    t_lba               lba;
+    uint8               *buf;
+    t_seccnt            *rsects;
+    t_seccnt            sects;
+    DISK_PCALLBACK      callback;
+    struct iovec        iov;
+    int32               res;                /* bytes or -errno */
+    t_stat              status;             /* status when dop == DOP_DONE */
+    };
+
+struct disk_uring {
+    int                 fd;                 /* ring, -1 = stopped */
+    int                 img;                /* image file */
+    pthread_t           reaper;
+    uint32              *sq_tail, *sq_mask, *sq_array;
+    uint32              *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void                *sq_map, *cq_map;
+    size_t              sq_len, cq_len, sqes_len;
+    uint32              order[URING_DEPTH]; /* requests in issue order */
+    uint32              ohead, ocount;
+    struct disk_uring_req req[URING_DEPTH];
+    };
+
+#define _disk_uring_active(ctx) ((ctx)->uring && ((ctx)->uring->fd >= 0))
+#define _disk_uring_pending(ctx) ((ctx)->uring->ocount != 0)
+
+static int _disk_uring_enter (int fd, uint32 to_submit, uint32 min_complete, uint32 flags)
+{
+return (int) syscall (__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void *
+_disk_uring_reap (void *arg)
+{
+UNIT *uptr = (UNIT *)arg;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_uring *u = ctx->uring;
+t_bool done = FALSE;
+
+sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+
+sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_reap(unit=%d) starting\n", (int)(uptr-ctx->dptr->units));
+
+while (!done) {
+    uint32 head, tail;
+    t_bool completed = FALSE;
+
+    if ((_disk_uring_enter (u->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0) &&
+        (errno != EINTR))
+        break;
+    pthread_mutex_lock (&ctx->io_lock);
+    head = *u->cq_head;
+    tail = __atomic_load_n (u->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+
+        if (cqe->user_data == URING_WAKE)
+            done = TRUE;
+        else {
+            u->req[cqe->user_data].res = cqe->res;
+            u->req[cqe->user_data].state = URQ_DONE;
+            completed = TRUE;
+            }
+        }
+    __atomic_store_n (u->cq_head, head, __ATOMIC_RELEASE);
+    if (completed) {
+        pthread_cond_broadcast (&ctx->io_done);
+        sim_activate (uptr, ctx->asynch_io_latency);
+        }
+    pthread_mutex_unlock (&ctx->io_lock);
+    }
+
+sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_reap(unit=%d) exiting\n", (int)(uptr-ctx->dptr->units));
+
+return NULL;
+}
+
+/* Start the ring for a unit; fails if the unit's format or byte order
+   needs the generic path or if the host refuses io_uring */
+
+static t_stat _disk_uring_start (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_uring *u = ctx->uring;
+struct io_uring_params p;
+
+if ((DK_GET_FMT (uptr) != DKUF_F_STD) ||                /* SIMH format only */
+    (ctx->ovl != NULL) ||                               /* not an overlay */
+    (uptr->dynflags & UNIT_DISK_CHK) ||                 /* write verify */
+    ((!sim_end) && (ctx->xfer_element_size != sizeof (char))))/* byte swap */
+    return SCPE_NOFNC;
+if (u == NULL) {
+    u = (struct disk_uring *)calloc (1, sizeof (*u));
+    if (u == NULL)
+        return SCPE_MEM;
+    }
+memset (&p, 0, sizeof (p));
+u->fd = (int) syscall (__NR_io_uring_setup, URING_DEPTH, &p);
+if (u->fd < 0) {
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_start(unit=%d) io_uring_setup: %s\n", (int)(uptr-ctx->dptr->units), strerror (errno));
+    if (u->ocount == 0) {
+        free (u);
+        u = NULL;
+        }
+    ctx->uring = u;
+    return SCPE_NOFNC;
+    }
+u->sq_len = p.sq_off.array + p.sq_entries * sizeof (uint32);
+u->cq_len = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+u->sqes_len = p.sq_entries * sizeof (struct io_uring_sqe);
+u->sq_map = mmap (NULL, u->sq_len, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, u->fd, IORING_OFF_SQ_RING);
+u->cq_map = mmap (NULL, u->cq_len, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, u->fd, IORING_OFF_CQ_RING);
+u->sqes = (struct io_uring_sqe *)mmap (NULL, u->sqes_len, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, u->fd, IORING_OFF_SQES);
+if ((u->sq_map == MAP_FAILED) || (u->cq_map == MAP_FAILED) || ((void *)u->sqes == MAP_FAILED)) {
+    if (u->sq_map != MAP_FAILED)
+        munmap (u->sq_map, u->sq_len);
+    if (u->cq_map != MAP_FAILED)
+        munmap (u->cq_map, u->cq_len);
+    if ((void *)u->sqes != MAP_FAILED)
+        munmap (u->sqes, u->sqes_len);
+    close (u->fd);
+    u->fd = -1;
+    if (u->ocount == 0) {
+        free (u);
+        u = NULL;
+        }
+    ctx->uring = u;
+    return SCPE_NOFNC;
+    }
+u->sq_tail = (uint32 *)((uint8 *)u->sq_map + p.sq_off.tail);
+u->sq_mask = (uint32 *)((uint8 *)u->sq_map + p.sq_off.ring_mask);
+u->sq_array = (uint32 *)((uint8 *)u->sq_map + p.sq_off.array);
+u->cq_head = (uint32 *)((uint8 *)u->cq_map + p.cq_off.head);
+u->cq_tail = (uint32 *)((uint8 *)u->cq_map + p.cq_off.tail);
+u->cq_mask = (uint32 *)((uint8 *)u->cq_map + p.cq_off.ring_mask);
+u->cqes = (struct io_uring_cqe *)((uint8 *)u->cq_map + p.cq_off.cqes);
+fflush (uptr->fileref);                                 /* push out, drop stdio buffer */
+u->img = fileno (uptr->fileref);
+ctx->uring = u;
+pthread_mutex_init (&ctx->io_lock, NULL);
+pthread_cond_init (&ctx->io_done, NULL);
+pthread_create (&u->reaper, NULL, _disk_uring_reap, (void *)uptr);
+sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_start(unit=%d) %d entries\n", (int)(uptr-ctx->dptr->units), p.sq_entries);
+return SCPE_OK;
+}
+
+/* Next submission entry, cleared */
+
+static struct io_uring_sqe *_disk_uring_sqe (struct disk_uring *u)
+{
+uint32 idx = *u->sq_tail & *u->sq_mask;
+struct io_uring_sqe *sqe = &u->sqes[idx];
+
+memset (sqe, 0, sizeof (*sqe));
+u->sq_array[idx] = idx;
+return sqe;
+}
+
+/* Publish the entry from _disk_uring_sqe and submit it */
+
+static int _disk_uring_push (struct disk_uring *u)
+{
+int r;
+
+__atomic_store_n (u->sq_tail, *u->sq_tail + 1, __ATOMIC_RELEASE);
+while (((r = _disk_uring_enter (u->fd, 1, 0, 0)) < 0) &&
+       ((errno == EINTR) || (errno == EAGAIN)))
+    ;
+if (r != 1)                                             /* not taken, withdraw */
+    __atomic_store_n (u->sq_tail, *u->sq_tail - 1, __ATOMIC_RELEASE);
+return r;
+}
+
+/* Wait until no request is in flight */
+
+static void _disk_uring_wait (struct disk_context *ctx)
+{
+struct disk_uring *u = ctx->uring;
+uint32 i;
+
+pthread_mutex_lock (&ctx->io_lock);
+for (i = 0; i < u->ocount; i++) {
+    while (u->req[u->order[(u->ohead + i) % URING_DEPTH]].state == URQ_BUSY)
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+    }
+pthread_mutex_unlock (&ctx->io_lock);
+}
+
+/* Stop the ring: let outstanding transfers finish, stop the reaper.
+   Completed requests whose callbacks have not run yet are kept. */
+
+static void _disk_uring_stop (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_uring *u = ctx->uring;
+struct io_uring_sqe *sqe;
+
+if (!_disk_uring_active (ctx))
+    return;
+_disk_uring_wait (ctx);
+sqe = _disk_uring_sqe (u);                               /* wake the reaper */
+sqe->opcode = IORING_OP_NOP;
+sqe->user_data = URING_WAKE;
+if (_disk_uring_push (u) == 1)
+    pthread_join (u->reaper, NULL);
+else
+    pthread_cancel (u->reaper);
+munmap (u->sq_map, u->sq_len);
+munmap (u->cq_map, u->cq_len);
+munmap (u->sqes, u->sqes_len);
+close (u->fd);
+u->fd = -1;
+pthread_mutex_destroy (&ctx->io_lock);
+pthread_cond_destroy (&ctx->io_done);
+if (u->ocount == 0) {
+    free (u);
+    ctx->uring = NULL;
+    }
+sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_stop(unit=%d)\n", (int)(uptr-ctx->dptr->units));
+}
+
+/* Does a transfer overlap one in flight, with at least one of them a
+   write?  Called with io_lock held */
+
+static t_bool _disk_uring_overlaps (struct disk_uring *u, int dop, t_lba lba, t_seccnt sects)
+{
+struct disk_uring_req *req;
+uint32 i;
+
+for (i = 0; i < u->ocount; i++) {
+    req = &u->req[u->order[(u->ohead + i) % URING_DEPTH]];
+    if ((req->state == URQ_BUSY) &&
+        ((dop == DOP_WSEC) || (req->dop == DOP_WSEC)) &&
+        (lba < req->lba + req->sects) && (req->lba < lba + sects))
+        return TRUE;
+    }
+return FALSE;
+}
+
+/* Run the callbacks of completed requests, oldest first, stopping at
+   the first request still in flight */
+
+static void _disk_uring_dispatch (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_uring *u = ctx->uring;
+struct disk_uring_req *req;
+DISK_PCALLBACK callback;
+t_stat r;
+uint32 tbc;
+
+while (u && u->ocount) {
+    req = &u->req[u->order[u->ohead]];
+    if (u->fd >= 0) {
+        pthread_mutex_lock (&ctx->io_lock);
+        if (req->state != URQ_DONE)
+            req = NULL;
+        pthread_mutex_unlock (&ctx->io_lock);
+        if (req == NULL)
+            break;
+        }
+    u->ohead = (u->ohead + 1) % URING_DEPTH;
+    --u->ocount;
+    tbc = req->sects * ctx->sector_size;
+    r = SCPE_OK;
+    if (req->dop == DOP_DONE)                           /* completed at issue */
+        r = req->status;
+    else if (req->res < 0) {
+        sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_dispatch(unit=%d) %s\n", (int)(uptr-ctx->dptr->units), strerror (-req->res));
+        r = SCPE_IOERR;
+        }
+    else {
+        if ((req->dop == DOP_RSEC) && ((uint32)req->res < tbc))
+            memset (req->buf + req->res, 0, tbc - req->res);/* fill */
+        if (req->rsects)
+            *req->rsects = (t_seccnt)((req->res + ctx->sector_size - 1) / ctx->sector_size);
+        if ((req->dop == DOP_WSEC) && ((uint32)req->res < tbc))
+            r = SCPE_IOERR;
+        }
+    callback = req->callback;
+    pthread_mutex_lock (&ctx->io_lock);
+    req->state = URQ_FREE;
+    pthread_mutex_unlock (&ctx->io_lock);
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_dispatch(unit=%d, dop=%d, status=%d)\n", (int)(uptr-ctx->dptr->units), req->dop, r);
+    callback (uptr, r);
+    if (ctx != (struct disk_context *)uptr->disk_ctx)   /* detached by callback? */
+        break;
+    u = ctx->uring;
+    }
+}
+
+/* Issue a request.  Requests which need no transfer complete at once but
+   still go through the order list and the ring, so callbacks keep issue
+   order and run from the unit's event.  Callbacks run here only if all
+   URING_DEPTH requests are taken, or if the ring refuses the request. */
+
+static void _disk_uring_submit (UNIT *uptr, int dop, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_uring *u = ctx->uring;
+struct disk_uring_req *req;
+struct io_uring_sqe *sqe;
+uint32 i;
+
+sim_debug (ctx->dbit, ctx->dptr, "_disk_uring_submit(op=%d, unit=%d, lba=0x%X, sects=%d)\n", dop, (int)(uptr-ctx->dptr->units), lba, sects);
+
+while (u->ocount == URING_DEPTH) {                      /* full? wait for oldest */
+    pthread_mutex_lock (&ctx->io_lock);
+    while (u->req[u->order[u->ohead]].state != URQ_DONE)
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+    pthread_mutex_unlock (&ctx->io_lock);
+    _disk_uring_dispatch (uptr);
+    }
+for (i = 0; u->req[i].state != URQ_FREE; i++)
+    ;
+req = &u->req[i];
+req->dop = dop;
+req->lba = lba;
+req->buf = buf;
+req->rsects = rsects;
+req->sects = sects;
+req->callback = callback;
+req->res = 0;
+req->status = SCPE_OK;
+if (rsects)
+    *rsects = 0;
+u->order[(u->ohead + u->ocount) % URING_DEPTH] = i;
+++u->ocount;
+if (dop == DOP_IAVL) {
+    req->dop = DOP_DONE;
+    req->status = sim_disk_isavailable (uptr);
+    }
+else if ((dop == DOP_RSEC) && (sects == 1) &&           /* single sector read */
+         (lba >= (uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1)))) {
+    memset (buf, '\0', ctx->sector_size);               /* beyond the end, as sim_disk_rdsect */
+    if (rsects)
+        *rsects = 1;
+    req->dop = DOP_DONE;
+    }
+sqe = _disk_uring_sqe (u);
+if (req->dop == DOP_DONE)                               /* completes through the reaper */
+    sqe->opcode = IORING_OP_NOP;
+else {
+    req->iov.iov_base = buf;
+    req->iov.iov_len = sects * ctx->sector_size;
+    sqe->opcode = (dop == DOP_RSEC) ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = u->img;
+    sqe->off = ((t_offset)lba) * ctx->sector_size;
+    sqe->addr = (t_uint64)(size_t)&req->iov;
+    sqe->len = 1;
+    pthread_mutex_lock (&ctx->io_lock);
+    if (_disk_uring_overlaps (u, dop, lba, sects))      /* keep order of overlapping transfers */
+        sqe->flags |= IOSQE_IO_DRAIN;
+    pthread_mutex_unlock (&ctx->io_lock);
+    }
+sqe->user_data = i;
+req->state = URQ_BUSY;
+if (_disk_uring_push (u) == 1)
+    return;
+pthread_mutex_lock (&ctx->io_lock);                     /* ring refused, do it here */
+req->state = URQ_DONE;
+pthread_mutex_unlock (&ctx->io_lock);
+if (req->dop != DOP_DONE) {
+    _disk_uring_wait (ctx);                             /* after those in flight */
+    req->res = (int32)((dop == DOP_RSEC) ?
+                        pread (u->img, buf, req->iov.iov_len, (off_t)(((t_offset)lba) * ctx->sector_size)) :
+                        pwrite (u->img, buf, req->iov.iov_len, (off_t)(((t_offset)lba) * ctx->sector_size)));
+    if (req->res < 0)
+        req->res = -errno;
+    }
+_disk_uring_dispatch (uptr);
+}
+
+/* Synchronous transfer on the ring's descriptor, for sim_disk_rdsect and
+   sim_disk_wrsect while a ring is in use */
+
+static t_stat _disk_uring_sync (UNIT *uptr, int dop, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+size_t tbc = sects * ctx->sector_size;
+off_t da = (off_t)(((t_offset)lba) * ctx->sector_size);
+ssize_t i;
+
+if (rsects)
+    *rsects = 0;
+i = (dop == DOP_RSEC) ? pread (ctx->uring->img, buf, tbc, da) : pwrite (ctx->uring->img, buf, tbc, da);
+if (i < 0)
+    return SCPE_IOERR;
+if ((dop == DOP_RSEC) && ((size_t)i < tbc))             /* fill */
+    memset (&buf[i], 0, tbc - i);
+if (rsects)
+    *rsects = (t_seccnt)((i + ctx->sector_size - 1) / ctx->sector_size);
+return ((dop == DOP_WSEC) && ((size_t)i < tbc)) ? SCPE_IOERR : SCPE_OK;
+}
+#else
+#define _disk_uring_active(ctx) FALSE
+#define _disk_uring_pending(ctx) FALSE
+#define _disk_uring_wait(ctx)
+#define _disk_uring_start(uptr) SCPE_NOFNC
+#define _disk_uring_stop(uptr)
+#define _disk_uring_dispatch(uptr)
+#define _disk_uring_submit(uptr, op, lba, buf, rsects, sects, callback)
+#endif
+
 static void *
 _disk_io(void *arg)
 {
@@ -218,6 +680,10 @@ DISK_PCALLBACK callback = ctx->callback;
 
 sim_debug (ctx->dbit, ctx->dptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop, ctx->callback);
 
+if (ctx->uring) {
+    _disk_uring_dispatch (uptr);
+    return;
+    }
 if (ctx->io_dop != DOP_DONE)
     abort();                                            /* horribly wrong, stop */
 
@@ -233,6 +699,8 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
     sim_debug (ctx->dbit, ctx->dptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop);
+    if (ctx->uring)
+        return _disk_uring_pending (ctx);
     return (ctx->io_dop != DOP_DONE);
     }
 return FALSE;
@@ -244,7 +712,9 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
     sim_debug (ctx->dbit, ctx->dptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop);
-    if (ctx->asynch_io) {
+    if (_disk_uring_active (ctx))
+        _disk_uring_wait (ctx);
+    else if (ctx->asynch_io) {
         pthread_mutex_lock (&ctx->io_lock);
         while (ctx->io_dop != DOP_DONE)
             pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
@@ -288,6 +758,7 @@ static t_stat sim_os_disk_info_raw (FILE *f, uint32 *sector_size, uint32 *remova
 static char *HostPathToVhdPath (const char *szHostPath, char *szVhdPath, size_t VhdPathSize);
 static char *VhdPathToHostPath (const char *szVhdPath, char *szHostPath, size_t HostPathSize);
 static t_offset get_filesystem_size (UNIT *uptr);
+static void _sim_disk_ovl_show (FILE *st, UNIT *uptr);
 
 struct sim_disk_fmt {
     const char          *name;                          /* name */
@@ -335,6 +806,8 @@ size_t i;
 for (i = 0; i < DKUF_N_FMT; i++)
     if (fmts[i].fmtval == f) {
         fprintf (st, "%s format", fmts[i].name);
+        if ((uptr->flags & UNIT_ATT) && (uptr->disk_ctx != NULL))
+            _sim_disk_ovl_show (st, uptr);
         return SCPE_OK;
         }
 fprintf (st, "invalid format");
@@ -433,6 +906,21 @@ AIO_CALL(DOP_IAVL, 0, NULL, NULL, 0, callback);
 return r;
 }
 
+/* Number of asynchronous transfers a unit accepts before the first one
+   completes.  Callbacks are always made in the order the transfers were
+   issued. */
+
+uint32 sim_disk_queue_depth (UNIT *uptr)
+{
+#if defined (SIM_ASYNCH_IO) && defined (HAVE_IO_URING)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx && ctx->asynch_io && _disk_uring_active (ctx))
+    return URING_DEPTH;
+#endif
+return 1;
+}
+
 /* Test for write protect */
 
 t_bool sim_disk_wrp (UNIT *uptr)
@@ -483,9 +971,9 @@ pthread_attr_t attr;
 
 sim_debug (ctx->dbit, ctx->dptr, "sim_disk_set_async(unit=%d)\n", (int)(uptr-ctx->dptr->units));
 
-ctx->asynch_io = sim_asynch_enabled;
+ctx->asynch_io = sim_asynch_enabled && (ctx->map == NULL);/* memcpy needs no thread */
 ctx->asynch_io_latency = latency;
-if (ctx->asynch_io) {
+if (ctx->asynch_io && (_disk_uring_start (uptr) != SCPE_OK)) {/* io_uring or I/O thread */
     pthread_mutex_init (&ctx->io_lock, NULL);
     pthread_cond_init (&ctx->io_cond, NULL);
     pthread_cond_init (&ctx->io_done, NULL);
@@ -520,7 +1008,11 @@ if (!ctx) return SCPE_UNATT;
 
 sim_debug (ctx->dbit, ctx->dptr, "sim_disk_clr_async(unit=%d)\n", (int)(uptr-ctx->dptr->units));
 
-if (ctx->asynch_io) {
+if (_disk_uring_active (ctx)) {
+    _disk_uring_stop (uptr);
+    ctx->asynch_io = 0;
+    }
+else if (ctx->asynch_io) {
     pthread_mutex_lock (&ctx->io_lock);
     ctx->asynch_io = 0;
     pthread_cond_signal (&ctx->io_cond);
@@ -534,6 +1026,559 @@ return SCPE_OK;
 #endif
 }
 
+/* Memory mapped SIMH format images (ATTACH -P)
+
+   The whole image, extended to the drive's capacity if it is shorter, is
+   mapped shared, and transfers are a single copy between the mapping and
+   the caller's buffer, byte swapped on big endian hosts.  A writable image
+   is allocated on the host first, holes included: a store into a page the
+   host can't back would be a SIGBUS, not an I/O error.  If that fails the
+   unit stays attached, with file I/O.  The pages are
+   written back by the host as it sees fit; the range written since the
+   last msync is pushed out asynchronously once MAP_SYNC_MSEC has passed,
+   and synchronously when the simulator stops and at detach. */
+
+#define MAP_SYNC_MSEC   1000                /* write back at least this often */
+
+static t_stat _sim_disk_map (UNIT *uptr)
+{
+#if defined (SIM_DISK_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset size = ((t_offset)uptr->capac)*ctx->capac_factor*((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1);
+t_offset fsize;
+int fd;
+void *m;
+
+if ((DK_GET_FMT (uptr) != DKUF_F_STD) || (ctx->ovl != NULL))
+    return sim_messagef (SCPE_NOFNC, "%s: only SIMH format disk images can be mapped\n", sim_uname (uptr));
+fsize = sim_fsize_ex (uptr->fileref);
+fd = fileno (uptr->fileref);
+if ((fsize > size) || (uptr->flags & UNIT_RO))          /* larger or can't extend? */
+    size = fsize;
+if ((size == 0) || (size != (t_offset)(size_t)size))
+    return sim_messagef (SCPE_NOFNC, "%s: can't map %s, size %.0f\n", sim_uname (uptr), uptr->filename, (double)size);
+fflush (uptr->fileref);                                 /* push out, drop stdio buffer */
+if (!(uptr->flags & UNIT_RO)) {                         /* allocate, extend to capacity */
+#if defined (__APPLE__)
+    int e = ENOTSUP;                                    /* no posix_fallocate */
+#else
+    int e = posix_fallocate (fd, 0, (off_t)size);
+#endif
+
+    if (e != 0) {
+        sim_messagef (SCPE_OK, "%s: can't allocate %s: %s, using file I/O\n", sim_uname (uptr), uptr->filename, strerror (e));
+        return SCPE_OK;
+        }
+    }
+m = mmap (NULL, (size_t)size, (uptr->flags & UNIT_RO) ? PROT_READ : PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+if (m == MAP_FAILED)
+    return sim_messagef (SCPE_IOERR, "%s: can't map %s: %s\n", sim_uname (uptr), uptr->filename, strerror (errno));
+ctx->map = (uint8 *)m;
+ctx->map_size = size;
+ctx->map_lo = size;
+ctx->map_hi = 0;
+ctx->map_time = sim_os_msec ();
+sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_map(unit=%d) %.0f bytes\n", (int)(uptr-ctx->dptr->units), (double)size);
+return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "%s: disk images can't be mapped on this host\n", sim_uname (uptr));
+#endif
+}
+
+static void _sim_disk_map_sync (struct disk_context *ctx, t_bool wait)
+{
+#if defined (SIM_DISK_MMAP)
+t_offset lo = ctx->map_lo & ~((t_offset)sysconf (_SC_PAGESIZE) - 1);
+
+if (ctx->map_hi > lo)
+    msync (ctx->map + lo, (size_t)(ctx->map_hi - lo), wait ? MS_SYNC : MS_ASYNC);
+ctx->map_lo = ctx->map_size;
+ctx->map_hi = 0;
+ctx->map_time = sim_os_msec ();
+#endif
+}
+
+static void _sim_disk_unmap (struct disk_context *ctx)
+{
+#if defined (SIM_DISK_MMAP)
+if (ctx->map == NULL)
+    return;
+_sim_disk_map_sync (ctx, TRUE);
+munmap (ctx->map, (size_t)ctx->map_size);
+ctx->map = NULL;
+#endif
+}
+
+static t_stat _sim_disk_map_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset da = ((t_offset)lba) * ctx->sector_size;
+size_t tbc = sects * ctx->sector_size, n = 0;
+
+if (da < ctx->map_size)
+    n = ((t_offset)tbc < (ctx->map_size - da)) ? tbc : (size_t)(ctx->map_size - da);
+sim_buf_copy_swapped (buf, ctx->map + da, ctx->xfer_element_size, n / ctx->xfer_element_size);
+if (n < tbc)                                            /* fill */
+    memset (&buf[n], 0, tbc - n);
+if (sectsread)
+    *sectsread = (t_seccnt)((n + ctx->sector_size - 1) / ctx->sector_size);
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_map_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset da = ((t_offset)lba) * ctx->sector_size;
+size_t tbc = sects * ctx->sector_size, n = 0;
+
+if (sectswritten)
+    *sectswritten = 0;
+if (uptr->flags & UNIT_RO)
+    return SCPE_RO;
+if (da < ctx->map_size)
+    n = ((t_offset)tbc < (ctx->map_size - da)) ? tbc : (size_t)(ctx->map_size - da);
+sim_buf_copy_swapped (ctx->map + da, buf, ctx->xfer_element_size, n / ctx->xfer_element_size);
+if (n) {
+    if (da < ctx->map_lo)
+        ctx->map_lo = da;
+    if (da + n > ctx->map_hi)
+        ctx->map_hi = da + n;
+    if ((sim_os_msec () - ctx->map_time) >= MAP_SYNC_MSEC)
+        _sim_disk_map_sync (ctx, FALSE);
+    }
+if (sectswritten)
+    *sectswritten = (t_seccnt)(n / ctx->sector_size);
+return (n < tbc) ? SCPE_IOERR : SCPE_OK;                /* beyond the mapping */
+}
+
+/* Copy-on-write overlays (ATTACH -W)
+
+   An overlay file holds every sector written to a unit whose SIMH format
+   base image is only ever read.  A 512 byte header (magic, sector size,
+   sectors covered, generation being written, newest snapshot generation
+   and the base image name) is followed by fixed size slots: the sector
+   number, the generation that wrote it and the sector's previous slot,
+   then the sector data.  Slots are only ever appended, so the block map
+   is rebuilt from the slot headers at attach and kept in memory: a bitmap
+   tells whether a sector lives in the overlay at all and the map gives
+   its newest slot, so each lookup is a bit test and a load.
+
+   A write reuses the sector's slot when that slot was written in the
+   current generation and appends a new one otherwise.  SAVE seals the
+   current generation by starting the next one and records the unit as
+   attached to overlay@generation; RESTORE reattaches to that name, which
+   drops each sector back along its slot chain to the saved generation and
+   truncates the newer slots.  A snapshot is a header write, not a copy. */
+
+#define OVL_MAGIC       "SIMHOVL1"
+#define OVL_HDRSIZE     512                 /* header bytes */
+#define OVL_BASEOFF     64                  /* base image name offset in header */
+#define OVL_SLOTHDR     16                  /* sector, generation, previous slot, 0 */
+#define OVL_H_SECSIZE   0                   /* header words following the magic */
+#define OVL_H_SECTORS   1
+#define OVL_H_GEN       2
+#define OVL_H_SEALED    3
+#define OVL_H_WORDS     4
+
+struct disk_overlay {
+    FILE                *base;              /* base image, opened read only */
+    char                basename[OVL_HDRSIZE - OVL_BASEOFF];
+    uint32              gen;                /* generation being written */
+    uint32              sealed;             /* newest snapshot generation */
+    uint32              sectors;            /* sectors covered by the map */
+    uint32              slots;              /* data slots in the file (1..slots) */
+    uint32              slots_max;          /* slot entries allocated */
+    uint32              *present;           /* sector bitmap, 1 = in overlay */
+    uint32              *map;               /* sector -> newest slot */
+    uint32              *slot_gen;          /* slot -> generation that wrote it */
+    uint32              *slot_prev;         /* slot -> sector's previous slot, 0 = base */
+    };
+
+#define OVL_PRESENT(o, s)   (((s) < (o)->sectors) && ((o)->present[(s) >> 5] & (1u << ((s) & 0x1F))))
+#define OVL_SLOTPOS(ctx, n) (OVL_HDRSIZE + ((t_offset)(n) - 1)*(OVL_SLOTHDR + (ctx)->sector_size))
+
+static t_bool _sim_disk_ovl_rdhdr (FILE *f, uint32 *h, char *basename)
+{
+char magic[sizeof (OVL_MAGIC) - 1];
+
+if ((sim_fseeko (f, 0, SEEK_SET) != 0) ||
+    (fread (magic, 1, sizeof (magic), f) != sizeof (magic)) ||
+    (memcmp (magic, OVL_MAGIC, sizeof (magic)) != 0) ||
+    (sim_fread (h, sizeof (*h), OVL_H_WORDS, f) != OVL_H_WORDS))
+    return FALSE;
+if (basename) {
+    memset (basename, 0, OVL_HDRSIZE - OVL_BASEOFF);
+    if ((sim_fseeko (f, OVL_BASEOFF, SEEK_SET) != 0) ||
+        (fread (basename, 1, OVL_HDRSIZE - OVL_BASEOFF - 1, f) == 0))
+        return FALSE;
+    }
+return (h[OVL_H_SECSIZE] != 0);
+}
+
+static t_stat _sim_disk_ovl_wrhdr (FILE *f, const uint32 *h, const char *basename)
+{
+char hdr[OVL_HDRSIZE];
+
+memset (hdr, 0, sizeof (hdr));
+memcpy (hdr, OVL_MAGIC, sizeof (OVL_MAGIC) - 1);
+strncpy (hdr + OVL_BASEOFF, basename, OVL_HDRSIZE - OVL_BASEOFF - 1);
+if ((sim_fseeko (f, 0, SEEK_SET) != 0) ||
+    (fwrite (hdr, 1, sizeof (hdr), f) != sizeof (hdr)) ||
+    (sim_fseeko (f, sizeof (OVL_MAGIC) - 1, SEEK_SET) != 0) ||
+    (sim_fwrite (h, sizeof (*h), OVL_H_WORDS, f) != OVL_H_WORDS) ||
+    (fflush (f) != 0))
+    return SCPE_IOERR;
+return SCPE_OK;
+}
+
+/* Size of the disk an overlay stands for (attach size function) */
+
+static t_offset _sim_disk_ovl_size (FILE *f)
+{
+uint32 h[OVL_H_WORDS];
+
+if (!_sim_disk_ovl_rdhdr (f, h, NULL))
+    return (t_offset)-1;
+return ((t_offset)h[OVL_H_SECTORS])*h[OVL_H_SECSIZE];
+}
+
+/* Is cptr (or cptr without an @generation suffix) an overlay? */
+
+static t_bool _sim_disk_ovl_probe (const char *cptr, char *name, char *basename, int32 *gen)
+{
+FILE *f;
+uint32 h[OVL_H_WORDS];
+const char *at;
+size_t len;
+t_bool r;
+
+*gen = -1;
+len = strlen (cptr);
+if (len > CBUFSIZE - 1)
+    len = CBUFSIZE - 1;
+memcpy (name, cptr, len);
+name[len] = '\0';
+f = sim_fopen (name, "rb");
+if ((f == NULL) &&                                      /* name@generation? */
+    ((at = strrchr (name, '@')) != NULL) && (at[1] != '\0') &&
+    (strspn (at + 1, "0123456789") == strlen (at + 1))) {
+    *gen = (int32)atol (at + 1);
+    name[at - name] = '\0';
+    f = sim_fopen (name, "rb");
+    }
+if (f == NULL)
+    return FALSE;
+r = _sim_disk_ovl_rdhdr (f, h, basename);
+fclose (f);
+return r;
+}
+
+static t_stat _sim_disk_ovl_create (const char *ovlname, const char *basename, size_t sector_size)
+{
+FILE *f;
+uint32 h[OVL_H_WORDS];
+char obase[OVL_HDRSIZE - OVL_BASEOFF];
+t_offset size;
+t_stat r;
+
+if (strlen (basename) >= sizeof (obase))
+    return sim_messagef (SCPE_ARG, "Overlay base image name too long: %s\n", basename);
+f = sim_fopen (ovlname, "rb");
+if (f != NULL) {                                        /* reuse overlay of this base */
+    t_bool same = _sim_disk_ovl_rdhdr (f, h, obase) && (strcmp (obase, basename) == 0);
+
+    fclose (f);
+    if (same)
+        return SCPE_OK;
+    return sim_messagef (SCPE_ARG, "%s exists and is not an overlay of %s\n", ovlname, basename);
+    }
+f = sim_vhd_disk_open (basename, "rb");
+if (f != NULL) {
+    sim_vhd_disk_close (f);
+    return sim_messagef (SCPE_ARG, "Overlay base image must be in SIMH format: %s\n", basename);
+    }
+f = sim_fopen (basename, "rb");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open overlay base image: %s\n", basename);
+size = sim_fsize_ex (f);
+fclose (f);
+f = sim_fopen (ovlname, "wb+");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't create overlay: %s\n", ovlname);
+h[OVL_H_SECSIZE] = (uint32)sector_size;
+h[OVL_H_SECTORS] = (uint32)((size + sector_size - 1) / sector_size);
+h[OVL_H_GEN] = 1;                                       /* 0 is the base itself */
+h[OVL_H_SEALED] = 0;
+r = _sim_disk_ovl_wrhdr (f, h, basename);
+fclose (f);
+if (r != SCPE_OK)
+    (void)remove (ovlname);
+return r;
+}
+
+static t_stat _sim_disk_ovl_grow (struct disk_overlay *ovl, uint32 sectors, uint32 slots)
+{
+if (sectors > ovl->sectors) {
+    uint32 words = (sectors + 31) >> 5, owords = (ovl->sectors + 31) >> 5;
+    uint32 *present = (uint32 *)realloc (ovl->present, words*sizeof (*present));
+    uint32 *map;
+
+    if (present == NULL)
+        return SCPE_MEM;
+    memset (present + owords, 0, (words - owords)*sizeof (*present));
+    ovl->present = present;
+    map = (uint32 *)realloc (ovl->map, sectors*sizeof (*map));
+    if (map == NULL)
+        return SCPE_MEM;
+    ovl->map = map;
+    ovl->sectors = sectors;
+    }
+if (slots >= ovl->slots_max) {
+    uint32 max = ovl->slots_max ? ovl->slots_max : 1024;
+    uint32 *slot_gen, *slot_prev;
+
+    while (max <= slots)
+        max = max * 2;
+    slot_gen = (uint32 *)realloc (ovl->slot_gen, max*sizeof (*slot_gen));
+    if (slot_gen == NULL)
+        return SCPE_MEM;
+    ovl->slot_gen = slot_gen;
+    slot_prev = (uint32 *)realloc (ovl->slot_prev, max*sizeof (*slot_prev));
+    if (slot_prev == NULL)
+        return SCPE_MEM;
+    ovl->slot_prev = slot_prev;
+    ovl->slots_max = max;
+    }
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_ovl_update (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->ovl;
+uint32 h[OVL_H_WORDS];
+
+h[OVL_H_SECSIZE] = ctx->sector_size;
+h[OVL_H_SECTORS] = ovl->sectors;
+h[OVL_H_GEN] = ovl->gen;
+h[OVL_H_SEALED] = ovl->sealed;
+return _sim_disk_ovl_wrhdr (uptr->fileref, h, ovl->basename);
+}
+
+/* Return to snapshot generation gen, discarding everything written since */
+
+static t_stat _sim_disk_ovl_rollback (UNIT *uptr, uint32 gen)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->ovl;
+uint32 sec, n, slots = ovl->slots;
+
+for (sec = 0; sec < ovl->sectors; sec++) {
+    if (ovl->present[sec >> 5] == 0) {                  /* skip empty words */
+        sec |= 0x1F;
+        continue;
+        }
+    if (!OVL_PRESENT (ovl, sec))
+        continue;
+    for (n = ovl->map[sec]; (n != 0) && (ovl->slot_gen[n] > gen); n = ovl->slot_prev[n])
+        ;
+    ovl->map[sec] = n;
+    if (n == 0)                                         /* back to the base */
+        ovl->present[sec >> 5] &= ~(1u << (sec & 0x1F));
+    }
+while ((slots > 0) && (ovl->slot_gen[slots] > gen))     /* newer slots are at the end */
+    slots = slots - 1;
+sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_ovl_rollback(unit=%d) generation %u, %u of %u slots kept\n", (int)(uptr-ctx->dptr->units), gen, slots, ovl->slots);
+ovl->slots = slots;
+ovl->gen = gen + 1;
+ovl->sealed = gen;
+if (uptr->flags & UNIT_RO)                              /* in memory only */
+    return SCPE_OK;
+fflush (uptr->fileref);
+if (sim_set_fsize (uptr->fileref, (t_addr)OVL_SLOTPOS (ctx, slots + 1)) != 0)
+    return SCPE_IOERR;
+return _sim_disk_ovl_update (uptr);
+}
+
+/* Load the overlay open on uptr->fileref, optionally rolling back to a snapshot */
+
+static void _sim_disk_ovl_close (UNIT *uptr);
+
+static t_stat _sim_disk_ovl_open (UNIT *uptr, const char *basename, int32 gen)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl;
+uint32 h[OVL_H_WORDS], sh[OVL_SLOTHDR/sizeof (uint32)];
+uint32 n, slots, capsects;
+t_offset fsize;
+size_t len;
+t_stat r;
+
+if (!_sim_disk_ovl_rdhdr (uptr->fileref, h, NULL))
+    return SCPE_IOERR;
+if (h[OVL_H_SECSIZE] != ctx->sector_size)
+    return sim_messagef (SCPE_ARG, "%s: overlay %s has %u byte sectors, the drive %u\n", sim_uname (uptr), uptr->filename, h[OVL_H_SECSIZE], ctx->sector_size);
+if ((gen >= 0) && ((uint32)gen > h[OVL_H_SEALED]))
+    return sim_messagef (SCPE_ARG, "%s: generation %d of %s is not a snapshot, the newest is %u\n", sim_uname (uptr), (int)gen, uptr->filename, h[OVL_H_SEALED]);
+ctx->ovl = ovl = (struct disk_overlay *)calloc (1, sizeof (*ovl));
+if (ovl == NULL)
+    return SCPE_MEM;
+len = strlen (basename);
+if (len > sizeof (ovl->basename) - 1)
+    len = sizeof (ovl->basename) - 1;
+memcpy (ovl->basename, basename, len);
+ovl->basename[len] = '\0';
+ovl->gen = h[OVL_H_GEN];
+ovl->sealed = h[OVL_H_SEALED];
+ovl->base = sim_fopen (basename, "rb");
+if (ovl->base == NULL) {
+    _sim_disk_ovl_close (uptr);
+    return sim_messagef (SCPE_OPENERR, "%s: can't open overlay base image %s\n", sim_uname (uptr), basename);
+    }
+capsects = (uint32)((((t_offset)uptr->capac)*ctx->capac_factor*((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1))/ctx->sector_size);
+fsize = sim_fsize_ex (uptr->fileref);                   /* a partial last slot is ignored */
+slots = (fsize > OVL_HDRSIZE) ? (uint32)((fsize - OVL_HDRSIZE)/(OVL_SLOTHDR + ctx->sector_size)) : 0;
+r = _sim_disk_ovl_grow (ovl, (h[OVL_H_SECTORS] > capsects) ? h[OVL_H_SECTORS] : capsects, slots);
+for (n = 1; (r == SCPE_OK) && (n <= slots); n++) {      /* rebuild the map */
+    if ((sim_fseeko (uptr->fileref, OVL_SLOTPOS (ctx, n), SEEK_SET) != 0) ||
+        (sim_fread (sh, sizeof (*sh), OVL_SLOTHDR/sizeof (uint32), uptr->fileref) != OVL_SLOTHDR/sizeof (uint32))) {
+        r = SCPE_IOERR;
+        break;
+        }
+    if ((sh[0] >= ovl->sectors) &&
+        ((r = _sim_disk_ovl_grow (ovl, sh[0] + 1, slots)) != SCPE_OK))
+        break;
+    ovl->slot_gen[n] = sh[1];
+    ovl->slot_prev[n] = sh[2];
+    ovl->map[sh[0]] = n;
+    ovl->present[sh[0] >> 5] |= 1u << (sh[0] & 0x1F);
+    }
+ovl->slots = slots;
+if ((r == SCPE_OK) && (gen >= 0))
+    r = _sim_disk_ovl_rollback (uptr, (uint32)gen);
+if (r != SCPE_OK) {
+    _sim_disk_ovl_close (uptr);
+    return r;
+    }
+sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_ovl_open(unit=%d) base '%s', %u slots, generation %u\n", (int)(uptr-ctx->dptr->units), basename, ovl->slots, ovl->gen);
+return SCPE_OK;
+}
+
+static void _sim_disk_ovl_close (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->ovl;
+
+if (ovl == NULL)
+    return;
+if ((ovl->base != NULL) && !(uptr->flags & UNIT_RO))
+    _sim_disk_ovl_update (uptr);                        /* sectors covered */
+if (ovl->base != NULL)
+    fclose (ovl->base);
+free (ovl->present);
+free (ovl->map);
+free (ovl->slot_gen);
+free (ovl->slot_prev);
+free (ovl);
+ctx->ovl = NULL;
+}
+
+static void _sim_disk_ovl_show (FILE *st, UNIT *uptr)
+{
+struct disk_overlay *ovl = ((struct disk_context *)uptr->disk_ctx)->ovl;
+
+if (ovl != NULL)
+    fprintf (st, ", overlay on %s generation %u", ovl->basename, ovl->gen);
+}
+
+static t_stat _sim_disk_ovl_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->ovl;
+size_t ss = ctx->sector_size, xes = ctx->xfer_element_size, got;
+t_seccnt i, n;
+
+if (sectsread)
+    *sectsread = 0;
+for (i = 0; i < sects; i += n) {
+    n = 1;
+    if (OVL_PRESENT (ovl, lba + i)) {                   /* sector from its slot */
+        if ((sim_fseeko (uptr->fileref, OVL_SLOTPOS (ctx, ovl->map[lba + i]) + OVL_SLOTHDR, SEEK_SET) != 0) ||
+            (sim_fread (buf + i*ss, xes, ss/xes, uptr->fileref) != ss/xes))
+            return SCPE_IOERR;
+        continue;
+        }
+    while ((i + n < sects) && !OVL_PRESENT (ovl, lba + i + n))
+        n = n + 1;                                      /* run from the base */
+    got = 0;
+    if (sim_fseeko (ovl->base, ((t_offset)(lba + i))*ss, SEEK_SET) == 0)
+        got = sim_fread (buf + i*ss, xes, (n*ss)/xes, ovl->base);
+    if (ferror (ovl->base))
+        return SCPE_IOERR;
+    if (got < (n*ss)/xes)                               /* beyond the base: fill */
+        memset (buf + i*ss + got*xes, 0, n*ss - got*xes);
+    }
+if (sectsread)
+    *sectsread = sects;
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_ovl_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->ovl;
+size_t ss = ctx->sector_size, xes = ctx->xfer_element_size;
+uint32 sh[OVL_SLOTHDR/sizeof (uint32)];
+t_offset pos = -1, da;
+t_seccnt i;
+t_lba sec;
+uint32 n;
+t_stat r;
+
+if (sectswritten)
+    *sectswritten = 0;
+if (uptr->flags & UNIT_RO)
+    return SCPE_RO;
+for (i = 0; i < sects; i++) {
+    sec = lba + i;
+    if ((sec >= ovl->sectors) &&
+        ((r = _sim_disk_ovl_grow (ovl, sec + 1, 0)) != SCPE_OK))
+        return r;
+    n = OVL_PRESENT (ovl, sec) ? ovl->map[sec] : 0;
+    if ((n != 0) && (ovl->slot_gen[n] == ovl->gen)) {   /* rewrite in this generation */
+        da = OVL_SLOTPOS (ctx, n) + OVL_SLOTHDR;
+        if ((sim_fseeko (uptr->fileref, da, SEEK_SET) != 0) ||
+            (sim_fwrite (buf + i*ss, xes, ss/xes, uptr->fileref) != ss/xes))
+            return SCPE_IOERR;
+        pos = da + ss;
+        }
+    else {                                              /* append a slot */
+        if ((r = _sim_disk_ovl_grow (ovl, 0, ovl->slots + 1)) != SCPE_OK)
+            return r;
+        sh[0] = sec;
+        sh[1] = ovl->gen;
+        sh[2] = n;
+        sh[3] = 0;
+        n = ovl->slots + 1;
+        da = OVL_SLOTPOS (ctx, n);
+        if (((da != pos) &&                             /* appends run on */
+             (sim_fseeko (uptr->fileref, da, SEEK_SET) != 0)) ||
+            (sim_fwrite (sh, sizeof (*sh), OVL_SLOTHDR/sizeof (uint32), uptr->fileref) != OVL_SLOTHDR/sizeof (uint32)) ||
+            (sim_fwrite (buf + i*ss, xes, ss/xes, uptr->fileref) != ss/xes))
+            return SCPE_IOERR;
+        pos = da + OVL_SLOTHDR + ss;
+        ovl->slots = n;
+        ovl->slot_gen[n] = ovl->gen;
+        ovl->slot_prev[n] = sh[2];
+        ovl->map[sec] = n;
+        ovl->present[sec >> 5] |= 1u << (sec & 0x1F);
+        }
+    if (sectswritten)
+        *sectswritten = i + 1;
+    }
+return SCPE_OK;
+}
+
 /* Read Sectors */
 
 static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
@@ -545,6 +1590,16 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
+if (ctx->ovl)
+    return _sim_disk_ovl_rdsect (uptr, lba, buf, sectsread, sects);
+if (ctx->map)
+    return _sim_disk_map_rdsect (uptr, lba, buf, sectsread, sects);
+
+#if defined (SIM_ASYNCH_IO) && defined (HAVE_IO_URING)
+if (ctx->uring)
+    return _disk_uring_sync (uptr, DOP_RSEC, lba, buf, sectsread, sects);
+#endif
+
 da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
 if (sectsread)
@@ -661,6 +1716,16 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
+if (ctx->ovl)
+    return _sim_disk_ovl_wrsect (uptr, lba, buf, sectswritten, sects);
+if (ctx->map)
+    return _sim_disk_map_wrsect (uptr, lba, buf, sectswritten, sects);
+
+#if defined (SIM_ASYNCH_IO) && defined (HAVE_IO_URING)
+if (ctx->uring)
+    return _disk_uring_sync (uptr, DOP_WSEC, lba, buf, sectswritten, sects);
+#endif
+
 da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
 if (sectswritten)
@@ -845,16 +1910,17 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
 static void _sim_disk_io_flush (UNIT *uptr)
 {
 uint32 f = DK_GET_FMT (uptr);
-
-#if defined (SIM_ASYNCH_IO)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
+#if defined (SIM_ASYNCH_IO)
 sim_disk_clr_async (uptr);
 if (sim_asynch_enabled)
     sim_disk_set_async (uptr, ctx->asynch_io_latency);
 #endif
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
+        if (ctx->map)
+            _sim_disk_map_sync (ctx, TRUE);
         fflush (uptr->fileref);
         break;
     case DKUF_F_VHD:                                    /* Virtual Disk */
@@ -866,6 +1932,40 @@ switch (f) {                                            /* case on format */
         }
 }
 
+/*
+   Called by SAVE for each attached unit.  For a unit with a writable
+   overlay the current generation is sealed and the name to record,
+   overlay@generation, is returned; otherwise NULL.
+*/
+const char *sim_disk_snapshot (UNIT *uptr)
+{
+static char name[CBUFSIZE + 16];
+struct disk_context *ctx;
+struct disk_overlay *ovl;
+uint32 sealed;
+
+if (!(uptr->flags & UNIT_ATT) ||                        /* not an attached */
+    (uptr->io_flush != _sim_disk_io_flush))             /* disk unit? */
+    return NULL;
+ctx = (struct disk_context *)uptr->disk_ctx;
+ovl = ctx->ovl;
+if ((ovl == NULL) || (uptr->flags & UNIT_RO))
+    return NULL;
+sealed = ovl->sealed;
+ovl->sealed = ovl->gen;
+ovl->gen = ovl->gen + 1;
+fflush (uptr->fileref);
+if (_sim_disk_ovl_update (uptr) != SCPE_OK) {
+    ovl->gen = ovl->sealed;
+    ovl->sealed = sealed;
+    sim_printf ("%s: can't snapshot overlay %s, saving it as is\n", sim_uname (uptr), uptr->filename);
+    return NULL;
+    }
+sim_debug (ctx->dbit, ctx->dptr, "sim_disk_snapshot(unit=%d) generation %u\n", (int)(uptr-ctx->dptr->units), ovl->sealed);
+sprintf (name, "%s@%u", uptr->filename, ovl->sealed);
+return name;
+}
+
 static t_stat _err_return (UNIT *uptr, t_stat stat)
 {
 free (uptr->filename);
@@ -1334,6 +2434,9 @@ t_offset (*size_function)(FILE *file);
 t_stat (*storage_function)(FILE *file, uint32 *sector_size, uint32 *removable, uint32 *is_cdrom) = NULL;
 t_bool created = FALSE, copied = FALSE;
 t_bool auto_format = FALSE;
+t_bool map_image = (sim_switches & SWMASK ('P')) != 0;
+char ovl_name[CBUFSIZE], ovl_base[OVL_HDRSIZE - OVL_BASEOFF] = "";
+int32 ovl_gen = -1;
 t_offset capac, filesystem_capac;
 
 if (uptr->flags & UNIT_DIS)                             /* disabled? */
@@ -1367,6 +2470,21 @@ if (sim_switches & SWMASK ('D')) {                      /* create difference dis
         }
     return sim_messagef (SCPE_ARG, "Unable to create differencing VHD: %s\n", gbuf);
     }
+if (sim_switches & SWMASK ('W')) {                      /* overlay on a base image? */
+    char gbuf[CBUFSIZE];
+    t_stat r;
+
+    sim_switches = sim_switches & ~(SWMASK ('W'));
+    cptr = get_glyph_nc (cptr, gbuf, 0);                /* get overlay */
+    if (*cptr == 0)                                     /* must be more */
+        return SCPE_2FARG;
+    if (DK_GET_FMT (uptr) != DKUF_F_STD)
+        return sim_messagef (SCPE_ARG, "Overlays are only supported in SIMH format\n");
+    r = _sim_disk_ovl_create (gbuf, cptr, sector_size);
+    if (r != SCPE_OK)
+        return r;
+    return sim_disk_attach (uptr, gbuf, sector_size, xfer_element_size, dontautosize, dbit, dtype, pdp11tracksize, completion_delay);
+    }
 if (sim_switches & SWMASK ('C')) {                      /* create vhd disk & copy contents? */
     char gbuf[CBUFSIZE];
     FILE *vhd;
@@ -1517,6 +2635,12 @@ else
 
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
+        if (_sim_disk_ovl_probe (cptr, ovl_name, ovl_base, &ovl_gen)) {
+            cptr = ovl_name;                            /* overlay{@generation} */
+            open_function = sim_fopen;
+            size_function = _sim_disk_ovl_size;
+            break;
+            }
         if (NULL == (uptr->fileref = sim_vhd_disk_open (cptr, "rb"))) {
             if (errno == EBADF)                        /* VHD but broken */
                 return SCPE_OPENERR;
@@ -1610,6 +2734,15 @@ uptr->pos = 0;
 if (storage_function)
     storage_function (uptr->fileref, &ctx->storage_sector_size, &ctx->removable, &ctx->is_cdrom);
 
+if (ovl_base[0]) {                                      /* overlay attached? */
+    t_stat r = _sim_disk_ovl_open (uptr, ovl_base, ovl_gen);
+
+    if (r != SCPE_OK) {
+        sim_disk_detach (uptr);
+        return r;
+        }
+    }
+
 if ((created) && (!copied)) {
     t_stat r = SCPE_OK;
     uint8 *secbuf = (uint8 *)calloc (128, ctx->sector_size);     /* alloc temp sector buf */
@@ -1769,6 +2902,15 @@ if (capac && (capac != (t_offset)-1)) {
         }
     }
 
+if (map_image) {                                        /* map SIMH image? */
+    t_stat r = _sim_disk_map (uptr);
+
+    if (r != SCPE_OK) {
+        sim_disk_detach (uptr);
+        return r;
+        }
+    }
+
 #if defined (SIM_ASYNCH_IO)
 sim_disk_set_async (uptr, completion_delay);
 #endif
@@ -1817,6 +2959,11 @@ if (uptr->io_flush)
     uptr->io_flush (uptr);                              /* flush buffered data */
 
 sim_disk_clr_async (uptr);
+#if defined (SIM_ASYNCH_IO)
+free (ctx->uring);                                      /* undelivered completions */
+#endif
+_sim_disk_unmap (ctx);
+_sim_disk_ovl_close (uptr);
 
 uptr->flags &= ~(UNIT_ATT | UNIT_RO);
 uptr->dynflags &= ~(UNIT_NO_FIO | UNIT_DISK_CHK);
@@ -1891,6 +3038,16 @@ fprintf (st, "                expanding one).\n");
 fprintf (st, "    -D          Create a Differencing VHD (relative to an already existing VHD\n");
 fprintf (st, "                disk)\n");
 fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk\n");
+fprintf (st, "    -P          Map a SIMH format disk into memory and transfer data by copying\n");
+fprintf (st, "                to and from the mapping.  The file is extended to the drive's\n");
+fprintf (st, "                full size.  Changes are written back at least every second and\n");
+fprintf (st, "                whenever the simulator stops.\n");
+fprintf (st, "    -W          Attach a copy-on-write overlay to a SIMH format base image:\n");
+fprintf (st, "                ATTACH -W %s overlay base.  The base is only read, writes go\n", dptr->name);
+fprintf (st, "                to the overlay, which remembers its base and may afterwards\n");
+fprintf (st, "                be attached by itself.  SAVE snapshots the overlay instead\n");
+fprintf (st, "                of copying it, and RESTORE returns it to the saved state,\n");
+fprintf (st, "                discarding later writes and later snapshots.\n");
 fprintf (st, "    -O          Override consistency checks when attaching differencing disks\n");
 fprintf (st, "                which have unexpected parent disk GUID or timestamps\n\n");
 fprintf (st, "    -U          Fix inconsistencies which are overridden by the -O switch\n");
@@ -89,10 +89,12 @@ t_stat sim_disk_clearerr (UNIT *uptr);
 t_bool sim_disk_isavailable (UNIT *uptr);
 t_bool sim_disk_isavailable_a (UNIT *uptr, DISK_PCALLBACK callback);
 t_bool sim_disk_wrp (UNIT *uptr);
+uint32 sim_disk_queue_depth (UNIT *uptr);
 t_stat sim_disk_pdp11_bad_block (UNIT *uptr, int32 sec, int32 wds);
 t_offset sim_disk_size (UNIT *uptr);
 t_bool sim_disk_vhd_support (void);
 t_bool sim_disk_raw_support (void);
+const char *sim_disk_snapshot (UNIT *uptr);
 void sim_disk_data_trace (UNIT *uptr, const uint8 *data, size_t lba, size_t len, const char* txt, int detail, uint32 reason);
 
 #ifdef  __cplusplus
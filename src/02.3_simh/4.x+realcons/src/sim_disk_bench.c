@@ -0,0 +1,386 @@
+/* sim_disk_bench.c: disk transfer benchmark and consistency test
+
+   Copyright (c) 2026, BlinkenBone contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   One disk unit of 512 byte sectors, driven through
+   sim_disk_rdsect_a/sim_disk_wrsect_a like a controller would.
+   Build with  make -f quickmake sim_disk_bench,  add USE_ASYNCH_IO=1 for
+   the I/O thread backend, or io_uring where the kernel headers have it.
+
+   Commands, for example
+        printf "attach db0 /tmp/db.dsk\ndverify\ndbench\nexit\n" | ./sim_disk_bench
+
+   DVERIFY {requests {depth {OVERLAP}}}
+                        random reads and writes of 1-64 sectors, up to
+                        <depth> in flight (default 1000 requests, depth 1),
+                        data checked against a copy held in memory, which is
+                        compared with the image again at the end.  With
+                        OVERLAP, requests in flight may overlap, and must
+                        still take effect in issue order.
+   DBENCH {requests {sectors {depth}}}
+                        sequential reads, random reads and random writes of
+                        <sectors> sectors (default 4000 requests of 16),
+                        prints throughput and mean latency per request.
+   DSUM                 prints a checksum of the unit's contents, e.g. to
+                        compare an overlay before SAVE and after RESTORE.
+
+   Depth > 1 needs the io_uring backend; the I/O thread backend takes one
+   request per unit at a time.  ATTACH -P DB0 <file> runs the same tests
+   on a memory mapped image, and ATTACH -W DB0 <overlay> <file> on a
+   copy-on-write overlay.
+*/
+
+#include "sim_defs.h"
+#include "sim_disk.h"
+#include "sim_timer.h"
+#include <time.h>
+
+#define DB_SECT         512                             /* bytes per sector */
+#define DB_NSECT        32768                           /* sectors, 16MB */
+#define DB_MAXXFER      64                              /* max sectors per request */
+#define DB_MAXDEPTH     16                              /* max requests in flight */
+
+typedef struct {
+    t_lba               lba;
+    t_seccnt            sects;
+    t_seccnt            done;                           /* sectors transferred */
+    int                 write;
+    double              start;                          /* issue time, usec */
+    uint8               buf[DB_MAXXFER * DB_SECT];
+    } DBREQ;
+
+t_stat db_svc (UNIT *uptr);
+t_stat db_attach (UNIT *uptr, CONST char *cptr);
+t_stat db_detach (UNIT *uptr);
+t_stat db_verify_cmd (int32 flag, CONST char *cptr);
+t_stat db_bench_cmd (int32 flag, CONST char *cptr);
+t_stat db_sum_cmd (int32 flag, CONST char *cptr);
+
+static UNIT db_unit = { UDATA (&db_svc, UNIT_FIX|UNIT_ATTABLE|UNIT_DISABLE|UNIT_ROABLE, DB_NSECT * (DB_SECT / 2)) };
+static DBREQ db_req[DB_MAXDEPTH];                       /* in flight, oldest first */
+static uint32 db_rhead, db_rcount;
+static uint32 db_completed;
+static t_stat db_status;
+static double db_latency;                               /* sum, usec */
+static uint8 *db_copy = NULL;                           /* expected image contents */
+static uint32 db_errors;
+
+DEVICE db_dev = {
+    "DB", &db_unit, NULL, NULL,
+    1, 10, 31, 1, 16, 16,
+    NULL, NULL, NULL, NULL, &db_attach, &db_detach,
+    NULL, DEV_DISK
+    };
+
+/* Simulator interface */
+
+char sim_name[64] = "Disk bench";
+REG *sim_PC = NULL;
+int32 sim_emax = 1;
+DEVICE *sim_devices[] = { &db_dev, NULL };
+const char *sim_stop_messages[SCPE_BASE] = { "Unknown error" };
+
+static CTAB db_cmd[] = {
+    { "DVERIFY", &db_verify_cmd, 0, "dverify {requests {depth {OVERLAP}}} check transfers against memory copy\n" },
+    { "DBENCH",  &db_bench_cmd,  0, "dbench {requests {sectors {depth}}}  disk transfer timing\n" },
+    { "DSUM",    &db_sum_cmd,    0, "dsum                                 checksum of the unit's contents\n" },
+    { NULL }
+    };
+
+static void db_init (void)
+{
+sim_vm_cmd = db_cmd;
+}
+
+void (*sim_vm_init) (void) = &db_init;
+
+t_stat sim_instr (void)
+{
+return SCPE_NOFNC;
+}
+
+t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+{
+return SCPE_NOFNC;
+}
+
+t_stat fprint_sym (FILE *of, t_addr addr, t_value *val, UNIT *uptr, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat parse_sym (CONST char *cptr, t_addr addr, UNIT *uptr, t_value *val, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat db_svc (UNIT *uptr)
+{
+return SCPE_OK;
+}
+
+t_stat db_attach (UNIT *uptr, CONST char *cptr)
+{
+return sim_disk_attach (uptr, cptr, DB_SECT, sizeof (uint16), TRUE, 0, "DB", 0, 0);
+}
+
+t_stat db_detach (UNIT *uptr)
+{
+return sim_disk_detach (uptr);
+}
+
+static double db_usec (void)
+{
+struct timespec ts;
+
+clock_gettime (CLOCK_MONOTONIC, &ts);
+return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static uint32 db_random (uint32 *seed)
+{
+uint32 x = *seed;
+
+x ^= x << 13;
+x ^= x >> 17;
+x ^= x << 5;
+return *seed = x;
+}
+
+static int32 db_arg (CONST char **cptr, int32 dflt, int32 max, t_stat *r)
+{
+char gbuf[CBUFSIZE];
+int32 val;
+
+*cptr = get_glyph (*cptr, gbuf, 0);
+if (gbuf[0] == 0)
+    return dflt;
+val = (int32) get_uint (gbuf, 10, max, r);
+if ((*r == SCPE_OK) && (val == 0))
+    *r = SCPE_ARG;
+return val;
+}
+
+/* Completion: callbacks arrive in issue order, so it is always the oldest */
+
+static void db_callback (UNIT *uptr, t_stat status)
+{
+DBREQ *rq = &db_req[db_rhead];
+
+db_latency = db_latency + (db_usec () - rq->start);
+if (status != SCPE_OK)
+    db_status = status;
+if (db_copy) {
+    if (rq->write)
+        memcpy (&db_copy[rq->lba * DB_SECT], rq->buf, rq->sects * DB_SECT);
+    else if ((rq->done != rq->sects) ||
+             memcmp (&db_copy[rq->lba * DB_SECT], rq->buf, rq->sects * DB_SECT)) {
+        if (db_errors++ < 10)
+            sim_printf ("read of %d sectors at %d differs (%d transferred)\n", rq->sects, rq->lba, rq->done);
+        }
+    }
+db_rhead = (db_rhead + 1) % DB_MAXDEPTH;
+--db_rcount;
+++db_completed;
+}
+
+static void db_issue (t_lba lba, t_seccnt sects, int write, uint32 *seed)
+{
+DBREQ *rq = &db_req[(db_rhead + db_rcount) % DB_MAXDEPTH];
+uint32 i;
+
+++db_rcount;
+rq->lba = lba;
+rq->sects = sects;
+rq->done = 0;
+rq->write = write;
+if (write) {
+    for (i = 0; i < sects * DB_SECT; i += 4) {
+        uint32 x = db_random (seed);
+
+        memcpy (&rq->buf[i], &x, sizeof (x));
+        }
+    }
+rq->start = db_usec ();
+if (write)
+    sim_disk_wrsect_a (&db_unit, lba, rq->buf, &rq->done, sects, &db_callback);
+else
+    sim_disk_rdsect_a (&db_unit, lba, rq->buf, &rq->done, sects, &db_callback);
+}
+
+/* Wait for completions until at most <depth> - 1 requests are in flight */
+
+static void db_wait (uint32 depth)
+{
+while (db_rcount >= depth) {
+    AIO_UPDATE_QUEUE;
+    }
+}
+
+/* True if the range overlaps a request in flight */
+
+static t_bool db_busy (t_lba lba, t_seccnt sects)
+{
+uint32 i;
+
+for (i = 0; i < db_rcount; i++) {
+    DBREQ *rq = &db_req[(db_rhead + i) % DB_MAXDEPTH];
+
+    if ((lba < rq->lba + rq->sects) && (rq->lba < lba + sects))
+        return TRUE;
+    }
+return FALSE;
+}
+
+static void db_reset (void)
+{
+db_rhead = db_rcount = db_completed = db_errors = 0;
+db_status = SCPE_OK;
+db_latency = 0.0;
+}
+
+t_stat db_verify_cmd (int32 flag, CONST char *cptr)
+{
+int32 requests, depth, n;
+uint32 seed = 4711, bad = 0;
+t_lba lba;
+t_seccnt sects, done;
+uint8 *buf;
+t_bool overlap = FALSE;
+char gbuf[CBUFSIZE];
+t_stat r = SCPE_OK;
+
+requests = db_arg (&cptr, 1000, 0x7FFFFFFF, &r);
+if (r == SCPE_OK)
+    depth = db_arg (&cptr, 1, DB_MAXDEPTH, &r);
+if (r != SCPE_OK)
+    return r;
+cptr = get_glyph (cptr, gbuf, 0);
+if (gbuf[0]) {
+    if (strcmp (gbuf, "OVERLAP"))
+        return SCPE_ARG;
+    overlap = TRUE;
+    }
+if (!(db_unit.flags & UNIT_ATT))
+    return SCPE_UNATT;
+db_copy = (uint8 *)calloc (DB_NSECT, DB_SECT);
+buf = (uint8 *)malloc (DB_SECT);
+if ((db_copy == NULL) || (buf == NULL)) {
+    free (db_copy);
+    free (buf);
+    db_copy = NULL;
+    return SCPE_MEM;
+    }
+db_reset ();
+for (lba = 0; lba < DB_NSECT; lba++) {                  /* current contents */
+    sim_disk_rdsect (&db_unit, lba, &db_copy[lba * DB_SECT], NULL, 1);
+    }
+for (n = 0; n < requests; n++) {
+    do {
+        sects = 1 + db_random (&seed) % DB_MAXXFER;
+        lba = db_random (&seed) % (DB_NSECT - sects);
+        } while (!overlap && db_busy (lba, sects));
+    db_issue (lba, sects, db_random (&seed) & 1, &seed);
+    db_wait (depth);
+    }
+db_wait (1);
+for (lba = 0; lba < DB_NSECT; lba++) {                  /* image matches? */
+    sim_disk_rdsect (&db_unit, lba, buf, &done, 1);
+    if (memcmp (buf, &db_copy[lba * DB_SECT], DB_SECT) && (bad++ < 10))
+        sim_printf ("sector %d differs from the last write\n", lba);
+    }
+free (db_copy);
+free (buf);
+db_copy = NULL;
+if (db_status != SCPE_OK)
+    return db_status;
+if (db_errors || bad)
+    return sim_messagef (SCPE_IERR, "%d bad reads, %d bad sectors\n", db_errors, bad);
+sim_printf ("%d requests, depth %d%s: all data as written\n", requests, depth, overlap ? ", overlapping" : "");
+return SCPE_OK;
+}
+
+static void db_bench (const char *what, int32 requests, t_seccnt sects, int32 depth, int pattern)
+{
+uint32 seed = 815;
+int32 n;
+double start, usec;
+t_lba lba = 0;
+
+db_reset ();
+start = db_usec ();
+for (n = 0; n < requests; n++) {
+    if (pattern == 0) {                                 /* sequential */
+        if (lba + sects > DB_NSECT)
+            lba = 0;
+        }
+    else lba = db_random (&seed) % (DB_NSECT - sects);
+    db_issue (lba, sects, pattern == 2, &seed);
+    lba = lba + sects;
+    db_wait (depth);
+    }
+db_wait (1);
+usec = db_usec () - start;
+sim_printf ("%-16s %6d x %2d sectors: %8.1f ms %8.1f MB/s %8.1f usec/request\n", what,
+            requests, sects, usec / 1000.0, (requests * sects * (double) DB_SECT) / usec,
+            db_latency / requests);
+}
+
+t_stat db_bench_cmd (int32 flag, CONST char *cptr)
+{
+int32 requests, sects, depth;
+t_stat r = SCPE_OK;
+
+requests = db_arg (&cptr, 4000, 0x7FFFFFFF, &r);
+if (r == SCPE_OK)
+    sects = db_arg (&cptr, 16, DB_MAXXFER, &r);
+if (r == SCPE_OK)
+    depth = db_arg (&cptr, 1, DB_MAXDEPTH, &r);
+if (r != SCPE_OK)
+    return r;
+if (!(db_unit.flags & UNIT_ATT))
+    return SCPE_UNATT;
+db_bench ("sequential read", requests, sects, depth, 0);
+db_bench ("random read", requests, sects, depth, 1);
+db_bench ("random write", requests, sects, depth, 2);
+return db_status;
+}
+
+t_stat db_sum_cmd (int32 flag, CONST char *cptr)
+{
+uint8 buf[DB_MAXXFER * DB_SECT];
+uint32 sum = 2166136261u;                               /* FNV-1a */
+t_lba lba;
+size_t i;
+t_stat r;
+
+if (!(db_unit.flags & UNIT_ATT))
+    return SCPE_UNATT;
+for (lba = 0; lba < DB_NSECT; lba += DB_MAXXFER) {
+    r = sim_disk_rdsect (&db_unit, lba, buf, NULL, DB_MAXXFER);
+    if (r != SCPE_OK)
+        return r;
+    for (i = 0; i < sizeof (buf); i++)
+        sum = (sum ^ buf[i]) * 16777619u;
+    }
+sim_printf ("checksum %08X\n", sum);
+return SCPE_OK;
+}
@@ -0,0 +1,470 @@
+/* sim_queue_bench.c: event queue benchmark and ordering test
+
+   Copyright (c) 2026, BlinkenBone contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   One device of synthetic units on the scp event queue, no machine.
+   Build with  make -f quickmake sim_queue_bench
+
+   Commands, for example  printf "qverify\nqbench\nexit\n" | ./sim_queue_bench
+
+   QVERIFY {steps}      drives the scp event queue and a copy of the former
+                        linear delta list (ref_xxx below) with the same
+                        pseudo random activate/cancel traffic, lets both count
+                        down the same instructions and compares the order and
+                        time of every event, sim_interval, sim_activate_time
+                        and sim_qcount.  Default 2000000 instructions.
+   QBENCH {units {events}}
+                        activates and cancels <units> units (default 10000)
+                        in random order, then processes <events> self
+                        rescheduling events (default 200000), on the scp
+                        queue and on the linear list.
+*/
+
+#include "sim_defs.h"
+#include "sim_timer.h"
+
+#define QB_MAXUNITS     10000
+#define QB_SIM          0                               /* scp event queue */
+#define QB_REF          1                               /* reference list */
+
+#define REF_END         -1
+#define REF_IDLE        -2
+
+typedef struct {
+    int32               next;                           /* REF_IDLE if not queued */
+    int32               time;                           /* delta to predecessor */
+    } REFQ;
+
+t_stat qb_svc (UNIT *uptr);
+t_stat qb_verify_cmd (int32 flag, CONST char *cptr);
+t_stat qb_bench_cmd (int32 flag, CONST char *cptr);
+
+static UNIT qb_unit[QB_MAXUNITS];
+static REFQ ref_q[QB_MAXUNITS];
+static int32 ref_head = REF_END;
+static int32 ref_interval, ref_noqueue;
+static double ref_gtime;
+
+static int32 qb_nunits;                                 /* units in use */
+static t_bool qb_benchmode;
+static uint32 qb_seed[2];                               /* bench reschedule streams */
+static uint32 qb_fires[2][QB_MAXUNITS];
+static int32 qb_log_id[2][QB_MAXUNITS];                 /* events of one step */
+static double qb_log_time[2][QB_MAXUNITS];
+static int32 qb_log_cnt[2];
+static t_bool qb_overflow;
+
+DEVICE qb_dev = {
+    "QB", qb_unit, NULL, NULL,
+    QB_MAXUNITS, 8, 16, 1, 8, 16,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, 0
+    };
+
+/* Simulator interface */
+
+char sim_name[64] = "Event queue bench";
+REG *sim_PC = NULL;
+int32 sim_emax = 1;
+DEVICE *sim_devices[] = { &qb_dev, NULL };
+const char *sim_stop_messages[SCPE_BASE] = { "Unknown error" };
+
+static CTAB qb_cmd[] = {
+    { "QVERIFY", &qb_verify_cmd, 0, "qverify {steps}          compare event queue with linear list\n" },
+    { "QBENCH",  &qb_bench_cmd,  0, "qbench {units {events}}  event queue timing\n" },
+    { NULL }
+    };
+
+static void qb_init (void)
+{
+sim_vm_cmd = qb_cmd;
+}
+
+void (*sim_vm_init) (void) = &qb_init;
+
+t_stat sim_instr (void)
+{
+return SCPE_NOFNC;
+}
+
+t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+{
+return SCPE_NOFNC;
+}
+
+t_stat fprint_sym (FILE *of, t_addr addr, t_value *val, UNIT *uptr, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat parse_sym (CONST char *cptr, t_addr addr, UNIT *uptr, t_value *val, int32 sw)
+{
+return SCPE_ARG;
+}
+
+/* Reference: the linear delta list scp.c used before the heap */
+
+static void ref_update (void)
+{
+int32 x = (ref_head == REF_END) ? ref_noqueue : ref_q[ref_head].time;
+
+ref_gtime = ref_gtime + (x - ref_interval);
+if (ref_head == REF_END)
+    ref_noqueue = ref_interval;
+else
+    ref_q[ref_head].time = ref_interval;
+}
+
+static void ref_activate (int32 id, int32 event_time)
+{
+int32 c, prv, accum;
+
+if (ref_q[id].next != REF_IDLE)                         /* already active? */
+    return;
+ref_update ();
+prv = REF_END;
+accum = 0;
+for (c = ref_head; c != REF_END; c = ref_q[c].next) {
+    if (event_time < (accum + ref_q[c].time))
+        break;
+    accum = accum + ref_q[c].time;
+    prv = c;
+    }
+if (prv == REF_END) {
+    c = ref_q[id].next = ref_head;
+    ref_head = id;
+    }
+else {
+    c = ref_q[id].next = ref_q[prv].next;
+    ref_q[prv].next = id;
+    }
+ref_q[id].time = event_time - accum;
+if (c != REF_END)
+    ref_q[c].time = ref_q[c].time - ref_q[id].time;
+ref_interval = ref_q[ref_head].time;
+}
+
+static void ref_cancel (int32 id)
+{
+int32 c, n;
+
+if (ref_head == REF_END)
+    return;
+ref_update ();
+if (ref_q[id].next == REF_IDLE)
+    return;
+if (ref_head == id)
+    n = ref_head = ref_q[id].next;
+else {
+    for (c = ref_head; ref_q[c].next != id; c = ref_q[c].next)
+        ;
+    n = ref_q[c].next = ref_q[id].next;
+    }
+ref_q[id].next = REF_IDLE;
+if (n != REF_END)
+    ref_q[n].time += ref_q[id].time;
+ref_q[id].time = 0;
+if (ref_head != REF_END)
+    ref_interval = ref_q[ref_head].time;
+else ref_interval = ref_noqueue = NOQUEUE_WAIT;
+}
+
+static int32 ref_activate_time (int32 id)
+{
+int32 c, accum = 0;
+
+for (c = ref_head; c != REF_END; c = ref_q[c].next) {
+    if (c == ref_head) {
+        if (ref_interval > 0)
+            accum = accum + ref_interval;
+        }
+    else
+        accum = accum + ref_q[c].time;
+    if (c == id)
+        return accum + 1;
+    }
+return 0;
+}
+
+static int32 ref_qcount (void)
+{
+int32 c, cnt = 0;
+
+for (c = ref_head; c != REF_END; c = ref_q[c].next)
+    cnt++;
+return cnt;
+}
+
+static void qb_action (int32 side, int32 id);
+
+static void ref_process_event (void)
+{
+int32 id;
+
+ref_update ();
+if (ref_head == REF_END) {
+    ref_interval = ref_noqueue = NOQUEUE_WAIT;
+    return;
+    }
+do {
+    id = ref_head;
+    ref_head = ref_q[id].next;
+    ref_q[id].next = REF_IDLE;
+    ref_q[id].time = 0;
+    if (ref_head != REF_END)
+        ref_interval = ref_q[ref_head].time;
+    else
+        ref_interval = ref_noqueue = NOQUEUE_WAIT;
+    qb_action (QB_REF, id);
+    } while ((ref_interval <= 0) && (ref_head != REF_END));
+if (ref_head == REF_END)
+    ref_interval = ref_noqueue = NOQUEUE_WAIT;
+}
+
+/* The same operations on both queues */
+
+static void qb_activate (int32 side, int32 id, int32 delay)
+{
+if (side == QB_SIM)
+    sim_activate (&qb_unit[id], delay);
+else
+    ref_activate (id, delay);
+}
+
+static void qb_cancel (int32 side, int32 id)
+{
+if (side == QB_SIM)
+    sim_cancel (&qb_unit[id]);
+else
+    ref_cancel (id);
+}
+
+static uint32 qb_random (uint32 *seed)
+{
+uint32 x = *seed;
+
+x ^= x << 13;
+x ^= x >> 17;
+x ^= x << 5;
+return *seed = x;
+}
+
+static uint32 qb_hash (uint32 x)
+{
+x = (x ^ 61) ^ (x >> 16);
+x = x + (x << 3);
+x = x ^ (x >> 4);
+x = x * 0x27d4eb2d;
+return x ^ (x >> 15);
+}
+
+/* Event action.  What a unit does next depends only on its id and how often
+   it fired, so both queues see the same traffic as long as they agree. */
+
+static void qb_action (int32 side, int32 id)
+{
+uint32 r;
+
+if (qb_benchmode) {
+    qb_activate (side, id, 1 + qb_random (&qb_seed[side]) % (4 * qb_nunits));
+    return;
+    }
+r = qb_hash ((id << 16) ^ qb_fires[side][id]++);
+if (qb_log_cnt[side] < QB_MAXUNITS) {
+    qb_log_id[side][qb_log_cnt[side]] = id;
+    qb_log_time[side][qb_log_cnt[side]++] = (side == QB_SIM) ? sim_gtime () : ref_gtime;
+    }
+else
+    qb_overflow = TRUE;
+if (r & 7)                                              /* 7/8 reschedule */
+    qb_activate (side, id, (r >> 3) % 200);
+if (((r >> 12) & 3) == 0)
+    qb_cancel (side, (r >> 16) % qb_nunits);
+if (((r >> 14) & 3) == 0)
+    qb_activate (side, (r >> 18) % qb_nunits, (r >> 24) % 50);
+}
+
+t_stat qb_svc (UNIT *uptr)
+{
+qb_action (QB_SIM, (int32)(uptr - qb_unit));
+return SCPE_OK;
+}
+
+static void qb_reset (int32 nunits)
+{
+int32 i;
+
+for (i = 0; i < QB_MAXUNITS; i++) {
+    sim_cancel (&qb_unit[i]);
+    qb_unit[i].action = &qb_svc;
+    ref_q[i].next = REF_IDLE;
+    ref_q[i].time = 0;
+    qb_fires[QB_SIM][i] = qb_fires[QB_REF][i] = 0;
+    }
+ref_head = REF_END;
+ref_gtime = sim_gtime ();                               /* also syncs sim_interval */
+ref_interval = ref_noqueue = sim_interval;
+qb_nunits = nunits;
+qb_log_cnt[QB_SIM] = qb_log_cnt[QB_REF] = 0;
+qb_overflow = FALSE;
+}
+
+static int32 qb_arg (CONST char **cptr, int32 dflt, int32 max, t_stat *r)
+{
+char gbuf[CBUFSIZE];
+int32 val;
+
+*cptr = get_glyph (*cptr, gbuf, 0);
+if (gbuf[0] == 0)
+    return dflt;
+val = (int32) get_uint (gbuf, 10, max, r);
+if ((*r == SCPE_OK) && (val == 0))
+    *r = SCPE_ARG;
+return val;
+}
+
+t_stat qb_verify_cmd (int32 flag, CONST char *cptr)
+{
+int32 steps, step, i, id, d, events = 0, checks = 0;
+uint32 seed = 4711;
+double t0;
+t_stat r = SCPE_OK;
+
+steps = qb_arg (&cptr, 2000000, 0x7FFFFFFF, &r);
+if (r != SCPE_OK)
+    return r;
+qb_benchmode = FALSE;
+qb_reset (64);
+t0 = sim_gtime ();
+for (step = 0; step < steps; step++) {
+    uint32 x = qb_random (&seed);
+
+    if ((x & 0xF) == 0) {                               /* external activate */
+        id = (x >> 4) % qb_nunits;
+        d = (x >> 12) % 300;
+        qb_activate (QB_SIM, id, d);
+        qb_activate (QB_REF, id, d);
+        }
+    if ((x & 0x3F0) == 0) {                             /* external cancel */
+        id = (x >> 12) % qb_nunits;
+        qb_cancel (QB_SIM, id);
+        qb_cancel (QB_REF, id);
+        }
+    if ((x & 0xF000) == 0) {                            /* compare due times */
+        id = (x >> 16) % qb_nunits;
+        if (sim_activate_time (&qb_unit[id]) != ref_activate_time (id))
+            return sim_messagef (SCPE_IERR, "step %d: unit %d due in %d, reference %d\n",
+                                 step, id, sim_activate_time (&qb_unit[id]) - 1, ref_activate_time (id) - 1);
+        if (sim_qcount () != ref_qcount ())
+            return sim_messagef (SCPE_IERR, "step %d: %d events queued, reference %d\n",
+                                 step, sim_qcount (), ref_qcount ());
+        checks++;
+        }
+    d = ((x >> 20) & 0x1F) ? 1 : 1 + ((x >> 25) & 7);   /* sometimes run late */
+    sim_interval = sim_interval - d;
+    ref_interval = ref_interval - d;
+    if (sim_interval <= 0)
+        sim_process_event ();
+    if (ref_interval <= 0)
+        ref_process_event ();
+    if (sim_interval != ref_interval)
+        return sim_messagef (SCPE_IERR, "step %d: sim_interval %d, reference %d\n",
+                             step, sim_interval, ref_interval);
+    if (qb_overflow || (qb_log_cnt[QB_SIM] != qb_log_cnt[QB_REF]))
+        return sim_messagef (SCPE_IERR, "step %d: %d events, reference %d\n",
+                             step, qb_log_cnt[QB_SIM], qb_log_cnt[QB_REF]);
+    for (i = 0; i < qb_log_cnt[QB_SIM]; i++) {
+        if ((qb_log_id[QB_SIM][i] != qb_log_id[QB_REF][i]) ||
+            ((qb_log_time[QB_SIM][i] - t0) != (qb_log_time[QB_REF][i] - t0)))
+            return sim_messagef (SCPE_IERR, "step %d: event %d is unit %d at %.0f, reference unit %d at %.0f\n",
+                                 step, i, qb_log_id[QB_SIM][i], qb_log_time[QB_SIM][i] - t0,
+                                 qb_log_id[QB_REF][i], qb_log_time[QB_REF][i] - t0);
+        }
+    events = events + qb_log_cnt[QB_SIM];
+    qb_log_cnt[QB_SIM] = qb_log_cnt[QB_REF] = 0;
+    }
+qb_reset (0);
+sim_printf ("%d instructions, %d events, %d due time checks: same as linear list\n", steps, events, checks);
+return SCPE_OK;
+}
+
+/* Activate and cancel all units, then run self rescheduling events */
+
+static void qb_bench (int32 side, int32 nunits, int32 events, uint32 *ms_actcan, uint32 *ms_events)
+{
+static int32 perm[QB_MAXUNITS];
+int32 i, n;
+uint32 seed = 815, start;
+
+qb_benchmode = TRUE;
+qb_reset (nunits);
+for (i = 0; i < nunits; i++)
+    perm[i] = i;
+for (i = nunits - 1; i > 0; i--) {                      /* random order */
+    int32 j = qb_random (&seed) % (i + 1), t = perm[i];
+
+    perm[i] = perm[j];
+    perm[j] = t;
+    }
+start = sim_os_msec ();
+for (i = 0; i < nunits; i++)
+    qb_activate (side, perm[i], qb_random (&seed) % (4 * nunits));
+for (i = 0; i < nunits; i++)
+    qb_cancel (side, perm[(i * 7919) % nunits]);
+*ms_actcan = sim_os_msec () - start;
+
+qb_seed[side] = 42;
+for (i = 0; i < nunits; i++)
+    qb_activate (side, i, qb_random (&seed) % (4 * nunits));
+start = sim_os_msec ();
+for (n = 0; n < events; n++) {                          /* skip to next event */
+    if (side == QB_SIM) {
+        sim_interval = 0;
+        sim_process_event ();
+        }
+    else {
+        ref_interval = 0;
+        ref_process_event ();
+        }
+    }
+*ms_events = sim_os_msec () - start;
+qb_reset (0);
+}
+
+t_stat qb_bench_cmd (int32 flag, CONST char *cptr)
+{
+int32 nunits, events;
+uint32 ms[2][2];
+t_stat r = SCPE_OK;
+
+nunits = qb_arg (&cptr, QB_MAXUNITS, QB_MAXUNITS, &r);
+if (r == SCPE_OK)
+    events = qb_arg (&cptr, 200000, 0x7FFFFFFF, &r);
+if (r != SCPE_OK)
+    return r;
+qb_bench (QB_SIM, nunits, events, &ms[QB_SIM][0], &ms[QB_SIM][1]);
+qb_bench (QB_REF, nunits, events, &ms[QB_REF][0], &ms[QB_REF][1]);
+sim_printf ("%d units activated and canceled: heap %u ms, linear list %u ms\n",
+            nunits, ms[QB_SIM][0], ms[QB_REF][0]);
+sim_printf ("%d events:                       heap %u ms, linear list %u ms\n",
+            events, ms[QB_SIM][1], ms[QB_REF][1]);
+return SCPE_OK;
+}
@@ -59,6 +59,10 @@ extern "C" {
 #include <dlfcn.h>
 #endif
 
+#if !defined (_WIN32) && !defined (VMS) && (!defined (__OS2__) || defined (__EMX__))
+#include <sys/uio.h>                                    /* for sim_write_sock_v */
+#endif
+
 #ifndef WSAAPI
 #define WSAAPI
 #endif
@@ -120,6 +124,11 @@ int sim_write_sock (SOCKET sock, char *msg, int nbytes)
 return 0;
 }
 
+int sim_write_sock_v (SOCKET sock, const SIM_SOCK_BUF *bufs, int count)
+{
+return 0;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 return;
@@ -1257,6 +1266,65 @@ if (sbytes == SOCKET_ERROR) {
 return sbytes;
 }
 
+/* Gathered write: the pieces go out in order with one sendmsg/WSASend
+   where the host has one (only the first SIM_SOCK_MAXBUFS are taken),
+   otherwise piece by piece until one is not sent completely.  Returns
+   the total bytes sent, like sim_write_sock. */
+
+int sim_write_sock_v (SOCKET sock, const SIM_SOCK_BUF *bufs, int count)
+{
+int i, err, sbytes;
+#if defined (_WIN32)
+WSABUF iov[SIM_SOCK_MAXBUFS];
+DWORD sent;
+#elif !defined (VMS)
+struct iovec iov[SIM_SOCK_MAXBUFS];
+struct msghdr msg;
+#endif
+
+if (count > SIM_SOCK_MAXBUFS)
+    count = SIM_SOCK_MAXBUFS;
+#if defined (VMS)
+for (i = sbytes = 0; i < count; i++) {
+    err = sim_write_sock (sock, bufs[i].buf, bufs[i].len);
+    if (err < 0)                                        /* error? */
+        return (sbytes ? sbytes : err);                 /* report what went */
+    sbytes += err;
+    if (err < bufs[i].len)                              /* no more room? */
+        break;
+    }
+return sbytes;
+#else
+for (i = 0; i < count; i++) {
+#if defined (_WIN32)
+    iov[i].buf = (char *)bufs[i].buf;
+    iov[i].len = (u_long)bufs[i].len;
+#else
+    iov[i].iov_base = (void *)bufs[i].buf;
+    iov[i].iov_len = (size_t)bufs[i].len;
+#endif
+    }
+#if defined (_WIN32)
+sbytes = (WSASend (sock, iov, count, &sent, 0, NULL, NULL) == SOCKET_ERROR) ? SOCKET_ERROR : (int)sent;
+#else
+memset (&msg, 0, sizeof (msg));
+msg.msg_iov = iov;
+msg.msg_iovlen = count;
+sbytes = (int)sendmsg (sock, &msg, 0);
+#endif
+if (sbytes == SOCKET_ERROR) {
+    err = WSAGetLastError ();
+    if (err == WSAEWOULDBLOCK)                          /* no room */
+        return 0;
+#if defined(EAGAIN)
+    if (err == EAGAIN)                                  /* no room */
+        return 0;
+#endif
+    }
+return sbytes;
+#endif
+}
+
 void sim_close_sock (SOCKET sock)
 {
 shutdown(sock, SD_BOTH);
@@ -124,6 +124,12 @@ SOCKET sim_accept_conn_ex (SOCKET master, char **connectaddr, int opt_flags);
 int sim_check_conn (SOCKET sock, int rd);
 int sim_read_sock (SOCKET sock, char *buf, int nbytes);
 int sim_write_sock (SOCKET sock, const char *msg, int nbytes);
+typedef struct {                                        /* piece of a gathered write */
+    const char          *buf;
+    int                 len;
+    } SIM_SOCK_BUF;
+#define SIM_SOCK_MAXBUFS    8                           /* pieces per sim_write_sock_v */
+int sim_write_sock_v (SOCKET sock, const SIM_SOCK_BUF *bufs, int count);
 void sim_close_sock (SOCKET sock);
 const char *sim_get_err_sock (const char *emsg);
 SOCKET sim_err_sock (SOCKET sock, const char *emsg);
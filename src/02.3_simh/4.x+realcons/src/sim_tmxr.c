@@ -71,6 +71,7 @@
    tmxr_get_packet_ln_ex -              get packet from line with separater byte
    tmxr_poll_rx -                       poll receive
    tmxr_putc_ln -                       put character for line
+   tmxr_put_buf_ln -                    put characters for line
    tmxr_put_packet_ln -                 put packet on line
    tmxr_put_packet_ln_ex -              put packet on line with separator byte
    tmxr_poll_tx -                       poll transmit
@@ -112,6 +113,7 @@
    tmxr_show_lnorder -                  show line connection order
    tmxr_show_summ -                     show connection summary
    tmxr_show_cstat -                    show line connections or status
+   tmxr_set_stats -                     write line statistics to a file
    tmxr_show_lines -                    show number of lines
    tmxr_show_open_devices -             show info about all open tmxr devices 
 
@@ -348,6 +350,18 @@
 #include <ctype.h>
 #include <math.h>
 
+/* On Linux, receive readiness comes from epoll rather than a recv() on
+   every connected line */
+
+#if defined(__linux__) && !defined(DONT_USE_EPOLL)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define TMXR_EPOLL_EVENTS   64                          /* events taken per tmxr_poll_rx */
+#endif
+
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
 /* Commands */
@@ -451,6 +465,35 @@ static u_char mantra[] = {                  /* Telnet Option Negotiation Mantra
 
 static void tmxr_add_to_open_list (TMXR* mux);
 
+/* Line latency statistics
+
+   Latency is kept per burst rather than per character.  A line's
+   transmit queue (buffer and pending packet) and its receive buffer are
+   stamped with the wall clock time when they go from empty to holding
+   data, and one sample of the time since then is taken when they are
+   empty again: drained to the socket for transmit, or read by the
+   simulator for receive.  The character paths only test the stamp.
+*/
+
+#define TMXR_STAMP(t)   do { if ((t) == 0.0) (t) = sim_timenow_double (); } while (0)
+
+static void tmxr_lat_sample (TMXR_LAT *lat, double *stamp)
+{
+double usec = (sim_timenow_double () - *stamp) * 1000000.0;
+int32 b;
+
+*stamp = 0.0;
+if (usec < 0.0)                                         /* clock stepped back? */
+    usec = 0.0;
+for (b = 0; (b < TMXR_LAT_BUCKETS - 1) && (usec >= (double)(1 << b)); b++)
+    ;
+++lat->bucket[b];
+++lat->count;
+lat->sum += usec;
+if (usec > lat->max)
+    lat->max = usec;
+}
+
 /* Initialize the line state.
 
    Reset the line state to represent an idle line.  Note that we do not clear
@@ -470,7 +513,10 @@ lp->dstb = 0;                                           /* default bin mode */
 lp->rxbpr = lp->rxbpi = lp->rxcnt = lp->rxpcnt = 0;     /* init receive indexes */
 if (!lp->txbfd || lp->notelnet)                         /* if not buffered telnet */
     lp->txbpr = lp->txbpi = lp->txcnt = lp->txpcnt = 0; /*   init transmit indexes */
-lp->txdrp = lp->txstall = 0;
+lp->txdrp = lp->txstall = lp->rxreads = 0;
+lp->rxstamp = lp->txstamp = 0.0;
+memset (&lp->rxlat, 0, sizeof (lp->rxlat));
+memset (&lp->txlat, 0, sizeof (lp->txlat));
 tmxr_set_get_modem_bits (lp, 0, 0, NULL);
 if ((!lp->mp->buffered) && (!lp->txbfd)) {
     lp->txbfd = 0;
@@ -729,6 +775,71 @@ if ((written > 0) && (lp->txbps) && (sim_is_running))
 return written;
 }
 
+/* Gathered transmit
+
+   On a stream socket line, the transmit buffer (both parts when it has
+   wrapped) and then "length" bytes at "buf" are handed to the socket in
+   one sim_write_sock_v call.  What the socket takes out of the transmit
+   buffer is removed from it; the return value is the number of bytes
+   taken from "buf", or -1 if the connection failed.
+*/
+
+static t_bool tmxr_can_writev (const TMLN *lp)
+{
+#if defined(DONT_USE_WRITEV)
+return FALSE;
+#else
+return (lp->sock && !lp->serport && !lp->loopback && !lp->datagram);
+#endif
+}
+
+/* Packet data can be sent from the packet buffer itself when no
+   per character processing (telnet, logging, expect) applies */
+
+static t_bool tmxr_raw_packet (const TMLN *lp)
+{
+return tmxr_can_writev (lp) && lp->notelnet && !lp->txlog && !lp->expect.rules;
+}
+
+static int32 tmxr_writev (TMLN *lp, const char *buf, int32 length)
+{
+SIM_SOCK_BUF bufs[3];
+int32 n = 0, queued = tmxr_tqln (lp), sbytes, fromring;
+
+if ((lp->txbps) && (sim_gtime () < lp->txnexttime) && (sim_is_running))
+    return 0;
+if (queued) {
+    bufs[n].buf = &lp->txb[lp->txbpr];
+    bufs[n++].len = MIN (queued, lp->txbsz - lp->txbpr);
+    if (queued > bufs[0].len) {                         /* wrapped? */
+        bufs[n].buf = lp->txb;
+        bufs[n++].len = queued - bufs[0].len;
+        }
+    }
+if (length) {
+    bufs[n].buf = buf;
+    bufs[n++].len = length;
+    }
+if (n == 0)
+    return 0;
+sbytes = sim_write_sock_v (lp->sock, bufs, n);
+if (sbytes == SOCKET_ERROR)
+    return -1;
+fromring = MIN (sbytes, queued);
+if (fromring) {
+    tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), MIN (fromring, bufs[0].len));
+    if (fromring > bufs[0].len)
+        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", lp->txb, fromring - bufs[0].len);
+    lp->txbpr = (lp->txbpr + fromring) % lp->txbsz;     /* update remove ptr */
+    }
+if (sbytes > fromring)
+    tmxr_debug (TMXR_DBG_XMT, lp, "Sent", (char *)buf, sbytes - fromring);
+lp->txcnt = lp->txcnt + sbytes;                         /* update counts */
+if ((sbytes > 0) && (lp->txbps) && (sim_is_running))
+    lp->txnexttime = floor (sim_gtime () + ((sbytes * lp->txdelta * sim_timer_inst_per_sec ()) / TMXR_RX_BPS_UNIT_SCALE));
+return sbytes - fromring;
+}
+
 
 /* Remove a character from the read buffer.
 
@@ -1309,6 +1420,9 @@ if (lp->serport) {
 else                                                    /* Telnet connection */
     if (lp->sock) {
         sim_close_sock (lp->sock);                      /* close socket */
+#if defined(USE_EPOLL)
+        lp->epoll_sock = 0;                             /* gone from epoll set, number may be reused */
+#endif
         free (lp->telnet_sent_opts);
         lp->telnet_sent_opts = NULL;
         lp->sock = 0;
@@ -1768,8 +1882,11 @@ if ((lp->conn && lp->rcve) &&                           /* conn & enb & */
             }
         }
     }                                                   /* end if conn */
-if (lp->rxbpi == lp->rxbpr)                             /* empty? zero ptrs */
+if (lp->rxbpi == lp->rxbpr) {                           /* empty? zero ptrs */
     lp->rxbpi = lp->rxbpr = 0;
+    if (lp->rxstamp != 0.0)                             /* burst all read? */
+        tmxr_lat_sample (&lp->rxlat, &lp->rxstamp);
+    }
 if (val) {                                              /* Got something? */
     if (lp->rxbps)
         lp->rxnexttime = floor (sim_gtime () + ((lp->rxdelta * sim_timer_inst_per_sec ()) / lp->rxbpsfactor));
@@ -1847,6 +1964,75 @@ if (lp->conn)
 return SCPE_LOST;
 }
 
+#if defined(USE_EPOLL)
+/* Receive readiness set
+
+   Each multiplexer keeps the sockets of its connected lines in an epoll
+   set, so that a receive poll costs one epoll_wait() plus a read on each
+   line which actually has data (or has been closed by the peer), instead
+   of a recv() on every connected line.  Sockets are added the first time
+   tmxr_poll_rx sees them and leave the set by themselves when closed;
+   tmxr_reset_ln_ex clears epoll_sock so that a new connection which gets
+   the same socket number is added again.  Serial and loopback lines are
+   still read on every poll.
+
+   Returns TRUE with rxready set on the lines that need a read, or FALSE
+   if the set can't be used this time and every line should be read.
+*/
+
+static void tmxr_epoll_close (TMXR *mp)
+{
+int32 i;
+
+if (mp->epoll_fd > 0)
+    close (mp->epoll_fd);
+mp->epoll_fd = 0;
+for (i = 0; i < mp->lines; i++) {
+    mp->ldsc[i].epoll_sock = 0;
+    mp->ldsc[i].rxready = FALSE;
+    }
+}
+
+static t_bool tmxr_epoll_rx (TMXR *mp)
+{
+struct epoll_event ev[TMXR_EPOLL_EVENTS];
+int32 i;
+int n;
+TMLN *lp;
+
+if (mp->epoll_fd == 0) {                                /* first poll? */
+    n = epoll_create1 (EPOLL_CLOEXEC);
+    mp->epoll_fd = (n > 0) ? n : -1;
+    if (mp->epoll_fd < 0)
+        tmxr_debug_trace (mp, "tmxr_epoll_rx() - epoll unavailable, reading all lines");
+    }
+if (mp->epoll_fd < 0)
+    return FALSE;
+for (i = 0; i < mp->lines; i++) {                       /* pick up new connections */
+    lp = mp->ldsc + i;
+    if (lp->sock == lp->epoll_sock)
+        continue;
+    lp->epoll_sock = lp->sock;
+    if (lp->sock) {
+        memset (ev, 0, sizeof (ev[0]));
+        ev[0].events = EPOLLIN;
+        ev[0].data.u32 = (uint32)i;
+        if ((epoll_ctl (mp->epoll_fd, EPOLL_CTL_ADD, lp->sock, &ev[0]) != 0) &&
+            ((errno != EEXIST) ||
+             (epoll_ctl (mp->epoll_fd, EPOLL_CTL_MOD, lp->sock, &ev[0]) != 0))) {
+            tmxr_epoll_close (mp);
+            mp->epoll_fd = -1;                          /* don't try again until reattached */
+            return FALSE;
+            }
+        }
+    }
+n = epoll_wait (mp->epoll_fd, ev, TMXR_EPOLL_EVENTS, 0);
+for (i = 0; i < n; i++)
+    mp->ldsc[ev[i].data.u32].rxready = TRUE;
+return (n >= 0) && (n < TMXR_EPOLL_EVENTS);             /* error or maybe more pending? read all */
+}
+#endif
+
 /* Poll for input
 
    Inputs:
@@ -1858,13 +2044,23 @@ void tmxr_poll_rx (TMXR *mp)
 {
 int32 i, nbytes, j;
 TMLN *lp;
+#if defined(USE_EPOLL)
+t_bool ready, readyset = tmxr_epoll_rx (mp);
+#endif
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
+++mp->rxpolls;
 for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
     if (!(lp->sock || lp->serport || lp->loopback) || 
         !(lp->rcve))                                    /* skip if not connected */
         continue;
+#if defined(USE_EPOLL)
+    ready = lp->rxready;
+    lp->rxready = FALSE;
+    if (lp->sock && readyset && !ready)                 /* nothing arrived on socket? */
+        continue;
+#endif
 
     nbytes = 0;
     if (lp->rxbpi == 0)                                 /* need input? */
@@ -1889,6 +2085,7 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
         j = lp->rxbpi;                                  /* start of data */
         lp->rxbpi = lp->rxbpi + nbytes;                 /* adv pointers */
         lp->rxcnt = lp->rxcnt + nbytes;
+        ++lp->rxreads;
 
 /* Examine new data, remove TELNET cruft before making input available */
 
@@ -2088,6 +2285,8 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
     if (lp->rxbpi == lp->rxbpr)                         /* if buf empty, */
         lp->rxbpi = lp->rxbpr = 0;                      /* reset pointers */
+    else
+        TMXR_STAMP (lp->rxstamp);                       /* note arrival of burst */
     }                                                   /* end for */
 }
 
@@ -2143,6 +2342,7 @@ if ((lp->txbfd && !lp->notelnet) || (TXBUF_AVAIL(lp) > 1)) {/* room for char (+
     if ((TN_IAC == (u_char) chr) && (!lp->notelnet))    /* char == IAC in telnet session? */
         TXBUF_CHAR (lp, TN_IAC);                        /* stuff extra IAC char */
     TXBUF_CHAR (lp, chr);                               /* buffer char & adv pointer */
+    TMXR_STAMP (lp->txstamp);                           /* note start of burst */
     if (((!lp->txbfd) && 
          (TXBUF_AVAIL (lp) <= TMXR_GUARD)) ||           /* near full? */
         (lp->txbps))                                    /* or we're rate limiting output */
@@ -2168,6 +2368,89 @@ if ((lp->txbfd && !lp->notelnet) || (TXBUF_AVAIL(lp) > 1)) {/* room for char (+
 return SCPE_STALL;                                      /* char not sent */
 }
 
+/* Store buffer of characters in line buffer
+
+   Inputs:
+        *lp     =       pointer to line descriptor
+        *buf    =       pointer to characters
+        size    =       number of characters
+        *count  =       pointer to count of characters accepted
+   Outputs:
+        status  =       ok, connection lost, or stall
+
+   Implementation notes:
+
+    1. If the line is not connected, SCPE_LOST is returned.
+    2. The result is the same as calling tmxr_putc_ln for each character
+       until one stalls.  On a stream socket line, characters are handed
+       to the socket straight from the caller's buffer (behind anything
+       already buffered); only what the socket did not take is copied
+       into the line buffer.
+    3. Lines that are buffered, serial, rate limited, or have telnet
+       data that needs escaping are done character by character.
+*/
+
+t_stat tmxr_put_buf_ln (TMLN *lp, const uint8 *buf, int32 size, int32 *count)
+{
+int32 sent = 0, n;
+t_stat r = SCPE_OK;
+
+*count = 0;
+if ((lp->conn == FALSE) &&                              /* no conn & not buffered telnet? */
+    (!lp->txbfd || lp->notelnet)) {
+    lp->txdrp += size;                                  /* lost */
+    return SCPE_LOST;
+    }
+tmxr_debug_trace_line (lp, "tmxr_put_buf_ln()");
+if ((lp->txbfd) || (lp->serport) || (lp->txbps) ||      /* needs per character handling? */
+    (!sim_is_running) ||
+    ((!lp->notelnet) && (memchr (buf, TN_IAC, size)))) {
+    while ((sent < size) &&
+           (SCPE_OK == (r = tmxr_putc_ln (lp, buf[sent]))))
+        ++sent;
+    *count = sent;
+    return r;
+    }
+if (tmxr_can_writev (lp)) {
+    sent = tmxr_writev (lp, (const char *)buf, size);   /* write behind buffered data */
+    if (sent < 0) {                                     /* I/O Error? */
+        lp->txbpi = lp->txbpr = 0;                      /* Drop the data we already know we can't send */
+        lp->rxpboffset = lp->txppoffset = lp->txppsize = 0;
+        tmxr_close_ln (lp);                             /*  close line/port on error */
+        lp->txdrp += size;
+        return SCPE_LOST;
+        }
+    }
+while ((sent < size) &&                                 /* copy the rest */
+       ((n = MIN (size - sent, lp->txbsz - tmxr_tqln (lp) - 1)) > 0)) {
+    n = MIN (n, lp->txbsz - lp->txbpi);                 /* up to the end of the buffer */
+    memcpy (&lp->txb[lp->txbpi], buf + sent, n);
+    lp->txbpi = (lp->txbpi + n) % lp->txbsz;
+    sent += n;
+    TMXR_STAMP (lp->txstamp);                           /* note start of burst */
+    }
+if (lp->txlog) {                                        /* log if available */
+    extern TMLN *sim_oline;                             /* Make sure to avoid recursion */
+    TMLN *save_oline = sim_oline;                       /* when logging to a socket */
+
+    sim_oline = NULL;                                   /* save output socket */
+    fwrite (buf, 1, sent, lp->txlog);                   /* log to actual file */
+    sim_oline = save_oline;                             /* resture output socket */
+    }
+if (lp->expect.rules) {                                 /* process expect rules as needed */
+    for (n = 0; n < sent; n++)
+        sim_exp_check (&lp->expect, buf[n]);
+    }
+*count = sent;
+if (TXBUF_AVAIL (lp) <= TMXR_GUARD)                     /* near full? */
+    lp->xmte = 0;                                       /* disable line transmit until space available */
+if (sent < size) {
+    ++lp->txstall; lp->xmte = 0;                        /* no room, dsbl line */
+    return SCPE_STALL;
+    }
+return SCPE_OK;
+}
+
 /* Store packet in line buffer
 
    Inputs:
@@ -2214,9 +2497,11 @@ if (!lp->datagram) {
 memcpy (lp->txpb + pktlen_size + fc_size, buf, size);
 lp->txppsize = size + pktlen_size + fc_size;
 lp->txppoffset = 0;
+TMXR_STAMP (lp->txstamp);                               /* note start of burst */
 tmxr_debug (TMXR_DBG_PXMT, lp, "Sending Packet", (char *)&lp->txpb[pktlen_size+fc_size], size);
 ++lp->txpcnt;
 while ((lp->txppoffset < lp->txppsize) && 
+       (!tmxr_raw_packet (lp)) &&                       /* else sent from txpb */
        (SCPE_OK == (r = tmxr_putc_ln (lp, lp->txpb[lp->txppoffset]))))
    ++lp->txppoffset;
 tmxr_send_buffered_data (lp);
@@ -2237,6 +2522,7 @@ int32 i, nbytes;
 TMLN *lp;
 
 tmxr_debug_trace (mp, "tmxr_poll_tx()");
+++mp->txpolls;
 for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
     if (!lp->conn)                                      /* skip if !conn */
@@ -2271,9 +2557,24 @@ int32 tmxr_send_buffered_data (TMLN *lp)
 {
 int32 nbytes, sbytes;
 t_stat r;
+t_bool rawpkt = tmxr_raw_packet (lp);
 
 tmxr_debug_trace_line (lp, "tmxr_send_buffered_data()");
 nbytes = tmxr_tqln(lp);                                 /* avail bytes */
+if (tmxr_can_writev (lp) &&                             /* one write for buffer and packet? */
+    (nbytes || (rawpkt && tmxr_tpqln (lp)))) {
+    sbytes = tmxr_writev (lp, rawpkt ? (char *)&lp->txpb[lp->txppoffset] : NULL,
+                              rawpkt ? tmxr_tpqln (lp) : 0);
+    if (sbytes < 0) {                                   /* I/O Error? */
+        lp->txbpi = lp->txbpr = 0;                      /* Drop the data we already know we can't send */
+        lp->rxpboffset = lp->txppoffset = lp->txppsize = 0;/* Drop the data we already know we can't send */
+        tmxr_close_ln (lp);                             /*  close line/port on error */
+        return nbytes;                                  /*  done now. */
+        }
+    lp->txppoffset += sbytes;                           /* packet data sent */
+    nbytes = tmxr_tqln(lp);
+    }
+else
 if (nbytes) {                                           /* >0? write */
     if (lp->txbpr < lp->txbpi)                          /* no wrap? */
         sbytes = tmxr_write (lp, nbytes);               /* write all data */
@@ -2308,12 +2609,16 @@ if (nbytes) {                                           /* >0? write */
         }
     }                                                   /* end if nbytes */
 while ((lp->txppoffset < lp->txppsize) &&               /* buffered packet data? */
+       (!rawpkt) &&                                     /* not sent from the packet buffer? */
        (lp->txbsz > nbytes) &&                          /* and room in xmt buffer */
        (SCPE_OK == (r = tmxr_putc_ln (lp, lp->txpb[lp->txppoffset]))))
    ++lp->txppoffset;
 if ((nbytes == 0) && (tmxr_tqln(lp) > 0))
     return tmxr_send_buffered_data (lp);
-return tmxr_tqln(lp) + tmxr_tpqln(lp);
+nbytes = tmxr_tqln(lp) + tmxr_tpqln(lp);
+if ((nbytes == 0) && (lp->txstamp != 0.0))             /* burst all sent? */
+    tmxr_lat_sample (&lp->txlat, &lp->txstamp);
+return nbytes;
 }
 
 
@@ -3974,6 +4279,9 @@ if (mp->ring_sock != INVALID_SOCKET) {
     mp->ring_ipad = NULL;
     mp->ring_start_time = 0;
     }
+#if defined(USE_EPOLL)
+tmxr_epoll_close (mp);
+#endif
 _tmxr_remove_from_open_list (mp);
 return SCPE_OK;
 }
@@ -4548,6 +4856,29 @@ if (lp->txlog)
 }
 
 
+/* Print a latency histogram, buckets are labelled with their upper bound */
+
+static void tmxr_flat (FILE *st, const char *dir, const TMXR_LAT *lat)
+{
+int32 b, n;
+
+if (lat->count == 0)
+    return;
+fprintf (st, "  %s latency (usecs) average/max = %.1f/%.1f over %u bursts\n   ",
+    dir, lat->sum / lat->count, lat->max, lat->count);
+for (b = n = 0; b < TMXR_LAT_BUCKETS; b++) {
+    if (lat->bucket[b] == 0)
+        continue;
+    if ((n++ % 6) == 5)
+        fprintf (st, "\n   ");
+    if (b < TMXR_LAT_BUCKETS - 1)
+        fprintf (st, " <%u: %u", 1u << b, lat->bucket[b]);
+    else
+        fprintf (st, " >=%u: %u", 1u << (b - 1), lat->bucket[b]);
+    }
+fprintf (st, "\n");
+}
+
 /* Print statistics - used only in named SHOW command */
 
 void tmxr_fstats (FILE *st, const TMLN *lp, int32 ln)
@@ -4565,6 +4896,8 @@ else {
     fprintf (st, "  input (%s)", (lp->rcve? enab: dsab));
     if (lp->rxcnt)
         fprintf (st, " queued/total = %d/%d", tmxr_rqln (lp), lp->rxcnt);
+    if (lp->rxreads)
+        fprintf (st, " reads = %d", lp->rxreads);
     if (lp->rxpcnt)
         fprintf (st, " packets = %d", lp->rxpcnt);
     fprintf (st, "\n  output (%s)", (lp->xmte? enab: dsab));
@@ -4593,6 +4926,8 @@ if (lp->txdrp)
     fprintf (st, "  dropped = %d\n", lp->txdrp);
 if (lp->txstall)
     fprintf (st, "  stalled = %d\n", lp->txstall);
+tmxr_flat (st, "input", &lp->rxlat);
+tmxr_flat (st, "output", &lp->txlat);
 }
 
 
@@ -4939,6 +5274,114 @@ for (i = any = 0; i < mp->lines; i++) {
     }
 if (any == 0)
     fprintf (st, (mp->lines == 1? "disconnected\n": "all disconnected\n"));
+else
+    if (!val)
+        fprintf (st, "Polls: input = %u, output = %u\n", mp->rxpolls, mp->txpolls);
+return SCPE_OK;
+}
+
+/* Statistics file helpers */
+
+static void tmxr_csv_lat (FILE *f, const TMXR_LAT *lat)
+{
+int32 b;
+
+fprintf (f, ",%u,%.1f,%.1f", lat->count, lat->count ? lat->sum / lat->count : 0.0, lat->max);
+for (b = 0; b < TMXR_LAT_BUCKETS; b++)
+    fprintf (f, ",%u", lat->bucket[b]);
+}
+
+static void tmxr_add_lat (TMXR_LAT *tot, const TMXR_LAT *lat)
+{
+int32 b;
+
+tot->count += lat->count;
+tot->sum += lat->sum;
+if (lat->max > tot->max)
+    tot->max = lat->max;
+for (b = 0; b < TMXR_LAT_BUCKETS; b++)
+    tot->bucket[b] += lat->bucket[b];
+}
+
+/* Write statistics to a file
+
+   Writes a heading and one comma separated line per multiplexer line,
+   followed by a line of totals for the multiplexer, to the file named by
+   "cptr".  The file is replaced, or appended to if the -A switch is given;
+   the heading is then only written if the file is new or empty.
+   The -C switch clears the poll and read counts and the latency statistics
+   afterwards, so that the next dump covers a new interval.
+
+   Implementation notes:
+
+    1. This function is usually called as an MTAB processing routine
+       ("SET dev STATISTICS=file").
+*/
+
+t_stat tmxr_set_stats (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+TMXR *mp = (TMXR *) desc;
+TMLN *lp;
+TMXR_LAT rxlat, txlat;
+FILE *f;
+const char *dname;
+int32 i, b, conns = 0;
+int32 rxreads = 0, rxcnt = 0, rxpcnt = 0, txcnt = 0, txpcnt = 0, txdrp = 0, txstall = 0;
+
+if (mp == NULL)
+    return SCPE_IERR;
+if ((cptr == NULL) || (*cptr == 0))                     /* no file name? */
+    return SCPE_2FARG;
+f = sim_fopen (cptr, (sim_switches & SWMASK ('A')) ? "a" : "w");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open %s: %s\n", cptr, strerror (errno));
+dname = (mp->dptr) ? sim_dname (mp->dptr) : "";
+memset (&rxlat, 0, sizeof (rxlat));
+memset (&txlat, 0, sizeof (txlat));
+if (sim_fsize_ex (f) == 0) {                            /* new file? heading */
+    fprintf (f, "device,line,connected,rx_polls,tx_polls,rx_reads,rx_bytes,rx_packets,"
+                "tx_bytes,tx_packets,tx_dropped,tx_stalls,rx_bps,tx_bps");
+    for (i = 0; i < 2; i++) {
+        fprintf (f, ",%s_bursts,%s_avg_us,%s_max_us", i ? "tx" : "rx", i ? "tx" : "rx", i ? "tx" : "rx");
+        for (b = 0; b < TMXR_LAT_BUCKETS - 1; b++)
+            fprintf (f, ",%s_lt%uus", i ? "tx" : "rx", 1u << b);
+        fprintf (f, ",%s_ge%uus", i ? "tx" : "rx", 1u << (b - 1));
+        }
+    fprintf (f, "\n");
+    }
+for (i = 0; i < mp->lines; i++) {
+    lp = mp->ldsc + i;
+    if ((lp->sock != 0) || (lp->serport != 0))
+        ++conns;
+    fprintf (f, "%s,%d,%d,%u,%u,%d,%d,%d,%d,%d,%d,%d,%u,%u", dname, i,
+        ((lp->sock != 0) || (lp->serport != 0)), mp->rxpolls, mp->txpolls, lp->rxreads,
+        lp->rxcnt, lp->rxpcnt, lp->txcnt, lp->txpcnt, lp->txdrp, lp->txstall, lp->rxbps, lp->txbps);
+    tmxr_csv_lat (f, &lp->rxlat);
+    tmxr_csv_lat (f, &lp->txlat);
+    fprintf (f, "\n");
+    rxreads += lp->rxreads;
+    rxcnt += lp->rxcnt;
+    rxpcnt += lp->rxpcnt;
+    txcnt += lp->txcnt;
+    txpcnt += lp->txpcnt;
+    txdrp += lp->txdrp;
+    txstall += lp->txstall;
+    tmxr_add_lat (&rxlat, &lp->rxlat);
+    tmxr_add_lat (&txlat, &lp->txlat);
+    if (sim_switches & SWMASK ('C')) {                  /* clear interval statistics? */
+        memset (&lp->rxlat, 0, sizeof (lp->rxlat));
+        memset (&lp->txlat, 0, sizeof (lp->txlat));
+        lp->rxreads = 0;
+        }
+    }
+fprintf (f, "%s,all,%d,%u,%u,%d,%d,%d,%d,%d,%d,%d,,", dname, conns, mp->rxpolls, mp->txpolls,
+    rxreads, rxcnt, rxpcnt, txcnt, txpcnt, txdrp, txstall);
+tmxr_csv_lat (f, &rxlat);
+tmxr_csv_lat (f, &txlat);
+fprintf (f, "\n");
+fclose (f);
+if (sim_switches & SWMASK ('C'))
+    mp->rxpolls = mp->txpolls = 0;
 return SCPE_OK;
 }
 
@@ -123,6 +123,13 @@ typedef struct SERPORT *SERHANDLE;
 
 typedef struct tmln TMLN;
 typedef struct tmxr TMXR;
+#define TMXR_LAT_BUCKETS 24                             /* <1, <2, <4 .. <2^22, more usecs */
+typedef struct {
+    uint32              count;                          /* bursts measured */
+    double              sum;                            /* total usecs */
+    double              max;                            /* longest usecs */
+    uint32              bucket[TMXR_LAT_BUCKETS];       /* histogram */
+    } TMXR_LAT;
 struct loopbuf {
     int32               bpr;                          /* xmt buf remove */
     int32               bpi;                          /* xmt buf insert */
@@ -200,6 +207,13 @@ struct tmln {
     DEVICE              *dptr;                          /* line specific device */
     EXPECT              expect;                         /* Expect rules */
     SEND                send;                           /* Send input state */
+    SOCKET              epoll_sock;                     /* socket in mux's epoll set */
+    t_bool              rxready;                        /* epoll reported input */
+    int32               rxreads;                        /* reads which got data */
+    double              rxstamp;                        /* rcv buffer filled at (0 = empty) */
+    double              txstamp;                        /* xmt queue filled at (0 = empty) */
+    TMXR_LAT            rxlat;                          /* socket to simulator read latency */
+    TMXR_LAT            txlat;                          /* queue to socket latency */
     };
 
 struct tmxr {
@@ -224,6 +238,9 @@ struct tmxr {
     t_bool              port_speed_control;             /* multiplexer programmatically sets port speed */
     t_bool              packet;                         /* Lines are packet oriented */
     t_bool              datagram;                       /* Lines use datagram packet transport */
+    int                 epoll_fd;                       /* rcv readiness set (0 = not open, -1 = unavailable) */
+    uint32              rxpolls;                        /* tmxr_poll_rx calls */
+    uint32              txpolls;                        /* tmxr_poll_tx calls */
     };
 
 int32 tmxr_poll_conn (TMXR *mp);
@@ -235,6 +252,7 @@ t_stat tmxr_get_packet_ln (TMLN *lp, const uint8 **pbuf, size_t *psize);
 t_stat tmxr_get_packet_ln_ex (TMLN *lp, const uint8 **pbuf, size_t *psize, uint8 frame_byte);
 void tmxr_poll_rx (TMXR *mp);
 t_stat tmxr_putc_ln (TMLN *lp, int32 chr);
+t_stat tmxr_put_buf_ln (TMLN *lp, const uint8 *buf, int32 size, int32 *count);
 t_stat tmxr_put_packet_ln (TMLN *lp, const uint8 *buf, size_t size);
 t_stat tmxr_put_packet_ln_ex (TMLN *lp, const uint8 *buf, size_t size, uint8 frame_byte);
 void tmxr_poll_tx (TMXR *mp);
@@ -282,6 +300,7 @@ t_stat tmxr_set_lnorder (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat tmxr_show_lnorder (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat tmxr_show_summ (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat tmxr_show_cstat (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat tmxr_set_stats (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat tmxr_show_lines (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat tmxr_show_open_devices (FILE* st, DEVICE *dptr, UNIT* uptr, int32 val, CONST char* desc);
 t_stat tmxr_activate (UNIT *uptr, int32 interval);
@@ -0,0 +1,441 @@
+/* sim_tmxr_bench.c: terminal multiplexer poll benchmark and consistency test
+
+   Copyright (c) 2026, BlinkenBone contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   One 64 line multiplexer, driven through tmxr_poll_conn/tmxr_poll_rx/
+   tmxr_getc_ln like a DZ11 would, with the other end of every line a local
+   TCP connection made by the program.
+   Build with  make -f quickmake sim_tmxr_bench,  add CC_DEFS=-DDONT_USE_EPOLL
+   to compare with recv() on every connected line, CC_DEFS=-DDONT_USE_WRITEV
+   to compare with one send() per transmit buffer piece.
+
+   Commands, for example
+        printf "attach tb 23230;notelnet\ntverify\ntbench\nexit\n" | ./sim_tmxr_bench
+
+   TVERIFY {chars}      sends <chars> characters (default 10000) on random
+                        lines and checks each one arrives on its line and
+                        nowhere else; every 64th character a connection is
+                        closed and made again, so socket numbers get reused.
+   TBENCH {polls}       for 1, 2, 4 .. 64 connected lines, times <polls>
+                        calls of tmxr_poll_rx (default 100000) with all lines
+                        idle, and the delivery of one character per poll
+                        while all others are idle.
+   TXBENCH {kbytes}     sends <kbytes> KB (default 16384) on one line, as
+                        tmxr_putc_ln characters, as 256 byte tmxr_put_buf_ln
+                        chunks and as 1024 byte tmxr_put_packet_ln packets,
+                        to a client which drains and checks it; reports the
+                        rate of each.  Telnet should be off (notelnet).
+   SHOW TB STATISTICS and SET TB STATISTICS=file report the line counters
+   and latencies collected by sim_tmxr during a run.
+*/
+
+#include "sim_defs.h"
+#include "sim_sock.h"
+#include "sim_tmxr.h"
+#include <time.h>
+
+#define TB_LINES        64                              /* lines on the mux */
+#define TB_CONNWAIT     5000                            /* msec to wait for a connection */
+#define TB_CHUNK        256                             /* tmxr_put_buf_ln size */
+#define TB_PACKET       1024                            /* tmxr_put_packet_ln size */
+#define TB_PATTERN      251                             /* data byte n is n % TB_PATTERN */
+
+t_stat tb_svc (UNIT *uptr);
+t_stat tb_attach (UNIT *uptr, CONST char *cptr);
+t_stat tb_detach (UNIT *uptr);
+t_stat tb_verify_cmd (int32 flag, CONST char *cptr);
+t_stat tb_bench_cmd (int32 flag, CONST char *cptr);
+t_stat tb_txbench_cmd (int32 flag, CONST char *cptr);
+
+static TMLN tb_ldsc[TB_LINES];
+static TMXR tb_desc = { TB_LINES, 0, 0, tb_ldsc };
+static UNIT tb_unit = { UDATA (&tb_svc, UNIT_ATTABLE, 0) };
+static SOCKET tb_client[TB_LINES];                      /* far end of each line */
+static int32 tb_line[TB_LINES];                         /* line each client got */
+
+static MTAB tb_mod[] = {
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATISTICS", NULL,
+        NULL, &tmxr_show_cstat, (void *) &tb_desc, "Display multiplexer statistics" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NC, 0, NULL, "STATISTICS=file",
+        &tmxr_set_stats, NULL, (void *) &tb_desc, "Write line statistics to a file" },
+    { 0 }
+    };
+
+DEVICE tb_dev = {
+    "TB", &tb_unit, NULL, tb_mod,
+    1, 10, 31, 1, 8, 8,
+    &tmxr_ex, &tmxr_dep, NULL, NULL, &tb_attach, &tb_detach,
+    NULL, DEV_MUX
+    };
+
+/* Simulator interface */
+
+char sim_name[64] = "Mux bench";
+REG *sim_PC = NULL;
+int32 sim_emax = 1;
+DEVICE *sim_devices[] = { &tb_dev, NULL };
+const char *sim_stop_messages[SCPE_BASE] = { "Unknown error" };
+
+static CTAB tb_cmd[] = {
+    { "TVERIFY", &tb_verify_cmd, 0, "tverify {chars}                      check characters arrive on their lines\n" },
+    { "TBENCH",  &tb_bench_cmd,  0, "tbench {polls}                       receive poll timing vs. connected lines\n" },
+    { "TXBENCH", &tb_txbench_cmd, 0, "txbench {kbytes}                     transmit rate of putc, put_buf and packets\n" },
+    { NULL }
+    };
+
+static void tb_init (void)
+{
+sim_vm_cmd = tb_cmd;
+}
+
+void (*sim_vm_init) (void) = &tb_init;
+
+t_stat sim_instr (void)
+{
+return SCPE_NOFNC;
+}
+
+t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+{
+return SCPE_NOFNC;
+}
+
+t_stat fprint_sym (FILE *of, t_addr addr, t_value *val, UNIT *uptr, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat parse_sym (CONST char *cptr, t_addr addr, UNIT *uptr, t_value *val, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat tb_svc (UNIT *uptr)
+{
+return SCPE_OK;
+}
+
+t_stat tb_attach (UNIT *uptr, CONST char *cptr)
+{
+int32 i;
+t_stat r;
+
+r = tmxr_attach (&tb_desc, uptr, cptr);
+if (r != SCPE_OK)
+    return r;
+for (i = 0; i < TB_LINES; i++) {
+    tb_ldsc[i].rcve = 1;                                /* all lines receive */
+    tb_client[i] = INVALID_SOCKET;
+    }
+return SCPE_OK;
+}
+
+t_stat tb_detach (UNIT *uptr)
+{
+int32 i;
+
+for (i = 0; i < TB_LINES; i++) {
+    if (tb_client[i] != INVALID_SOCKET)
+        sim_close_sock (tb_client[i]);
+    tb_client[i] = INVALID_SOCKET;
+    }
+return tmxr_detach (&tb_desc, uptr);
+}
+
+static double tb_usec (void)
+{
+struct timespec ts;
+
+clock_gettime (CLOCK_MONOTONIC, &ts);
+return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static uint32 tb_random (uint32 *seed)
+{
+uint32 x = *seed;
+
+x ^= x << 13;
+x ^= x >> 17;
+x ^= x << 5;
+return *seed = x;
+}
+
+static int32 tb_arg (CONST char **cptr, int32 dflt, int32 max, t_stat *r)
+{
+char gbuf[CBUFSIZE];
+int32 val;
+
+*cptr = get_glyph (*cptr, gbuf, 0);
+if (gbuf[0] == 0)
+    return dflt;
+val = (int32) get_uint (gbuf, 10, max, r);
+if ((*r == SCPE_OK) && (val == 0))
+    *r = SCPE_ARG;
+return val;
+}
+
+/* Connect a client and let the mux accept it; returns the line it got, -1 on error.
+   The connection poll interval is skipped, a real mux accepts one per second. */
+
+static int32 tb_connect (int32 client)
+{
+char hostport[CBUFSIZE];
+uint32 start = sim_os_msec ();
+int32 ln = -1;
+
+sprintf (hostport, "localhost:%s", tb_desc.port);
+tb_client[client] = sim_connect_sock (hostport, "localhost", NULL);
+if (tb_client[client] == INVALID_SOCKET)
+    return -1;
+while ((ln < 0) && ((sim_os_msec () - start) < TB_CONNWAIT)) {
+    if (tb_desc.last_poll_time)
+        tb_desc.last_poll_time = sim_os_msec () - 1000 * tb_desc.poll_interval;
+    ln = tmxr_poll_conn (&tb_desc);
+    if (ln < 0)
+        sim_os_ms_sleep (1);
+    }
+if ((ln >= 0) && (sim_check_conn (tb_client[client], FALSE) < 0))
+    ln = -1;
+return tb_line[client] = ln;
+}
+
+/* Close a client and poll until its line has seen the close */
+
+static void tb_disconnect (int32 client)
+{
+int32 n;
+
+sim_close_sock (tb_client[client]);
+tb_client[client] = INVALID_SOCKET;
+for (n = 0; (tb_ldsc[tb_line[client]].conn) && (n < TB_CONNWAIT); n++) {
+    tmxr_poll_rx (&tb_desc);
+    sim_os_ms_sleep (n ? 1 : 0);
+    }
+}
+
+/* Poll until line ln has a character (or lost its connection); any character
+   showing up on another line counts as an error */
+
+static int32 tb_receive (int32 ln, uint32 *polls, uint32 *errors)
+{
+int32 i, c;
+uint32 start = sim_os_msec ();
+
+while ((sim_os_msec () - start) < TB_CONNWAIT) {
+    tmxr_poll_rx (&tb_desc);
+    ++*polls;
+    for (i = 0; i < TB_LINES; i++) {
+        if ((i == ln) || !tmxr_rqln (&tb_ldsc[i]))
+            continue;
+        c = tmxr_getc_ln (&tb_ldsc[i]);
+        if ((*errors)++ < 10)
+            sim_printf ("character %02X arrived on line %d instead of %d\n", c & 0xFF, i, ln);
+        }
+    if (tmxr_rqln (&tb_ldsc[ln]))
+        return tmxr_getc_ln (&tb_ldsc[ln]) & 0xFF;
+    if (!tb_ldsc[ln].conn)
+        break;
+    }
+return -1;
+}
+
+t_stat tb_verify_cmd (int32 flag, CONST char *cptr)
+{
+int32 chars, n, i, c;
+uint32 seed = 4711, polls = 0, errors = 0, reconnects = 0;
+char ch;
+t_stat r = SCPE_OK;
+
+chars = tb_arg (&cptr, 10000, 0x7FFFFFFF, &r);
+if (r != SCPE_OK)
+    return r;
+if (!(tb_unit.flags & UNIT_ATT))
+    return SCPE_UNATT;
+for (i = 0; i < TB_LINES; i++) {
+    if ((tb_client[i] == INVALID_SOCKET) && (tb_connect (i) < 0))
+        return sim_messagef (SCPE_OPENERR, "can't connect client %d\n", i);
+    }
+for (n = 0; n < chars; n++) {
+    i = tb_random (&seed) % TB_LINES;
+    if ((n % 64) == 63) {                               /* drop and remake a connection */
+        tb_disconnect (i);
+        if (tb_connect (i) < 0)
+            return sim_messagef (SCPE_OPENERR, "can't reconnect client %d\n", i);
+        ++reconnects;
+        }
+    ch = (char)tb_random (&seed);
+    sim_write_sock (tb_client[i], &ch, 1);
+    c = tb_receive (tb_line[i], &polls, &errors);
+    if ((c != (ch & 0xFF)) && (errors++ < 10))
+        sim_printf ("line %d: sent %02X, received %X\n", tb_line[i], ch & 0xFF, c);
+    }
+if (errors)
+    return sim_messagef (SCPE_IERR, "%d errors\n", errors);
+sim_printf ("%d characters, %d reconnects, %.2f polls/character: all arrived on their lines\n",
+            chars, reconnects, (double)polls / chars);
+return SCPE_OK;
+}
+
+t_stat tb_bench_cmd (int32 flag, CONST char *cptr)
+{
+int32 polls, chars, nlines, i, n;
+uint32 errors = 0, rxpolls;
+double start, idle, active;
+char ch = 'x';
+t_stat r = SCPE_OK;
+
+polls = tb_arg (&cptr, 100000, 0x7FFFFFFF, &r);
+if (r != SCPE_OK)
+    return r;
+if (!(tb_unit.flags & UNIT_ATT))
+    return SCPE_UNATT;
+chars = (polls + 9) / 10;                               /* socket round trips are slower */
+for (i = 0; i < TB_LINES; i++) {                        /* start with no connections */
+    if (tb_client[i] != INVALID_SOCKET)
+        tb_disconnect (i);
+    }
+sim_printf ("lines   idle usec/poll   1 active: usec/char polls/char\n");
+for (nlines = 1; nlines <= TB_LINES; nlines *= 2) {
+    for (i = 0; i < nlines; i++) {
+        if ((tb_client[i] == INVALID_SOCKET) && (tb_connect (i) < 0))
+            return sim_messagef (SCPE_OPENERR, "can't connect client %d\n", i);
+        }
+    start = tb_usec ();
+    for (n = 0; n < polls; n++)
+        tmxr_poll_rx (&tb_desc);
+    idle = (tb_usec () - start) / polls;
+    rxpolls = 0;
+    start = tb_usec ();
+    for (n = 0; n < chars; n++) {
+        sim_write_sock (tb_client[n % nlines], &ch, 1);
+        if (tb_receive (tb_line[n % nlines], &rxpolls, &errors) != ch)
+            ++errors;
+        }
+    active = (tb_usec () - start) / chars;
+    sim_printf ("%5d %18.3f %20.3f %10.2f\n", nlines, idle, active, (double)rxpolls / chars);
+    }
+if (errors)
+    return sim_messagef (SCPE_IERR, "%d characters lost or misrouted\n", errors);
+return SCPE_OK;
+}
+
+/* Transmit receiver: read what client 0 has and check it against the
+   pattern; framed streams have a 2 byte length before every packet */
+
+typedef struct {
+    t_bool      framed;
+    uint32      bytes;                                  /* data bytes checked */
+    uint32      offset;                                 /* position in frame */
+    uint32      errors;
+    } TB_RX;
+
+static void tb_drain (TB_RX *rx)
+{
+static char buf[65536];
+int32 n, i;
+uint8 want;
+
+while ((n = sim_read_sock (tb_client[0], buf, sizeof (buf))) > 0) {
+    for (i = 0; i < n; i++) {
+        if (rx->framed && (rx->offset < 2))
+            want = (rx->offset ? TB_PACKET : (TB_PACKET >> 8)) & 0xFF;
+        else
+            want = (rx->bytes++) % TB_PATTERN;
+        if (rx->framed)
+            rx->offset = (rx->offset + 1) % (TB_PACKET + 2);
+        if (((uint8)buf[i] != want) && (rx->errors++ < 10))
+            sim_printf ("data byte %u: received %02X, expected %02X\n", rx->bytes, buf[i] & 0xFF, want);
+        }
+    }
+}
+
+t_stat tb_txbench_cmd (int32 flag, CONST char *cptr)
+{
+static const char *modes[] = { "tmxr_putc_ln", "tmxr_put_buf_ln", "tmxr_put_packet_ln" };
+static uint8 pattern[TB_PATTERN + TB_PACKET];
+TMLN *lp;
+TB_RX rx;
+int32 mode, total, sent, count, i;
+uint32 stalls, start_ms;
+double start, usec;
+t_bool running = sim_is_running;
+t_stat r = SCPE_OK;
+
+total = tb_arg (&cptr, 16384, 0x1FFFFF, &r);
+if (r != SCPE_OK)
+    return r;
+if (!(tb_unit.flags & UNIT_ATT))
+    return SCPE_UNATT;
+total *= 1024;
+if ((tb_client[0] == INVALID_SOCKET) && (tb_connect (0) < 0))
+    return sim_messagef (SCPE_OPENERR, "can't connect client 0\n");
+lp = &tb_ldsc[tb_line[0]];
+sim_os_ms_sleep (100);
+while (sim_read_sock (tb_client[0], (char *)pattern, sizeof (pattern)) > 0)
+    ;                                                   /* discard connect messages */
+for (i = 0; i < (int32)sizeof (pattern); i++)
+    pattern[i] = i % TB_PATTERN;
+sim_is_running = TRUE;                                  /* as output from a running simulator */
+sim_printf ("transmit             MB/s   stalls\n");
+for (mode = 0; mode < 3; mode++) {
+    memset (&rx, 0, sizeof (rx));
+    rx.framed = (mode == 2);
+    stalls = 0;
+    start = tb_usec ();
+    for (sent = 0; (sent < total) && lp->conn; ) {
+        switch (mode) {
+            case 0:
+                r = tmxr_putc_ln (lp, pattern[sent % TB_PATTERN]);
+                count = (r == SCPE_OK);
+                break;
+            case 1:
+                r = tmxr_put_buf_ln (lp, &pattern[sent % TB_PATTERN], ((total - sent < TB_CHUNK) ? total - sent : TB_CHUNK), &count);
+                break;
+            default:
+                r = tmxr_put_packet_ln (lp, &pattern[sent % TB_PATTERN], TB_PACKET);
+                count = (r == SCPE_OK) ? TB_PACKET : 0;
+                break;
+            }
+        sent += count;
+        if (r != SCPE_OK) {                             /* full, let the line and client catch up */
+            ++stalls;
+            tmxr_poll_tx (&tb_desc);
+            tb_drain (&rx);
+            }
+        }
+    start_ms = sim_os_msec ();
+    while ((rx.bytes < (uint32)sent) && lp->conn &&
+           ((sim_os_msec () - start_ms) < TB_CONNWAIT)) {
+        tmxr_poll_tx (&tb_desc);
+        tb_drain (&rx);
+        }
+    usec = tb_usec () - start;
+    if ((rx.bytes != (uint32)total) && (rx.errors++ < 10))
+        sim_printf ("%s: %u of %d bytes arrived\n", modes[mode], rx.bytes, total);
+    sim_printf ("%-18s %8.1f %8u\n", modes[mode], total / usec, stalls);
+    if (rx.errors) {
+        sim_is_running = running;
+        return sim_messagef (SCPE_IERR, "%s: %u errors\n", modes[mode], rx.errors);
+        }
+    }
+sim_is_running = running;
+return SCPE_OK;
+}
@@ -40,6 +40,13 @@ in this Software without prior written authorization from the author.
 #if defined(HAVE_LIBPNG)
 #include <png.h>
 #endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define VID_DECAY_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VID_DECAY_NEON
+#endif
 // Global video system flgs/variables
 
 uint32 vid_mono_palette[2];                         /* Monochrome Color Map */
@@ -51,6 +58,166 @@ int nostore=0;							            /* Enables storage display. Always defined. */
 char vid_release_key[64] = "Ctrl-Right-Shift";
 
 
+/*	Phosphor decay.
+
+Every Refresh() cycle each colour byte v of a pixel becomes (unsigned char)(v * colmap[c] - 1), zero stays zero.
+This is precomputed per channel in decay_lut. The vector kernels evaluate the same function as a saturating
+((v * decay_mul[c]) >> 16) - 1, on 16 pixels per step. vid_decay_setup picks each 16 bit fixed point multiplier
+next to colmap[c] * 65536 that reproduces decay_lut exactly for all 256 values, so all kernels give identical
+images. If there is no such multiplier (not the case for any phosphor in display.c) the byte tables are used.
+The alpha byte is left alone.
+
+The surface is divided in VID_TILE x VID_TILE pixel tiles. vid_setpixel and vid_draw set a tile's byte in the
+dirty map, vid_decay skips clean tiles and clears the byte of a tile that has faded to black. The byte is cleared
+before the tile is decayed and set again if something is left, so a pixel drawn concurrently by the simulator
+thread is never lost.
+*/
+
+static uint8 decay_lut[4][256];                         /* new value by channel and old value */
+static uint16 decay_mul[4];                             /* fixed point fade constants, alpha 0 */
+static t_bool decay_vec = FALSE;                        /* vector kernel usable */
+static const double *decay_map = NULL;                  /* constants decay_lut was built for */
+
+t_bool vid_decay_setup (const double *map)
+{
+    int c, v, i;
+    double x;
+    uint32 m;
+
+    decay_map = map;
+    decay_vec = TRUE;
+    for (v = 0; v < 256; v++)
+        decay_lut[3][v] = (uint8)v;
+    decay_mul[3] = 0;
+    for (c = 0; c < 3; c++) {
+        decay_lut[c][0] = 0;
+        for (v = 1; v < 256; v++) {
+            x = v * map[c] - 1;
+            decay_lut[c][v] = (x <= 0) ? 0 : ((x >= 255) ? 255 : (uint8)x);
+        }
+        m = (uint32)(map[c] * 65536.0);
+        for (i = 0; i < 5; i++) {                       /* m-2 .. m+2 */
+            uint32 t = m + i - 2;
+
+            if ((t > 0xFFFF) || (m + i < 2))
+                continue;
+            for (v = 1; v < 256; v++)
+                if ((((v * t) >> 16) ? ((v * t) >> 16) - 1 : 0) != decay_lut[c][v])
+                    break;
+            if (v == 256)
+                break;
+        }
+        if (i == 5)
+            decay_vec = FALSE;                          /* no exact multiplier, byte tables */
+        else
+            decay_mul[c] = (uint16)(m + i - 2);
+    }
+#if defined(VID_DECAY_SSE2) || defined(VID_DECAY_NEON)
+    return decay_vec;
+#else
+    return decay_vec = FALSE;
+#endif
+}
+
+/* Decay n pixels at p, returns nonzero if any colour byte is still lit */
+
+static uint32 decay_span (uint8 *p, int32 n)
+{
+    uint32 lit = 0;
+    int32 i = 0;
+
+#if defined(VID_DECAY_SSE2)
+    if (decay_vec) {
+        const __m128i zero = _mm_setzero_si128 ();
+        const __m128i mul = _mm_set_epi16 (0, decay_mul[2], decay_mul[1], decay_mul[0],
+                                           0, decay_mul[2], decay_mul[1], decay_mul[0]);
+        const __m128i one = _mm_set1_epi32 (0x00010101);
+        const __m128i amask = _mm_set1_epi32 ((int)0xFF000000);
+        __m128i acc = zero;
+
+        for (; i + 8 <= n; i += 8, p += 32) {           /* 2 x 4 pixels */
+            __m128i a = _mm_loadu_si128 ((__m128i *)p);
+            __m128i b = _mm_loadu_si128 ((__m128i *)(p + 16));
+            __m128i ra = _mm_packus_epi16 (_mm_mulhi_epu16 (_mm_unpacklo_epi8 (a, zero), mul),
+                                           _mm_mulhi_epu16 (_mm_unpackhi_epi8 (a, zero), mul));
+            __m128i rb = _mm_packus_epi16 (_mm_mulhi_epu16 (_mm_unpacklo_epi8 (b, zero), mul),
+                                           _mm_mulhi_epu16 (_mm_unpackhi_epi8 (b, zero), mul));
+
+            ra = _mm_subs_epu8 (ra, one);
+            rb = _mm_subs_epu8 (rb, one);
+            acc = _mm_or_si128 (acc, _mm_or_si128 (ra, rb));
+            _mm_storeu_si128 ((__m128i *)p, _mm_or_si128 (ra, _mm_and_si128 (a, amask)));
+            _mm_storeu_si128 ((__m128i *)(p + 16), _mm_or_si128 (rb, _mm_and_si128 (b, amask)));
+        }
+        lit = (_mm_movemask_epi8 (_mm_cmpeq_epi8 (acc, zero)) != 0xFFFF);
+    }
+#elif defined(VID_DECAY_NEON)
+    if (decay_vec) {
+        const uint8x16_t one = vdupq_n_u8 (1);
+        uint8x16_t acc = vdupq_n_u8 (0);
+        uint64x2_t any;
+        int c;
+
+        for (; i + 16 <= n; i += 16, p += 64) {         /* 16 pixels, one plane per channel */
+            uint8x16x4_t px = vld4q_u8 (p);
+
+            for (c = 0; c < 3; c++) {
+                uint16x8_t lo = vmovl_u8 (vget_low_u8 (px.val[c]));
+                uint16x8_t hi = vmovl_u8 (vget_high_u8 (px.val[c]));
+                uint16x8_t rlo = vcombine_u16 (vshrn_n_u32 (vmull_n_u16 (vget_low_u16 (lo), decay_mul[c]), 16),
+                                               vshrn_n_u32 (vmull_n_u16 (vget_high_u16 (lo), decay_mul[c]), 16));
+                uint16x8_t rhi = vcombine_u16 (vshrn_n_u32 (vmull_n_u16 (vget_low_u16 (hi), decay_mul[c]), 16),
+                                               vshrn_n_u32 (vmull_n_u16 (vget_high_u16 (hi), decay_mul[c]), 16));
+
+                px.val[c] = vqsubq_u8 (vcombine_u8 (vmovn_u16 (rlo), vmovn_u16 (rhi)), one);
+                acc = vorrq_u8 (acc, px.val[c]);
+            }
+            vst4q_u8 (p, px);
+        }
+        any = vreinterpretq_u64_u8 (acc);
+        lit = ((vgetq_lane_u64 (any, 0) | vgetq_lane_u64 (any, 1)) != 0);
+    }
+#endif
+    for (; i < n; i++, p += 4) {
+        p[0] = decay_lut[0][p[0]];
+        p[1] = decay_lut[1][p[1]];
+        p[2] = decay_lut[2][p[2]];
+        lit |= p[0] | p[1] | p[2];
+    }
+    return lit;
+}
+
+/* Decay a w x h pixel 32 bit surface. With dirty == NULL all of it, else only the tiles marked in dirty,
+   VID_TILES(w) bytes per tile row. */
+
+void vid_decay (uint8 *buf, int32 pitch, int32 w, int32 h, uint8 *dirty)
+{
+    int32 tx, ty, y, ye, x, n, tw = VID_TILES (w);
+    uint32 lit;
+
+    if (dirty == NULL) {
+        for (y = 0; y < h; y++)
+            decay_span (buf + y * pitch, w);
+        return;
+    }
+    for (ty = 0; ty < VID_TILES (h); ty++, dirty += tw) {
+        y = ty << VID_TILE_SHIFT;
+        ye = (y + VID_TILE < h) ? y + VID_TILE : h;
+        for (tx = 0; tx < tw; tx++) {
+            if (!dirty[tx])
+                continue;
+            dirty[tx] = 0;
+            x = tx << VID_TILE_SHIFT;
+            n = (x + VID_TILE < w) ? VID_TILE : w - x;
+            for (lit = 0; y < ye; y++)
+                lit |= decay_span (buf + y * pitch + x * 4, n);
+            y = ty << VID_TILE_SHIFT;
+            if (lit)
+                dirty[tx] = 1;
+        }
+    }
+}
+
 // Only include SDL code if specified. See end of this module for stubbed code.
 
 #if defined(USE_SIM_VIDEO) && defined(HAVE_LIBSDL)
@@ -73,6 +240,8 @@ static int screen_num,xloc,yloc;
 static uint32 lstst=0,lstcd=0;
 static unsigned char *pixels;
 static int pitch,surlen;
+static uint8 *tiles = NULL;                         /* decay dirty map, see vid_decay */
+static int tiles_x, tiles_size = 0;
 SIM_MOUSE_EVENT *xmev = 0,*xhev = 0;
 SIM_KEY_EVENT *xkev = 0;
 static enum vid_stat{STOPPED,WINDOW_OK,RUNNING,CLOSING,CLOSED}vid_init;
@@ -478,7 +647,14 @@ t_stat vid_create_window(void)
     }
 
     pixels = (unsigned char *)surface->pixels;
-    surlen = (init_h * surface->pitch);
+    pitch = surface->pitch;
+    surlen = (init_h * pitch);
+    tiles_x = VID_TILES(init_w);
+    if (tiles_size < tiles_x * VID_TILES(init_h)) {       // Kept for the next window, Refresh of this one may still run
+        tiles_size = tiles_x * VID_TILES(init_h);
+        tiles = (uint8 *)realloc(tiles, tiles_size);
+    }
+    memset(tiles, 1, tiles_size);
     SDL_UpdateWindowSurface(window);
     SDL_CreateThread(Refresh,"Refresh",(void *)NULL);
     if (!(init_flags & SIM_VID_INPUTCAPTURED))
@@ -620,6 +796,7 @@ t_stat vid_set_cursor (t_bool visible, uint32 width, uint32 height, uint8 *data,
 t_stat vid_erase_win()
 {
     memset(surface->pixels, 0, init_w * init_h * 4);
+    memset(tiles, 0, tiles_size);
     SDL_UpdateWindowSurface(window);				/* Write black surface to the host system window */
     return 0;
 }
@@ -641,6 +818,8 @@ void vid_draw (int32 x, int32 y, int32 w, int32 h, uint32 *buf)
     pixels = (uint32 *)surface->pixels;
     for (i = 0; i < h; i++)
         memcpy (pixels + ((i + y) * init_w) + x, buf + w*i, w*sizeof(*pixels));
+    for (i = y >> VID_TILE_SHIFT; i <= (y + h - 1) >> VID_TILE_SHIFT; i++)
+        memset (tiles + i * tiles_x + (x >> VID_TILE_SHIFT), 1, ((x + w - 1) >> VID_TILE_SHIFT) - (x >> VID_TILE_SHIFT) + 1);
 
     return;
 }
@@ -650,8 +829,9 @@ The function is central to all display system. Firstly, the current surface (eff
 is copied to the screen surface by SDL_UpdateWindowSurface. This function (hopefully) calls a GPU
 bitblt process and with modern hardware is extremely fast (1 mS.).
 The next section su responsible for gradually fading the image in the window. This is achieved using an RGB time
-constant sequence in colmap such that the phosphor fade constant for each color can be different. This loop is also very fast
-typically 10-15 mS. on recent X86 family processors clocked at >1.5 GHz. The final part of the loop ensure that the
+constant sequence in colmap such that the phosphor fade constant for each color can be different. The fade is done by vid_decay
+with SSE2/NEON and only on the tiles that are not black yet, a fraction of a mS. for a VT11 frame (see sim_video_bench.c).
+It used to take 10-15 mS. with a double multiply per byte, and much longer on a Raspberry Pi. The final part of the loop ensure that the
 entire cycle takes almost 20 mS. with due allowance for scheduling  etc. In this case, the fade constants can be preset and
 no matter what is on screen, the fading will be constant.
 As the fade constants are set by color, some interesting effects can be obtained. See display.c for examples where the pixels
@@ -662,10 +842,6 @@ The nostore function can also be used for a storage scope display eg the Tektron
 */
 
 static int Refresh(void *info) {
-    int i,j;
-    unsigned char *p;
-    double *d;
-
     while (window && vid_init != STOPPED) {
         told=sim_os_msec();
 
@@ -673,11 +849,11 @@ static int Refresh(void *info) {
 
             SDL_UpdateWindowSurface(window);				// Write the surface to the host system window
 
-            if (!nostore && sim_is_running)                 // Only decay the pixels in store mode and if the simulator is running
-                for (i = 0,p=(unsigned char *)pixels;i < surlen/4; i++, p++)
-                    for (j = 0,d = colmap;j < 3;j++, p++, d++)
-                        if (*p)
-                            *p = (unsigned char)(*p * (*d) - 1);	// Decay none zero pixels only
+            if (!nostore && sim_is_running) {               // Only decay the pixels in store mode and if the simulator is running
+                if (colmap != decay_map)
+                    vid_decay_setup(colmap);
+                vid_decay(pixels, pitch, init_w, init_h, tiles);
+            }
         }
 
         tnew = sim_os_msec();
@@ -831,10 +1007,72 @@ t_stat vid_setpixel(int ix,int iy,int level,int color) {
     if (vid_init == RUNNING) {
         p=(Uint32 *)(pixels + (iy * surface->pitch) + (ix * sizeof(Uint32)));
         *p = pxval;
+        tiles[((iy >> VID_TILE_SHIFT) * tiles_x) + (ix >> VID_TILE_SHIFT)] = 1;
     }
     return SCPE_OK;
 }
 
+/*
+Batched versions of vid_setpixel for the vector displays (see display_points and display_vector in display.c).
+vid_setpixels draws n points given as x,y pairs. vid_line draws a vector with both ends included using
+Bresenham's algorithm, stepping a pointer through the surface. The caller makes sure that all points, or
+both ends of the vector, lie in the window.
+*/
+
+void vid_setpixels(const int32 *xy, int32 n) {
+    Uint32 *p = (Uint32 *)pixels;
+    int32 w = pitch / sizeof(Uint32);
+
+    if (vid_init != RUNNING)
+        return;
+    for (; n > 0; n--, xy += 2) {
+        p[(xy[1] * w) + xy[0]] = pxval;
+        tiles[((xy[1] >> VID_TILE_SHIFT) * tiles_x) + (xy[0] >> VID_TILE_SHIFT)] = 1;
+    }
+}
+
+void vid_line(int32 x0, int32 y0, int32 x1, int32 y1) {
+    Uint32 *p, v = pxval;
+    int32 dx = abs(x1 - x0), dy = abs(y1 - y0);
+    int32 sx = (x1 < x0) ? -1 : 1, sy = (y1 < y0) ? -1 : 1;
+    int32 py = sy * (int32)(pitch / sizeof(Uint32));    // Pointer step for one row up/down
+    int32 e, n;
+
+    if (vid_init != RUNNING)
+        return;
+    p = (Uint32 *)(pixels + (y0 * pitch)) + x0;
+    if (dx >= dy) {                                     // X major
+        e = 2 * dy - dx;
+        for (n = dx; n >= 0; n--) {
+            *p = v;
+            tiles[((y0 >> VID_TILE_SHIFT) * tiles_x) + (x0 >> VID_TILE_SHIFT)] = 1;
+            if (e >= 0) {
+                p += py;
+                y0 += sy;
+                e -= 2 * dx;
+            }
+            e += 2 * dy;
+            p += sx;
+            x0 += sx;
+        }
+    }
+    else {                                              // Y major
+        e = 2 * dx - dy;
+        for (n = dy; n >= 0; n--) {
+            *p = v;
+            tiles[((y0 >> VID_TILE_SHIFT) * tiles_x) + (x0 >> VID_TILE_SHIFT)] = 1;
+            if (e >= 0) {
+                p += sx;
+                x0 += sx;
+                e -= 2 * dy;
+            }
+            e += 2 * dx;
+            p += py;
+            y0 += sy;
+        }
+    }
+}
+
 t_stat vid_lock_cursor()
 {
     SDL_ShowCursor(SDL_DISABLE);		   /* Make host OS cursor invisible in non-capture/default mode */
@@ -1329,6 +1567,16 @@ t_stat vid_setpixel(ix, iy, level, color)
     return SCPE_NOFNC;
 }
 
+void vid_setpixels(const int32 *xy, int32 n)
+{
+    return;
+}
+
+void vid_line(int32 x0, int32 y0, int32 x1, int32 y1)
+{
+    return;
+}
+
 t_stat vid_set_cursor (t_bool visible, uint32 width, uint32 height, uint8 *data, uint8 *mask, uint32 hot_x, uint32 hot_y)
 {
     return SCPE_NOFNC;
@@ -192,6 +192,8 @@ t_stat vid_show (FILE* st, DEVICE *dptr,  UNIT* uptr, int32 val, CONST char* des
 t_stat vid_screenshot (const char *filename);
 t_stat vid_open (DEVICE *dptr, const char *title, uint32 width, uint32 height, int flags);
 t_stat vid_setpixel(int ix,int iy,int level,int color);
+void vid_setpixels(const int32 *xy, int32 n);
+void vid_line(int32 x0, int32 y0, int32 x1, int32 y1);
 t_stat vid_erase_win();
 int vid_map_key (int key);
 t_stat vid_set_release_key (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
@@ -199,6 +201,12 @@ t_stat vid_show_release_key (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat vid_lock_cursor(void);
 t_stat vid_unlock_cursor(void);
 
+#define VID_TILE_SHIFT      5                           /* phosphor decay tiles, 32x32 pixels */
+#define VID_TILE            (1 << VID_TILE_SHIFT)
+#define VID_TILES(n)        (((n) + VID_TILE - 1) >> VID_TILE_SHIFT)
+t_bool vid_decay_setup (const double *map);
+void vid_decay (uint8 *buf, int32 pitch, int32 w, int32 h, uint8 *dirty);
+
 extern uint32 vid_mono_palette[2];
 void vid_set_cursor_position (int32 x, int32 y);        /* cursor position (set by calling code) */
 
@@ -0,0 +1,352 @@
+/* sim_video_bench.c: phosphor decay benchmark and consistency test
+
+   Copyright (c) 2026, BlinkenBone contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   Runs the Refresh() phosphor decay of sim_video.c without a window, on a
+   plain 32 bit surface buffer.  Build with  make -f quickmake sim_video_bench
+   On a Raspberry Pi 2/3 running 32 bit code add CC_DEFS=-mfpu=neon for the
+   NEON kernel, x86-64 and AArch64 have SSE2/NEON by default.
+
+   Commands, for example  printf "vverify\nvbench\nexit\n" | ./sim_video_bench
+
+   VVERIFY {frames}     for each phosphor of display/display.c, decays a
+                        surface of random pixels with random pixels drawn
+                        into it between frames, with the former double
+                        precision loop, with vid_decay on the whole surface
+                        and with vid_decay on the dirty tiles, and compares
+                        the three images after every frame.  Default 200.
+   VBENCH {frames}      ms per decay frame on a 1024 x 1024 VR17 surface,
+                        green P29 phosphor, for a Lunar Lander like frame
+                        (terrain, lander, instrument text, redrawn every
+                        frame) and for a blank screen.  Default 500.
+*/
+
+#include "sim_defs.h"
+#include "sim_video.h"
+#include <time.h>
+
+#define VB_W            1024                            /* VR17 */
+#define VB_H            1024
+#define VB_WARMUP       150                             /* frames until the trails are steady */
+
+#define VB_REF          0                               /* former double loop */
+#define VB_FULL         1                               /* vid_decay, whole surface */
+#define VB_TILES        2                               /* vid_decay, dirty tiles */
+
+typedef struct {
+    const char          *name;
+    double              colr[3];
+    uint32              level;
+    } VBPHOS;
+
+static const VBPHOS vb_phos[] = {                       /* as display/display.c */
+    { "P17", { 0.8, 0.998, 0.8 },  0x8080ff },
+    { "P29", { 0.0, 0.8,   0.0 },  0xff00 },
+    { "P40", { 0.8, 0.98,  0.98 }, 0xb0b0ff },
+    { "red", { 0.0, 0.9,   0.9 },  0xffff00 },
+    { NULL }
+    };
+
+t_stat vb_svc (UNIT *uptr);
+t_stat vb_verify_cmd (int32 flag, CONST char *cptr);
+t_stat vb_bench_cmd (int32 flag, CONST char *cptr);
+
+static UNIT vb_unit = { UDATA (&vb_svc, 0, 0) };
+static uint8 *vb_buf[3];                                /* surfaces by method */
+static uint8 *vb_dirty[3];
+static int32 vb_w, vb_h, vb_pitch;
+static uint32 vb_level;
+
+DEVICE vb_dev = {
+    "VB", &vb_unit, NULL, NULL,
+    1, 10, 31, 1, 16, 16,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, 0
+    };
+
+/* Simulator interface */
+
+char sim_name[64] = "Video bench";
+REG *sim_PC = NULL;
+int32 sim_emax = 1;
+DEVICE *sim_devices[] = { &vb_dev, NULL };
+const char *sim_stop_messages[SCPE_BASE] = { "Unknown error" };
+
+static CTAB vb_cmd[] = {
+    { "VVERIFY", &vb_verify_cmd, 0, "vverify {frames}     compare decay kernels with the double loop\n" },
+    { "VBENCH",  &vb_bench_cmd,  0, "vbench {frames}      decay timing, Lunar Lander and blank frames\n" },
+    { NULL }
+    };
+
+static void vb_init (void)
+{
+sim_vm_cmd = vb_cmd;
+}
+
+void (*sim_vm_init) (void) = &vb_init;
+
+t_stat sim_instr (void)
+{
+return SCPE_NOFNC;
+}
+
+t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+{
+return SCPE_NOFNC;
+}
+
+t_stat fprint_sym (FILE *of, t_addr addr, t_value *val, UNIT *uptr, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat parse_sym (CONST char *cptr, t_addr addr, UNIT *uptr, t_value *val, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat vb_svc (UNIT *uptr)
+{
+return SCPE_OK;
+}
+
+static double vb_usec (void)
+{
+struct timespec ts;
+
+clock_gettime (CLOCK_MONOTONIC, &ts);
+return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static uint32 vb_random (uint32 *seed)
+{
+uint32 x = *seed;
+
+x ^= x << 13;
+x ^= x >> 17;
+x ^= x << 5;
+return *seed = x;
+}
+
+static int32 vb_arg (CONST char **cptr, int32 dflt, int32 max, t_stat *r)
+{
+char gbuf[CBUFSIZE];
+int32 val;
+
+*cptr = get_glyph (*cptr, gbuf, 0);
+if (gbuf[0] == 0)
+    return dflt;
+val = (int32) get_uint (gbuf, 10, max, r);
+if ((*r == SCPE_OK) && (val == 0))
+    *r = SCPE_ARG;
+return val;
+}
+
+/* Surfaces of w x h pixels, pitch rounded up like SDL may do */
+
+static t_stat vb_alloc (int32 w, int32 h, int32 pitch)
+{
+int m;
+
+vb_w = w;
+vb_h = h;
+vb_pitch = pitch;
+for (m = 0; m < 3; m++) {
+    free (vb_buf[m]);
+    free (vb_dirty[m]);
+    vb_buf[m] = (uint8 *) calloc (h, pitch);
+    vb_dirty[m] = (uint8 *) malloc (VID_TILES (w) * VID_TILES (h));
+    if ((vb_buf[m] == NULL) || (vb_dirty[m] == NULL))
+        return SCPE_MEM;
+    memset (vb_dirty[m], 1, VID_TILES (w) * VID_TILES (h));
+    }
+return SCPE_OK;
+}
+
+/* What vid_setpixel does, on all surfaces */
+
+static void vb_setpixel (int32 x, int32 y, uint32 val)
+{
+int m;
+
+if ((x < 0) || (x >= vb_w) || (y < 0) || (y >= vb_h))
+    return;
+for (m = 0; m < 3; m++) {
+    *(uint32 *)(vb_buf[m] + y * vb_pitch + x * 4) = val;
+    vb_dirty[m][(y >> VID_TILE_SHIFT) * VID_TILES (vb_w) + (x >> VID_TILE_SHIFT)] = 1;
+    }
+}
+
+static void vb_line (int32 x0, int32 y0, int32 x1, int32 y1)
+{
+int32 i, n = abs (x1 - x0);
+
+if (abs (y1 - y0) > n)
+    n = abs (y1 - y0);
+for (i = 0; i <= n; i++)
+    vb_setpixel (x0 + (n ? (x1 - x0) * i / n : 0), y0 + (n ? (y1 - y0) * i / n : 0), vb_level);
+}
+
+/* The Refresh() loop before vid_decay, with a defined result for a zero constant */
+
+static void vb_decay_ref (const double *map)
+{
+int32 x, y, c;
+uint8 *p;
+double v;
+
+for (y = 0; y < vb_h; y++)
+    for (x = 0, p = vb_buf[VB_REF] + y * vb_pitch; x < vb_w; x++, p++)
+        for (c = 0; c < 3; c++, p++)
+            if (*p) {
+                v = *p * map[c] - 1;
+                *p = (v <= 0) ? 0 : (unsigned char) v;
+                }
+}
+
+static void vb_decay (int m, const double *map)
+{
+if (m == VB_REF)
+    vb_decay_ref (map);
+else vid_decay (vb_buf[m], vb_pitch, vb_w, vb_h, (m == VB_TILES) ? vb_dirty[m] : NULL);
+}
+
+t_stat vb_verify_cmd (int32 flag, CONST char *cptr)
+{
+int32 frames, f, i, errors = 0;
+uint32 seed = 4711;
+const VBPHOS *ph;
+t_stat r = SCPE_OK;
+int m;
+
+frames = vb_arg (&cptr, 200, 100000, &r);
+if (r != SCPE_OK)
+    return r;
+for (ph = vb_phos; ph->name; ph++) {
+    sim_printf ("%-4s %s kernel\n", ph->name, vid_decay_setup (ph->colr) ? "vector" : "table");
+    r = vb_alloc (1000, 700, 1008 * 4);                 /* partial tiles and vectors */
+    if (r != SCPE_OK)
+        return r;
+    for (i = 0; i < vb_h * vb_pitch; i++)
+        vb_buf[VB_REF][i] = (uint8) vb_random (&seed);
+    memcpy (vb_buf[VB_FULL], vb_buf[VB_REF], vb_h * vb_pitch);
+    memcpy (vb_buf[VB_TILES], vb_buf[VB_REF], vb_h * vb_pitch);
+    for (f = 0; f < frames; f++) {
+        for (i = 0; i < 200; i++)
+            vb_setpixel (vb_random (&seed) % vb_w, vb_random (&seed) % vb_h,
+                         (f & 1) ? ph->level : vb_random (&seed));
+        for (m = 0; m < 3; m++)
+            vb_decay (m, ph->colr);
+        for (m = VB_FULL; m <= VB_TILES; m++)
+            if (memcmp (vb_buf[VB_REF], vb_buf[m], vb_h * vb_pitch)) {
+                if (errors++ < 10)
+                    sim_printf ("%s frame %d: %s differs\n", ph->name, f,
+                                (m == VB_FULL) ? "whole surface" : "dirty tiles");
+                }
+        }
+    }
+sim_printf ("%d frames per phosphor, %d errors\n", frames, errors);
+return SCPE_OK;
+}
+
+/* Lunar Lander like frame: terrain across the screen, the lander drifting
+   down with its flame, and the instrument text along the top */
+
+static void vb_lander (int32 f)
+{
+static int32 terrain[65];
+uint32 seed = 1969;
+int32 i, j, x, y, cx, cy;
+
+if (terrain[0] == 0)
+    for (i = 0; i <= 64; i++)
+        terrain[i] = 100 + vb_random (&seed) % 250;
+for (i = 0; i < 64; i++)
+    vb_line (i * 16, terrain[i], i * 16 + 16, terrain[i + 1]);
+x = 300 + (f % 400);
+y = 900 - (f % 500);
+vb_line (x - 20, y, x + 20, y);                         /* body */
+vb_line (x + 20, y, x + 20, y + 30);
+vb_line (x + 20, y + 30, x - 20, y + 30);
+vb_line (x - 20, y + 30, x - 20, y);
+vb_line (x - 12, y + 30, x - 6, y + 45);                /* cabin */
+vb_line (x - 6, y + 45, x + 6, y + 45);
+vb_line (x + 6, y + 45, x + 12, y + 30);
+vb_line (x - 20, y, x - 32, y - 25);                    /* legs */
+vb_line (x + 20, y, x + 32, y - 25);
+vb_line (x - 38, y - 25, x - 26, y - 25);
+vb_line (x + 26, y - 25, x + 38, y - 25);
+if (f & 2) {                                            /* flame */
+    vb_line (x - 8, y, x, y - 40 - (f % 7) * 3);
+    vb_line (x + 8, y, x, y - 40 - (f % 7) * 3);
+    }
+seed = 747;
+for (i = 0; i < 6; i++)                                 /* 6 lines of 40 characters */
+    for (j = 0; j < 40; j++) {
+        cx = 40 + j * 24;
+        cy = 980 - i * 24;
+        vb_line (cx + vb_random (&seed) % 12, cy + vb_random (&seed) % 16,
+                 cx + vb_random (&seed) % 12, cy + vb_random (&seed) % 16);
+        vb_line (cx + vb_random (&seed) % 12, cy + vb_random (&seed) % 16,
+                 cx + vb_random (&seed) % 12, cy + vb_random (&seed) % 16);
+        vb_line (cx + vb_random (&seed) % 12, cy + vb_random (&seed) % 16,
+                 cx + vb_random (&seed) % 12, cy + vb_random (&seed) % 16);
+        }
+}
+
+static void vb_bench (const char *what, int32 frames, t_bool lander, const double *map)
+{
+static const char *mname[3] = { "double loop", "vid_decay, all", "vid_decay, tiles" };
+double usec[3] = { 0, 0, 0 }, start;
+int32 f, m, lit;
+
+vb_alloc (VB_W, VB_H, VB_W * 4);
+for (f = 0; f < VB_WARMUP + frames; f++) {
+    if (lander)
+        vb_lander (f);
+    for (m = 0; m < 3; m++) {
+        start = vb_usec ();
+        vb_decay (m, map);
+        if (f >= VB_WARMUP)
+            usec[m] += vb_usec () - start;
+        }
+    }
+for (f = lit = 0; f < VID_TILES (VB_W) * VID_TILES (VB_H); f++)
+    lit += vb_dirty[VB_TILES][f];
+for (m = 0; m < 3; m++)
+    sim_printf ("%-8s %-17s %8.3f ms/frame\n", what, mname[m], usec[m] / frames / 1000.0);
+sim_printf ("%-8s %d of %d tiles lit\n", what, lit, VID_TILES (VB_W) * VID_TILES (VB_H));
+}
+
+t_stat vb_bench_cmd (int32 flag, CONST char *cptr)
+{
+int32 frames;
+t_stat r = SCPE_OK;
+
+frames = vb_arg (&cptr, 500, 1000000, &r);
+if (r != SCPE_OK)
+    return r;
+vb_level = vb_phos[1].level;
+sim_printf ("P29 %s kernel, %d frames\n", vid_decay_setup (vb_phos[1].colr) ? "vector" : "table", frames);
+vb_bench ("lander", frames, TRUE, vb_phos[1].colr);
+vb_bench ("blank", frames, FALSE, vb_phos[1].colr);
+return SCPE_OK;
+}
@@ -42,6 +42,11 @@
 
 #include "blinkenlight_panels.h" /* internal panels&controls data base */
 #include "blinkenlight_api_client.h"
+#include "blinkenlight_api_shm.h"
+
+static void blinkenlight_api_client_shm_detach(blinkenlight_api_client_t *_this);
+static void blinkenlight_api_client_shm_detach_panel(blinkenlight_api_client_t *_this,
+		blinkenlight_panel_t *p);
 
 /*
  *  constructor for client object
@@ -55,6 +60,8 @@ blinkenlight_api_client_t *blinkenlight_api_client_constructor(void)
 	_this->connected = 0;
 	_this->rpc_server_hostname = NULL;
 	_this->rpc_client = NULL;
+	_this->exchange_unsupported = 0;
+	_this->delta_unsupported = 0;
 	_this->panel_list = blinkenlight_panels_constructor();
 	strcpy(_this->error_text, "");
 	_this->error_file = NULL;
@@ -124,6 +131,8 @@ blinkenlight_api_status_t blinkenlight_api_client_connect(blinkenlight_api_clien
 
 	blinkenlight_panels_clear(_this->panel_list);
 
+	_this->exchange_unsupported = 0; // try EXCHANGEPANEL_CONTROLVALUES on first service
+	_this->delta_unsupported = 0; // ... and EXCHANGEPANEL_CONTROLVALUES_DELTA
 	_this->connected = 1;
 	return 0; // OK
 }
@@ -138,6 +147,7 @@ blinkenlight_api_status_t blinkenlight_api_client_disconnect(blinkenlight_api_cl
 		return 1; // error
 	}
 
+	blinkenlight_api_client_shm_detach(_this);
 	_this->connected = 0;
 #ifdef WIN32
 	rpc_nt_exit();
@@ -176,6 +186,60 @@ blinkenlight_api_status_t blinkenlight_api_client_get_serverinfo(blinkenlight_ap
 	return 0; // OK
 }
 
+/*
+ * Shared memory transport: if server runs on the same host,
+ * exchange_controls_values() uses the server's shared memory segment
+ * for the panel instead of RPC calls.
+ * Server publishes a token for the segment, which must match.
+ * Older or remote servers: panel remains on RPC.
+ */
+static void blinkenlight_api_client_shm_attach(blinkenlight_api_client_t *_this,
+		blinkenlight_panel_t *p)
+{
+	unsigned token;
+	blinkenlight_api_shm_t *shm;
+
+	p->shm = NULL;
+	if (blinkenlight_api_client_get_object_param(_this, &token, RPC_PARAM_CLASS_PANEL, p->index,
+			RPC_PARAM_HANDLE_PANEL_SHM) != 0 || token == 0)
+		return; // no shm on server
+	shm = blinkenlight_api_shm_open(p->name, p->controls_outputs_values_bytecount,
+			p->controls_inputs_values_bytecount, token);
+	if (shm == NULL)
+		return; // server on other host
+	if (blinkenlight_api_client_set_object_param(_this, RPC_PARAM_CLASS_PANEL, p->index,
+			RPC_PARAM_HANDLE_PANEL_SHM, token) != 0) {
+		blinkenlight_api_shm_close(shm, p->controls_outputs_values_bytecount,
+				p->controls_inputs_values_bytecount);
+		return;
+	}
+	p->shm_seq = shm->inputs_seq | 1; // odd = never a snapshot: first exchange decodes inputs
+	p->shm_input_event_seq = shm->input_event_seq; // older events not of interest
+	p->input_event_received = 0;
+	p->shm = shm;
+}
+
+static void blinkenlight_api_client_shm_detach_panel(blinkenlight_api_client_t *_this,
+		blinkenlight_panel_t *p)
+{
+	if (p->shm) {
+		// server may be dead already: errors ignored
+		blinkenlight_api_client_set_object_param(_this, RPC_PARAM_CLASS_PANEL, p->index,
+				RPC_PARAM_HANDLE_PANEL_SHM, 0);
+		blinkenlight_api_shm_close((blinkenlight_api_shm_t *) p->shm,
+				p->controls_outputs_values_bytecount, p->controls_inputs_values_bytecount);
+		p->shm = NULL;
+	}
+}
+
+static void blinkenlight_api_client_shm_detach(blinkenlight_api_client_t *_this)
+{
+	unsigned i_panel;
+
+	for (i_panel = 0; i_panel < _this->panel_list->panels_count; i_panel++)
+		blinkenlight_api_client_shm_detach_panel(_this, &(_this->panel_list->panels[i_panel]));
+}
+
 /*
  * read list of panels and controls from server
  */
@@ -231,6 +295,7 @@ blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
 	blinkenlight_panel_t *p;
 	int	error_code ;
 
+	blinkenlight_api_client_shm_detach(_this);
 	blinkenlight_panels_clear(_this->panel_list);
 	// read panels with increasing handles, until error
 	i_panel = 0;
@@ -265,6 +330,7 @@ blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
 
 			i_panel++;
 			blinkenlight_api_client_get_controls(_this, p); // get controls for panel
+			blinkenlight_api_client_shm_attach(_this, p); // server on same host?
 		}
 		xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_getpanelinfo_res, (char*)result_panel) ;
 	} while (error_code == 0);
@@ -273,106 +339,188 @@ blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
 }
 
 /*
- *	read input control values from remote server into client input controls
+ *	decode input control values received from server into client input controls
  */
-blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
-		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+static blinkenlight_api_status_t blinkenlight_api_client_decode_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p,
+		unsigned char *value_bytes, unsigned value_bytes_len)
 {
-	rpc_blinkenlight_api_controlvalues_struct *result_valuelist;
-	int	error_code ;
 	blinkenlight_control_t *c;
 	unsigned i_control;
 	unsigned char *value_byte_ptr; // index in received value byte stream
 	uint64_t value;
 
-	result_valuelist = rpc_blinkenlight_api_getpanel_controlvalues_1(p->index,
-			(CLIENT *) _this->rpc_client);
-	if (result_valuelist == NULL)
+	/* go through all input controls, assign value for each */
+	// check: exakt amount of values provided?
+	// "Sum of bytes" must be "sum(all controls) of value_bytelen
+	if (p->controls_inputs_values_bytecount != value_bytes_len)
 	{
-		// An error occurred while calling the server: Get rpc error message and die.
-		strcpy(_this->error_text,
-				clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+		sprintf(_this->error_text,
+				"Error in blinkenlight_api_getpanel_controlvalues():\n"
+						"Sum (Panel[%s].inputcontrols.value_bytelen) is %d, but %d values were received.",
+				p->name, p->controls_inputs_values_bytecount, value_bytes_len);
 		_this->error_file = __FILE__;
 		_this->error_line = __LINE__;
-		return 1; // error
+		return 1;
 	}
-
-	error_code = result_valuelist->error_code ;
-	if (error_code == 0)
+	/* go through all input controls, assign value to each
+	 * decode control value from the right amount of bytes
+	 * */
+	value_byte_ptr = value_bytes;
+	for (i_control = 0; i_control < p->controls_count; i_control++)
 	{
-		/* go through all input controls, assign value for each */
-		// check: exakt amount of values provided?
-		// "Sum of bytes" must be "sum(all controls) of value_bytelen
-		if (p->controls_inputs_values_bytecount != result_valuelist->value_bytes.value_bytes_len)
-		{
-			sprintf(_this->error_text,
-					"Error in blinkenlight_api_getpanel_controlvalues():\n"
-							"Sum (Panel[%s].inputcontrols.value_bytelen) is %d, but %d values were received.",
-					p->name, p->controls_inputs_values_bytecount,
-					result_valuelist->value_bytes.value_bytes_len);
-			_this->error_file = __FILE__;
-			_this->error_line = __LINE__;
-			return 1;
-		}
-		/* go through all input controls, assign value to each
-		 * decode control value from the right amount of bytes
-		 * */
-		value_byte_ptr = result_valuelist->value_bytes.value_bytes_val;
-		for (i_control = 0; i_control < p->controls_count; i_control++)
+		c = &(p->controls[i_control]);
+		if (c->is_input)
 		{
-			c = &(p->controls[i_control]);
-			if (c->is_input)
-			{
-				assert(
-						value_byte_ptr  < (result_valuelist->value_bytes.value_bytes_val + result_valuelist->value_bytes.value_bytes_len) );
-				value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
-				c->value_previous = c->value;
-				c->value = value;
-				value_byte_ptr += c->value_bytelen;
-			}
+			assert(value_byte_ptr < (value_bytes + value_bytes_len));
+			value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
+			c->value_previous = c->value;
+			c->value = value;
+			value_byte_ptr += c->value_bytelen;
 		}
 	}
-	xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_controlvalues_struct, (char*)result_valuelist) ;
 	return 0; // OK
 }
 
 /*
- *	write values from client outputs controls to server control's
- *      on success: value_previous := value
+ *	encode values of client output controls for transmission to server
+ *	into "controls_outputs_values_bytecount" bytes
  */
-blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
-		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+static void blinkenlight_api_client_encode_outputcontrols_values(blinkenlight_panel_t *p,
+		unsigned char *value_bytes)
 {
-	rpc_blinkenlight_api_controlvalues_struct valuelist;
 	blinkenlight_control_t *c;
 	unsigned i_control;
 	unsigned char *value_byte_ptr; // index in result value byte stream
-	rpc_blinkenlight_api_setpanel_controlvalues_res *result;
-
-	// 1) fill valuelist with values of output controls
-	valuelist.error_code = 0;
-	valuelist.value_bytes.value_bytes_len = p->controls_outputs_values_bytecount;
-	valuelist.value_bytes.value_bytes_val = (u_char *) calloc(p->controls_outputs_values_bytecount,
-			sizeof(u_char));
-	assert(valuelist.value_bytes.value_bytes_val);
 
 	/* go through all output controls, assign value from each into result stream
 	 * each output control puts "value_bytelen" bytes into char stream, lsb first */
-	value_byte_ptr = valuelist.value_bytes.value_bytes_val;
+	value_byte_ptr = value_bytes;
 	for (i_control = 0; i_control < p->controls_count; i_control++)
 	{
 		c = &(p->controls[i_control]);
 		if (!c->is_input)
 		{
-			assert(
-					value_byte_ptr < (valuelist.value_bytes.value_bytes_val + valuelist.value_bytes.value_bytes_len));
+			assert(value_byte_ptr < (value_bytes + p->controls_outputs_values_bytecount));
 			encode_uint64_to_bytes(value_byte_ptr, c->value, c->value_bytelen);
 			value_byte_ptr += c->value_bytelen; // next pos in buffer
 		}
 	}
+}
+
+/*
+ *	RPC value list with change bitmap and values of changed output controls only,
+ *	see RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES_DELTA.
+ *	valuelist->value_bytes is allocated, caller must free()
+ */
+static void blinkenlight_api_client_get_outputcontrols_delta_valuelist(blinkenlight_panel_t *p,
+		rpc_blinkenlight_api_controlvalues_struct *valuelist)
+{
+	blinkenlight_control_t *c;
+	unsigned i_control, i_output;
+	unsigned bitmap_bytecount = (p->controls_outputs_count + 7) / 8;
+	unsigned char *value_byte_ptr; // index in result value byte stream
+
+	valuelist->error_code = 0;
+	// worst case: all changed
+	valuelist->value_bytes.value_bytes_val = (u_char *) calloc(
+			bitmap_bytecount + p->controls_outputs_values_bytecount, sizeof(u_char));
+	assert(valuelist->value_bytes.value_bytes_val);
+
+	value_byte_ptr = valuelist->value_bytes.value_bytes_val + bitmap_bytecount;
+	for (i_output = i_control = 0; i_control < p->controls_count; i_control++)
+	{
+		c = &(p->controls[i_control]);
+		if (!c->is_input)
+		{
+			if (c->value != c->value_previous)
+			{
+				valuelist->value_bytes.value_bytes_val[i_output / 8] |= 1 << (i_output % 8);
+				encode_uint64_to_bytes(value_byte_ptr, c->value, c->value_bytelen);
+				value_byte_ptr += c->value_bytelen; // next pos in buffer
+			}
+			i_output++;
+		}
+	}
+	valuelist->value_bytes.value_bytes_len = value_byte_ptr - valuelist->value_bytes.value_bytes_val;
+}
+
+/*
+ *	RPC value list for output controls.
+ *	valuelist->value_bytes is allocated, caller must free()
+ */
+static void blinkenlight_api_client_get_outputcontrols_valuelist(blinkenlight_panel_t *p,
+		rpc_blinkenlight_api_controlvalues_struct *valuelist)
+{
+	valuelist->error_code = 0;
+	valuelist->value_bytes.value_bytes_len = p->controls_outputs_values_bytecount;
+	valuelist->value_bytes.value_bytes_val = (u_char *) calloc(p->controls_outputs_values_bytecount,
+			sizeof(u_char));
+	assert(valuelist->value_bytes.value_bytes_val);
+	blinkenlight_api_client_encode_outputcontrols_values(p, valuelist->value_bytes.value_bytes_val);
+}
+
+// output successful: set value_previous" to value
+static void blinkenlight_api_client_outputcontrols_transmitted(blinkenlight_panel_t *p)
+{
+	blinkenlight_control_t *c;
+	unsigned i_control;
+
+	for (i_control = 0; i_control < p->controls_count; i_control++)
+	{
+		c = &(p->controls[i_control]);
+		if (!c->is_input)
+			c->value_previous = c->value;
+	}
+}
+
+/*
+ *	read input control values from remote server into client input controls
+ */
+blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+{
+	rpc_blinkenlight_api_controlvalues_struct *result_valuelist;
+	blinkenlight_api_status_t status = 0;
+
+	result_valuelist = rpc_blinkenlight_api_getpanel_controlvalues_1(p->index,
+			(CLIENT *) _this->rpc_client);
+	if (result_valuelist == NULL)
+	{
+		// An error occurred while calling the server: Get rpc error message and die.
+		strcpy(_this->error_text,
+				clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1; // error
+	}
+
+	if (result_valuelist->error_code == 0)
+		status = blinkenlight_api_client_decode_inputcontrols_values(_this, p,
+				result_valuelist->value_bytes.value_bytes_val,
+				result_valuelist->value_bytes.value_bytes_len);
+	xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_controlvalues_struct, (char*)result_valuelist) ;
+	return status;
+}
+
+/*
+ *	write values from client outputs controls to server control's
+ *      on success: value_previous := value
+ */
+blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+{
+	rpc_blinkenlight_api_controlvalues_struct valuelist;
+	rpc_blinkenlight_api_setpanel_controlvalues_res *result;
+
+	// 1) fill valuelist with values of output controls
+	blinkenlight_api_client_get_outputcontrols_valuelist(p, &valuelist);
+
 	// 2) list filled, call server proc
 	result = rpc_blinkenlight_api_setpanel_controlvalues_1(p->index, valuelist,
 			(CLIENT *) _this->rpc_client);
+	// 3) free list
+	free(valuelist.value_bytes.value_bytes_val);
 	if (result == NULL)
 	{
 		// An error occurred while calling the server: Get rpc error message and die.
@@ -384,20 +532,221 @@ blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
 	}
 	assert(result->error_code == 0);
 
-	// 3) free list
-	free(valuelist.value_bytes.value_bytes_val);
-
 	// 4) output successful: set value_previous" to value
-	for (i_control = 0; i_control < p->controls_count; i_control++)
-	{
-		c = &(p->controls[i_control]);
-		if (!c->is_input)
-			c->value_previous = c->value;
-	}
+	blinkenlight_api_client_outputcontrols_transmitted(p);
 	xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_setpanel_controlvalues_res, (char *)result) ;
 	return 0; // OK
 }
 
+/*
+ * Input change pushed by server: take time stamps of snapshot "seq".
+ * If server updated meanwhile: event stays pending, taken with next snapshot.
+ */
+static void blinkenlight_api_client_shm_input_event(blinkenlight_panel_t *p,
+		blinkenlight_api_shm_t *shm, uint32_t seq)
+{
+	uint32_t event_seq = shm->input_event_seq;
+	uint64_t scan_us, detect_us, publish_us;
+
+	if (event_seq == p->shm_input_event_seq)
+		return;
+	scan_us = shm->input_event_scan_us;
+	detect_us = shm->input_event_detect_us;
+	publish_us = shm->input_event_publish_us;
+#ifndef WIN32
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&shm->inputs_seq, __ATOMIC_RELAXED) != seq)
+		return;
+#endif
+	p->shm_input_event_seq = event_seq;
+	p->input_event_scan_us = scan_us;
+	p->input_event_detect_us = detect_us;
+	p->input_event_publish_us = publish_us;
+	p->input_event_receive_us = blinkenlight_api_shm_now_us();
+	p->input_event_received = 1;
+}
+
+/*
+ * 1, if server pushed an input change which was not yet received.
+ * Only with shared memory transport, else always 0.
+ * Cheap: can be called in the application's main loop.
+ */
+int blinkenlight_api_client_input_event_pending(blinkenlight_panel_t *p)
+{
+	blinkenlight_api_shm_t *shm = (blinkenlight_api_shm_t *) p->shm;
+#ifndef WIN32
+	if (shm)
+		return __atomic_load_n(&shm->input_event_seq, __ATOMIC_RELAXED) != p->shm_input_event_seq;
+#endif
+	return 0;
+}
+
+/*
+ * Inputs from shared memory: server publishes them every few milliseconds.
+ * No new publish since last call: inputs are those already decoded.
+ * No publish for BLINKENLIGHT_API_SHM_STALE_US: server is hanging, dead or
+ * has dropped us. Then shm is left and result is 0: caller must use RPC,
+ * which also reports a dead server as error.
+ * Result 1: inputs handled, decode status in *status.
+ */
+static int blinkenlight_api_client_shm_get_inputcontrols_values(blinkenlight_api_client_t *_this,
+		blinkenlight_panel_t *p, blinkenlight_api_shm_t *shm, blinkenlight_api_status_t *status)
+{
+	unsigned char value_bytes[MAX_BLINKENLIGHT_PANEL_CONTROLS * sizeof(uint64_t)];
+	uint32_t seq;
+
+	if (blinkenlight_api_shm_read(&shm->inputs_seq, value_bytes,
+			BLINKENLIGHT_API_SHM_INPUTS(shm, p->controls_outputs_values_bytecount),
+			p->controls_inputs_values_bytecount, &seq) == 0)
+	{
+		if (seq != p->shm_seq)
+		{
+			p->shm_seq = seq;
+			blinkenlight_api_client_shm_input_event(p, shm, seq);
+			*status = blinkenlight_api_client_decode_inputcontrols_values(_this, p, value_bytes,
+					p->controls_inputs_values_bytecount);
+			return 1;
+		}
+		if (blinkenlight_api_shm_now_us()
+				- __atomic_load_n(&shm->inputs_publish_us, __ATOMIC_RELAXED)
+				< BLINKENLIGHT_API_SHM_STALE_US)
+		{
+			*status = 0; // inputs unchanged
+			return 1;
+		}
+	}
+	blinkenlight_api_client_shm_detach_panel(_this, p);
+	return 0;
+}
+
+/*
+ *	read input control values pushed by the server, outputs are not transmitted.
+ *	With shared memory transport no round trip is needed, else same as
+ *	get_inputcontrols_values().
+ */
+blinkenlight_api_status_t blinkenlight_api_client_receive_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+{
+	blinkenlight_api_status_t status = 0;
+	blinkenlight_api_shm_t *shm = (blinkenlight_api_shm_t *) p->shm;
+
+	if (shm && blinkenlight_api_client_shm_get_inputcontrols_values(_this, p, shm, &status))
+		return status;
+	return blinkenlight_api_client_get_inputcontrols_values(_this, p);
+}
+
+/*
+ *	write values of output controls to server and read input control values back,
+ *	in one round trip.
+ *	Only changed output controls are transmitted (EXCHANGEPANEL_CONTROLVALUES_DELTA).
+ *	Older servers are detected on first call, then EXCHANGEPANEL_CONTROLVALUES
+ *	or set_outputcontrols_values() (only if outputs changed)
+ *	and get_inputcontrols_values() are used.
+ */
+blinkenlight_api_status_t blinkenlight_api_client_exchange_controls_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+{
+	rpc_blinkenlight_api_controlvalues_struct valuelist;
+	rpc_blinkenlight_api_controlvalues_struct *result_valuelist;
+	blinkenlight_api_status_t status = 0;
+	blinkenlight_api_shm_t *shm = (blinkenlight_api_shm_t *) p->shm;
+
+	if (shm)
+	{
+		// outputs: encode directly into shared memory
+		blinkenlight_api_shm_write_begin(&shm->outputs_seq);
+		blinkenlight_api_client_encode_outputcontrols_values(p, BLINKENLIGHT_API_SHM_OUTPUTS(shm));
+		blinkenlight_api_shm_write_end(&shm->outputs_seq);
+		blinkenlight_api_client_outputcontrols_transmitted(p);
+
+		// inputs: leave shm and exchange over RPC, if server is gone.
+		if (blinkenlight_api_client_shm_get_inputcontrols_values(_this, p, shm, &status))
+			return status;
+	}
+
+	if (!_this->delta_unsupported)
+	{
+		blinkenlight_api_client_get_outputcontrols_delta_valuelist(p, &valuelist);
+		result_valuelist = rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1(p->index,
+				valuelist, (CLIENT *) _this->rpc_client);
+		free(valuelist.value_bytes.value_bytes_val);
+		if (result_valuelist != NULL)
+		{
+			if (result_valuelist->error_code == 0)
+			{
+				blinkenlight_api_client_outputcontrols_transmitted(p);
+				status = blinkenlight_api_client_decode_inputcontrols_values(_this, p,
+						result_valuelist->value_bytes.value_bytes_val,
+						result_valuelist->value_bytes.value_bytes_len);
+			}
+			xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_controlvalues_struct,
+					(char*)result_valuelist) ;
+			return status;
+		}
+		else
+		{
+			struct rpc_err err;
+			clnt_geterr((CLIENT *) _this->rpc_client, &err);
+			if (err.re_status != RPC_PROCUNAVAIL)
+			{
+				// An error occurred while calling the server: Get rpc error message and die.
+				strcpy(_this->error_text,
+						clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+				_this->error_file = __FILE__;
+				_this->error_line = __LINE__;
+				return 1; // error
+			}
+			// older server: transmit all outputs from now on
+			_this->delta_unsupported = 1;
+		}
+	}
+
+	if (!_this->exchange_unsupported)
+	{
+		blinkenlight_api_client_get_outputcontrols_valuelist(p, &valuelist);
+		result_valuelist = rpc_blinkenlight_api_exchangepanel_controlvalues_1(p->index, valuelist,
+				(CLIENT *) _this->rpc_client);
+		free(valuelist.value_bytes.value_bytes_val);
+		if (result_valuelist != NULL)
+		{
+			if (result_valuelist->error_code == 0)
+			{
+				blinkenlight_api_client_outputcontrols_transmitted(p);
+				status = blinkenlight_api_client_decode_inputcontrols_values(_this, p,
+						result_valuelist->value_bytes.value_bytes_val,
+						result_valuelist->value_bytes.value_bytes_len);
+			}
+			xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_controlvalues_struct,
+					(char*)result_valuelist) ;
+			return status;
+		}
+		else
+		{
+			struct rpc_err err;
+			clnt_geterr((CLIENT *) _this->rpc_client, &err);
+			if (err.re_status != RPC_PROCUNAVAIL)
+			{
+				// An error occurred while calling the server: Get rpc error message and die.
+				strcpy(_this->error_text,
+						clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+				_this->error_file = __FILE__;
+				_this->error_line = __LINE__;
+				return 1; // error
+			}
+			// older server: use separate calls from now on
+			_this->exchange_unsupported = 1;
+		}
+	}
+
+	if (blinkenlight_panels_get_control_value_changes(_this->panel_list, p, /*output*/0) > 0)
+	{
+		status = blinkenlight_api_client_set_outputcontrols_values(_this, p);
+		if (status)
+			return status;
+	}
+	return blinkenlight_api_client_get_inputcontrols_values(_this, p);
+}
+
 
 /*
  *	get/set a parameter
@@ -53,6 +53,11 @@ typedef struct
 	// untyped, because can not include rpc/rcp.h -> Collision SimH/<windows.h>
 	void *rpc_client;
 
+	// 1: server does not know EXCHANGEPANEL_CONTROLVALUES, use SET + GET
+	int exchange_unsupported;
+	// 1: server does not know EXCHANGEPANEL_CONTROLVALUES_DELTA, transmit all outputs
+	int delta_unsupported;
+
 	// list of all panels published by server
 	blinkenlight_panel_list_t *panel_list;
 
@@ -88,6 +93,14 @@ blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
 // write changed values for output controls to the server
 blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
 		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p);
+// write all output controls and read input controls in one call
+blinkenlight_api_status_t blinkenlight_api_client_exchange_controls_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p);
+// server pushed changed inputs, get them with receive_inputcontrols_values()
+int blinkenlight_api_client_input_event_pending(blinkenlight_panel_t *p);
+// read pushed input controls, without transmitting outputs
+blinkenlight_api_status_t blinkenlight_api_client_receive_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p);
 
 // get a param of a bus, panel, control
 blinkenlight_api_status_t blinkenlight_api_client_get_object_param(blinkenlight_api_client_t *_this,
@@ -38,7 +38,10 @@
 
 #define BLINKENLIGHT_API_SERVER_PROCS_C_
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "print.h"
 
@@ -50,6 +53,8 @@
 // callbacks
 #include "blinkenlight_api_server_procs.h"
 
+#include "blinkenlight_api_shm.h"
+
 #include "bitcalc.h"
 
 // global list of Blinkenlight API panels
@@ -191,6 +196,109 @@ rpc_blinkenlight_api_getcontrolinfo_1_svc(u_int i_panel, u_int i_control, struct
 	return &result;
 }
 
+/*
+ * assign received values to output controls of a panel
+ * value_bytes: the value for each output control is build by combining the next "bytelen" bytes
+ * changed_bitmap: NULL = value_bytes has "controls_outputs_values_bytecount" bytes
+ * 	for all output controls.
+ * 	Else 1 bit per output control, value_bytes contains only values of output controls
+ * 	with bit set. Others are not touched.
+ */
+static void blinkenlight_api_server_set_outputcontrols_values(blinkenlight_panel_t *p,
+		unsigned char *value_bytes, unsigned char *changed_bitmap)
+{
+	uint64_t	now_us ; // system ticks in microseconds
+	unsigned i_control;
+	unsigned i_output; // index of control in list of output controls
+	unsigned char *value_byte_ptr; // index in received value byte stream
+	blinkenlight_control_t *c;
+
+	now_us = historybuffer_now_us() ;
+
+	/* go through all output controls, assign value to each
+	 * decode control value from the right amount of bytes
+	 * */
+	value_byte_ptr = value_bytes;
+	for (i_output = i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (!c->is_input) {
+			i_output++;
+			if (changed_bitmap
+					&& !(changed_bitmap[(i_output - 1) / 8] & (1 << ((i_output - 1) % 8))))
+				continue; // unchanged
+			assert((value_byte_ptr - value_bytes) < p->controls_outputs_values_bytecount);
+			c->value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
+            // trunc to valid bits
+            c->value &= BitmaskFromLen64[c->value_bitlen];
+
+            // callback before lowpass
+            if (blinkenlight_api_panel_set_controlvalue_evt)
+                blinkenlight_api_panel_set_controlvalue_evt(p, c);
+
+            if (c->fmax > 0) {
+                // low pass requested.
+                // If fmax == 0: fast processing without ring buffer and averaging logic
+                // TODO: local lamp test should be feed changed values here, so
+                //          lamptest appearance is low passed
+                historybuffer_set_val(c->history, now_us, c->value) ;
+            }
+			print(LOG_DEBUG, "   control[%d].value = 0x%llx (%d bytes)\n", i_control, c->value,
+					c->value_bytelen);
+			value_byte_ptr += c->value_bytelen;
+		}
+	}
+	// signal to app: "value of output control updated"
+	if (blinkenlight_api_panel_set_controlvalues_evt)
+		blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/0);
+}
+
+/*
+ * encode values of all input controls of a panel into
+ * "controls_inputs_values_bytecount" bytes.
+ * The bytes for each input control is are the "bytelen" lsb for each value
+ */
+static void blinkenlight_api_server_get_inputcontrols_values(blinkenlight_panel_t *p,
+		unsigned char *value_bytes)
+{
+    uint64_t    now_us ; // system ticks in microseconds
+	unsigned i_control;
+	unsigned char *value_byte_ptr; // index in result value byte stream
+	blinkenlight_control_t *c;
+
+	now_us = historybuffer_now_us();
+
+	// signal to app: "value of input control requested"
+	if (blinkenlight_api_panel_get_controlvalues_evt)
+		blinkenlight_api_panel_get_controlvalues_evt(p);
+
+	/* go through all input controls, assign value from each into result stream
+	 * each input control puts "value_bytelen" bytes into char stream, lsb first */
+	value_byte_ptr = value_bytes;
+	for (i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (c->is_input) {
+		    uint64_t    val = 0 ;
+			assert((value_byte_ptr - value_bytes) < p->controls_inputs_values_bytecount);
+            if (c->fmax) {
+                 int i_bit ;
+                // low pass each single bit of control individually!
+                // use fmax only for pin debouncing!
+                 historybuffer_get_average_vals(c->history, 1000000 / c->fmax, now_us, /*bitmode*/1);
+                 // re-assemble value from low-passed bits
+                 for (i_bit = 0 ; i_bit < c->value_bitlen ; i_bit++)
+                     if (c->averaged_value_bits[i_bit] > 128) // > 50% ?
+                         val |= (1 << i_bit) ;
+            }
+            else val = c->value ;
+
+			encode_uint64_to_bytes(value_byte_ptr, val, c->value_bytelen);
+			print(LOG_DEBUG, "  result.values[] += control[%d].value = 0x%llx (%d bytes)\n",
+					i_control, val, c->value_bytelen);
+			value_byte_ptr += c->value_bytelen; // next pos in buffer
+		}
+	}
+}
+
 /*
  * setpanel_controlvalues()
  * Set all output controls of a panel
@@ -203,17 +311,11 @@ rpc_blinkenlight_api_setpanel_controlvalues_res *
 rpc_blinkenlight_api_setpanel_controlvalues_1_svc(u_int i_panel,
 		rpc_blinkenlight_api_controlvalues_struct valuelist, struct svc_req *rqstp)
 {
-	uint64_t	now_us ; // system ticks in microseconds
 	static rpc_blinkenlight_api_setpanel_controlvalues_res result;
 	blinkenlight_panel_t *p;
-	unsigned i_control;
-	unsigned char *value_byte_ptr; // index in received value byte stream
-	blinkenlight_control_t *c;
 
 	print(LOG_DEBUG, "blinkenlight_api_setpanel_controlvalues(i_panel=%d)\n", i_panel);
 
-	now_us = historybuffer_now_us() ;
-
 	if (i_panel >= blinkenlight_panel_list->panels_count) {
 		print(LOG_ERR, "i_panel > panels_count\n");
 		result.error_code = 1; // invalid panel
@@ -229,41 +331,8 @@ rpc_blinkenlight_api_setpanel_controlvalues_1_svc(u_int i_panel,
 					valuelist.value_bytes.value_bytes_len);
 			exit(1);
 		}
-
-		/* go through all output controls, assign value to each
-		 * decode control value from the right amount of bytes
-		 * */
-		value_byte_ptr = valuelist.value_bytes.value_bytes_val;
-		for (i_control = 0; i_control < p->controls_count; i_control++) {
-			c = &(p->controls[i_control]);
-			if (!c->is_input) {
-				assert(
-						(value_byte_ptr - valuelist.value_bytes.value_bytes_val)
-								< valuelist.value_bytes.value_bytes_len);
-				c->value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
-                // trunc to valid bits
-                c->value &= BitmaskFromLen64[c->value_bitlen];
-
-                // callback before lowpass
-                if (blinkenlight_api_panel_set_controlvalue_evt)
-                    blinkenlight_api_panel_set_controlvalue_evt(p, c);
-
-                if (c->fmax > 0) {
-                    // low pass requested.
-                    // If fmax == 0: fast processing without ring buffer and averaging logic
-                    // TODO: local lamp test should be feed changed values here, so
-                    //          lamptest appearance is low passed
-                    historybuffer_set_val(c->history, now_us, c->value) ;
-                }
-				print(LOG_DEBUG, "   control[%d].value = 0x%llx (%d bytes)\n", i_control, c->value,
-						c->value_bytelen);
-				value_byte_ptr += c->value_bytelen;
-			}
-		}
-		// signal to app: "value of output control updated"
-		if (blinkenlight_api_panel_set_controlvalues_evt)
-			blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/0);
-
+		blinkenlight_api_server_set_outputcontrols_values(p, valuelist.value_bytes.value_bytes_val,
+				NULL);
 		result.error_code = 0;
 	}
 	return &result;
@@ -281,17 +350,11 @@ rpc_blinkenlight_api_setpanel_controlvalues_1_svc(u_int i_panel,
 rpc_blinkenlight_api_controlvalues_struct *
 rpc_blinkenlight_api_getpanel_controlvalues_1_svc(u_int i_panel, struct svc_req *rqstp)
 {
-    uint64_t    now_us ; // system ticks in microseconds
 	static rpc_blinkenlight_api_controlvalues_struct result;
 	blinkenlight_panel_t *p;
-	unsigned i_control;
-	unsigned char *value_byte_ptr; // index in result value byte stream
-	blinkenlight_control_t *c;
 
 	print(LOG_DEBUG, "blinkenlight_api_getpanel_controlvalues(i_panel=%d)\n", i_panel);
 
-	now_us = historybuffer_now_us();
-
 	if (i_panel >= blinkenlight_panel_list->panels_count)
 		result.error_code = 1; // invalid panel
 	else {
@@ -300,50 +363,176 @@ rpc_blinkenlight_api_getpanel_controlvalues_1_svc(u_int i_panel, struct svc_req
 		// free previous result
 		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_controlvalues_struct, (char *) &result);
 
-		// signal to app: "value of input control requested"
-		if (blinkenlight_api_panel_get_controlvalues_evt)
-			blinkenlight_api_panel_get_controlvalues_evt(p);
-
 		result.value_bytes.value_bytes_len = p->controls_inputs_values_bytecount;
 		result.value_bytes.value_bytes_val = (u_char *) calloc(p->controls_inputs_values_bytecount,
 				sizeof(u_char));
 		assert(result.value_bytes.value_bytes_val);
 
-
-		/* go through all input controls, assign value from each into result stream
-		 * each input control puts "value_bytelen" bytes into char stream, lsb first */
-		value_byte_ptr = result.value_bytes.value_bytes_val;
-		for (i_control = 0; i_control < p->controls_count; i_control++) {
-			c = &(p->controls[i_control]);
-			if (c->is_input) {
-			    uint64_t    val = 0 ;
-				assert(
-						(value_byte_ptr - result.value_bytes.value_bytes_val)
-								< result.value_bytes.value_bytes_len);
-                if (c->fmax) {
-                     int i_bit ;
-                    // low pass each single bit of control individually!
-                    // use fmax only for pin debouncing!
-                     historybuffer_get_average_vals(c->history, 1000000 / c->fmax, now_us, /*bitmode*/1);
-                     // re-assemble value from low-passed bits
-                     for (i_bit = 0 ; i_bit < c->value_bitlen ; i_bit++)
-                         if (c->averaged_value_bits[i_bit] > 128) // > 50% ?
-                             val |= (1 << i_bit) ;
-                }
-                else val = c->value ;
-
-				encode_uint64_to_bytes(value_byte_ptr, val, c->value_bytelen);
-				print(LOG_DEBUG, "  result.values[] += control[%d].value = 0x%llx (%d bytes)\n",
-						i_control, val, c->value_bytelen);
-				value_byte_ptr += c->value_bytelen; // next pos in buffer
-			}
-		}
+		blinkenlight_api_server_get_inputcontrols_values(p, result.value_bytes.value_bytes_val);
 		result.error_code = 0;
 	}
 
 	return &result;
 }
 
+/*
+ * exchangepanel_controlvalues()
+ * setpanel_controlvalues() and getpanel_controlvalues() in one call:
+ * set all output controls from "valuelist", then return values of all input controls.
+ * Saves one network round trip per client service cycle.
+ */
+rpc_blinkenlight_api_controlvalues_struct *
+rpc_blinkenlight_api_exchangepanel_controlvalues_1_svc(u_int i_panel,
+		rpc_blinkenlight_api_controlvalues_struct valuelist, struct svc_req *rqstp)
+{
+	rpc_blinkenlight_api_setpanel_controlvalues_res *set_result;
+	rpc_blinkenlight_api_controlvalues_struct *result;
+
+	print(LOG_DEBUG, "blinkenlight_api_exchangepanel_controlvalues(i_panel=%d)\n", i_panel);
+
+	set_result = rpc_blinkenlight_api_setpanel_controlvalues_1_svc(i_panel, valuelist, rqstp);
+	result = rpc_blinkenlight_api_getpanel_controlvalues_1_svc(i_panel, rqstp);
+	if (set_result->error_code)
+		result->error_code = set_result->error_code;
+	return result;
+}
+
+/*
+ * exchangepanel_controlvalues_delta()
+ * like exchangepanel_controlvalues(), but valuelist is
+ * - change bitmap: 1 bit per output control, (controls_outputs_count+7)/8 bytes
+ * - values of output controls with bit set, "bytelen" bytes each.
+ * Unchanged controls (and their history) are not touched.
+ */
+rpc_blinkenlight_api_controlvalues_struct *
+rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_svc(u_int i_panel,
+		rpc_blinkenlight_api_controlvalues_struct valuelist, struct svc_req *rqstp)
+{
+	blinkenlight_panel_t *p;
+	blinkenlight_control_t *c;
+	rpc_blinkenlight_api_controlvalues_struct *result;
+	unsigned i_control, i_output;
+	unsigned bitmap_bytecount, value_bytecount;
+	unsigned char *bitmap;
+	int error_code = 0;
+
+	print(LOG_DEBUG, "blinkenlight_api_exchangepanel_controlvalues_delta(i_panel=%d)\n", i_panel);
+
+	if (i_panel < blinkenlight_panel_list->panels_count) {
+		p = &(blinkenlight_panel_list->panels[i_panel]);
+		bitmap = valuelist.value_bytes.value_bytes_val;
+		bitmap_bytecount = (p->controls_outputs_count + 7) / 8;
+		// check: bitmap and value for every changed control provided?
+		value_bytecount = bitmap_bytecount;
+		if (valuelist.value_bytes.value_bytes_len >= bitmap_bytecount)
+			for (i_output = i_control = 0; i_control < p->controls_count; i_control++) {
+				c = &(p->controls[i_control]);
+				if (!c->is_input) {
+					if (bitmap[i_output / 8] & (1 << (i_output % 8)))
+						value_bytecount += c->value_bytelen;
+					i_output++;
+				}
+			}
+		if (value_bytecount != valuelist.value_bytes.value_bytes_len) {
+			print(LOG_ERR, "Error in blinkenlight_api_exchangepanel_controlvalues_delta():\n");
+			print(LOG_ERR,
+					"Panel[%s]: %d bytes for changed outputcontrols expected, but %d values were transmitted.\n",
+					p->name, value_bytecount, valuelist.value_bytes.value_bytes_len);
+			error_code = 1;
+		} else
+			blinkenlight_api_server_set_outputcontrols_values(p, bitmap + bitmap_bytecount, bitmap);
+	}
+	result = rpc_blinkenlight_api_getpanel_controlvalues_1_svc(i_panel, rqstp);
+	if (error_code)
+		result->error_code = error_code;
+	return result;
+}
+
+/*
+ * Shared memory transport.
+ * Server creates a segment for each panel, a client on the same host
+ * attaches to it with RPC_PARAM_HANDLE_PANEL_SHM.
+ * blinkenlight_api_server_shm_service() must be called periodically in the
+ * RPC server loop, so it runs in the same thread as the RPC procedures.
+ */
+static uint32_t blinkenlight_api_server_shm_token;
+
+// last input event, from hardware scan thread
+static struct
+{
+	uint32_t seq; // incremented by event
+	uint64_t scan_us, detect_us;
+} blinkenlight_api_server_shm_event;
+
+void blinkenlight_api_server_shm_create(void)
+{
+	unsigned i_panel;
+	blinkenlight_panel_t *p;
+
+	blinkenlight_api_server_shm_token = ((uint32_t) time(NULL) << 16) ^ (uint32_t) getpid();
+	if (blinkenlight_api_server_shm_token == 0)
+		blinkenlight_api_server_shm_token = 1; // 0 = "no shm"
+	for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
+		p = &(blinkenlight_panel_list->panels[i_panel]);
+		p->shm = blinkenlight_api_shm_create(p->name, p->controls_outputs_values_bytecount,
+				p->controls_inputs_values_bytecount, blinkenlight_api_server_shm_token);
+		p->shm_attached = 0;
+		if (p->shm == NULL)
+			print(LOG_NOTICE, "No shared memory for panel %s, only RPC\n", p->name);
+	}
+}
+
+void blinkenlight_api_server_shm_input_event(uint64_t scan_us, uint64_t detect_us)
+{
+	blinkenlight_api_server_shm_event.scan_us = scan_us;
+	blinkenlight_api_server_shm_event.detect_us = detect_us;
+	blinkenlight_api_server_shm_event.seq++;
+}
+
+void blinkenlight_api_server_shm_service(void)
+{
+	unsigned i_panel;
+	blinkenlight_panel_t *p;
+	blinkenlight_api_shm_t *shm;
+	unsigned char value_bytes[MAX_BLINKENLIGHT_PANEL_CONTROLS * sizeof(uint64_t)];
+	uint32_t seq;
+
+	for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
+		p = &(blinkenlight_panel_list->panels[i_panel]);
+		shm = (blinkenlight_api_shm_t *) p->shm;
+		if (!shm || !p->shm_attached)
+			continue;
+		// header is writable by the client: must still describe this panel
+		if (shm->outputs_bytecount != p->controls_outputs_values_bytecount
+				|| shm->inputs_bytecount != p->controls_inputs_values_bytecount) {
+			print(LOG_ERR, "Shared memory header of panel %s corrupted, client detached\n",
+					p->name);
+			p->shm_attached = 0;
+			continue;
+		}
+		// 1) new output values from client?
+		if (blinkenlight_api_shm_read(&shm->outputs_seq, value_bytes,
+				BLINKENLIGHT_API_SHM_OUTPUTS(shm), p->controls_outputs_values_bytecount, &seq) == 0
+				&& seq != p->shm_seq) {
+			p->shm_seq = seq;
+			blinkenlight_api_server_set_outputcontrols_values(p, value_bytes, NULL);
+		}
+		// 2) publish input values
+		blinkenlight_api_server_get_inputcontrols_values(p, value_bytes);
+		blinkenlight_api_shm_write_begin(&shm->inputs_seq);
+		memcpy(BLINKENLIGHT_API_SHM_INPUTS(shm, p->controls_outputs_values_bytecount), value_bytes,
+				p->controls_inputs_values_bytecount);
+		if (shm->input_event_seq != blinkenlight_api_server_shm_event.seq) {
+			shm->input_event_scan_us = blinkenlight_api_server_shm_event.scan_us;
+			shm->input_event_detect_us = blinkenlight_api_server_shm_event.detect_us;
+			shm->input_event_publish_us = blinkenlight_api_shm_now_us();
+			shm->input_event_seq = blinkenlight_api_server_shm_event.seq;
+		}
+		shm->inputs_publish_us = blinkenlight_api_shm_now_us();
+		blinkenlight_api_shm_write_end(&shm->inputs_seq);
+	}
+}
+
 /*
  * rpc_param_get()
  * get a parameter value of an object (bus, panel, control)
@@ -385,6 +574,11 @@ static void rpc_param_get_intern(rpc_param_result_struct * result,
 				else
 					result->param_value = p->mode;
 				result->error_code = RPC_ERR_OK;
+				break;
+			case RPC_PARAM_HANDLE_PANEL_SHM:
+				result->param_value = p->shm ? blinkenlight_api_server_shm_token : 0;
+				result->error_code = RPC_ERR_OK;
+				break;
 			}
 
 		}
@@ -451,6 +645,19 @@ rpc_param_set_1_svc(rpc_param_cmd_set_struct cmd_set, struct svc_req *rqstp)
 				if (blinkenlight_api_panel_set_controlvalues_evt)
 					blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/1);
 				break;
+			case RPC_PARAM_HANDLE_PANEL_SHM:
+				// client on same host attaches/detaches shared memory transport
+				if (cmd_set.param_value == 0) {
+					p->shm_attached = 0;
+					result.error_code = RPC_ERR_OK;
+				} else if (p->shm && cmd_set.param_value == blinkenlight_api_server_shm_token) {
+					blinkenlight_api_shm_t *shm = (blinkenlight_api_shm_t *) p->shm;
+					// current outputs in shm are from an earlier client: ignore
+					p->shm_seq = shm->outputs_seq;
+					p->shm_attached = 1;
+					result.error_code = RPC_ERR_OK;
+				}
+				break;
 			}
 
 		}
@@ -41,6 +41,12 @@ typedef int (*blinkenlight_api_panel_get_mode_evt_t) (blinkenlight_panel_t *) ;
 typedef void (*blinkenlight_api_panel_set_mode_evt_t) (blinkenlight_panel_t *, int) ;
 typedef char *(*blinkenlight_api_get_info_evt_t) (void) ;
 
+// shared memory transport for clients on the same host
+void blinkenlight_api_server_shm_create(void);
+void blinkenlight_api_server_shm_service(void);
+// inputs changed: publish with next shm_service(), with time stamps for latency statistic
+void blinkenlight_api_server_shm_input_event(uint64_t scan_us, uint64_t detect_us);
+
 #ifndef BLINKENLIGHT_API_SERVER_PROCS_C_
 
  // global panel config
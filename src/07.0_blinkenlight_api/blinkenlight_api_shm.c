@@ -0,0 +1,230 @@
+/* blinkenlight_api_shm.c: shared memory transport for Blinkenlight API control values
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ If server and client run on the same host (SimH and PiDP11 server on a Raspberry),
+ control values are exchanged over a POSIX shared memory segment per panel.
+ Output values written by client, input values written by server.
+ No kernel call per service cycle, RPC is only used to set up the connection.
+
+ Under Windows not available: create() and open() always fail, RPC is used.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "blinkenlight_api_shm.h"
+
+// max tries to get a consistent snapshot
+#define BLINKENLIGHT_API_SHM_READ_RETRIES	10000
+
+#ifndef WIN32
+
+// "/blinkenlight_11_70" for panel "11/70"
+static void blinkenlight_api_shm_name(char *buffer, char *panelname)
+{
+	char *s;
+	strcpy(buffer, BLINKENLIGHT_API_SHM_NAME_PREFIX);
+	s = buffer + strlen(buffer);
+	for (; *panelname; panelname++)
+		*s++ = isalnum(*panelname) ? *panelname : '_';
+	*s = '\0';
+}
+
+static unsigned blinkenlight_api_shm_size(unsigned outputs_bytecount, unsigned inputs_bytecount)
+{
+	return sizeof(blinkenlight_api_shm_t) + outputs_bytecount + inputs_bytecount;
+}
+
+/*
+ * server: create segment for panel. Stale segment of earlier server run is replaced.
+ */
+blinkenlight_api_shm_t *blinkenlight_api_shm_create(char *panelname, unsigned outputs_bytecount,
+		unsigned inputs_bytecount, uint32_t token)
+{
+	char name[256];
+	unsigned size = blinkenlight_api_shm_size(outputs_bytecount, inputs_bytecount);
+	blinkenlight_api_shm_t *shm;
+	int fd;
+
+	blinkenlight_api_shm_name(name, panelname);
+	shm_unlink(name);
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0660);
+	if (fd < 0)
+		return NULL;
+	// owner and group only: SimH may run as another user of the server's group.
+	// fchmod() because umask may have removed the group bits.
+	fchmod(fd, 0660);
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+	shm = (blinkenlight_api_shm_t *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED) {
+		shm_unlink(name);
+		return NULL;
+	}
+	memset(shm, 0, size);
+	shm->version = BLINKENLIGHT_API_SHM_VERSION;
+	shm->token = token;
+	shm->outputs_bytecount = outputs_bytecount;
+	shm->inputs_bytecount = inputs_bytecount;
+	// magic last: segment is valid now
+	__atomic_store_n(&shm->magic, BLINKENLIGHT_API_SHM_MAGIC, __ATOMIC_RELEASE);
+	return shm;
+}
+
+/*
+ * client: map segment of panel.
+ * NULL if server is on other host, or is older, or segment from other server instance.
+ */
+blinkenlight_api_shm_t *blinkenlight_api_shm_open(char *panelname, unsigned outputs_bytecount,
+		unsigned inputs_bytecount, uint32_t token)
+{
+	char name[256];
+	unsigned size = blinkenlight_api_shm_size(outputs_bytecount, inputs_bytecount);
+	blinkenlight_api_shm_t *shm;
+	struct stat st;
+	int fd;
+
+	blinkenlight_api_shm_name(name, panelname);
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0 || st.st_size != size) {
+		close(fd);
+		return NULL;
+	}
+	shm = (blinkenlight_api_shm_t *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED)
+		return NULL;
+	if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != BLINKENLIGHT_API_SHM_MAGIC
+			|| shm->version != BLINKENLIGHT_API_SHM_VERSION || shm->token != token
+			|| shm->outputs_bytecount != outputs_bytecount
+			|| shm->inputs_bytecount != inputs_bytecount) {
+		munmap(shm, size);
+		return NULL;
+	}
+	return shm;
+}
+
+void blinkenlight_api_shm_close(blinkenlight_api_shm_t *shm, unsigned outputs_bytecount,
+		unsigned inputs_bytecount)
+{
+	munmap(shm, blinkenlight_api_shm_size(outputs_bytecount, inputs_bytecount));
+}
+
+uint64_t blinkenlight_api_shm_now_us(void)
+{
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (uint64_t) tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+}
+
+/*
+ * Sequence lock: only one writer per stream.
+ * write_begin() makes sequence odd, write_end() even again.
+ */
+void blinkenlight_api_shm_write_begin(uint32_t *seq)
+{
+	__atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void blinkenlight_api_shm_write_end(uint32_t *seq)
+{
+	__atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+int blinkenlight_api_shm_read(uint32_t *seq, unsigned char *dst, unsigned char *src,
+		unsigned len, uint32_t *snapshot_seq)
+{
+	uint32_t seq_begin, seq_end;
+	int retries = BLINKENLIGHT_API_SHM_READ_RETRIES;
+
+	while (retries--) {
+		seq_begin = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+		if (seq_begin & 1)
+			continue; // writer busy
+		memcpy(dst, src, len);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq_end = __atomic_load_n(seq, __ATOMIC_RELAXED);
+		if (seq_begin == seq_end) {
+			if (snapshot_seq)
+				*snapshot_seq = seq_begin;
+			return 0; // consistent
+		}
+	}
+	return 1;
+}
+
+#else
+
+blinkenlight_api_shm_t *blinkenlight_api_shm_create(char *panelname, unsigned outputs_bytecount,
+		unsigned inputs_bytecount, uint32_t token)
+{
+	return NULL;
+}
+
+blinkenlight_api_shm_t *blinkenlight_api_shm_open(char *panelname, unsigned outputs_bytecount,
+		unsigned inputs_bytecount, uint32_t token)
+{
+	return NULL;
+}
+
+void blinkenlight_api_shm_close(blinkenlight_api_shm_t *shm, unsigned outputs_bytecount,
+		unsigned inputs_bytecount)
+{
+}
+
+uint64_t blinkenlight_api_shm_now_us(void)
+{
+	return 0;
+}
+
+void blinkenlight_api_shm_write_begin(uint32_t *seq)
+{
+}
+
+void blinkenlight_api_shm_write_end(uint32_t *seq)
+{
+}
+
+int blinkenlight_api_shm_read(uint32_t *seq, unsigned char *dst, unsigned char *src,
+		unsigned len, uint32_t *snapshot_seq)
+{
+	return 1;
+}
+
+#endif
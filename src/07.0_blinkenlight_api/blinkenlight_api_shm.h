@@ -0,0 +1,99 @@
+/* blinkenlight_api_shm.h: shared memory transport for Blinkenlight API control values
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BLINKENLIGHT_API_SHM_H_
+#define BLINKENLIGHT_API_SHM_H_
+
+#include <stdint.h>
+
+#define BLINKENLIGHT_API_SHM_MAGIC	0x424c4b53 // "BLKS"
+#define BLINKENLIGHT_API_SHM_VERSION	3
+
+// name of shared memory object: "/blinkenlight_<panel name>", ie /dev/shm/blinkenlight_11_70
+#define BLINKENLIGHT_API_SHM_NAME_PREFIX	"/blinkenlight_"
+
+/*
+ * Shared memory segment for one panel.
+ * Server creates it, client maps it, if both run on the same host.
+ * Both value byte streams have the same encoding as the RPC value lists
+ * (see rpc_blinkenlight_api_controlvalues_struct).
+ * Each stream is protected by a sequence lock:
+ * odd sequence = writer is updating, reader has to retry.
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	// identifies the server instance. Also published over RPC as
+	// RPC_PARAM_HANDLE_PANEL_SHM, so a client can check the segment
+	// belongs to the server it is connected to.
+	uint32_t token;
+	uint32_t outputs_bytecount; // = panel.controls_outputs_values_bytecount
+	uint32_t inputs_bytecount; // = panel.controls_inputs_values_bytecount
+
+	uint32_t outputs_seq; // sequence lock, written by client
+	uint32_t inputs_seq; // sequence lock, written by server
+
+	// Server pushes input changes (switch events) immediately.
+	// Written under inputs_seq. Time stamps: CLOCK_MONOTONIC in us, see blinkenlight_api_shm_now_us()
+	uint32_t input_event_seq; // incremented with every pushed input change
+	uint32_t input_event_reserved;
+	uint64_t input_event_scan_us; // change first seen by hardware scan
+	uint64_t input_event_detect_us; // change stable (debounced) and pushed
+	uint64_t input_event_publish_us; // written to this segment
+	// time of last publish of input values, written every server service pass
+	uint64_t inputs_publish_us;
+
+	// outputs_bytecount bytes output values, then inputs_bytecount bytes input values
+	unsigned char values[1];
+} blinkenlight_api_shm_t;
+
+// The segment is writable by the other side: buffer sizes and offsets
+// always come from the local panel definition, never from the header.
+#define BLINKENLIGHT_API_SHM_OUTPUTS(shm)	((shm)->values)
+#define BLINKENLIGHT_API_SHM_INPUTS(shm, outputs_bytecount)	((shm)->values + (outputs_bytecount))
+
+// Server publishes inputs every service pass (some milliseconds).
+// No publish for this long: server is hanging, gone, or has detached the client.
+#define BLINKENLIGHT_API_SHM_STALE_US	200000
+
+// server: create segment for panel
+blinkenlight_api_shm_t *blinkenlight_api_shm_create(char *panelname, unsigned outputs_bytecount,
+		unsigned inputs_bytecount, uint32_t token);
+// client: map existing segment, NULL if not there or not matching
+blinkenlight_api_shm_t *blinkenlight_api_shm_open(char *panelname, unsigned outputs_bytecount,
+		unsigned inputs_bytecount, uint32_t token);
+void blinkenlight_api_shm_close(blinkenlight_api_shm_t *shm, unsigned outputs_bytecount,
+		unsigned inputs_bytecount);
+
+// time stamp for input events, same clock for server and client on this host
+uint64_t blinkenlight_api_shm_now_us(void);
+
+// writer side of sequence lock
+void blinkenlight_api_shm_write_begin(uint32_t *seq);
+void blinkenlight_api_shm_write_end(uint32_t *seq);
+// reader side: copy a consistent snapshot of "len" bytes into dst.
+// result 0 = OK, 1 = writer did not finish update (died?)
+int blinkenlight_api_shm_read(uint32_t *seq, unsigned char *dst, unsigned char *src,
+		unsigned len, uint32_t *snapshot_seq);
+
+#endif /* BLINKENLIGHT_API_SHM_H_ */
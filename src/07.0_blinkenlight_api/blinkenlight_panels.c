@@ -147,6 +147,9 @@ blinkenlight_panel_t *blinkenlight_add_panel(blinkenlight_panel_list_t *_this)
 	p->controls_inputs_count = 0;
 	p->mode = 0;
 	p->tag = 0;
+	p->shm = NULL;
+	p->shm_attached = 0;
+	p->shm_seq = 0;
 	return p;
 }
 
@@ -232,6 +232,18 @@ typedef struct blinkenlight_panel_struct
 	// 0x03 = "powerless": all controls dark, power button OFF, but still responsive to API
 	unsigned mode;
 
+	// shared memory transport (blinkenlight_api_shm_t), if client and server on same host.
+	// NULL: values only over RPC
+	void *shm;
+	int shm_attached; // server: a client uses shm, publish inputs and poll outputs
+	uint32_t shm_seq; // server: sequence of last processed outputs, client: of last received inputs
+	// client: last input change event pushed by server, and its time stamps in us.
+	// input_event_received is set by the client, reset by the application.
+	uint32_t shm_input_event_seq;
+	int input_event_received;
+	uint64_t input_event_scan_us, input_event_detect_us, input_event_publish_us,
+			input_event_receive_us;
+
 } blinkenlight_panel_t;
 
 // many panels can be connected to one BLINKENBUS,
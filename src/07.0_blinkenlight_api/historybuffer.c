@@ -20,6 +20,8 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 16-OCT-2026			bit mode averaging with sliding window integrator
+ 16-OCT-2026			lock-free single producer/single consumer ring replaces the mutex
  03-FEB-2019	JH		mutex to make read and write to buffer atomic (PiDP11 server crashes)
  12-Mar-2016	JH      created
  */
@@ -37,8 +39,6 @@
 #include "historybuffer.h"
 #include "blinkenlight_panels.h"
 
-#define ISEMPTY(this)  ((this)->readidx == (this)->writeidx)
-
 // need it here
 static uint64_t maxu64(uint64_t a, uint64_t b)
 {
@@ -48,20 +48,48 @@ static uint64_t maxu64(uint64_t a, uint64_t b)
         return b;
 }
 
-// needed for debugging the "server11 crash"
-#define DBG_ASSERT(cond)	do{	\
-	if (!(cond)) { \
-		fprintf(stderr, "DBG_ASSERT: "#cond" failed in %s #%d\n", __FILE__, __LINE__) ;	\
-		break_here() ;	\
-		exit(1) ; \
-		} \
-} while (0)
-
+// atomic access to "write_count", shared between writer and reader thread.
+// Entry fields are relaxed atomics: the writer may rewrite a slot while the reader copies it.
+// Like a seqlock, the writer fences between publishing "write_count" and rewriting the
+// next slot, the reader between copying entries and checking "write_count" again.
+#ifdef WIN32
+// under Windows only simulating server: volatile access is ordered by MSVC
+#define HISTORYBUFFER_LOAD_ACQUIRE(p)	(*(volatile uint32_t *)(p))
+#define HISTORYBUFFER_STORE_RELEASE(p, v)	(*(volatile uint32_t *)(p) = (v))
+#define HISTORYBUFFER_FENCE_ACQUIRE()
+#define HISTORYBUFFER_FENCE_RELEASE()
+#define HISTORYBUFFER_LOAD_RELAXED(p)	(*(volatile uint64_t *)(p))
+#define HISTORYBUFFER_STORE_RELAXED(p, v)	(*(volatile uint64_t *)(p) = (v))
+#else
+#define HISTORYBUFFER_LOAD_ACQUIRE(p)	__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define HISTORYBUFFER_STORE_RELEASE(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define HISTORYBUFFER_FENCE_ACQUIRE()	__atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define HISTORYBUFFER_FENCE_RELEASE()	__atomic_thread_fence(__ATOMIC_RELEASE)
+#define HISTORYBUFFER_LOAD_RELAXED(p)	__atomic_load_n((p), __ATOMIC_RELAXED)
+#define HISTORYBUFFER_STORE_RELAXED(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#endif
 
-static void break_here()
+// copy an entry, which the writer may be rewriting. Caller checks "write_count" afterwards.
+static void historybuffer_entry_copy(historybuffer_entry_t *dst, historybuffer_entry_t *src)
 {
+    dst->value = HISTORYBUFFER_LOAD_RELAXED(&src->value);
+    dst->timestamp_begin_us = HISTORYBUFFER_LOAD_RELAXED(&src->timestamp_begin_us);
 }
 
+// index of lowest set bit, v != 0
+static unsigned lowest_bit_idx(uint64_t v)
+{
+#ifdef WIN32
+    unsigned idx = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        idx++;
+    }
+    return idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
 
 /*
  * high resolution system ticks in micro seconds
@@ -89,13 +117,8 @@ uint64_t historybuffer_now_us()
 static char *historybuffer_entry_as_text(historybuffer_entry_t *hbe)
 {
     static char buffer[256];
-    if (hbe->timestamp_end_us == 0)
-        sprintf(buffer, "timestamp=%0.3f us (unterminated), value=0%" PRIo64,
-                (double) hbe->timestamp_begin_us / 1000, hbe->value);
-    else
-        sprintf(buffer, "timestamp=%0.3f - %0.3f = %0.3f us, value=0%" PRIo64,
-                (double) hbe->timestamp_begin_us / 1000, (double) hbe->timestamp_end_us / 1000,
-                (double) (hbe->timestamp_end_us - hbe->timestamp_begin_us) / 1000, hbe->value);
+    sprintf(buffer, "timestamp=%0.3f us, value=0%" PRIo64,
+            (double) hbe->timestamp_begin_us / 1000, hbe->value);
     return buffer;
 }
 
@@ -103,151 +126,201 @@ static char *historybuffer_entry_as_text(historybuffer_entry_t *hbe)
  * create(), destroy()
  * buffer is for one value, bitlen is const.
  * 0: is no bit vector, see historybuffer_get_average_vals()
+ * capacity is rounded up to a power of 2.
  */
 historybuffer_t *historybuffer_create(struct blinkenlight_control_struct *c, unsigned capacity)
 {
     historybuffer_t *_this;
     _this = (historybuffer_t *) malloc(sizeof(historybuffer_t));
     _this->control = c;
-    _this->capacity = (int) capacity;
-    assert(_this->capacity > 0);
-    _this->buffer = (historybuffer_entry_t *) calloc(capacity, sizeof(historybuffer_entry_t));
-    _this->startpos = _this->endpos = 0;
-#ifdef USE_MUTEX
-    if (pthread_mutex_init(&_this->mutex, NULL) != 0)  { 
-        fprintf(stderr, "\n mutex_init() has failed\n"); 
-		exit(1) ;
-    } 		
-#endif
-	
+    assert(capacity > 1);
+    _this->capacity = 2;
+    while (_this->capacity < capacity)
+        _this->capacity <<= 1;
+    _this->capacity_mask = _this->capacity - 1;
+    _this->buffer = (historybuffer_entry_t *) calloc(_this->capacity, sizeof(historybuffer_entry_t));
+    _this->write_count = 0;
+    _this->average_incremental = 1;
+    _this->avg_valid = 0;
+    // reader keeps entries leaving the window, even if writer overwrote them meanwhile
+    _this->avg_window = (historybuffer_entry_t *) calloc(2 * _this->capacity,
+            sizeof(historybuffer_entry_t));
+    _this->avg_window_mask = 2 * _this->capacity - 1;
     return _this;
 }
 
 void historybuffer_destroy(historybuffer_t *_this)
 {
-#ifdef USE_MUTEX
-    pthread_mutex_destroy(&_this->mutex) ;
-#endif
+    free(_this->avg_window);
     free(_this->buffer);
     free(_this);
 }
 
-// get number of items in buffer
+// get number of valid items in buffer
 unsigned historybuffer_fill(historybuffer_t *_this)
 {
-    if (_this->startpos == _this->endpos)
-        return 0;
-    else if (_this->endpos > _this->startpos)
-        return _this->endpos - _this->startpos;
+    uint32_t write_count = HISTORYBUFFER_LOAD_ACQUIRE(&_this->write_count);
+    if (write_count < _this->capacity - 1)
+        return write_count;
     else
-        // end rolled around
-        return _this->capacity - _this->startpos + _this->endpos;
-}
-
-// internal: translate an item index into buffer position.
-// idx < fill() !
-static unsigned historybuffer_idx2pos(historybuffer_t *_this, unsigned idx)
-{
-    int pos;
-    assert(_this->startpos != _this->endpos); // not empty
-    if (_this->endpos > _this->startpos) {
-        assert(idx < _this->endpos);
-        pos = _this->startpos + idx;
-    } else { // end rolled around
-        if (idx < _this->capacity - _this->startpos)
-            // idx not rolled around
-            pos = _this->startpos + idx;
-        else {
-            // start at ring end, end and idx rolled around
-            pos = idx - (_this->capacity - _this->startpos); // index now from buffer[0]
-            assert(pos < _this->endpos); // not behind end ptr
-        }
-    }
-    return pos;
+        return _this->capacity - 1;
 }
 
 // get item over linear index. [0] = oldest, [fill()-1] = newest, NULL if not found
+// Not protected against concurrent writes, for diagnostics.
 historybuffer_entry_t *historybuffer_get(historybuffer_t *_this, unsigned idx)
 {
-    if (idx >= historybuffer_fill(_this))
+    unsigned fill = historybuffer_fill(_this);
+    if (idx >= fill)
         return NULL;
     else {
-        unsigned pos = historybuffer_idx2pos(_this, idx);
-        return &(_this->buffer[pos]);
+        uint32_t write_count = HISTORYBUFFER_LOAD_ACQUIRE(&_this->write_count);
+        return &(_this->buffer[(write_count - fill + idx) & _this->capacity_mask]);
     }
 }
 
-/* get oldest entry.
+/* append new value at end of buffer
+ * oldest entries get overwritten
+ * the newest entry is valid until the next is appended.
+ * See Java code at blinkenbone.panelsim.ControlSliceVisualization.setStateAveraging()
  */
-historybuffer_entry_t * historybuffer_peek_first(historybuffer_t *_this)
+void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t value)
 {
-    if (_this->startpos == _this->endpos)
-        return NULL; // empty ;
-    return &_this->buffer[_this->startpos];
-}
+    historybuffer_entry_t *hbe;
+    uint32_t write_count = _this->write_count; // only writer modifies
 
-historybuffer_entry_t * historybuffer_peek_last(historybuffer_t *_this)
-{
-    int pos;
-    if (_this->startpos == _this->endpos)
-        return NULL; // empty ;
-    pos = _this->endpos - 1; // point to last written
-    if (pos < 0)
-        pos = _this->capacity - 1;
-    return &_this->buffer[pos];
+    // add new entry only if state changed!
+    if (write_count > 0
+            && HISTORYBUFFER_LOAD_RELAXED(
+                    &_this->buffer[(write_count - 1) & _this->capacity_mask].value) == value)
+        return;
+
+    // fill the entry, then publish it.
+    // Fence: the slot still holds entry #write_count-capacity. A reader which copied
+    // any part of the new entry then also sees "write_count" of this call and retries.
+    HISTORYBUFFER_FENCE_RELEASE();
+    hbe = &_this->buffer[write_count & _this->capacity_mask];
+    HISTORYBUFFER_STORE_RELAXED(&hbe->timestamp_begin_us, now_us);
+    HISTORYBUFFER_STORE_RELAXED(&hbe->value, value);
+    HISTORYBUFFER_STORE_RELEASE(&_this->write_count, write_count + 1);
 }
 
-// remove oldest item from start of buffer
-historybuffer_entry_t * historybuffer_poll(historybuffer_t *_this)
+/*
+ * Sliding window integrator for bit mode.
+ * ON-time of a bit from some origin until t is "acc[bit] + bit(t) * t".
+ * When a bit goes ON at t, t is subtracted from acc, if it goes OFF, t is added.
+ * So advancing over an entry costs only the bits changed against its predecessor.
+ * "head" integrates until now, "tail" until interval start:
+ * ON-time in interval = head integral - tail integral.
+ */
+static void historybuffer_average_edges(uint64_t *acc, uint64_t value_old, uint64_t value_new,
+        uint64_t t)
 {
-    historybuffer_entry_t *entry;
-    if (_this->startpos == _this->endpos)
-        return NULL; // empty ;
-    entry = &_this->buffer[_this->startpos];
-    _this->startpos++;
-    if (_this->startpos >= _this->capacity)
-        _this->startpos = 0;
-    return entry; // valid until next push()
+    uint64_t changed = value_old ^ value_new;
+    while (changed) {
+        unsigned bitidx = lowest_bit_idx(changed);
+        if ((value_new >> bitidx) & 1)
+            acc[bitidx] -= t; // unsigned wrap around cancels in difference
+        else
+            acc[bitidx] += t;
+        changed &= changed - 1;
+    }
 }
 
-/* append new value at end of buffer
- * oldest entries get pushed out
- * the end timestamp of the current value (last set) is udpated ti now
- * See Java code at blinkenbone.panelsim.ControlSliceVisualization.setStateAveraging()
+/*
+ * Move head to "now_us" and tail to "interval_start_us", then calc averaged bits.
+ * State is rebuilt if interval changed, time went backwards, or entries have been overwritten.
+ * Result 0: no entry valid at interval start (buffer younger than interval, or too many
+ * changes in interval): caller must evaluate with complete walk.
  */
-void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t value)
+static int historybuffer_get_average_vals_incremental(historybuffer_t *_this,
+        uint64_t averaging_interval_us, uint64_t now_us)
 {
+    uint64_t interval_start_us = now_us - averaging_interval_us;
+    uint64_t value_mask;
+    uint32_t write_count; // snapshot of writer position
+    uint32_t oldest_seq; // oldest entry read from buffer in this call
+    uint32_t seq;
     historybuffer_entry_t *hbe;
-#ifdef USE_MUTEX
-	pthread_mutex_lock(&_this->mutex) ; // inhinit concurrent reads
-#endif
+    unsigned bitidx;
 
-    if (historybuffer_fill(_this) + 1 >= _this->capacity)
-        // overflow: remove oldest
-        historybuffer_poll(_this);
-
-    hbe = historybuffer_peek_last(_this);
-    if (hbe == NULL || hbe->value != value) {
-        // add new entry only if state changed!
-        if (hbe != NULL)
-            // terminate current state, if queue not empty
-            hbe->timestamp_end_us = now_us;
-        // append new state
-        hbe = &_this->buffer[_this->endpos];
-        // advance to next free buffer entry
-        _this->endpos++;
-        if (_this->endpos >= _this->capacity) {
-            _this->endpos = 0;
-        }
-        // fill data
-        hbe->timestamp_begin_us = now_us;
-        hbe->timestamp_end_us = 0; // currently valid.
-        hbe->value = value;
+    if (_this->control->value_bitlen >= 64)
+        value_mask = ~(uint64_t) 0;
+    else
+        value_mask = ((uint64_t) 1 << _this->control->value_bitlen) - 1;
+
+    write_count = HISTORYBUFFER_LOAD_ACQUIRE(&_this->write_count);
+    if (!_this->avg_valid || _this->avg_interval_us != averaging_interval_us
+            || now_us < _this->avg_now_us
+            || write_count - _this->avg_tail_seq > _this->avg_window_mask) {
+        // rebuild: search newest entry valid at interval start, newest first
+        uint32_t fill = write_count < _this->capacity - 1 ? write_count : _this->capacity - 1;
+        uint32_t idx;
+        for (idx = 1; idx <= fill; idx++)
+            if (HISTORYBUFFER_LOAD_RELAXED(
+                    &_this->buffer[(write_count - idx) & _this->capacity_mask].timestamp_begin_us)
+                    <= interval_start_us)
+                break;
+        if (idx > fill)
+            return 0;
+        seq = write_count - idx;
+        _this->avg_interval_us = averaging_interval_us;
+        _this->avg_head_seq = _this->avg_tail_seq = seq;
+        historybuffer_entry_copy(&_this->avg_window[seq & _this->avg_window_mask],
+                &_this->buffer[seq & _this->capacity_mask]);
+        _this->avg_head_value = _this->avg_tail_value = _this->avg_window[seq
+                & _this->avg_window_mask].value & value_mask;
+        memset(_this->avg_head_acc, 0, sizeof(_this->avg_head_acc));
+        memset(_this->avg_tail_acc, 0, sizeof(_this->avg_tail_acc));
+        _this->avg_valid = 1;
+        oldest_seq = seq;
+    } else
+        oldest_seq = _this->avg_head_seq + 1;
+
+    // entries entering the window. Entries written after caller sampled "now_us" wait.
+    for (seq = _this->avg_head_seq + 1; seq != write_count; seq++) {
+        hbe = &_this->avg_window[seq & _this->avg_window_mask];
+        historybuffer_entry_copy(hbe, &_this->buffer[seq & _this->capacity_mask]);
+        if (hbe->timestamp_begin_us > now_us)
+            break;
+        historybuffer_average_edges(_this->avg_head_acc, _this->avg_head_value,
+                hbe->value & value_mask, hbe->timestamp_begin_us);
+        _this->avg_head_value = hbe->value & value_mask;
+        _this->avg_head_seq = seq;
+    }
+    _this->avg_now_us = now_us;
+    // entries copied: oldest_seq.. head. Oldest must not be in rewrite by now.
+    HISTORYBUFFER_FENCE_ACQUIRE();
+    if (HISTORYBUFFER_LOAD_ACQUIRE(&_this->write_count) - oldest_seq >= _this->capacity) {
+        _this->avg_valid = 0;
+        return 0;
+    }
+
+    // entries leaving the window, from own copy. tail never passes head.
+    for (seq = _this->avg_tail_seq + 1; seq != _this->avg_head_seq + 1; seq++) {
+        hbe = &_this->avg_window[seq & _this->avg_window_mask];
+        if (hbe->timestamp_begin_us > interval_start_us)
+            break;
+        historybuffer_average_edges(_this->avg_tail_acc, _this->avg_tail_value,
+                hbe->value & value_mask, hbe->timestamp_begin_us);
+        _this->avg_tail_value = hbe->value & value_mask;
+        _this->avg_tail_seq = seq;
     }
-	
-#ifdef USE_MUTEX
-	pthread_mutex_unlock(&_this->mutex) ; // allow read
-#endif	
+    // more changes in interval than the buffer can hold:
+    // complete walk assumes oldest entry valid since interval start, do the same.
+    if (write_count - _this->avg_tail_seq >= _this->capacity)
+        return 0;
+
+    // calc average into result, falls in range 0..255
+    for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++) {
+        uint64_t on_us = _this->avg_head_acc[bitidx] - _this->avg_tail_acc[bitidx];
+        if ((_this->avg_head_value >> bitidx) & 1)
+            on_us += now_us;
+        if ((_this->avg_tail_value >> bitidx) & 1)
+            on_us -= interval_start_us;
+        _this->control->averaged_value_bits[bitidx] = (255 * on_us) / averaging_interval_us;
+    }
+    return 1;
 }
 
 /*
@@ -272,16 +345,24 @@ void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t val
  *
  * if averaging_interval_us == 0: return current value
  *
+ * The buffer is not modified: entries are evaluated from newest to oldest,
+ * until the start of the interval is reached.
+ * If the writer overwrote an evaluated entry in the meantime, evaluation is repeated.
+ * In bit mode the interval is normally not walked completely: a sliding window
+ * integrator is advanced over the entries written since the last call,
+ * see historybuffer_get_average_vals_incremental().
+ *
  * See Java code at blinkenbone.panelsim.ControlSliceVisualization.getState()
  */
 void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_interval_us,
         uint64_t now_us, int bitmode)
 {
-    int last_idx; // index of newest entry in history
-    unsigned fill;
-    unsigned idx;
-    historybuffer_entry_t *hbe;
+    uint32_t write_count; // snapshot of writer position
+    uint32_t fill;
+    uint32_t idx; // 1 = newest entry
+    historybuffer_entry_t hbe; // local copy
     uint64_t interval_start_us;
+    uint64_t state_end_us;
     uint64_t sum_state_durations[64]; // cummulated time of all ON states
     uint64_t sum_durations_us; // time of all states
     unsigned bitidx;
@@ -290,66 +371,81 @@ void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_i
     memset(_this->control->averaged_value_bits, 0, sizeof(_this->control->averaged_value_bits));
     _this->control->averaged_value = 0;
 
-    last_idx = historybuffer_fill(_this) - 1;
-    if (last_idx < 0)
-        return; // buffer empty, return all 0's
-#ifdef USE_MUTEX
-	pthread_mutex_lock(&_this->mutex) ; // inhibit concurrent writes
-#endif
-    hbe = historybuffer_get(_this, last_idx);
-    assert(hbe != NULL);
+    if (averaging_interval_us > 0 && bitmode && _this->control->value_bitlen > 0
+            && _this->average_incremental
+            && historybuffer_get_average_vals_incremental(_this, averaging_interval_us, now_us))
+        return;
+
+    interval_start_us = now_us - averaging_interval_us;
+    do {
+        write_count = HISTORYBUFFER_LOAD_ACQUIRE(&_this->write_count);
+        if (write_count == 0)
+            return; // buffer empty, return all 0's
+        fill = write_count < _this->capacity - 1 ? write_count : _this->capacity - 1;
+
+        if (averaging_interval_us == 0) {
+            // just return the current value
+            historybuffer_entry_copy(&hbe, &_this->buffer[(write_count - 1) & _this->capacity_mask]);
+            idx = 1;
+        } else {
+            memset(sum_state_durations, 0, sizeof(sum_state_durations));
+            sum_durations_us = 0;
+            // iterate through all entries in time interval, newest first
+            state_end_us = now_us;
+            for (idx = 1; idx <= fill; idx++) {
+                uint64_t state_starttime_us;
+                uint64_t state_duration_us;
+                historybuffer_entry_copy(&hbe, &_this->buffer[(write_count - idx) & _this->capacity_mask]);
+                if (hbe.timestamp_begin_us > now_us)
+                    continue; // written after caller sampled "now_us"
+                if (idx == fill)
+                    // oldest known state is assumed valid since start of interval
+                    state_starttime_us = interval_start_us;
+                else
+                    state_starttime_us = maxu64(interval_start_us, hbe.timestamp_begin_us);
+                if (state_end_us > state_starttime_us) {
+                    state_duration_us = state_end_us - state_starttime_us;
+                    if (!bitmode) {
+                        // average whole value. Overflow calculation of 64 bit arithmetic:
+                        // assume 256 buffer entries and a final scale of 255, so 8+8 extra bits are needed.
+                        // => overflow if value > 2^48 => 36 bit PDP-10 OK
+                        sum_state_durations[0] += hbe.value * state_duration_us;
+                    } else
+                        // average single bits
+                        for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++) {
+                            if ((hbe.value >> bitidx) & 1)
+                                sum_state_durations[bitidx] += state_duration_us;
+                        }
+                    sum_durations_us += state_duration_us;
+                }
+                if (hbe.timestamp_begin_us <= interval_start_us)
+                    break; // older entries outside interval
+                state_end_us = hbe.timestamp_begin_us;
+            }
+            if (idx > fill)
+                idx = fill;
+        }
+        // entries evaluated: write_count-idx .. write_count-1.
+        // Oldest of these must not be in rewrite by now.
+        HISTORYBUFFER_FENCE_ACQUIRE();
+    } while (HISTORYBUFFER_LOAD_ACQUIRE(&_this->write_count) - (write_count - idx)
+            >= _this->capacity);
 
     if (averaging_interval_us == 0) {
-        // just return the current value
-        _this->control->averaged_value = hbe->value;
+        _this->control->averaged_value = hbe.value;
         if (bitmode)
             for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++)
-                if ((hbe->value >> bitidx) & 1)
+                if ((hbe.value >> bitidx) & 1)
                     _this->control->averaged_value_bits[bitidx] = 1;
-#ifdef USE_MUTEX
-		pthread_mutex_unlock(&_this->mutex) ; // allow write
-#endif
         return;
     }
 
-    // terminate current state (which has no end time yet)
-    hbe->timestamp_end_us = now_us;
-
-    // discard old history entries,
-    interval_start_us = now_us - averaging_interval_us;
-    while ((hbe = historybuffer_peek_first(_this)) && hbe->timestamp_end_us <= interval_start_us)
-        historybuffer_poll(_this);
-    // update start time of first entry to start of averaging intervall (truncate partly)
-    // not necessary, see use of "max()" below. But better for debugging output.
-    if (hbe)
-        hbe->timestamp_begin_us = interval_start_us;
-
-    memset(sum_state_durations, 0, sizeof(sum_state_durations));
-    sum_durations_us = 0;
-    fill = historybuffer_fill(_this);
-    // iterate through all entries in time interval
-    for (idx = 0; (hbe = historybuffer_get(_this, idx)) != NULL; idx++) {
-        uint64_t state_starttime_us = maxu64(interval_start_us, hbe->timestamp_begin_us);
-        uint64_t state_duration_us = hbe->timestamp_end_us - state_starttime_us;
-        if (!bitmode) {
-            // average whole value. Overflow calculation of 64 bit arithmetic:
-            // assume 256 buffer entries and a final scale of 255, so 8+8 extra bits are needed.
-            // => overflow if value > 2^48 => 36 bit PDP-10 OK
-            sum_state_durations[0] += hbe->value * state_duration_us;
-        } else
-            // average single bits
-            for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++) {
-                if ((hbe->value >> bitidx) & 1)
-                    sum_state_durations[bitidx] += state_duration_us;
-            }
-        sum_durations_us += state_duration_us;
-    }
-
     // calc average into result
     // !! sumDurations_us == (now_us - intervalStart_us !!
     if (_this->control->value_bitlen == 0) {
         // average whole value
-        _this->control->averaged_value = (255 * sum_state_durations[0]) / sum_durations_us;
+        if (sum_durations_us > 0)
+            _this->control->averaged_value = (255 * sum_state_durations[0]) / sum_durations_us;
     } else
         // average every single bit
         for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++) {
@@ -360,9 +456,6 @@ void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_i
             else
                 _this->control->averaged_value_bits[bitidx] = 0;
         }
-#ifdef USE_MUTEX		
-	pthread_mutex_unlock(&_this->mutex) ; // allow write
-#endif
 }
 
 /*
@@ -378,27 +471,12 @@ void historybuffer_diagdump(historybuffer_t *_this, FILE *stream, int test_avera
 
     fprintf(stream, "Dump of historybuffer @ %p\n", _this);
     fill = historybuffer_fill(_this);
-    fprintf(stream, "  capacity=%u, startpos=%u, endpos=%u, fill=%u\n", _this->capacity,
-            _this->startpos, _this->endpos, fill);
-    fprintf(stream, "  first: capacity=%u, startpos=%u, endpos=%u, fill=%u\n", _this->capacity,
-            _this->startpos, _this->endpos, fill);
-
-    hbe = historybuffer_peek_first(_this);
-    if (hbe == NULL)
-        fprintf(stream, "no first entry\n");
-    else
-        fprintf(stream, "first entry: %s\n", historybuffer_entry_as_text(hbe));
-
-    hbe = historybuffer_peek_last(_this);
-    if (hbe == NULL)
-        fprintf(stream, "no last entry\n");
-    else
-        fprintf(stream, "last entry: %s\n", historybuffer_entry_as_text(hbe));
+    fprintf(stream, "  capacity=%u, write_count=%u, fill=%u\n", _this->capacity,
+            _this->write_count, fill);
 
     for (idx = 0; idx < fill; idx++) {
-        unsigned pos = historybuffer_idx2pos(_this, idx);
-        hbe = &(_this->buffer[pos]);
-        fprintf(stream, "entry[%u]: pos=%u, %s\n", idx, pos, historybuffer_entry_as_text(hbe));
+        hbe = historybuffer_get(_this, idx);
+        fprintf(stream, "entry[%u]: %s\n", idx, historybuffer_entry_as_text(hbe));
     }
 
     if (test_average && fill > (_this->capacity * 2 / 3)) {
@@ -406,13 +484,14 @@ void historybuffer_diagdump(historybuffer_t *_this, FILE *stream, int test_avera
         uint64_t intervall_start_us;
         uint64_t averaging_interval_us;
         int bitidx; // decrements
-        // calc average for middle of sampled timestamps. after that, older buffer entries are deleted
+        // calc average for middle of sampled timestamps.
         idx = fill / 2;
         hbe = historybuffer_get(_this, idx);
         if (hbe == NULL)
             return;
         // interval start in the middle of a value sample
-        intervall_start_us = (hbe->timestamp_end_us + hbe->timestamp_begin_us) / 2;
+        intervall_start_us = (historybuffer_get(_this, idx + 1)->timestamp_begin_us
+                + hbe->timestamp_begin_us) / 2;
         averaging_interval_us = now_us - intervall_start_us;
         historybuffer_get_average_vals(_this, averaging_interval_us, now_us, /*bitmode*/1);
         fprintf(stream,
@@ -427,4 +506,3 @@ void historybuffer_diagdump(historybuffer_t *_this, FILE *stream, int test_avera
     }
 
 }
-
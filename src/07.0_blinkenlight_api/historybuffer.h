@@ -21,6 +21,8 @@
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+ 16-OCT-2026			bit mode averaging with sliding window integrator
+ 16-OCT-2026			lock-free single producer/single consumer ring replaces the mutex
  03-FEB-2019	JH		mutex to make read and write to buffer atomic (PiDP11 server crashes)
  12-Mar-2016	JH      created
  */
@@ -31,34 +33,52 @@
 
 #include <stdint.h>
 #include <stdio.h>
-#ifndef WIN32
-// under Windows only simulating server and pthread not available
-#define USE_MUTEX
-#include <pthread.h>
-#endif
 
-/* single entry in history buffer */
+/*
+ * Single producer / single consumer:
+ * one thread writes with historybuffer_set_val() (RPC server),
+ * another thread reads with historybuffer_get_average_vals() (LED pattern generator).
+ * No lock: writer publishes new entries by advancing "write_count" (release),
+ * reader never modifies the buffer and retries if the writer overwrote
+ * entries while they were evaluated.
+ */
+
+/* single entry in history buffer.
+ * A value is valid until the begin of the next entry, the newest until "now".
+ * Fields are only accessed as relaxed atomics, see historybuffer.c */
 typedef struct
 {
 	uint64_t value;
 	uint64_t timestamp_begin_us; // value is valid after this time
-	uint64_t timestamp_end_us; // value is valid before this time, 0 = current valid
 } historybuffer_entry_t;
 
 typedef struct
 {
 	struct blinkenlight_control_struct *control; // backlink to possessing control
-	// data types internal "int" becaus of arithemtic
-	int capacity;
+	unsigned capacity; // power of 2
+	unsigned capacity_mask;
 
-	int startpos; // first valid item in ring
-	int endpos; // next free item to write
-	// empty: readidx == writeidx
+	// count of all entries ever written. Entry #n is at buffer[n & capacity_mask].
+	// The last "capacity-1" entries are valid, the slot of the oldest may be in rewrite.
+	// Only modified by writer.
+	uint32_t write_count;
 	historybuffer_entry_t *buffer;
-#ifdef USE_MUTEX
-	pthread_mutex_t mutex; // exclusive access to either read or write functions
-#endif	
 
+	// Reader only: sliding window integrator for historybuffer_get_average_vals(bitmode=1).
+	// "head" follows the newest entry up to "now", "tail" the entry valid at window start.
+	// Per bit: ON-time integral = avg_head_acc[bit] + bit*now, changed only on bit edges.
+	int average_incremental; // 0: always evaluate complete interval (diagnostics)
+	int avg_valid; // 0: state has to be rebuild
+	uint64_t avg_interval_us;
+	uint64_t avg_now_us;
+	uint32_t avg_head_seq; // entry valid at avg_now_us
+	uint32_t avg_tail_seq; // entry valid at avg_now_us - avg_interval_us
+	historybuffer_entry_t *avg_window; // copy of entries tail..head, 2*capacity, [seq & avg_window_mask]
+	unsigned avg_window_mask;
+	uint64_t avg_head_value;
+	uint64_t avg_tail_value;
+	uint64_t avg_head_acc[64];
+	uint64_t avg_tail_acc[64];
 } historybuffer_t;
 
 uint64_t historybuffer_now_us(void);
@@ -66,23 +86,16 @@ uint64_t historybuffer_now_us(void);
 historybuffer_t *historybuffer_create(struct blinkenlight_control_struct *c, unsigned capacity);
 void historybuffer_destroy(historybuffer_t *_this);
 
-// append new value at end of buffer
+// append new value at end of buffer. Writer only.
 void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t value);
 
-// get oldest entry
-historybuffer_entry_t * historybuffer_peek_first(historybuffer_t *_this);
-// get newest entry
-historybuffer_entry_t * historybuffer_peek_last(historybuffer_t *_this);
-
-// remove oldest item from start of buffer
-historybuffer_entry_t * historybuffer_poll(historybuffer_t *_this);
-
 // get number # of items in buffer
 unsigned historybuffer_fill(historybuffer_t *_this);
 
 // get item over index. 0 = oldest, fill()-1 = newest, NULL if not found
 historybuffer_entry_t *historybuffer_get(historybuffer_t *_this, unsigned idx);
 
+// Reader only.
 void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_interval_us,
 		uint64_t now_us, int bitmode);
 
@@ -0,0 +1,114 @@
+/* historybuffer_benchmark.c: timing of historybuffer_get_average_vals()
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ Stand alone, not part of server build:
+	gcc -O2 -DBLINKENLIGHT_SERVER -I/usr/include/tirpc -o historybuffer_benchmark \
+		historybuffer_benchmark.c historybuffer.c
+
+ Simulates a PiDP11 lamp control: fmax = 10 Hz (100ms averaging interval),
+ value changes every 400us (buffer nearly full), LED pattern update every 20ms.
+ Reports ns per historybuffer_get_average_vals(bitmode=1) for complete walk
+ over the interval and for the sliding window integrator.
+ Both variants must calculate the same averages.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "historybuffer.h"
+#include "blinkenlight_panels.h"
+
+#define BENCHMARK_CAPACITY	256
+#define BENCHMARK_INTERVAL_US	100000
+#define BENCHMARK_CHANGE_PERIOD_US	400
+#define BENCHMARK_QUERY_PERIOD_US	20000
+#define BENCHMARK_QUERIES	200000
+
+static uint64_t benchmark_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+// pseudo random values, same sequence for every run
+static uint64_t benchmark_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/*
+ * feed buffer and query it. Only the query is timed.
+ * result: ns per query, checksum over all averages in *checksum
+ */
+static double benchmark_run(unsigned value_bitlen, int incremental, uint64_t *checksum)
+{
+    blinkenlight_control_t control;
+    historybuffer_t *hb;
+    uint64_t random_state = 0x2545f4914f6cdd1dULL;
+    uint64_t now_us = 1000000;
+    uint64_t ns = 0;
+    unsigned query, i, bitidx;
+
+    memset(&control, 0, sizeof(control));
+    control.value_bitlen = value_bitlen;
+    hb = historybuffer_create(&control, BENCHMARK_CAPACITY);
+    hb->average_incremental = incremental;
+    *checksum = 0;
+    for (query = 0; query < BENCHMARK_QUERIES; query++) {
+        uint64_t start_ns;
+        for (i = 0; i < BENCHMARK_QUERY_PERIOD_US / BENCHMARK_CHANGE_PERIOD_US; i++) {
+            now_us += BENCHMARK_CHANGE_PERIOD_US;
+            historybuffer_set_val(hb, now_us, benchmark_random(&random_state));
+        }
+        start_ns = benchmark_ns();
+        historybuffer_get_average_vals(hb, BENCHMARK_INTERVAL_US, now_us, /*bitmode*/1);
+        ns += benchmark_ns() - start_ns;
+        for (bitidx = 0; bitidx < value_bitlen; bitidx++)
+            *checksum = *checksum * 31 + control.averaged_value_bits[bitidx];
+    }
+    historybuffer_destroy(hb);
+    return (double) ns / BENCHMARK_QUERIES;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned bitlens[] = { 1, 16, 22, 36 };
+    unsigned i;
+    int result = 0;
+
+    printf("bitlen   complete walk   incremental\n");
+    for (i = 0; i < sizeof(bitlens) / sizeof(bitlens[0]); i++) {
+        uint64_t checksum_walk, checksum_incremental;
+        double ns_walk = benchmark_run(bitlens[i], 0, &checksum_walk);
+        double ns_incremental = benchmark_run(bitlens[i], 1, &checksum_incremental);
+        printf("%6u %12.0f ns %11.0f ns%s\n", bitlens[i], ns_walk, ns_incremental,
+                checksum_walk == checksum_incremental ? "" : "   RESULTS DIFFER!");
+        if (checksum_walk != checksum_incremental)
+            result = 1;
+    }
+    return result;
+}
@@ -0,0 +1,246 @@
+/* historybuffer_stress.c: concurrent writer and reader on one historybuffer
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ Stand alone, not part of server build:
+	gcc -O2 -pthread -DBLINKENLIGHT_SERVER -I/usr/include/tirpc -o historybuffer_stress \
+		historybuffer_stress.c historybuffer.c
+	./historybuffer_stress [-c writer_cpu,reader_cpu] [writes]
+
+ The writer thread plays the RPC server: historybuffer_set_val() at ~10 kHz.
+ The reader plays the LED pattern generator: historybuffer_get_average_vals()
+ at ~10 kHz, alternating complete walk and sliding window integrator.
+ Writer and reader are pinned to different CPUs (default 0 and 1), else they
+ never run truly concurrent: with only one CPU the test still runs, but warns.
+ Entry #n has a fixed timestamp and value, so the reader knows the exact
+ bit averages for any "now" and checks every call against them.
+ If the writer overwrote entries of the interval during the call ("overrun"),
+ the oldest entry left in the buffer was extended to the interval start:
+ the result must then match one of the oldest entries possible while the call ran.
+ Any mismatch means a torn or lost entry.
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "historybuffer.h"
+#include "blinkenlight_panels.h"
+
+#define STRESS_CAPACITY	256
+#define STRESS_BITLEN	22
+#define STRESS_CHANGE_PERIOD_US	400 // timestamp distance of entries
+#define STRESS_INTERVAL_US	100000 // 250 entries: buffer nearly full
+#define STRESS_WRITE_PERIOD_NS	100000 // writer pace
+#define STRESS_READ_PERIOD_NS	100000 // reader pace
+#define STRESS_WRITES	200000
+#define STRESS_T0_US	1000000
+
+static historybuffer_t *stress_hb;
+static unsigned stress_writes = STRESS_WRITES;
+static volatile int stress_writer_done;
+static int stress_writer_cpu = 0, stress_reader_cpu = 1;
+
+// timestamp and value of entry #n
+static uint64_t stress_timestamp_us(uint32_t n)
+{
+    return STRESS_T0_US + (uint64_t) n * STRESS_CHANGE_PERIOD_US;
+}
+
+// splitmix64: a bijection, so consecutive values always differ and are all written
+static uint64_t stress_value(uint32_t n)
+{
+    uint64_t z = (uint64_t) n + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t stress_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+static void *stress_writer(void *arg)
+{
+    uint64_t start_ns = stress_ns();
+    uint32_t n;
+
+    for (n = 0; n < stress_writes; n++) {
+        while (stress_ns() - start_ns < (uint64_t) n * STRESS_WRITE_PERIOD_NS)
+            ;
+        historybuffer_set_val(stress_hb, stress_timestamp_us(n), stress_value(n));
+    }
+    __atomic_store_n(&stress_writer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// expected bit averages over [now_us - STRESS_INTERVAL_US, now_us], entry #newest valid at now_us.
+// Entry #first is the oldest in the buffer, assumed valid since interval start.
+static void stress_expected(uint32_t newest, uint32_t first, uint64_t now_us,
+        uint8_t *averaged_value_bits)
+{
+    uint64_t interval_start_us = now_us - STRESS_INTERVAL_US;
+    uint64_t on_us[STRESS_BITLEN];
+    uint64_t state_end_us = now_us;
+    uint32_t n;
+    unsigned bitidx;
+
+    memset(on_us, 0, sizeof(on_us));
+    for (n = newest;; n--) {
+        uint64_t begin_us = stress_timestamp_us(n);
+        uint64_t value = stress_value(n);
+        if (begin_us < interval_start_us || n == first)
+            begin_us = interval_start_us;
+        for (bitidx = 0; bitidx < STRESS_BITLEN; bitidx++)
+            if ((value >> bitidx) & 1)
+                on_us[bitidx] += state_end_us - begin_us;
+        if (begin_us == interval_start_us)
+            break;
+        state_end_us = begin_us;
+    }
+    for (bitidx = 0; bitidx < STRESS_BITLEN; bitidx++)
+        averaged_value_bits[bitidx] = (255 * on_us[bitidx]) / STRESS_INTERVAL_US;
+}
+
+static int stress_pin(pthread_t thread, int cpu)
+{
+    cpu_set_t cpuset;
+
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    if (pthread_setaffinity_np(thread, sizeof(cpuset), &cpuset)) {
+        fprintf(stderr, "Can not pin thread to CPU %d\n", cpu);
+        return -1;
+    }
+    return 0;
+}
+
+static int stress_matches(const uint8_t *averaged_value_bits, const uint8_t *expected,
+        unsigned *bitidx)
+{
+    for (*bitidx = 0; *bitidx < STRESS_BITLEN; (*bitidx)++)
+        if (averaged_value_bits[*bitidx] != expected[*bitidx])
+            return 0;
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    blinkenlight_control_t control;
+    pthread_t writer;
+    uint8_t expected[STRESS_BITLEN];
+    uint64_t random_state = 0x2545f4914f6cdd1dULL;
+    unsigned long reads = 0, checked = 0, overrun = 0, mismatch = 0;
+    unsigned bitidx;
+    long ncpu;
+    struct timespec next_read;
+    int pin = 1;
+    int argi = 1;
+
+    if (argi + 1 < argc && !strcmp(argv[argi], "-c")) {
+        if (sscanf(argv[argi + 1], "%d,%d", &stress_writer_cpu, &stress_reader_cpu) != 2) {
+            fprintf(stderr, "Usage: %s [-c writer_cpu,reader_cpu] [writes]\n", argv[0]);
+            return 2;
+        }
+        argi += 2;
+    }
+    if (argi < argc)
+        stress_writes = strtoul(argv[argi], NULL, 0);
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 2) {
+        printf("WARNING: only %ld CPU online, writer and reader never run concurrently.\n",
+                ncpu);
+        pin = 0;
+    } else if (stress_writer_cpu == stress_reader_cpu)
+        printf("WARNING: writer and reader pinned to the same CPU %d.\n", stress_writer_cpu);
+    memset(&control, 0, sizeof(control));
+    control.value_bitlen = STRESS_BITLEN;
+    stress_hb = historybuffer_create(&control, STRESS_CAPACITY);
+    if (pthread_create(&writer, NULL, stress_writer, NULL)) {
+        perror("pthread_create");
+        return 2;
+    }
+    if (pin && (stress_pin(writer, stress_writer_cpu) || stress_pin(pthread_self(),
+            stress_reader_cpu)))
+        return 2;
+
+    clock_gettime(CLOCK_MONOTONIC, &next_read);
+    while (!__atomic_load_n(&stress_writer_done, __ATOMIC_ACQUIRE)) {
+        uint32_t write_count, write_count_after, oldest, first;
+        uint64_t now_us;
+
+        next_read.tv_nsec += STRESS_READ_PERIOD_NS;
+        if (next_read.tv_nsec >= 1000000000) {
+            next_read.tv_nsec -= 1000000000;
+            next_read.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_read, NULL);
+
+        write_count = __atomic_load_n(&stress_hb->write_count, __ATOMIC_ACQUIRE);
+        if (write_count < STRESS_INTERVAL_US / STRESS_CHANGE_PERIOD_US + 2)
+            continue;
+        // "now" before the next entry: all entries up to "now" are published
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 7;
+        random_state ^= random_state << 17;
+        now_us = stress_timestamp_us(write_count - 1) + random_state % STRESS_CHANGE_PERIOD_US;
+        oldest = (now_us - STRESS_INTERVAL_US - STRESS_T0_US) / STRESS_CHANGE_PERIOD_US;
+
+        stress_hb->average_incremental = reads & 1;
+        historybuffer_get_average_vals(stress_hb, STRESS_INTERVAL_US, now_us, /*bitmode*/1);
+        reads++;
+
+        write_count_after = __atomic_load_n(&stress_hb->write_count, __ATOMIC_ACQUIRE);
+        checked++;
+        if (write_count_after - oldest < STRESS_CAPACITY - 1) {
+            stress_expected(write_count - 1, oldest, now_us, expected);
+        } else {
+            // interval start no longer in buffer: the call saw "write_count"
+            // somewhere in write_count..write_count_after, and its oldest entry
+            overrun++;
+            for (first = write_count - (STRESS_CAPACITY - 1);
+                    first != write_count_after - (STRESS_CAPACITY - 1) + 1 && first != write_count;
+                    first++) {
+                stress_expected(write_count - 1, first, now_us, expected);
+                if (stress_matches(control.averaged_value_bits, expected, &bitidx))
+                    break;
+            }
+        }
+        if (!stress_matches(control.averaged_value_bits, expected, &bitidx) && mismatch++ < 10)
+            printf("MISMATCH: write_count=%u..%u, now=%llu us, %s, bit %u: %u, expected %u\n",
+                    write_count, write_count_after, (unsigned long long) now_us,
+                    (reads - 1) & 1 ? "incremental" : "complete walk", bitidx,
+                    control.averaged_value_bits[bitidx], expected[bitidx]);
+    }
+    pthread_join(writer, NULL);
+    historybuffer_destroy(stress_hb);
+
+    printf("%u writes, %lu reads: %lu checked, %lu of them overrun, %lu mismatches\n",
+            stress_writes, reads, checked, overrun, mismatch);
+    return mismatch ? 1 : 0;
+}
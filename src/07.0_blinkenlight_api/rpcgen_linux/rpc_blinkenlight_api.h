@@ -94,6 +94,7 @@ typedef struct rpc_blinkenlight_api_setpanel_controlvalues_res rpc_blinkenlight_
 #define RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST 1
 #define RPC_PARAM_VALUE_PANEL_MODE_ALLTEST 2
 #define RPC_PARAM_VALUE_PANEL_MODE_POWERLESS 3
+#define RPC_PARAM_HANDLE_PANEL_SHM 3
 
 struct rpc_param_cmd_get_struct {
 	u_int object_class;
@@ -146,6 +147,18 @@ struct rpc_blinkenlight_api_setpanel_controlvalues_1_argument {
 };
 typedef struct rpc_blinkenlight_api_setpanel_controlvalues_1_argument rpc_blinkenlight_api_setpanel_controlvalues_1_argument;
 
+struct rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument {
+	u_int arg1;
+	rpc_blinkenlight_api_controlvalues_struct valuelist;
+};
+typedef struct rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument;
+
+struct rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument {
+	u_int arg1;
+	rpc_blinkenlight_api_controlvalues_struct valuelist;
+};
+typedef struct rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument;
+
 #define BLINKENLIGHTD 99
 #define BLINKENLIGHTD_VERS 1
 
@@ -165,6 +178,12 @@ extern  rpc_blinkenlight_api_setpanel_controlvalues_res * rpc_blinkenlight_api_s
 #define RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES 5
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1(u_int , CLIENT *);
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1_svc(u_int , struct svc_req *);
+#define RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES 6
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_1(u_int , rpc_blinkenlight_api_controlvalues_struct , CLIENT *);
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_1_svc(u_int , rpc_blinkenlight_api_controlvalues_struct , struct svc_req *);
+#define RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES_DELTA 7
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1(u_int , rpc_blinkenlight_api_controlvalues_struct , CLIENT *);
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_svc(u_int , rpc_blinkenlight_api_controlvalues_struct , struct svc_req *);
 #define RPC_PARAM_GET 100
 extern  rpc_param_result_struct * rpc_param_get_1(rpc_param_cmd_get_struct , CLIENT *);
 extern  rpc_param_result_struct * rpc_param_get_1_svc(rpc_param_cmd_get_struct , struct svc_req *);
@@ -195,6 +214,12 @@ extern  rpc_blinkenlight_api_setpanel_controlvalues_res * rpc_blinkenlight_api_s
 #define RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES 5
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1();
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1_svc();
+#define RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES 6
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_1();
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_1_svc();
+#define RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES_DELTA 7
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1();
+extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_svc();
 #define RPC_PARAM_GET 100
 extern  rpc_param_result_struct * rpc_param_get_1();
 extern  rpc_param_result_struct * rpc_param_get_1_svc();
@@ -231,6 +256,8 @@ extern  bool_t xdr_rpc_test_cmdstatus_struct (XDR *, rpc_test_cmdstatus_struct*)
 extern  bool_t xdr_rpc_test_data_struct (XDR *, rpc_test_data_struct*);
 extern  bool_t xdr_rpc_blinkenlight_api_getcontrolinfo_1_argument (XDR *, rpc_blinkenlight_api_getcontrolinfo_1_argument*);
 extern  bool_t xdr_rpc_blinkenlight_api_setpanel_controlvalues_1_argument (XDR *, rpc_blinkenlight_api_setpanel_controlvalues_1_argument*);
+extern  bool_t xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument (XDR *, rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument*);
+extern  bool_t xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument (XDR *, rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument*);
 
 #else /* K&R C */
 extern bool_t xdr_rpc_blinkenlight_api_nametype ();
@@ -251,6 +278,8 @@ extern bool_t xdr_rpc_test_cmdstatus_struct ();
 extern bool_t xdr_rpc_test_data_struct ();
 extern bool_t xdr_rpc_blinkenlight_api_getcontrolinfo_1_argument ();
 extern bool_t xdr_rpc_blinkenlight_api_setpanel_controlvalues_1_argument ();
+extern bool_t xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument ();
+extern bool_t xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument ();
 
 #endif /* K&R C */
 
@@ -130,6 +130,7 @@ const RPC_PARAM_VALUE_PANEL_MODE_NORMAL	= 0 ; /* panel in normal operating mode
 const RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST = 1 ; /* historic accurate, test lamps */
 const RPC_PARAM_VALUE_PANEL_MODE_ALLTEST = 2 ; /* test every control, inputs and outputs */
 const RPC_PARAM_VALUE_PANEL_MODE_POWERLESS = 3 ; /* all lamps off, power button released, pnael over PAI repsonsive */
+const RPC_PARAM_HANDLE_PANEL_SHM = 3 ; /* get: token of shared memory segment, 0 = none. set token: client uses shm, set 0: client uses RPC */
 
 /* cmd to server: get a parameter value */
 struct rpc_param_cmd_get_struct {
@@ -185,6 +186,15 @@ program BLINKENLIGHTD {
     rpc_blinkenlight_api_getcontrolinfo_res RPC_BLINKENLIGHT_API_GETCONTROLINFO(unsigned /*hPanel*/, unsigned /*hControl*/) = 3;
     rpc_blinkenlight_api_setpanel_controlvalues_res RPC_BLINKENLIGHT_API_SETPANEL_CONTROLVALUES(unsigned /*hPanel*/, rpc_blinkenlight_api_controlvalues_struct valuelist) = 4;
     rpc_blinkenlight_api_controlvalues_struct RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES(unsigned /*hPanel*/) = 5;
+    /* SETPANEL_CONTROLVALUES and GETPANEL_CONTROLVALUES in one round trip:
+     * valuelist are the output values, result are the input values.
+     * Older servers answer with PROC_UNAVAIL, clients fall back to 4 and 5. */
+    rpc_blinkenlight_api_controlvalues_struct RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES(unsigned /*hPanel*/, rpc_blinkenlight_api_controlvalues_struct valuelist) = 6;
+    /* like EXCHANGEPANEL_CONTROLVALUES, but only changed outputs are transmitted:
+     * valuelist starts with a change bitmap, 1 bit for each output control (bit 0 of byte 0 = first),
+     * followed by the values of the changed output controls only.
+     * Older servers answer with PROC_UNAVAIL, clients fall back to 6. */
+    rpc_blinkenlight_api_controlvalues_struct RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES_DELTA(unsigned /*hPanel*/, rpc_blinkenlight_api_controlvalues_struct valuelist) = 7;
     /* generic parameter get/set */
     rpc_param_result_struct RPC_PARAM_GET(rpc_param_cmd_get_struct cmd_get) = 100;
     rpc_param_result_struct RPC_PARAM_SET(rpc_param_cmd_set_struct cmd_set) = 101;
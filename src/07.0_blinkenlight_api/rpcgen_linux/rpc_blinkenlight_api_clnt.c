@@ -87,6 +87,40 @@ rpc_blinkenlight_api_getpanel_controlvalues_1(u_int arg1,  CLIENT *clnt)
 	return (&clnt_res);
 }
 
+rpc_blinkenlight_api_controlvalues_struct *
+rpc_blinkenlight_api_exchangepanel_controlvalues_1(u_int arg1, rpc_blinkenlight_api_controlvalues_struct valuelist,  CLIENT *clnt)
+{
+	rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument arg;
+	static rpc_blinkenlight_api_controlvalues_struct clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	arg.arg1 = arg1;
+	arg.valuelist = valuelist;
+	if (clnt_call (clnt, RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES, (xdrproc_t) xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument, (caddr_t) &arg,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_controlvalues_struct, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
+rpc_blinkenlight_api_controlvalues_struct *
+rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1(u_int arg1, rpc_blinkenlight_api_controlvalues_struct valuelist,  CLIENT *clnt)
+{
+	rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument arg;
+	static rpc_blinkenlight_api_controlvalues_struct clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	arg.arg1 = arg1;
+	arg.valuelist = valuelist;
+	if (clnt_call (clnt, RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES_DELTA, (xdrproc_t) xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument, (caddr_t) &arg,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_controlvalues_struct, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
 rpc_param_result_struct *
 rpc_param_get_1(rpc_param_cmd_get_struct cmd_get,  CLIENT *clnt)
 {
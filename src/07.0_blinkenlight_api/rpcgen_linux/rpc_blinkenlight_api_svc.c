@@ -46,6 +46,18 @@ _rpc_blinkenlight_api_getpanel_controlvalues_1 (u_int  *argp, struct svc_req *rq
 	return (rpc_blinkenlight_api_getpanel_controlvalues_1_svc(*argp, rqstp));
 }
 
+static rpc_blinkenlight_api_controlvalues_struct *
+_rpc_blinkenlight_api_exchangepanel_controlvalues_1 (rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument *argp, struct svc_req *rqstp)
+{
+	return (rpc_blinkenlight_api_exchangepanel_controlvalues_1_svc(argp->arg1, argp->valuelist, rqstp));
+}
+
+static rpc_blinkenlight_api_controlvalues_struct *
+_rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1 (rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument *argp, struct svc_req *rqstp)
+{
+	return (rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_svc(argp->arg1, argp->valuelist, rqstp));
+}
+
 static rpc_param_result_struct *
 _rpc_param_get_1 (rpc_param_cmd_get_struct  *argp, struct svc_req *rqstp)
 {
@@ -78,6 +90,8 @@ blinkenlightd_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		rpc_blinkenlight_api_getcontrolinfo_1_argument rpc_blinkenlight_api_getcontrolinfo_1_arg;
 		rpc_blinkenlight_api_setpanel_controlvalues_1_argument rpc_blinkenlight_api_setpanel_controlvalues_1_arg;
 		u_int rpc_blinkenlight_api_getpanel_controlvalues_1_arg;
+		rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument rpc_blinkenlight_api_exchangepanel_controlvalues_1_arg;
+		rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_arg;
 		rpc_param_cmd_get_struct rpc_param_get_1_arg;
 		rpc_param_cmd_set_struct rpc_param_set_1_arg;
 		rpc_test_data_struct rpc_test_data_to_server_1_arg;
@@ -122,6 +136,18 @@ blinkenlightd_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		local = (char *(*)(char *, struct svc_req *)) _rpc_blinkenlight_api_getpanel_controlvalues_1;
 		break;
 
+	case RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES:
+		_xdr_argument = (xdrproc_t) xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument;
+		_xdr_result = (xdrproc_t) xdr_rpc_blinkenlight_api_controlvalues_struct;
+		local = (char *(*)(char *, struct svc_req *)) _rpc_blinkenlight_api_exchangepanel_controlvalues_1;
+		break;
+
+	case RPC_BLINKENLIGHT_API_EXCHANGEPANEL_CONTROLVALUES_DELTA:
+		_xdr_argument = (xdrproc_t) xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument;
+		_xdr_result = (xdrproc_t) xdr_rpc_blinkenlight_api_controlvalues_struct;
+		local = (char *(*)(char *, struct svc_req *)) _rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1;
+		break;
+
 	case RPC_PARAM_GET:
 		_xdr_argument = (xdrproc_t) xdr_rpc_param_cmd_get_struct;
 		_xdr_result = (xdrproc_t) xdr_rpc_param_result_struct;
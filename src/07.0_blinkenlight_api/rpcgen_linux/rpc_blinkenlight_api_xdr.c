@@ -361,3 +361,23 @@ xdr_rpc_blinkenlight_api_setpanel_controlvalues_1_argument (XDR *xdrs, rpc_blink
 		 return FALSE;
 	return TRUE;
 }
+
+bool_t
+xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument (XDR *xdrs, rpc_blinkenlight_api_exchangepanel_controlvalues_1_argument *objp)
+{
+	 if (!xdr_u_int (xdrs, &objp->arg1))
+		 return FALSE;
+	 if (!xdr_rpc_blinkenlight_api_controlvalues_struct (xdrs, &objp->valuelist))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument (XDR *xdrs, rpc_blinkenlight_api_exchangepanel_controlvalues_delta_1_argument *objp)
+{
+	 if (!xdr_u_int (xdrs, &objp->arg1))
+		 return FALSE;
+	 if (!xdr_rpc_blinkenlight_api_controlvalues_struct (xdrs, &objp->valuelist))
+		 return FALSE;
+	return TRUE;
+}
@@ -70,17 +70,17 @@ long intervl = 50000; // light each row of leds 50 us
 // In early versions INP_GPIO(x) was used always before OUT_GPIO(x),
 // this is disabled now by INO_GPIO(g)
 #define INO_GPIO(g) //INP_GPIO(g) // Use this before OUT_GPIO
-#define INP_GPIO(g)   *(gpio.addr + ((g)/10)) &= ~(7<<(((g)%10)*3))
-#define OUT_GPIO(g)   *(gpio.addr + ((g)/10)) |=  (1<<(((g)%10)*3))
-#define SET_GPIO_ALT(g,a) *(gpio.addr + (((g)/10))) |= (((a)<=3?(a) + 4:(a)==4?3:2)<<(((g)%10)*3))
+#define INP_GPIO(g)   gpio_write((g)/10, gpio.addr[(g)/10] & ~(7<<(((g)%10)*3)))
+#define OUT_GPIO(g)   gpio_write((g)/10, gpio.addr[(g)/10] |  (1<<(((g)%10)*3)))
+#define SET_GPIO_ALT(g,a) gpio_write((g)/10, gpio.addr[(g)/10] | (((a)<=3?(a) + 4:(a)==4?3:2)<<(((g)%10)*3)))
 
-#define GPIO_SET  *(gpio.addr + 7)  // sets   bits which are 1 ignores bits which are 0
-#define GPIO_CLR  *(gpio.addr + 10) // clears bits which are 1 ignores bits which are 0
+#define GPIO_SET(v)  gpio_write(7, (v))  // sets   bits which are 1 ignores bits which are 0
+#define GPIO_CLR(v)  gpio_write(10, (v)) // clears bits which are 1 ignores bits which are 0
 
-#define GPIO_READ(g)  *(gpio.addr + 13) &= (1<<(g))
+#define GPIO_READ(g)  (gpio.addr[13] & (1<<(g)))
 
-#define GPIO_PULL *(gpio.addr + 37) // pull up/pull down
-#define GPIO_PULLCLK0 *(gpio.addr + 38) // pull up/pull down clock
+#define GPIO_PULL(v) gpio_write(37, (v)) // pull up/pull down
+#define GPIO_PULLCLK0(v) gpio_write(38, (v)) // pull up/pull down clock
 
 // Pi 4 update
 /* https://github.com/RPi-Distro/raspi-gpio/blob/master/raspi-gpio.c */	
@@ -114,6 +114,17 @@ void unmap_peripheral(struct bcm2835_peripheral *p)
 	close(p->mem_fd);
 }
 
+static void gpio_mem_delay_ns(long ns)
+{
+	nanosleep((struct timespec[]) { { 0, ns}}, NULL);
+}
+
+// the real GPIO registers
+gpio_backend_t gpio_backend_mem =
+{ "mem", map_peripheral, unmap_peripheral, NULL, gpio_mem_delay_ns };
+
+gpio_backend_t *gpio_backend = &gpio_backend_mem;
+
 // PART 2 - the multiplexing logic driving the front panel -------------
 
 uint8_t ledrows[] = {20, 21, 22, 23, 24, 25};
@@ -123,9 +134,13 @@ uint8_t rows[] = {16, 17, 18};
 uint8_t cols[] = {26,27,4, 5,6,7, 8,9,10, 11,12,13};
 
 
-void *blink(int *terminate)
+/*
+ * Map GPIO registers, set all mux pins to input, configure pull-ups.
+ * result 0 = OK, -1 = error
+ */
+int gpio_setup(void)
 {
-	int i, j, k, switchscan, tmp;
+	int i;
 
 	// Find gpio address (different for Pi 2) ----------
 	gpio.addr_p = bcm_host_get_peripheral_address() + +0x200000;
@@ -136,26 +151,16 @@ void *blink(int *terminate)
 	else if (gpio.addr_p == 0xfe200000)  
 		printf("*** RPi 4 detected\n");
 
-	// printf("Priority max SCHED_FIFO = %u\n",sched_get_priority_max(SCHED_FIFO) );
-
-	// set thread to real time priority -----------------
-	struct sched_param sp;
-	sp.sched_priority = 98; // maybe 99, 32, 31?
-	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp)) {
-		fprintf(stderr, "warning: failed to set RT priority\n");
-	}
-
-	// --------------------------------------------------
-	if (map_peripheral(&gpio) == -1) {
+	if (gpio_backend->map(&gpio) == -1) {
 		printf("Failed to map the physical GPIO registers into the virtual memory space.\n");
-		return (void *) -1;
+		return -1;
 	}
 
 	// initialise GPIO (all pins used as inputs, with pull-ups enabled on cols)
 
 	for (i = 0; i < 6; i++) { // Define ledrows as input
 		INP_GPIO(ledrows[i]);
-		GPIO_CLR = 1 << ledrows[i]; // so go to Low when switched to output
+		GPIO_CLR(1 << ledrows[i]); // so go to Low when switched to output
 	}
 	for (i = 0; i < 12; i++) // Define cols as input
 			{
@@ -185,11 +190,11 @@ if (gpio.addr_p==0xfe200000)
 		pullshift = (gpiox & 0xf) << 1;
 		pull = 1;	// pullup
 
-		pullbits = *(gpio.addr + pullreg);
+		pullbits = gpio.addr[pullreg];
 		//printf("col %d pullreg %d pullshift %x pull %d -- pullbits %x --> ", gpiox, pullreg, pullshift, pull, pullbits);
 		pullbits &= ~(3 << pullshift);
 		pullbits |= (pull << pullshift);
-		*(gpio.addr + pullreg) = pullbits;
+		gpio_write(pullreg, pullbits);
 		//printf("%x == %x --- %xl\r\n", pullbits, *(&gpio.addr_p + pullreg), gpio.addr_p + pullreg);
 	}
 	// GPIO row pins
@@ -200,10 +205,10 @@ if (gpio.addr_p==0xfe200000)
 		pullshift = (gpiox & 0xf) << 1;
 		pull = 0;	// pullup
 
-		pullbits = *(gpio.addr + pullreg);
+		pullbits = gpio.addr[pullreg];
 		pullbits &= ~(3 << pullshift);
 		pullbits |= (pull << pullshift);
-		*(gpio.addr + pullreg) = pullbits;
+		gpio_write(pullreg, pullbits);
 	}
 	// GPIO ledrow pins
 	for (i=0;i<6;i++)
@@ -213,48 +218,116 @@ if (gpio.addr_p==0xfe200000)
 		pullshift = (gpiox & 0xf) << 1;
 		pull = 0;	// pullup
 
-		pullbits = *(gpio.addr + pullreg);
+		pullbits = gpio.addr[pullreg];
 		pullbits &= ~(3 << pullshift);
 		pullbits |= (pull << pullshift);
-		*(gpio.addr + pullreg) = pullbits;
+		gpio_write(pullreg, pullbits);
 	}
 }
 else 	// configure pullups for older Pis
 {
 	// BCM2835 ARM Peripherals PDF p 101 & elinux.org/RPi_Low-level_peripherals#Internal_Pull-Ups_.26_Pull-Downs
-	GPIO_PULL = 2; // pull-up
+	GPIO_PULL(2); // pull-up
 	short_wait(); // must wait 150 cycles
-	GPIO_PULLCLK0 = 0x0c003ff0; // selects GPIO pins 4..13 and 26,27
+	GPIO_PULLCLK0(0x0c003ff0); // selects GPIO pins 4..13 and 26,27
 
 	short_wait();
-	GPIO_PULL = 0; // reset GPPUD register
+	GPIO_PULL(0); // reset GPPUD register
 	short_wait();
-	GPIO_PULLCLK0 = 0; // remove clock
+	GPIO_PULLCLK0(0); // remove clock
 	short_wait(); // probably unnecessary
 
 	// BCM2835 ARM Peripherals PDF p 101 & elinux.org/RPi_Low-level_peripherals#Internal_Pull-Ups_.26_Pull-Downs
-	GPIO_PULL = 0; // no pull-up no pull-down just float
+	GPIO_PULL(0); // no pull-up no pull-down just float
 	short_wait(); // must wait 150 cycles
-	GPIO_PULLCLK0 = 0x03f00000; // selects GPIO pins 20..25
+	GPIO_PULLCLK0(0x03f00000); // selects GPIO pins 20..25
 	short_wait();
-	GPIO_PULL = 0; // reset GPPUD register
+	GPIO_PULL(0); // reset GPPUD register
 	short_wait();
-	GPIO_PULLCLK0 = 0; // remove clock
+	GPIO_PULLCLK0(0); // remove clock
 	short_wait(); // probably unnecessary
 
 	// BCM2835 ARM Peripherals PDF p 101 & elinux.org/RPi_Low-level_peripherals#Internal_Pull-Ups_.26_Pull-Downs
-	GPIO_PULL = 0; // no pull-up no pull down just float
+	GPIO_PULL(0); // no pull-up no pull down just float
 // not the reason for flashes it seems:
-//GPIO_PULL = 2;	// pull-up - letf in but does not the reason for flashes
+//GPIO_PULL(2);	// pull-up - letf in but does not the reason for flashes
 	short_wait(); // must wait 150 cycles
-	GPIO_PULLCLK0 = 0x070000; // selects GPIO pins 16..18
+	GPIO_PULLCLK0(0x070000); // selects GPIO pins 16..18
 	short_wait();
-	GPIO_PULL = 0; // reset GPPUD register
+	GPIO_PULL(0); // reset GPPUD register
 	short_wait();
-	GPIO_PULLCLK0 = 0; // remove clock
+	GPIO_PULLCLK0(0); // remove clock
 	short_wait(); // probably unnecessary
 }
+	return 0;
+}
+
+/*
+ * Switch change events, pushed to clients.
+ * A new row value is reported, when read by GPIO_SWITCH_DEBOUNCE_SCANS
+ * successive scans (one scan per brightness phase, ~0.4 ms).
+ */
+#define GPIO_SWITCH_DEBOUNCE_SCANS	2
+
+void (*gpio_switch_event_callback)(uint64_t scan_us, uint64_t detect_us) = NULL;
+
+typedef struct
+{
+	uint32_t reported; // value of last event
+	uint32_t candidate; // new value, being debounced
+	unsigned stable_count; // scans with candidate value
+	uint64_t first_seen_us; // change from "reported" first seen
+} gpio_switch_debounce_t;
+
+static gpio_switch_debounce_t gpio_switch_debounce_state[3];
+
+static uint64_t gpio_now_us(void)
+{
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp); // same clock as blinkenlight_api_shm_now_us()
+	return (uint64_t) tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+}
+
+void gpio_switch_debounce(unsigned row, uint32_t switchscan)
+{
+	gpio_switch_debounce_t *d = &gpio_switch_debounce_state[row];
+
+	if (switchscan == d->reported) {
+		d->candidate = switchscan; // bounced back
+		d->stable_count = 0;
+		return;
+	}
+	if (d->candidate == d->reported)
+		d->first_seen_us = gpio_now_us(); // change starts
+	if (switchscan != d->candidate) {
+		d->candidate = switchscan;
+		d->stable_count = 1;
+	} else
+		d->stable_count++;
+	if (d->stable_count >= GPIO_SWITCH_DEBOUNCE_SCANS) {
+		d->reported = switchscan;
+		d->stable_count = 0;
+		if (gpio_switch_event_callback)
+			gpio_switch_event_callback(d->first_seen_us, gpio_now_us());
+	}
+}
+
+void *blink(int *terminate)
+{
+	int i, j, k, switchscan, tmp;
+
+	// printf("Priority max SCHED_FIFO = %u\n",sched_get_priority_max(SCHED_FIFO) );
+
+	// set thread to real time priority -----------------
+	struct sched_param sp;
+	sp.sched_priority = 98; // maybe 99, 32, 31?
+	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp)) {
+		fprintf(stderr, "warning: failed to set RT priority\n");
+	}
+
 	// --------------------------------------------------
+	if (gpio_setup() == -1)
+		return (void *) -1;
 
 	// printf("\nPiDP-11 FP on\n");
 
@@ -284,24 +357,23 @@ else 	// configure pullups for older Pis
 				// Toggle columns for this ledrow (which LEDs should be on (CLR = on))
 				for (k = 0; k < 12; k++) {
 					if ((gpio_ledstatus[i] & (1 << k)) == 0)
-						GPIO_SET = 1 << cols[k];
+						GPIO_SET(1 << cols[k]);
 					else
-						GPIO_CLR = 1 << cols[k];
+						GPIO_CLR(1 << cols[k]);
 				}
 
 				// Toggle this ledrow on
 				INO_GPIO(ledrows[i]);
-				GPIO_SET = 1 << ledrows[i]; // test for flash problem
+				GPIO_SET(1 << ledrows[i]); // test for flash problem
 				OUT_GPIO(ledrows[i]);
-				/*test* /			GPIO_SET = 1 << ledrows[i]; /**/
+				/*test* /			GPIO_SET(1 << ledrows[i]); /**/
 
-				nanosleep((struct timespec[]
-				) {	{	0, intervl}}, NULL);
+				gpio_delay_ns(intervl);
 
 				// Toggle ledrow off
-				GPIO_CLR = 1 << ledrows[i]; // superstition
+				GPIO_CLR(1 << ledrows[i]); // superstition
 //				INP_GPIO(ledrows[i]);
-				usleep(10); // waste of cpu cycles but may help against udn2981 ghosting, not flashes though
+				gpio_delay_ns(10000); // waste of cpu cycles but may help against udn2981 ghosting, not flashes though
 			}
 
 //nanosleep ((struct timespec[]){{0, intervl}}, NULL); // test
@@ -313,11 +385,11 @@ else 	// configure pullups for older Pis
 			// read three rows of switches
 			for (i = 0; i < 3; i++)
 			{
-				INO_GPIO(rows[i]); //			GPIO_CLR = 1 << rows[i];	// and output 0V to overrule built-in pull-up from column input pin
+				INO_GPIO(rows[i]); //			GPIO_CLR(1 << rows[i]);	// and output 0V to overrule built-in pull-up from column input pin
 				OUT_GPIO(rows[i]); // turn on one switch row
-				GPIO_CLR = 1 << rows[i]; // and output 0V to overrule built-in pull-up from column input pin
+				GPIO_CLR(1 << rows[i]); // and output 0V to overrule built-in pull-up from column input pin
 
-				nanosleep((struct timespec[]) { { 0, intervl / 100}}, NULL); // probably unnecessary long wait, maybe put above this loop also
+				gpio_delay_ns(intervl / 100); // probably unnecessary long wait, maybe put above this loop also
 
 				switchscan = 0;
 				for (j = 0; j < 12; j++) // 12 switches in each row
@@ -332,6 +404,7 @@ else 	// configure pullups for older Pis
 					check_rotary_encoders(switchscan);	// translate raw encoder data to switch position
 
 				gpio_switchstatus[i] = switchscan;
+				gpio_switch_debounce(i, switchscan);
 
 			}
 		}
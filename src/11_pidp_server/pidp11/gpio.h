@@ -29,6 +29,7 @@
 #define _GPIO_H_
 
 #include <stdio.h>
+#include <stdint.h>
 
 #include <sys/mman.h>
 #include <sys/types.h>
@@ -60,6 +61,54 @@ struct bcm2835_peripheral {
 
 //struct bcm2835_peripheral gpio = {GPIO_BASE};
 
+/*
+ * Access to the GPIO register file: mapped hardware or a simulation.
+ * gpio.c writes the registers only with gpio_write() and waits only
+ * with gpio_delay_ns(), so a simulation sees every change in time.
+ */
+typedef struct
+{
+	char *name;
+	int (*map)(struct bcm2835_peripheral *p); // set p->addr to register file. 0 = OK
+	void (*unmap)(struct bcm2835_peripheral *p);
+	void (*written)(unsigned reg, uint32_t value); // after write to register file, or NULL
+	void (*delay_ns)(long ns); // timing of the mux, < 1 second
+} gpio_backend_t;
+
+extern struct bcm2835_peripheral gpio;
+extern gpio_backend_t *gpio_backend; // default: gpio_backend_mem
+extern gpio_backend_t gpio_backend_mem; // /dev/mem, see map_peripheral()
+
+static inline void gpio_write(unsigned reg, uint32_t value)
+{
+	gpio.addr[reg] = value;
+	if (gpio_backend->written)
+		gpio_backend->written(reg, value);
+}
+
+static inline void gpio_delay_ns(long ns)
+{
+	gpio_backend->delay_ns(ns);
+}
+
+#ifndef _GPIO_C_
+// wiring of the mux, GPIO pin numbers
+extern uint8_t ledrows[6];
+extern uint8_t rows[3];
+extern uint8_t cols[12];
+extern long intervl; // on time of one ledrow in ns
+#endif
+
+int map_peripheral(struct bcm2835_peripheral *p);
+void unmap_peripheral(struct bcm2835_peripheral *p);
+unsigned bcm_host_get_peripheral_address(void); // find Pi 2 or Pi's gpio base address
+int gpio_setup(void); // map registers and configure mux pins
+void check_rotary_encoders(int switchscan);
+// every switch row scan, detects changes
+void gpio_switch_debounce(unsigned row, uint32_t switchscan);
+// called by mux thread on debounced switch change. time stamps: CLOCK_MONOTONIC us
+extern void (*gpio_switch_event_callback)(uint64_t scan_us, uint64_t detect_us);
+
 
 // thread main procedure
 //void *blink(int *terminate) ;
@@ -0,0 +1,211 @@
+/* gpio_benchmark.c: timing of the GPIO mux blink() on the simulated register file
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ Stand alone, not part of server build:
+	cc -O2 -DBLINKENLIGHT_SERVER -I. -I../../00_common -I../../07.0_blinkenlight_api \
+		-I../../07.0_blinkenlight_api/rpcgen_linux -I/usr/include/tirpc \
+		-o gpio_benchmark gpio_benchmark.c gpio.c gpiosim.c -pthread -lm
+
+ Usage: gpio_benchmark [-r] [<seconds>]
+	runs blink() for <seconds> (default 2) on gpio_backend_sim.
+	-r: real sleeps instead of virtual time, shows the jitter of this machine.
+
+ Reports
+ - mux frame rate (all brightness phases) and wall clock time per frame.
+   With virtual time this is the CPU cost of blink() itself,
+ - on-time of each ledrow, from the time stamped register write log,
+ - switch scan latency: a simulated switch is toggled at pseudo random times,
+   latency is the time until gpio_switchstatus[] shows it.
+ With virtual time all numbers except CPU time are exactly reproducible.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "gpio.h"
+#include "gpiosim.h"
+#include "gpiopattern.h"
+
+#define BENCHMARK_SWITCH_PERIOD_NS	20000000 // mean time between switch toggles
+
+// referenced by gpio.c, defined in main.c and gpiopattern.c
+int knobValue[2];
+volatile uint32_t gpio_switchstatus[3];
+int gpiopattern_ledstatus_phases_readidx = 0;
+volatile uint32_t gpiopattern_ledstatus_phases[2][GPIOPATTERN_LED_BRIGHTNESS_PHASES][8];
+
+void *blink(int *terminate);
+
+static int blink_terminate;
+static uint64_t run_ns, end_ns = 0; // 0 = not started
+static uint64_t random_state = 0x2545f4914f6cdd1dULL;
+
+// switch scan test
+static struct
+{
+	int pending;
+	unsigned row, bit;
+	unsigned expected; // gpio_switchstatus bit after toggle, 1 = open
+	uint64_t toggle_ns, next_toggle_ns;
+	unsigned count;
+	uint64_t sum_ns, min_ns, max_ns;
+} scan;
+
+// statistics of ledrow on-times
+typedef struct
+{
+	unsigned count;
+	double sum, sum2;
+	uint64_t min, max;
+	uint64_t start; // 0 = ledrow off
+} benchmark_stat_t;
+
+static uint64_t benchmark_random(void)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+static uint64_t benchmark_wall_ns(void)
+{
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+// called by the sim before every delay of blink()
+static void benchmark_on_delay(uint64_t now_ns)
+{
+	if (end_ns == 0) { // first delay: mux running
+		end_ns = now_ns + run_ns;
+		scan.next_toggle_ns = now_ns + BENCHMARK_SWITCH_PERIOD_NS;
+	}
+	if (now_ns >= end_ns)
+		blink_terminate = 1;
+
+	if (scan.pending) {
+		if (((gpio_switchstatus[scan.row] >> scan.bit) & 1) == scan.expected) {
+			uint64_t latency = now_ns - scan.toggle_ns;
+			scan.count++;
+			scan.sum_ns += latency;
+			if (scan.count == 1 || latency < scan.min_ns)
+				scan.min_ns = latency;
+			if (latency > scan.max_ns)
+				scan.max_ns = latency;
+			scan.pending = 0;
+			scan.next_toggle_ns = now_ns + benchmark_random() % (2 * BENCHMARK_SWITCH_PERIOD_NS);
+		}
+	} else if (now_ns >= scan.next_toggle_ns) {
+		// toggle a switch, not the rotary encoders in row 2
+		scan.row = benchmark_random() % 3;
+		scan.bit = benchmark_random() % (scan.row == 2 ? 8 : 12);
+		gpiosim->connections[rows[scan.row]] ^= 1u << cols[scan.bit];
+		gpiosim_update_levels();
+		scan.expected = !(gpiosim->connections[rows[scan.row]] & (1u << cols[scan.bit]));
+		scan.toggle_ns = now_ns;
+		scan.pending = 1;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	benchmark_stat_t ledrow_stat[6];
+	uint64_t wall_ns, first_ns = 0, last_ns = 0, i, log_start;
+	unsigned phase, reg, r, phases = 0;
+	double seconds = 2;
+	int argi;
+
+	for (argi = 1; argi < argc; argi++)
+		if (!strcmp(argv[argi], "-r"))
+			gpiosim_virtual_time = 0;
+		else
+			seconds = atof(argv[argi]);
+
+	// fixed LED pattern
+	for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++)
+		for (reg = 0; reg < 8; reg++)
+			gpiopattern_ledstatus_phases[0][phase][reg] = benchmark_random() & 0xfff;
+
+	run_ns = (uint64_t) (seconds * 1e9);
+	gpio_backend = &gpio_backend_sim;
+	gpiosim_on_delay = benchmark_on_delay;
+	wall_ns = benchmark_wall_ns();
+	if (blink(&blink_terminate) != 0)
+		return 1;
+	wall_ns = benchmark_wall_ns() - wall_ns;
+
+	// evaluate write log: ledrow on = GPSET0 .. GPCLR0 of its pin
+	memset(ledrow_stat, 0, sizeof(ledrow_stat));
+	log_start = gpiosim->write_count > GPIOSIM_LOG_SIZE ? gpiosim->write_count - GPIOSIM_LOG_SIZE : 0;
+	for (i = log_start; i < gpiosim->write_count; i++) {
+		gpiosim_write_t *w = &gpiosim->log[i & (GPIOSIM_LOG_SIZE - 1)];
+		for (r = 0; r < 6; r++) {
+			benchmark_stat_t *s = &ledrow_stat[r];
+			if (!(w->value & (1u << ledrows[r])))
+				continue;
+			if (w->reg == 7) {
+				s->start = w->time_ns + 1; // 0 = off
+				if (r == 0) {
+					if (!phases++)
+						first_ns = w->time_ns;
+					last_ns = w->time_ns;
+				}
+			} else if (w->reg == 10 && s->start) {
+				uint64_t on_ns = w->time_ns - (s->start - 1);
+				if (s->count == 0 || on_ns < s->min)
+					s->min = on_ns;
+				if (on_ns > s->max)
+					s->max = on_ns;
+				s->sum += on_ns;
+				s->sum2 += (double) on_ns * on_ns;
+				s->count++;
+				s->start = 0;
+			}
+		}
+	}
+
+	printf("%s time, %.1f s, %llu register writes%s\n", gpiosim_virtual_time ? "virtual" : "real",
+			seconds, (unsigned long long) gpiosim->write_count,
+			log_start ? " (log wrapped, evaluating the last part)" : "");
+	if (phases > GPIOPATTERN_LED_BRIGHTNESS_PHASES) {
+		double frames = (double) (phases - 1) / GPIOPATTERN_LED_BRIGHTNESS_PHASES;
+		printf("mux frame rate %.2f Hz, %.1f us wall clock per frame\n", frames * 1e9 / (last_ns - first_ns),
+				(double) wall_ns / 1000 / ((double) phases / GPIOPATTERN_LED_BRIGHTNESS_PHASES));
+	}
+	printf("ledrow  count     mean us   stddev us   min us   max us\n");
+	for (r = 0; r < 6; r++) {
+		benchmark_stat_t *s = &ledrow_stat[r];
+		double mean = s->count ? s->sum / s->count : 0;
+		double var = s->count ? s->sum2 / s->count - mean * mean : 0;
+		printf("%6u %6u %11.2f %11.2f %8.2f %8.2f\n", r, s->count, mean / 1000,
+				sqrt(var > 0 ? var : 0) / 1000, s->min / 1000.0, s->max / 1000.0);
+	}
+	if (scan.count)
+		printf("switch scan latency: %u toggles, mean %.1f us, min %.1f us, max %.1f us\n",
+				scan.count, (double) scan.sum_ns / scan.count / 1000, scan.min_ns / 1000.0,
+				scan.max_ns / 1000.0);
+	return 0;
+}
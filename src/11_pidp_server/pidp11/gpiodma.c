@@ -0,0 +1,437 @@
+/* gpiodma.c: "dma" backend for gpioframe: mux played out by the DMA engine
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ Every frame operation becomes a DMA control block (CB):
+ - write: copy a value word to a GPIO register
+ - sample: copy GPLEV0 to the sample area
+ - delay: copy n dummy words into the PWM FIFO. PWM serializes one
+   word per microsecond and paces the DMA with DREQ.
+ Same technique as ServoBlaster and pigpio, so PWM (analog audio)
+ can not be used at the same time.
+
+ Two CB chains in uncached VideoCore memory, each chain loops to itself.
+ swap() fills the idle chain and links the end of the running chain to it,
+ so the DMA switches over at the frame end, without a gap.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ioctl.h>
+
+#include "print.h"
+#include "gpio.h"
+#include "gpioframe.h"
+
+#define GPIODMA_DEFAULT_CHANNEL	10 // not used by Linux, Pi 1..4
+
+// peripheral offsets from bcm_host_get_peripheral_address()
+#define GPIODMA_DMA_OFFSET	0x007000
+#define GPIODMA_DMA_ENABLE	(0xff0 / 4) // word offset in DMA page
+#define GPIODMA_PWM_OFFSET	0x20C000
+#define GPIODMA_CLK_OFFSET	0x101000
+#define GPIODMA_GPIO_OFFSET	0x200000
+#define GPIODMA_BUS_BASE	0x7E000000 // peripherals as seen by DMA
+
+// DMA channel registers, word offsets
+#define DMA_CS	0
+#define DMA_CONBLK_AD	1
+#define DMA_DEBUG	8
+
+#define DMA_CS_ACTIVE	(1 << 0)
+#define DMA_CS_END	(1 << 1)
+#define DMA_CS_INT	(1 << 2)
+#define DMA_CS_ERROR	(1 << 8)
+#define DMA_CS_PRIORITY(x)	((x) << 16)
+#define DMA_CS_PANIC_PRIORITY(x)	((x) << 20)
+#define DMA_CS_WAIT_FOR_OUTSTANDING_WRITES	(1 << 28)
+#define DMA_CS_ABORT	(1 << 30)
+#define DMA_CS_RESET	(1 << 31)
+
+#define DMA_TI_WAIT_RESP	(1 << 3)
+#define DMA_TI_DEST_DREQ	(1 << 6)
+#define DMA_TI_PERMAP(x)	((x) << 16)
+#define DMA_TI_NO_WIDE_BURSTS	(1 << 26)
+#define DMA_PERMAP_PWM	5
+
+// PWM registers, word offsets
+#define PWM_CTL	0
+#define PWM_DMAC	2
+#define PWM_RNG1	4
+#define PWM_FIF1	6
+
+#define PWM_CTL_PWEN1	(1 << 0)
+#define PWM_CTL_USEF1	(1 << 5)
+#define PWM_CTL_CLRF1	(1 << 6)
+#define PWM_DMAC_ENAB	(1 << 31)
+#define PWM_DMAC_PANIC(x)	((x) << 8)
+#define PWM_DMAC_DREQ(x)	(x)
+
+// clock manager, word offsets
+#define CLK_PWMCTL	40
+#define CLK_PWMDIV	41
+#define CLK_PASSWD	0x5A000000
+#define CLK_CTL_BUSY	(1 << 7)
+#define CLK_CTL_ENAB	(1 << 4)
+#define CLK_CTL_SRC_PLLD	6
+
+#define GPIODMA_PWM_CLOCK_HZ	10000000
+#define GPIODMA_PWM_RANGE	10 // 10 MHz / 10 bits = 1 word per us
+
+// VideoCore mailbox, for uncached memory
+#define MBOX_IOCTL	_IOWR(100, 0, char *)
+#define MBOX_TAG_MEM_ALLOC	0x3000c
+#define MBOX_TAG_MEM_LOCK	0x3000d
+#define MBOX_TAG_MEM_UNLOCK	0x3000e
+#define MBOX_TAG_MEM_FREE	0x3000f
+
+typedef struct
+{
+	uint32_t ti;
+	uint32_t src;
+	uint32_t dst;
+	uint32_t len;
+	uint32_t stride;
+	uint32_t next;
+	uint32_t pad[2];
+} gpiodma_cb_t;
+
+// one chain of control blocks, with its data
+typedef struct
+{
+	gpiodma_cb_t cb[GPIOFRAME_MAX_OPS];
+	uint32_t values[GPIOFRAME_MAX_OPS];
+	uint32_t samples[GPIOFRAME_MAX_SAMPLES];
+} gpiodma_chain_t;
+
+typedef struct
+{
+	gpiodma_chain_t chain[2];
+	uint32_t dummy; // source of delay words
+} gpiodma_mem_t;
+
+static struct
+{
+	unsigned channel;
+	unsigned periph_base;
+	struct bcm2835_peripheral dma, pwm, clk;
+	volatile uint32_t *dma_reg; // registers of "channel"
+	int mbox_fd;
+	unsigned mem_handle;
+	unsigned mem_bus; // bus address of "mem"
+	unsigned mem_size;
+	void *mem_map;
+	volatile gpiodma_mem_t *mem;
+	unsigned chain_count[2]; // used cbs
+	int active; // chain index the DMA runs on, -1 = not started
+} gpiodma;
+
+// bus address of something inside gpiodma.mem
+#define GPIODMA_BUS(ptr) (gpiodma.mem_bus + (unsigned) ((volatile char *) (ptr) - (volatile char *) gpiodma.mem))
+
+static unsigned gpiodma_mbox_property(unsigned tag, unsigned argc, unsigned a0, unsigned a1,
+		unsigned a2)
+{
+	uint32_t buf[32];
+	unsigned i = 0;
+	buf[i++] = 0; // size, set below
+	buf[i++] = 0; // request
+	buf[i++] = tag;
+	buf[i++] = 3 * 4; // value buffer size
+	buf[i++] = argc * 4; // request length
+	buf[i++] = a0;
+	buf[i++] = a1;
+	buf[i++] = a2;
+	buf[i++] = 0; // end tag
+	buf[0] = i * sizeof(uint32_t);
+	if (ioctl(gpiodma.mbox_fd, MBOX_IOCTL, buf) < 0)
+		return 0;
+	return buf[5];
+}
+
+// map uncached memory. result 0 = OK
+static int gpiodma_mem_alloc(unsigned size)
+{
+	// Pi 1: L1 cache still on, use "direct" + "coherent"
+	unsigned flags = (gpiodma.periph_base == 0x20000000) ? 0xC : 0x4;
+	struct bcm2835_peripheral m;
+
+	gpiodma.mem_size = (size + 4095) & ~4095;
+	if ((gpiodma.mbox_fd = open("/dev/vcio", 0)) < 0) {
+		print(LOG_ERR, "Can not open /dev/vcio\n");
+		return -1;
+	}
+	gpiodma.mem_handle = gpiodma_mbox_property(MBOX_TAG_MEM_ALLOC, 3, gpiodma.mem_size, 4096,
+			flags);
+	if (!gpiodma.mem_handle) {
+		print(LOG_ERR, "VideoCore memory allocation failed\n");
+		return -1;
+	}
+	gpiodma.mem_bus = gpiodma_mbox_property(MBOX_TAG_MEM_LOCK, 1, gpiodma.mem_handle, 0, 0);
+	if (!gpiodma.mem_bus) {
+		print(LOG_ERR, "VideoCore memory lock failed\n");
+		return -1;
+	}
+	if ((m.mem_fd = open("/dev/mem", O_RDWR | O_SYNC)) < 0) {
+		print(LOG_ERR, "Failed to open /dev/mem, try checking permissions.\n");
+		return -1;
+	}
+	gpiodma.mem_map = mmap(NULL, gpiodma.mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, m.mem_fd,
+			gpiodma.mem_bus & ~0xC0000000);
+	close(m.mem_fd);
+	if (gpiodma.mem_map == MAP_FAILED) {
+		gpiodma.mem_map = NULL;
+		print(LOG_ERR, "mmap of VideoCore memory failed\n");
+		return -1;
+	}
+	gpiodma.mem = (volatile gpiodma_mem_t *) gpiodma.mem_map;
+	return 0;
+}
+
+static void gpiodma_mem_free(void)
+{
+	if (gpiodma.mem_map)
+		munmap(gpiodma.mem_map, gpiodma.mem_size);
+	if (gpiodma.mem_bus)
+		gpiodma_mbox_property(MBOX_TAG_MEM_UNLOCK, 1, gpiodma.mem_handle, 0, 0);
+	if (gpiodma.mem_handle)
+		gpiodma_mbox_property(MBOX_TAG_MEM_FREE, 1, gpiodma.mem_handle, 0, 0);
+	if (gpiodma.mbox_fd >= 0)
+		close(gpiodma.mbox_fd);
+	gpiodma.mem_map = NULL;
+	gpiodma.mem = NULL;
+}
+
+// PWM as 1us clock for DMA delays
+static void gpiodma_pwm_init(void)
+{
+	volatile uint32_t *clk = (volatile uint32_t *) gpiodma.clk.addr;
+	volatile uint32_t *pwm = (volatile uint32_t *) gpiodma.pwm.addr;
+	unsigned plld_hz = (gpiodma.periph_base == 0xFE000000) ? 750000000 : 500000000;
+
+	pwm[PWM_CTL] = 0;
+	usleep(10);
+	clk[CLK_PWMCTL] = CLK_PASSWD | CLK_CTL_SRC_PLLD; // stop clock
+	while (clk[CLK_PWMCTL] & CLK_CTL_BUSY)
+		usleep(10);
+	clk[CLK_PWMDIV] = CLK_PASSWD | ((plld_hz / GPIODMA_PWM_CLOCK_HZ) << 12);
+	clk[CLK_PWMCTL] = CLK_PASSWD | CLK_CTL_ENAB | CLK_CTL_SRC_PLLD;
+	usleep(100);
+	pwm[PWM_RNG1] = GPIODMA_PWM_RANGE;
+	usleep(10);
+	pwm[PWM_DMAC] = PWM_DMAC_ENAB | PWM_DMAC_PANIC(7) | PWM_DMAC_DREQ(3);
+	usleep(10);
+	pwm[PWM_CTL] = PWM_CTL_CLRF1;
+	usleep(10);
+	pwm[PWM_CTL] = PWM_CTL_USEF1 | PWM_CTL_PWEN1;
+	usleep(10);
+}
+
+static void gpiodma_reset(void)
+{
+	if (gpiodma.dma_reg) {
+		gpiodma.dma_reg[DMA_CS] = DMA_CS_ABORT;
+		usleep(100);
+		gpiodma.dma_reg[DMA_CS] = DMA_CS_RESET;
+		usleep(10);
+		gpiodma.dma_reg[DMA_DEBUG] = 7; // clear errors
+	}
+	if (gpiodma.pwm.addr)
+		gpiodma.pwm.addr[PWM_CTL] = 0;
+}
+
+static int gpiodma_open(char *arg, uint32_t *gpfsel)
+{
+	unsigned i;
+
+	memset(&gpiodma, 0, sizeof(gpiodma));
+	gpiodma.mbox_fd = -1;
+	gpiodma.active = -1;
+	gpiodma.channel = arg && *arg ? strtoul(arg, NULL, 10) : GPIODMA_DEFAULT_CHANNEL;
+	if (gpiodma.channel > 14) {
+		print(LOG_ERR, "Illegal DMA channel %u\n", gpiodma.channel);
+		return -1;
+	}
+	if (gpio_setup() == -1)
+		return -1;
+	for (i = 0; i < 3; i++)
+		gpfsel[i] = gpio.addr[i];
+
+	gpiodma.periph_base = bcm_host_get_peripheral_address();
+	gpiodma.dma.addr_p = gpiodma.periph_base + GPIODMA_DMA_OFFSET;
+	gpiodma.pwm.addr_p = gpiodma.periph_base + GPIODMA_PWM_OFFSET;
+	gpiodma.clk.addr_p = gpiodma.periph_base + GPIODMA_CLK_OFFSET;
+	if (map_peripheral(&gpiodma.dma) == -1 || map_peripheral(&gpiodma.pwm) == -1
+			|| map_peripheral(&gpiodma.clk) == -1) {
+		print(LOG_ERR, "Failed to map DMA, PWM or clock registers.\n");
+		return -1;
+	}
+	gpiodma.dma_reg = (volatile uint32_t *) gpiodma.dma.addr + gpiodma.channel * 0x100 / 4;
+
+	if (gpiodma_mem_alloc(sizeof(gpiodma_mem_t)))
+		return -1;
+	gpiodma.mem->dummy = 0;
+	for (i = 0; i < GPIOFRAME_MAX_SAMPLES; i++)
+		gpiodma.mem->chain[0].samples[i] = gpiodma.mem->chain[1].samples[i] = 0xffffffff; // all switches open
+
+	gpiodma_reset();
+	gpiodma_pwm_init();
+	gpiodma.dma.addr[GPIODMA_DMA_ENABLE] |= 1 << gpiodma.channel;
+	print(LOG_INFO, "GPIO DMA channel %u, %u bytes control blocks at bus address 0x%08x\n",
+			gpiodma.channel, gpiodma.mem_size, gpiodma.mem_bus);
+	return 0;
+}
+
+// index of the chain the DMA currently executes, -1 = stopped
+static int gpiodma_current_chain(void)
+{
+	unsigned ad = gpiodma.dma_reg[DMA_CONBLK_AD];
+	unsigned i;
+	for (i = 0; i < 2; i++) {
+		volatile gpiodma_chain_t *chain = &gpiodma.mem->chain[i];
+		if (gpiodma.chain_count[i] == 0)
+			continue;
+		if (ad >= GPIODMA_BUS(&chain->cb[0]) && ad <= GPIODMA_BUS(&chain->cb[gpiodma.chain_count[i] - 1]))
+			return i;
+	}
+	return -1;
+}
+
+// wait until DMA switched to "active" chain. Frame takes ~12ms
+// result 0 = OK, -1 = timeout: DMA still on the other chain, or stopped
+static int gpiodma_wait_active(void)
+{
+	unsigned timeout_ms = 100;
+	while (gpiodma_current_chain() != gpiodma.active && timeout_ms--)
+		nanosleep((struct timespec[]
+		) {	{	0, 1000000}}, NULL);
+	if (gpiodma.dma_reg[DMA_CS] & DMA_CS_ERROR)
+		print(LOG_ERR, "GPIO DMA error, debug = 0x%x\n", gpiodma.dma_reg[DMA_DEBUG]);
+	if (gpiodma_current_chain() != gpiodma.active) {
+		print(LOG_WARNING, "GPIO DMA did not switch to chain %d\n", gpiodma.active);
+		return -1;
+	}
+	return 0;
+}
+
+static void gpiodma_swap(gpioframe_t *frame)
+{
+	int idle = (gpiodma.active == 0) ? 1 : 0;
+	volatile gpiodma_chain_t *chain = &gpiodma.mem->chain[idle];
+	uint32_t pwm_fifo_bus = GPIODMA_BUS_BASE + GPIODMA_PWM_OFFSET + PWM_FIF1 * 4;
+	uint32_t gpio_bus = GPIODMA_BUS_BASE + GPIODMA_GPIO_OFFSET;
+	unsigned i;
+
+	if (frame->op_count == 0 || frame->op_count > GPIOFRAME_MAX_OPS) {
+		print(LOG_ERR, "GPIO DMA frame with %u operations, must be 1..%u\n", frame->op_count,
+				GPIOFRAME_MAX_OPS);
+		return;
+	}
+	// DMA must have left the idle chain. If not, keep the running frame, retry with the next.
+	if (gpiodma.active >= 0 && gpiodma_wait_active())
+		return;
+	for (i = 0; i < frame->op_count; i++) {
+		gpioframe_op_t *op = &frame->ops[i];
+		volatile gpiodma_cb_t *cb = &chain->cb[i];
+		switch (op->type) {
+		case gpioframe_op_write:
+			chain->values[i] = op->value;
+			cb->ti = DMA_TI_NO_WIDE_BURSTS | DMA_TI_WAIT_RESP;
+			cb->src = GPIODMA_BUS(&chain->values[i]);
+			cb->dst = gpio_bus + op->reg * 4;
+			cb->len = 4;
+			break;
+		case gpioframe_op_delay:
+			cb->ti = DMA_TI_NO_WIDE_BURSTS | DMA_TI_WAIT_RESP | DMA_TI_DEST_DREQ
+					| DMA_TI_PERMAP(DMA_PERMAP_PWM);
+			cb->src = GPIODMA_BUS(&gpiodma.mem->dummy);
+			cb->dst = pwm_fifo_bus;
+			cb->len = 4 * ((op->value + 999) / 1000); // 1 word per us, at least one
+			break;
+		case gpioframe_op_sample:
+			cb->ti = DMA_TI_NO_WIDE_BURSTS | DMA_TI_WAIT_RESP;
+			cb->src = gpio_bus + op->reg * 4;
+			cb->dst = GPIODMA_BUS(&chain->samples[op->value]);
+			cb->len = 4;
+			break;
+		}
+		cb->stride = 0;
+		cb->next = GPIODMA_BUS(&chain->cb[i + 1]);
+	}
+	chain->cb[frame->op_count - 1].next = GPIODMA_BUS(&chain->cb[0]); // loop
+	gpiodma.chain_count[idle] = frame->op_count;
+	__sync_synchronize();
+
+	if (gpiodma.active < 0) {
+		gpiodma.dma_reg[DMA_CONBLK_AD] = GPIODMA_BUS(&chain->cb[0]);
+		gpiodma.dma_reg[DMA_CS] = DMA_CS_INT | DMA_CS_END; // clear flags
+		gpiodma.dma_reg[DMA_CS] = DMA_CS_PRIORITY(7) | DMA_CS_PANIC_PRIORITY(7)
+				| DMA_CS_WAIT_FOR_OUTSTANDING_WRITES | DMA_CS_ACTIVE;
+	} else {
+		volatile gpiodma_chain_t *running = &gpiodma.mem->chain[gpiodma.active];
+		// at end of current frame, continue with new one
+		running->cb[gpiodma.chain_count[gpiodma.active] - 1].next = GPIODMA_BUS(&chain->cb[0]);
+	}
+	gpiodma.active = idle;
+}
+
+// samples of the last complete frame
+static void gpiodma_read_samples(uint32_t *samples, unsigned count)
+{
+	unsigned i;
+	volatile uint32_t *src;
+	if (gpiodma.chain_count[!gpiodma.active]) {
+		// previous chain was played completely, when DMA is on the new one.
+		// On timeout it is still playing: samples are from its previous cycle.
+		gpiodma_wait_active();
+		src = gpiodma.mem->chain[!gpiodma.active].samples;
+	} else
+		src = gpiodma.mem->chain[gpiodma.active].samples; // first frame: initially "all open"
+	for (i = 0; i < count; i++)
+		samples[i] = src[i];
+}
+
+static void gpiodma_pin_input(unsigned pin)
+{
+	gpio_write(pin / 10, gpio.addr[pin / 10] & ~(7 << ((pin % 10) * 3)));
+}
+
+static void gpiodma_close(void)
+{
+	unsigned i;
+	gpiodma_reset();
+	gpiodma_mem_free();
+	unmap_peripheral(&gpiodma.dma);
+	unmap_peripheral(&gpiodma.pwm);
+	unmap_peripheral(&gpiodma.clk);
+	// leave all mux pins as input, like blink()
+	for (i = 0; i < 6; i++)
+		gpiodma_pin_input(ledrows[i]);
+	for (i = 0; i < 12; i++)
+		gpiodma_pin_input(cols[i]);
+	for (i = 0; i < 3; i++)
+		gpiodma_pin_input(rows[i]);
+}
+
+gpioframe_backend_t gpioframe_backend_dma =
+{ "dma", gpiodma_open, gpiodma_swap, gpiodma_read_samples, gpiodma_close };
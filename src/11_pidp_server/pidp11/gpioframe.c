@@ -0,0 +1,311 @@
+/* gpioframe.c: precomputed multiplex frames, played out by a backend
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ blink() in gpio.c multiplexes by writing GPIO registers and sleeping in between,
+ which needs a real-time CPU core and still jitters.
+ Alternative: the whole multiplex sequence of all phases and rows
+ (the "frame") is generated in advance as a list of register writes, delays
+ and switch samples. A backend plays out the frame cyclic on its own,
+ the CPU only hands over a new frame with 50 Hz and decodes the switch samples.
+
+ Backends:
+ "dma":  DMA engine of the BCM283x, paced by the PWM FIFO. See gpiodma.c
+ "mock": plays out on the register file of gpiosim.c, on any Linux box.
+         Checks LED on-times against the brightness patterns and optionally
+         logs all register writes: "<time ns> <register> <value>" per line.
+ */
+
+#define GPIOFRAME_C_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "print.h"
+#include "gpio.h"
+#include "gpiopattern.h"
+#include "gpioframe.h"
+#include "gpiosim.h"
+
+gpioframe_backend_t *gpioframe_backend = NULL;
+static char *gpioframe_backend_arg = NULL;
+extern gpioframe_backend_t gpioframe_backend_mock; // below
+extern gpioframe_backend_t gpioframe_backend_dma; // gpiodma.c
+
+// ledrow off time before next ledrow, against ghosting. See usleep(10) in blink()
+#define GPIOFRAME_LEDROW_GAP_NS	10000
+
+// GPIO function select codes
+#define GPIOFRAME_FSEL_INPUT	0
+#define GPIOFRAME_FSEL_OUTPUT	1
+
+static void gpioframe_fsel(uint32_t *gpfsel, unsigned pin, unsigned function)
+{
+	unsigned shift = (pin % 10) * 3;
+	gpfsel[pin / 10] = (gpfsel[pin / 10] & ~(7 << shift)) | (function << shift);
+}
+
+static void gpioframe_add(gpioframe_t *frame, gpioframe_op_type_t type, unsigned reg, uint32_t value)
+{
+	gpioframe_op_t *op = &frame->ops[frame->op_count++];
+	op->type = type;
+	op->reg = reg;
+	op->value = value;
+}
+
+/*
+ * Generate the multiplex sequence for all brightness phases.
+ * gpfsel: function select registers 0..2 as found, bits of other pins are kept.
+ */
+void gpioframe_build(gpioframe_t *frame, volatile uint32_t ledstatus_phases[][8], uint32_t *gpfsel)
+{
+	uint32_t fsel_leds[3], fsel_switches[3];
+	unsigned phase, i, k;
+
+	// leds on: cols and ledrows output, switch rows input
+	// scan switches: cols input
+	memcpy(fsel_leds, gpfsel, sizeof(fsel_leds));
+	for (i = 0; i < 6; i++)
+		gpioframe_fsel(fsel_leds, ledrows[i], GPIOFRAME_FSEL_OUTPUT);
+	for (i = 0; i < 3; i++)
+		gpioframe_fsel(fsel_leds, rows[i], GPIOFRAME_FSEL_INPUT);
+	memcpy(fsel_switches, fsel_leds, sizeof(fsel_switches));
+	for (k = 0; k < 12; k++) {
+		gpioframe_fsel(fsel_leds, cols[k], GPIOFRAME_FSEL_OUTPUT);
+		gpioframe_fsel(fsel_switches, cols[k], GPIOFRAME_FSEL_INPUT);
+	}
+
+	frame->op_count = 0;
+	frame->sample_count = 0;
+	frame->ledstatus_phases = ledstatus_phases;
+	for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++) {
+		volatile uint32_t *gpio_ledstatus = ledstatus_phases[phase];
+
+		for (i = 0; i < 3; i++)
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPFSEL0 + i, fsel_leds[i]);
+		// light up 6 rows of 12 LEDs each
+		for (i = 0; i < 6; i++) {
+			uint32_t cols_off = 0, cols_on = 0; // LED on = col low
+			uint32_t ledstatus = gpio_ledstatus[i];
+			for (k = 0; k < 12; k++)
+				if (ledstatus & (1 << k))
+					cols_on |= 1 << cols[k];
+				else
+					cols_off |= 1 << cols[k];
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPSET0, cols_off);
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPCLR0, cols_on);
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPSET0, 1 << ledrows[i]);
+			gpioframe_add(frame, gpioframe_op_delay, 0, intervl);
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPCLR0, 1 << ledrows[i]);
+			gpioframe_add(frame, gpioframe_op_delay, 0, GPIOFRAME_LEDROW_GAP_NS);
+		}
+		// read three rows of switches
+		for (i = 0; i < 3; i++)
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPFSEL0 + i, fsel_switches[i]);
+		for (i = 0; i < 3; i++) {
+			unsigned reg = rows[i] / 10;
+			uint32_t fsel_row[3];
+			memcpy(fsel_row, fsel_switches, sizeof(fsel_row));
+			gpioframe_fsel(fsel_row, rows[i], GPIOFRAME_FSEL_OUTPUT);
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPFSEL0 + reg, fsel_row[reg]);
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPCLR0, 1 << rows[i]);
+			gpioframe_add(frame, gpioframe_op_delay, 0, intervl / 100);
+			frame->sample_row[frame->sample_count] = i;
+			gpioframe_add(frame, gpioframe_op_sample, GPIOFRAME_REG_GPLEV0, frame->sample_count++);
+			gpioframe_add(frame, gpioframe_op_write, GPIOFRAME_REG_GPFSEL0 + reg, fsel_switches[reg]);
+		}
+	}
+}
+
+/*
+ * Select backend from command line "-m" option.
+ */
+int gpioframe_select_backend(char *optarg)
+{
+	static gpioframe_backend_t *backends[] =
+	{ &gpioframe_backend_dma, &gpioframe_backend_mock, NULL };
+	gpioframe_backend_t **b;
+	char *colon = strchr(optarg, ':');
+	size_t namelen = colon ? (size_t) (colon - optarg) : strlen(optarg);
+
+	for (b = backends; *b; b++)
+		if (strlen((*b)->name) == namelen && !strncmp((*b)->name, optarg, namelen)) {
+			gpioframe_backend = *b;
+			gpioframe_backend_arg = colon ? colon + 1 : NULL;
+			return 1;
+		}
+	return 0;
+}
+
+/*
+ * Thread: feed backend with frames of current brightness patterns,
+ * decode the switch samples.
+ */
+void *gpioframe_mux(int *terminate)
+{
+	static gpioframe_t frame; // large
+	uint32_t samples[GPIOFRAME_MAX_SAMPLES];
+	uint32_t gpfsel[3];
+	unsigned i, j;
+
+	if (gpioframe_backend->open(gpioframe_backend_arg, gpfsel)) {
+		print(LOG_ERR, "Opening GPIO mux backend \"%s\" failed.\n", gpioframe_backend->name);
+		return (void *) -1;
+	}
+	print(LOG_INFO, "GPIO mux backend \"%s\" started.\n", gpioframe_backend->name);
+
+	while (*terminate == 0) {
+		gpioframe_build(&frame, gpiopattern_ledstatus_phases[gpiopattern_ledstatus_phases_readidx],
+				gpfsel);
+		gpioframe_backend->swap(&frame);
+
+		// switch scans in time order, so the rotary encoders see every transition
+		gpioframe_backend->read_samples(samples, frame.sample_count);
+		for (i = 0; i < frame.sample_count; i++) {
+			unsigned row = frame.sample_row[i];
+			int switchscan = 0;
+			for (j = 0; j < 12; j++) // 12 switches in each row
+				if (samples[i] & (1 << cols[j]))
+					switchscan += 1 << j;
+			if (row == 2)
+				check_rotary_encoders(switchscan); // translate raw encoder data to switch position
+			gpio_switchstatus[row] = switchscan;
+			gpio_switch_debounce(row, switchscan);
+		}
+
+		nanosleep((struct timespec[]
+		) {	{	0, GPIOFRAME_SWAP_PERIOD_US * 1000}}, NULL);
+	}
+	gpioframe_backend->close();
+	return 0;
+}
+
+/*
+ * Mock backend: plays out the frame on the simulated GPIO register file of gpiosim.c
+ * and measures how long each LED was lit.
+ * Closed switches are set in gpiosim->connections[], like for gpio_benchmark.
+ */
+static struct
+{
+	FILE *log;
+	uint64_t logged_count; // gpiosim->log entries written to "log"
+	uint32_t samples[GPIOFRAME_MAX_SAMPLES];
+	unsigned frames;
+	unsigned errors;
+} gpioframe_mock;
+
+static int gpioframe_mock_open(char *arg, uint32_t *gpfsel)
+{
+	unsigned i;
+
+	memset(&gpioframe_mock, 0, sizeof(gpioframe_mock));
+	if (arg && *arg) {
+		gpioframe_mock.log = fopen(arg, "w");
+		if (gpioframe_mock.log == NULL) {
+			print(LOG_ERR, "Can not open GPIO log file %s\n", arg);
+			return -1;
+		}
+		fprintf(gpioframe_mock.log, "# <time ns> <GPIO register word offset> <value>\n");
+	}
+	gpio_backend = &gpio_backend_sim;
+	if (gpio_setup() == -1)
+		return -1;
+	gpioframe_mock.logged_count = gpiosim->write_count; // setup not logged
+	for (i = 0; i < 3; i++)
+		gpfsel[i] = gpio.addr[i];
+	return 0;
+}
+
+static void gpioframe_mock_swap(gpioframe_t *frame)
+{
+	uint64_t led_on_ns[6][12];
+	unsigned i, k, phase;
+
+	memset(led_on_ns, 0, sizeof(led_on_ns));
+	for (i = 0; i < frame->op_count; i++) {
+		gpioframe_op_t *op = &frame->ops[i];
+		switch (op->type) {
+		case gpioframe_op_write:
+			gpio_write(op->reg, op->value);
+			break;
+		case gpioframe_op_delay:
+			// LED lit: ledrow driven high, col driven low
+			for (k = 0; k < 6; k++)
+				if (gpiosim_is_output(ledrows[k]) && (gpiosim->level & (1u << ledrows[k])))
+					for (phase = 0; phase < 12; phase++)
+						if (gpiosim_is_output(cols[phase])
+								&& !(gpiosim->level & (1u << cols[phase])))
+							led_on_ns[k][phase] += op->value;
+			gpio_delay_ns(op->value);
+			break;
+		case gpioframe_op_sample:
+			gpioframe_mock.samples[op->value] = gpio.addr[op->reg];
+			break;
+		}
+	}
+
+	if (gpioframe_mock.log) {
+		uint64_t n = gpiosim->write_count - gpioframe_mock.logged_count > GPIOSIM_LOG_SIZE ?
+				gpiosim->write_count - GPIOSIM_LOG_SIZE : gpioframe_mock.logged_count;
+		for (; n < gpiosim->write_count; n++) {
+			gpiosim_write_t *w = &gpiosim->log[n & (GPIOSIM_LOG_SIZE - 1)];
+			fprintf(gpioframe_mock.log, "%llu %u %08x\n", (unsigned long long) w->time_ns, w->reg,
+					w->value);
+		}
+		gpioframe_mock.logged_count = n;
+	}
+
+	// verify: every LED lit "intervl" in each phase its pattern bit is set
+	for (i = 0; i < 6; i++)
+		for (k = 0; k < 12; k++) {
+			uint64_t expected_ns = 0;
+			for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++)
+				if (frame->ledstatus_phases[phase][i] & (1 << k))
+					expected_ns += intervl;
+			if (led_on_ns[i][k] != expected_ns) {
+				if (gpioframe_mock.errors++ < 10)
+					print(LOG_ERR, "GPIO mock frame %u: LED %u.%u on %llu ns, expected %llu ns\n",
+							gpioframe_mock.frames, i, k, (unsigned long long) led_on_ns[i][k],
+							(unsigned long long) expected_ns);
+			}
+		}
+	gpioframe_mock.frames++;
+}
+
+static void gpioframe_mock_read_samples(uint32_t *samples, unsigned count)
+{
+	memcpy(samples, gpioframe_mock.samples, count * sizeof(uint32_t));
+}
+
+static void gpioframe_mock_close(void)
+{
+	if (gpioframe_mock.log)
+		fclose(gpioframe_mock.log);
+	gpio_backend->unmap(&gpio);
+	print(LOG_NOTICE, "GPIO mock: %u frames, %u LED timing errors\n", gpioframe_mock.frames,
+			gpioframe_mock.errors);
+}
+
+gpioframe_backend_t gpioframe_backend_mock =
+{ "mock", gpioframe_mock_open, gpioframe_mock_swap, gpioframe_mock_read_samples,
+		gpioframe_mock_close };
@@ -0,0 +1,102 @@
+/* gpioframe.h: precomputed multiplex frames, played out by a backend
+
+   Copyright (c) 2026, BlinkenBone contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef GPIOFRAME_H_
+#define GPIOFRAME_H_
+
+#include <stdint.h>
+
+#include "gpiopattern.h"
+
+// GPIO register word offsets, see "BCM2835 ARM Peripherals" p. 90
+#define GPIOFRAME_REG_GPFSEL0	0
+#define GPIOFRAME_REG_GPSET0	7
+#define GPIOFRAME_REG_GPCLR0	10
+#define GPIOFRAME_REG_GPLEV0	13
+
+// a new frame is handed to the backend with 50 Hz
+#define GPIOFRAME_SWAP_PERIOD_US	20000
+
+// one step of the multiplex sequence
+typedef enum
+{
+	gpioframe_op_write = 0, // write "value" into GPIO register "reg"
+	gpioframe_op_delay = 1, // wait "value" nano seconds
+	gpioframe_op_sample = 2 // read GPLEV0 into samples["value"]
+} gpioframe_op_type_t;
+
+typedef struct
+{
+	gpioframe_op_type_t type;
+	unsigned reg;
+	uint32_t value;
+} gpioframe_op_t;
+
+// per phase: leds on: 3 fsel + 6 ledrows * 6, switches: 3 fsel + 3 rows * 5
+#define GPIOFRAME_OPS_PER_PHASE	(3 + 6 * 6 + 3 + 3 * 5)
+#define GPIOFRAME_MAX_OPS	(GPIOPATTERN_LED_BRIGHTNESS_PHASES * GPIOFRAME_OPS_PER_PHASE)
+#define GPIOFRAME_MAX_SAMPLES	(GPIOPATTERN_LED_BRIGHTNESS_PHASES * 3)
+
+/*
+ * All phases x ledrows, plus switch scans, as GPIO register writes.
+ * Sequence is the same as in blink(), so every frame has the same structure:
+ * only the column values of the ledrows change.
+ */
+typedef struct
+{
+	unsigned op_count;
+	gpioframe_op_t ops[GPIOFRAME_MAX_OPS];
+	unsigned sample_count;
+	unsigned sample_row[GPIOFRAME_MAX_SAMPLES]; // switch row of every sample
+	volatile uint32_t (*ledstatus_phases)[8]; // frame was build from this, for verification
+} gpioframe_t;
+
+/*
+ * Backend plays out frames cyclic, independent of the CPU.
+ */
+typedef struct
+{
+	char *name;
+	// arg: text after "<name>:" on command line, or NULL.
+	// result: current GPIO function select registers in gpfsel[0..2]. 0 = OK
+	int (*open)(char *arg, uint32_t *gpfsel);
+	// play "frame" cyclic after the current frame ended. Frame is copied.
+	void (*swap)(gpioframe_t *frame);
+	// most recent GPLEV0 samples of the switch scans
+	void (*read_samples)(uint32_t *samples, unsigned count);
+	void (*close)(void);
+} gpioframe_backend_t;
+
+#ifndef GPIOFRAME_C_
+extern gpioframe_backend_t *gpioframe_backend; // NULL: classic blink() mux
+extern gpioframe_backend_t gpioframe_backend_mock;
+extern gpioframe_backend_t gpioframe_backend_dma;
+#endif
+
+// "dma[:channel]", "mock[:logfile]". result 0 = unknown
+int gpioframe_select_backend(char *optarg);
+
+void gpioframe_build(gpioframe_t *frame, volatile uint32_t ledstatus_phases[][8], uint32_t *gpfsel);
+
+// thread main procedure, alternative to blink()
+void *gpioframe_mux(int *terminate);
+
+#endif
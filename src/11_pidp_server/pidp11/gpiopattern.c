@@ -87,11 +87,18 @@
 #define GPIOPATTERN_C_
 
 #include <time.h>
+#include <string.h>
 #include <assert.h>
 #include "bitcalc.h"
 #include "rpc_blinkenlight_api.h"
 #include "gpiopattern.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 // pointer into double buffer
 int gpiopattern_ledstatus_phases_readidx = 0; // read page, used by GPIO mux
 int gpiopattern_ledstatus_phases_writeidx = 1; // writepage page, written from Blinkenlight API
@@ -257,39 +264,152 @@ void break_here()
 {
 }
 
-/* Write a control value into one of the gpio_ledstatus[8]
- * control value maybe a pattern for a brightness phase of the value
+/*
+ * Bit sliced pattern generation
+ * =============================
+ * All LEDs of a gpio_ledstatus[] register are processed together:
+ * - brightness of every LED is looked up once per update, as 31 phase bits
+ *   split into 4 byte planes: planes[j][k] = phases 8*j .. 8*j+7 of register bit k,
+ *   phase 8*j in the msb.
+ * - transposing the planes gives the register words for all phases:
+ *   the msbs of all bytes of a plane are the register word of one phase,
+ *   then every byte is shifted up for the next phase.
+ * - which control bit drives which register bit is taken from the register wiring
+ *   once, into a gather table per register.
  */
-static void value2gpio_ledstatus_value(blinkenlight_panel_t *p, blinkenlight_control_t *c,
-		uint32_t value, volatile uint32_t *gpio_ledstatus)
-{
-    unsigned i_register_wiring;
-    extern blinkenlight_control_t * leds_MMR0_MODE ;
-    extern blinkenlight_control_t * switch_LAMPTEST ;
-
-
-//-----------------------------------------------------------------------
-    extern blinkenlight_control_t * leds_ADDR_SELECT ;
-    extern blinkenlight_control_t * leds_DATA_SELECT ;
-//-----------------------------------------------------------------------
-
-
+#define GPIOPATTERN_REGISTERS	8	// see gpio_ledstatus[8]
+#define GPIOPATTERN_REGISTER_BITS	16	// max LEDs per register. 12 used.
+#define GPIOPATTERN_PLANES	4	// 32 phases as bytes
 
-    int panel_mode = p->mode ;
+// source of one LED in gpio_ledstatus[register]
+typedef struct
+{
+	blinkenlight_control_t *control; // NULL: not driven by API
+	unsigned bitidx; // index into control->averaged_value_bits[]
+	int active_low;
+} gpiopattern_led_source_t;
 
-    // local LAMPTEST overrides mode set over API
-    if (!switch_LAMPTEST->value)				// prototype has lamptest inverted
-        panel_mode = RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST ;
+// gather table, built for this panel
+static blinkenlight_panel_t *gpiopattern_led_sources_panel = NULL;
+static gpiopattern_led_source_t gpiopattern_led_sources[GPIOPATTERN_REGISTERS][GPIOPATTERN_REGISTER_BITS];
+static int gpiopattern_led_register_used[GPIOPATTERN_REGISTERS];
 
+// brightness_phase_lookup[level][] as byte planes, phase 8*j in msb of byte j
+static uint8_t brightness_phase_bytes[GPIOPATTERN_LED_BRIGHTNESS_LEVELS][GPIOPATTERN_PLANES];
 
+static void brightness_phase_bytes_init(void)
+{
+	unsigned level, phase;
+	memset(brightness_phase_bytes, 0, sizeof(brightness_phase_bytes));
+	for (level = 0; level < GPIOPATTERN_LED_BRIGHTNESS_LEVELS; level++)
+		for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++)
+			if (brightness_phase_lookup[level][phase])
+				brightness_phase_bytes[level][phase / 8] |= 0x80 >> (phase % 8);
+}
 
+/*
+ * Build gather table from control wiring.
+ * Controls later in list overwrite same register bits, like sequential register writes did.
+ * Mirrored bit order is resolved here.
+ * ADDR_SELECT and DATA_SELECT feedback LEDs are not wired, see gpiopattern_select_feedback().
+ */
+static void gpiopattern_led_sources_init(blinkenlight_panel_t *p)
+{
+	extern blinkenlight_control_t * leds_ADDR_SELECT;
+	extern blinkenlight_control_t * leds_DATA_SELECT;
+	unsigned i, i_register_wiring, k;
+
+	memset(gpiopattern_led_sources, 0, sizeof(gpiopattern_led_sources));
+	memset(gpiopattern_led_register_used, 0, sizeof(gpiopattern_led_register_used));
+	for (i = 0; i < p->controls_count; i++) {
+		blinkenlight_control_t *c = &p->controls[i];
+		if (c->is_input || c == leds_ADDR_SELECT || c == leds_DATA_SELECT)
+			continue;
+		for (i_register_wiring = 0; i_register_wiring < c->blinkenbus_register_wiring_count;
+				i_register_wiring++) {
+			blinkenlight_control_blinkenbus_register_wiring_t *bbrw =
+					&(c->blinkenbus_register_wiring[i_register_wiring]);
+			assert(bbrw->blinkenbus_register_address < GPIOPATTERN_REGISTERS);
+			assert(bbrw->blinkenbus_lsb + bbrw->blinkenbus_bitmask_len <= GPIOPATTERN_REGISTER_BITS);
+			gpiopattern_led_register_used[bbrw->blinkenbus_register_address] = 1;
+			for (k = 0; k < bbrw->blinkenbus_bitmask_len; k++) {
+				gpiopattern_led_source_t *src =
+						&gpiopattern_led_sources[bbrw->blinkenbus_register_address][bbrw->blinkenbus_lsb
+								+ k];
+				unsigned bitidx = bbrw->control_value_bit_offset + k;
+				src->active_low = bbrw->blinkenbus_levels_active_low;
+				if (bitidx < c->value_bitlen) {
+					src->control = c;
+					src->bitidx = c->mirrored_bit_order ? c->value_bitlen - 1 - bitidx : bitidx;
+				} else
+					src->control = NULL; // always OFF
+			}
+		}
+	}
+	brightness_phase_bytes_init();
+	gpiopattern_led_sources_panel = p;
+}
 
+/*
+ * planes[j][k]: phases 8*j..8*j+7 of register bit k, msb first
+ * -> words[phase]: bit k = register bit k in this phase
+ */
+static void gpiopattern_transpose(uint8_t planes[GPIOPATTERN_PLANES][GPIOPATTERN_REGISTER_BITS],
+		uint32_t *words)
+{
+	unsigned j, i;
+#if defined(__SSE2__)
+	for (j = 0; j < GPIOPATTERN_PLANES; j++) {
+		__m128i v = _mm_loadu_si128((__m128i *) planes[j]);
+		for (i = 0; i < 8; i++) {
+			*words++ = _mm_movemask_epi8(v); // msb of 16 bytes
+			v = _mm_add_epi8(v, v); // shift all bytes up
+		}
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	// no "movemask" on ARM: weight msbs by lane and add horizontal
+	static const uint8_t lane_bits[16] =
+	{ 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t weights = vld1q_u8(lane_bits);
+	for (j = 0; j < GPIOPATTERN_PLANES; j++) {
+		uint8x16_t v = vld1q_u8(planes[j]);
+		for (i = 0; i < 8; i++) {
+			uint8x16_t msbs = vandq_u8(vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(v), 7)),
+					weights);
+			uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(msbs)));
+			*words++ = (uint32_t) vgetq_lane_u64(sums, 0) | ((uint32_t) vgetq_lane_u64(sums, 1) << 8);
+			v = vshlq_n_u8(v, 1);
+		}
+	}
+#else
+	// 8 bytes in an uint64_t: msbs are collected into the top byte by one multiply
+	for (j = 0; j < GPIOPATTERN_PLANES; j++) {
+		uint64_t lo = 0, hi = 0;
+		for (i = 0; i < 8; i++) {
+			lo |= (uint64_t) planes[j][i] << (8 * i);
+			hi |= (uint64_t) planes[j][i + 8] << (8 * i);
+		}
+		for (i = 0; i < 8; i++) {
+			*words++ = (uint32_t) (((lo & 0x8080808080808080ULL) * 0x0002040810204081ULL) >> 56)
+					| (uint32_t) (((hi & 0x8080808080808080ULL) * 0x0002040810204081ULL) >> 56) << 8;
+			lo <<= 1; // carry into next byte never reaches its msb in 8 shifts
+			hi <<= 1;
+		}
+	}
+#endif
+}
 
-//-----------------------------------------------------------------------
-    if (c == leds_ADDR_SELECT) {
-        // circumvent wiring defintions, hard coded logic here:
-        // val:   UD  SD  KD CPHY     UI  SI  KI PPHY
-        // leds: 4.6 4.7 4.8 4.9     5.5 5.6 5.7 5.8
+/*
+ * ADDR_SELECT and DATA_SELECT feedback LEDs show the knob positions,
+ * hard coded logic, circumventing wiring definitions.
+ * Same for all phases: result are register masks to clear and set.
+ */
+static void gpiopattern_select_feedback(int panel_mode, uint32_t *clear4, uint32_t *set4,
+		uint32_t *clear5, uint32_t *set5)
+{
+	// ADDR_SELECT
+	// val:   UD  SD  KD CPHY     UI  SI  KI PPHY
+	// leds: 4.6 4.7 4.8 4.9     5.5 5.6 5.7 5.8
 #define REGMASK_LED_USER_D 0x40
 #define REGMASK_LED_SUPER_D 0x80
 #define REGMASK_LED_KERNEL_D 0x100
@@ -302,50 +422,9 @@ static void value2gpio_ledstatus_value(blinkenlight_panel_t *p, blinkenlight_con
 #define REGMASK_LED_PROG_PHY 0x200
 #define REGMASK_ADDR_ALL5 0x3C0
 
-        int mask4 = 0;
-        int mask5 = 0;
-        switch (panel_mode) {
-        case RPC_PARAM_VALUE_PANEL_MODE_NORMAL:
-
-//            switch(value) {
-            switch(knobValue[0]) {
-            case 0: mask5 |= REGMASK_LED_PROG_PHY; break ;
-            case 1: mask4 |= REGMASK_LED_CONS_PHY; break ;
-            case 2: mask4 |= REGMASK_LED_KERNEL_D; break ;
-            case 3: mask4 |= REGMASK_LED_SUPER_D ; break ;
-            case 4: mask4 |= REGMASK_LED_USER_D ; break ;
-            case 5: mask5 |= REGMASK_LED_USER_I ; break ;
-            case 6: mask5 |= REGMASK_LED_SUPER_I ; break ;
-            case 7: mask5 |= REGMASK_LED_KERNEL_I; break ;
-            }
-		break;
-	
-        case RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST:
-        case RPC_PARAM_VALUE_PANEL_MODE_ALLTEST:
-            mask4 = REGMASK_ADDR_ALL4 ; // all ON
-            mask5 = REGMASK_ADDR_ALL5 ; // all ON
-            break;
-
-
-        case RPC_PARAM_VALUE_PANEL_MODE_POWERLESS:
-            mask4 = 0 ; // all off
-		mask5 =0;
-            break;
-        }
-        // mask all out and set selective
-        gpio_ledstatus[4] = (gpio_ledstatus[4] & ~REGMASK_ADDR_ALL4) | mask4 ;
-        gpio_ledstatus[5] = (gpio_ledstatus[5] & ~REGMASK_ADDR_ALL5) | mask5 ;
-
-        //
-        return ;
-    }
-	
-//-------------------------------------------------------------------------
-//-----------------------------------------------------------------------
-    if (c == leds_DATA_SELECT) {
-        // circumvent wiring defintions, hard coded logic here:
-        // val:   DP  BR   uAD DR
-        // leds: 4.10 4.11 5.10 5.11
+	// DATA_SELECT
+	// val:   DP  BR   uAD DR
+	// leds: 4.10 4.11 5.10 5.11
 #define REGMASK_LED_DATA_PATHS 0x400
 #define REGMASK_LED_BUS_REG 0x800
 #define REGMASK_DATA_ALL4 0xC00
@@ -354,130 +433,129 @@ static void value2gpio_ledstatus_value(blinkenlight_panel_t *p, blinkenlight_con
 #define REGMASK_LED_DISREG 0x800
 #define REGMASK_DATA_ALL5 0xC00
 
-        int mask4 = 0;
-        int mask5 = 0;
-        switch (panel_mode) {
-        case RPC_PARAM_VALUE_PANEL_MODE_NORMAL:
-
-//            switch(value) {
-            switch(knobValue[1]) {
-
-            	case 0:
-		case 4: mask4 |= REGMASK_LED_BUS_REG ; break ;
-            	case 1:
-		case 5: mask4 |= REGMASK_LED_DATA_PATHS ; break ;
-            	case 2:
-		case 6: mask5 |= REGMASK_LED_UADR; break ;
-            	case 3: 
-		case 7: mask5 |= REGMASK_LED_DISREG; break ;
-            }
-		break;
-	
-        case RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST:
-        case RPC_PARAM_VALUE_PANEL_MODE_ALLTEST:
-            mask4 = REGMASK_DATA_ALL4 ; // all ON
-            mask5 = REGMASK_DATA_ALL5 ; // all ON
-            break;
-
-
-        case RPC_PARAM_VALUE_PANEL_MODE_POWERLESS:
-            mask4 = 0 ; // all off
-		mask5 =0;
-            break;
-        }
-        // mask all out and set selective
-        gpio_ledstatus[4] = (gpio_ledstatus[4] & ~REGMASK_DATA_ALL4) | mask4 ;
-        gpio_ledstatus[5] = (gpio_ledstatus[5] & ~REGMASK_DATA_ALL5) | mask5 ;
-
-        //
-        return ;
-    }
-	
-//-------------------------------------------------------------------------
-
-
-
-#ifdef OLD
-    if (c == leds_MMR0_MODE) {
-        // circumevent wiring definitions, hard coded logic here:
-        // val: 0 = Kernel, 1= off,  2 = Super, 3 = User
-        // leds: kernel = reg[2].4, super= reg[2].5 user=reg[2].6
-#define REGMASK_LED_KERNEL 0x10
-#define REGMASK_LED_SUPER 0x20
-#define REGMASK_LED_USER 0x40
-#define REGMASK_LEDS_K_S_U 0x70
-        int mask = 0;
-        switch (panel_mode) {
-        case RPC_PARAM_VALUE_PANEL_MODE_NORMAL:
-
-            switch(value) {
-            case 0: mask |= REGMASK_LED_KERNEL ; break ;
-            case 2: mask |= REGMASK_LED_SUPER; break ;
-            case 3: mask |= REGMASK_LED_USER; break ;
-            }
-// BUGFIX 20130323: break was missing:
-		break;
+	uint32_t mask4 = 0;
+	uint32_t mask5 = 0;
 
-        case RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST:
-        case RPC_PARAM_VALUE_PANEL_MODE_ALLTEST:
-            mask = REGMASK_LEDS_K_S_U ; // all ON
-            break;
-
-
-        case RPC_PARAM_VALUE_PANEL_MODE_POWERLESS:
-            mask = 0 ; // all off
-            break;
-        }
-mask = 0 ;
-        // mask all out and set selective
-        gpio_ledstatus[2] = (gpio_ledstatus[2] & ~REGMASK_LEDS_K_S_U) | mask ;
-        //
-        return ;
-    }
-#endif // OLD
+	*clear4 = REGMASK_ADDR_ALL4 | REGMASK_DATA_ALL4;
+	*clear5 = REGMASK_ADDR_ALL5 | REGMASK_DATA_ALL5;
 	switch (panel_mode) {
 	case RPC_PARAM_VALUE_PANEL_MODE_NORMAL:
-        if (c->mirrored_bit_order)
-{ printf(":");
-            value = mirror_bits(value, c->value_bitlen);
-}
+		switch (knobValue[0]) {
+		case 0: mask5 |= REGMASK_LED_PROG_PHY; break;
+		case 1: mask4 |= REGMASK_LED_CONS_PHY; break;
+		case 2: mask4 |= REGMASK_LED_KERNEL_D; break;
+		case 3: mask4 |= REGMASK_LED_SUPER_D; break;
+		case 4: mask4 |= REGMASK_LED_USER_D; break;
+		case 5: mask5 |= REGMASK_LED_USER_I; break;
+		case 6: mask5 |= REGMASK_LED_SUPER_I; break;
+		case 7: mask5 |= REGMASK_LED_KERNEL_I; break;
+		}
+		switch (knobValue[1]) {
+		case 0:
+		case 4: mask4 |= REGMASK_LED_BUS_REG; break;
+		case 1:
+		case 5: mask4 |= REGMASK_LED_DATA_PATHS; break;
+		case 2:
+		case 6: mask5 |= REGMASK_LED_UADR; break;
+		case 3:
+		case 7: mask5 |= REGMASK_LED_DISREG; break;
+		}
 		break;
 	case RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST:
 	case RPC_PARAM_VALUE_PANEL_MODE_ALLTEST:
-        value = BitmaskFromLen64[c->value_bitlen]; // all '1'
+		mask4 = REGMASK_ADDR_ALL4 | REGMASK_DATA_ALL4; // all ON
+		mask5 = REGMASK_ADDR_ALL5 | REGMASK_DATA_ALL5;
 		break;
 	case RPC_PARAM_VALUE_PANEL_MODE_POWERLESS:
-		// all LEDs off, but do not change control values
-        value = 0;
-		break;
+		break; // all off
 	}
-
-    // write value to gpio registers
-    for (i_register_wiring = 0; i_register_wiring < c->blinkenbus_register_wiring_count;
-            i_register_wiring++) {
-        blinkenlight_control_blinkenbus_register_wiring_t *bbrw;
-        unsigned regval; // value of current register
-        unsigned bitfield; // bits moutnend into current register
-        // for all registers assigned whole or in part to control
-        bbrw = &(c->blinkenbus_register_wiring[i_register_wiring]);
-
-        // clear out used bits in register
-        regval = gpio_ledstatus[bbrw->blinkenbus_register_address] & ~bbrw->blinkenbus_bitmask;
-
-        bitfield = (value >> bbrw->control_value_bit_offset); // value shifted to register lsb
-        if (bbrw->blinkenbus_levels_active_low)
-            bitfield = ~bitfield;
-        bitfield &= BitmaskFromLen32[bbrw->blinkenbus_bitmask_len]; // masked to register
-        bitfield <<= bbrw->blinkenbus_lsb;
-
-        gpio_ledstatus[bbrw->blinkenbus_register_address] = regval | bitfield; // write back
-    }
+	*set4 = mask4;
+	*set5 = mask5;
 }
 
 /*
  * - averages the Blinkenlight API outputs,
- * - generates the LED brightness patterns
- * - swaps the double buffer
+ * - generates the LED brightness patterns into the write page of the double buffer
+ */
+void gpiopattern_update_phases(blinkenlight_panel_t *p, uint64_t now_us)
+{
+	extern blinkenlight_control_t * switch_LAMPTEST;
+	int panel_mode = p->mode;
+	uint32_t clear4, set4, clear5, set5;
+	unsigned i, reg, k, j, phase;
+
+	// local LAMPTEST overrides mode set over API
+	if (!switch_LAMPTEST->value) // prototype has lamptest inverted
+		panel_mode = RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST;
+
+	if (p != gpiopattern_led_sources_panel)
+		gpiopattern_led_sources_init(p);
+
+	// get averaged values
+	for (i = 0; i < p->controls_count; i++) {
+		blinkenlight_control_t *c = &p->controls[i];
+		if (c->is_input)
+			continue;
+		assert(c->fmax);
+		historybuffer_get_average_vals(c->history, 1000000 / c->fmax, now_us, /*bitmode*/1);
+	}
+
+	// mount values for gpio_registers ordered by register,
+	// else flicker by co-running gpio_mux may occur.
+	gpiopattern_select_feedback(panel_mode, &clear4, &set4, &clear5, &set5);
+	for (reg = 0; reg < GPIOPATTERN_REGISTERS; reg++) {
+		uint8_t planes[GPIOPATTERN_PLANES][GPIOPATTERN_REGISTER_BITS];
+		uint32_t words[8 * GPIOPATTERN_PLANES];
+		uint32_t clear = 0, set = 0;
+
+		if (!gpiopattern_led_register_used[reg] && reg != 4 && reg != 5)
+			continue;
+		// phase pattern of every LED in register
+		for (k = 0; k < GPIOPATTERN_REGISTER_BITS; k++) {
+			gpiopattern_led_source_t *src = &gpiopattern_led_sources[reg][k];
+			static const uint8_t all_off[GPIOPATTERN_PLANES] = { 0, 0, 0, 0 };
+			static const uint8_t all_on[GPIOPATTERN_PLANES] = { 0xff, 0xff, 0xff, 0xff };
+			const uint8_t *bytes;
+			if (src->control == NULL)
+				bytes = all_off;
+			else
+				switch (panel_mode) {
+				case RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST:
+				case RPC_PARAM_VALUE_PANEL_MODE_ALLTEST:
+					bytes = all_on;
+					break;
+				case RPC_PARAM_VALUE_PANEL_MODE_POWERLESS:
+					// all LEDs off, but do not change control values
+					bytes = all_off;
+					break;
+				default: {
+					// from 0.. 255 to brightness level
+					unsigned bit_brightness =
+							((unsigned) (src->control->averaged_value_bits[src->bitidx])
+									* GPIOPATTERN_LED_BRIGHTNESS_LEVELS) / 256;
+					bytes = brightness_phase_bytes[bit_brightness];
+				}
+				}
+			for (j = 0; j < GPIOPATTERN_PLANES; j++)
+				planes[j][k] = src->active_low ? ~bytes[j] : bytes[j];
+		}
+		gpiopattern_transpose(planes, words);
+
+		if (reg == 4) {
+			clear = clear4;
+			set = set4;
+		} else if (reg == 5) {
+			clear = clear5;
+			set = set5;
+		}
+		for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++)
+			gpiopattern_ledstatus_phases[gpiopattern_ledstatus_phases_writeidx][phase][reg] =
+					(words[phase] & ~clear) | set;
+	}
+}
+
+/*
+ * Update thread: gpiopattern_update_phases() periodically, then swaps the double buffer.
  *
  * gpiopattern_blinkenlight_panel must be set before call!
  *
@@ -490,8 +568,6 @@ void *gpiopattern_update_leds(int *terminate)
 
 	while (*terminate == 0) {
 		blinkenlight_panel_t *p = gpiopattern_blinkenlight_panel; // short alias
-		uint64_t now_us;
-		unsigned i;
 
 		// wait for one period
 		nanosleep((struct timespec[]
@@ -500,53 +576,7 @@ void *gpiopattern_update_leds(int *terminate)
 		if (p == NULL)
 			continue;
 
-		now_us = historybuffer_now_us();
-
-		// mount values for gpio_registers ordered by register,
-		// else flicker by co-running gpio_mux may occur.
-		for (i = 0; i < p->controls_count; i++) {
-			blinkenlight_control_t *c = &p->controls[i];
-			unsigned bitidx;
-			unsigned phase;
-			if (c->is_input)
-				continue;
-
-			// fetch  shift
-			// get averaged values
-			assert(c->fmax) ;
-				historybuffer_get_average_vals(c->history, 1000000 / c->fmax, now_us, /*bitmode*/1);
-
-
-			/*
-			 // construct un-averaged value
-			 for (bitidx = 0; bitidx < c->value_bitlen; bitidx++)
-			 c->averaged_value_bits[bitidx] = (bitidx + 1) * 8 * ((c->value >> bitidx) & 1);
-			 //MSB s brighter
-			 */
-
-			// build the display value from the low-passed bits.
-			// for all display phases :
-			for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++) {
-				unsigned value;
-
-				// mount phase value
-				volatile uint32_t *gpio_ledstatus = // alias
-						gpiopattern_ledstatus_phases[gpiopattern_ledstatus_phases_writeidx][phase];
-				value = 0;
-				// for all bits :
-				for (bitidx = 0; bitidx < c->value_bitlen; bitidx++) {
-					// mount phase bit
-					unsigned bit_brightness = ((unsigned) (c->averaged_value_bits[bitidx])
-							* (GPIOPATTERN_LED_BRIGHTNESS_LEVELS)) / 256; // from 0.. 255 to
-
-					assert(bit_brightness < GPIOPATTERN_LED_BRIGHTNESS_LEVELS);
-					if (brightness_phase_lookup[bit_brightness][phase])
-						value |= 1 << bitidx;
-
-				}
-				value2gpio_ledstatus_value(p, c, value, gpio_ledstatus); // fill in to gpio
-			}
-		}
+		gpiopattern_update_phases(p, historybuffer_now_us());
 
 		// switch pages of double buffer
 		gpiopattern_ledstatus_phases_readidx = gpiopattern_ledstatus_phases_writeidx;
@@ -555,4 +585,3 @@ void *gpiopattern_update_leds(int *terminate)
 	} // while(! terminate)
 	return 0;
 }
-
@@ -55,5 +55,8 @@ extern volatile uint32_t gpiopattern_ledstatus_phases[2][GPIOPATTERN_LED_BRIGHTN
 
 // void *gpiopattern_update_leds(int *terminate) ;
 
+// one pattern update into write page of double buffer
+void gpiopattern_update_phases(blinkenlight_panel_t *p, uint64_t now_us) ;
+
 
 #endif
@@ -0,0 +1,179 @@
+/* gpiopattern_benchmark.c: timing of LED pattern generation, without GPIO
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ Stand alone, not part of server build:
+	cc -O2 -DBLINKENLIGHT_SERVER -I. -I../../00_common -I../../07.0_blinkenlight_api \
+		-I../../07.0_blinkenlight_api/rpcgen_linux -I/usr/include/tirpc \
+		-o gpiopattern_benchmark gpiopattern_benchmark.c gpiopattern.c \
+		../../07.0_blinkenlight_api/blinkenlight_panels.c \
+		../../07.0_blinkenlight_api/historybuffer.c ../../00_common/bitcalc.c
+
+ Panel has the LED wiring of main.c register_controls().
+ Control values change every 400us, like a running SimH,
+ gpiopattern_update_phases() is called every 20ms and timed.
+ Prints time per update and a checksum over all generated phase patterns,
+ which must not change with optimizations.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bitcalc.h"
+#include "blinkenlight_panels.h"
+#include "rpc_blinkenlight_api.h"
+#include "gpiopattern.h"
+
+#define BENCHMARK_CHANGE_PERIOD_US	400
+#define BENCHMARK_UPDATE_PERIOD_US	20000
+#define BENCHMARK_UPDATES	20000
+
+// referenced by gpiopattern.c, defined in main.c and gpio.c
+blinkenlight_panel_list_t *blinkenlight_panel_list;
+blinkenlight_control_t *switch_LAMPTEST, *leds_MMR0_MODE, *leds_ADDR_SELECT, *leds_DATA_SELECT;
+int knobValue[2];
+
+static blinkenlight_control_t *define_led_slice(blinkenlight_panel_t *p, char *name,
+		unsigned control_value_bit_offset, unsigned bitlen, unsigned gpio_ledstatus_index,
+		unsigned bit_offset)
+{
+	blinkenlight_control_t *c;
+	blinkenlight_control_blinkenbus_register_wiring_t *bbrw;
+
+	c = blinkenlight_panels_get_control_by_name(blinkenlight_panel_list, p, name, /*is_input*/0);
+	if (c == NULL) {
+		c = blinkenlight_add_control(blinkenlight_panel_list, p);
+		strcpy(c->name, name);
+		c->is_input = 0;
+		c->type = output_lamp;
+		c->encoding = binary;
+		c->fmax = 10;
+	}
+	bbrw = blinkenlight_add_register_wiring(c);
+	bbrw->blinkenbus_board_address = 0;
+	bbrw->board_register_address = gpio_ledstatus_index;
+	bbrw->control_value_bit_offset = control_value_bit_offset;
+	bbrw->blinkenbus_lsb = bit_offset;
+	bbrw->blinkenbus_msb = bbrw->blinkenbus_lsb + bitlen - 1;
+	bbrw->blinkenbus_levels_active_low = 0;
+	return c;
+}
+
+static blinkenlight_panel_t *benchmark_panel(void)
+{
+	blinkenlight_panel_t *p;
+	blinkenlight_control_t *c;
+
+	blinkenlight_panel_list = blinkenlight_panels_constructor();
+	p = blinkenlight_add_panel(blinkenlight_panel_list);
+	strcpy(p->name, "11/70");
+
+	switch_LAMPTEST = c = blinkenlight_add_control(blinkenlight_panel_list, p);
+	strcpy(c->name, "LAMPTEST");
+	c->is_input = 1;
+	c->type = input_switch;
+	c->value = 1; // inverted: not pressed
+
+	define_led_slice(p, "ADDRESS", 0, 12, 0, 0);
+	define_led_slice(p, "ADDRESS", 12, 10, 1, 0);
+	define_led_slice(p, "DATA", 0, 12, 3, 0);
+	define_led_slice(p, "DATA", 12, 4, 4, 0);
+	define_led_slice(p, "PARITY_HIGH", 0, 1, 4, 5);
+	define_led_slice(p, "PARITY_LOW", 0, 1, 4, 4);
+	define_led_slice(p, "PAR_ERR", 0, 1, 2, 11);
+	define_led_slice(p, "ADRS_ERR", 0, 1, 2, 10);
+	define_led_slice(p, "RUN", 0, 1, 2, 9);
+	define_led_slice(p, "PAUSE", 0, 1, 2, 8);
+	define_led_slice(p, "MASTER", 0, 1, 2, 7);
+	leds_MMR0_MODE = define_led_slice(p, "MMR0_MODE", 0, 3, 2, 4);
+	define_led_slice(p, "DATA_SPACE", 0, 1, 2, 3);
+	define_led_slice(p, "ADDRESSING_16", 0, 1, 2, 2);
+	define_led_slice(p, "ADDRESSING_18", 0, 1, 2, 1);
+	define_led_slice(p, "ADDRESSING_22", 0, 1, 2, 0);
+	define_led_slice(p, "ADDR_SELECT_FEEDBACK", 0, 4, 4, 6);
+	leds_ADDR_SELECT = define_led_slice(p, "ADDR_SELECT_FEEDBACK", 4, 4, 5, 5);
+	define_led_slice(p, "DATA_SELECT_FEEDBACK", 0, 2, 4, 10);
+	leds_DATA_SELECT = define_led_slice(p, "DATA_SELECT_FEEDBACK", 2, 2, 5, 10);
+
+	blinkenlight_panels_config_fixup(blinkenlight_panel_list);
+	return p;
+}
+
+static uint64_t benchmark_ns(void)
+{
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+	blinkenlight_panel_t *p = benchmark_panel();
+	uint64_t random_state = 0x2545f4914f6cdd1dULL;
+	uint64_t now_us = 1000000;
+	uint64_t ns = 0;
+	uint32_t checksum = 0;
+	unsigned update, i, phase, reg;
+
+	for (update = 0; update < BENCHMARK_UPDATES; update++) {
+		uint64_t start_ns;
+		// running SimH: random values
+		for (i = 0; i < BENCHMARK_UPDATE_PERIOD_US / BENCHMARK_CHANGE_PERIOD_US; i++) {
+			unsigned ci;
+			now_us += BENCHMARK_CHANGE_PERIOD_US;
+			for (ci = 0; ci < p->controls_count; ci++) {
+				blinkenlight_control_t *c = &p->controls[ci];
+				if (c->is_input)
+					continue;
+				random_state ^= random_state << 13;
+				random_state ^= random_state >> 7;
+				random_state ^= random_state << 17;
+				historybuffer_set_val(c->history, now_us,
+						random_state & BitmaskFromLen64[c->value_bitlen]);
+			}
+		}
+		// sometimes other panel modes and knob positions
+		if (update % 97 == 0)
+			p->mode = RPC_PARAM_VALUE_PANEL_MODE_POWERLESS;
+		else if (update % 89 == 0)
+			p->mode = RPC_PARAM_VALUE_PANEL_MODE_ALLTEST;
+		else
+			p->mode = RPC_PARAM_VALUE_PANEL_MODE_NORMAL;
+		switch_LAMPTEST->value = (update % 83 != 0);
+		knobValue[0] = (update / 10) % 8;
+		knobValue[1] = (update / 7) % 8;
+
+		start_ns = benchmark_ns();
+		gpiopattern_update_phases(p, now_us);
+		ns += benchmark_ns() - start_ns;
+
+		for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++)
+			for (reg = 0; reg < 8; reg++)
+				checksum = checksum * 31
+						+ gpiopattern_ledstatus_phases[gpiopattern_ledstatus_phases_writeidx][phase][reg];
+		gpiopattern_ledstatus_phases_readidx = gpiopattern_ledstatus_phases_writeidx;
+		gpiopattern_ledstatus_phases_writeidx = !gpiopattern_ledstatus_phases_writeidx;
+	}
+	printf("%u updates, %.1f us per update, checksum %08x\n", BENCHMARK_UPDATES,
+			(double) ns / BENCHMARK_UPDATES / 1000, checksum);
+	return 0;
+}
@@ -0,0 +1,125 @@
+/* gpiosim.c: simulated GPIO register file, for test and benchmark without a Pi
+
+ Copyright (c) 2026, BlinkenBone contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ gpio_backend_sim replaces /dev/mem by an anonymous mmap.
+ The register file is ordinary memory; after each gpio_write()
+ GPSET0/GPCLR0 are applied to the output latches, GPLEV0 is recalculated
+ and the write is logged with a time stamp.
+ Inputs have pull-ups. A switch matrix is simulated by "connections":
+ an output pin driving low pulls the connected input pins low.
+
+ Time is virtual by default: gpio_delay_ns() advances a clock
+ and writes take no time, so runs are exactly reproducible.
+ With gpiosim_virtual_time = 0 delays really sleep and CLOCK_MONOTONIC is used,
+ to see the timing jitter of the machine.
+ */
+
+#define GPIOSIM_C_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpio.h"
+#include "gpiosim.h"
+
+gpiosim_t *gpiosim = NULL;
+int gpiosim_virtual_time = 1;
+void (*gpiosim_on_delay)(uint64_t now_ns) = NULL;
+
+uint64_t gpiosim_now_ns(void)
+{
+	struct timespec tp;
+	if (gpiosim_virtual_time)
+		return gpiosim->time_ns;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+int gpiosim_is_output(unsigned pin)
+{
+	return ((gpiosim->regs[pin / 10] >> ((pin % 10) * 3)) & 7) == 1;
+}
+
+void gpiosim_update_levels(void)
+{
+	uint32_t outputs = 0, pulled_low = 0;
+	unsigned pin;
+	for (pin = 0; pin < 32; pin++)
+		if (gpiosim_is_output(pin))
+			outputs |= 1u << pin;
+	for (pin = 0; pin < 32; pin++)
+		if ((outputs & (1u << pin)) && !(gpiosim->level & (1u << pin)))
+			pulled_low |= gpiosim->connections[pin];
+	// outputs show their latch, inputs are pulled up
+	gpiosim->regs[13] = (gpiosim->level & outputs) | (~outputs & ~pulled_low);
+}
+
+static int gpiosim_map(struct bcm2835_peripheral *p)
+{
+	gpiosim = mmap(NULL, sizeof(gpiosim_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			-1, 0);
+	if (gpiosim == MAP_FAILED) {
+		perror("mmap");
+		gpiosim = NULL;
+		return -1;
+	}
+	// anonymous memory is zero: all pins input, latches low
+	p->mem_fd = -1;
+	p->map = gpiosim;
+	p->addr = gpiosim->regs;
+	gpiosim_update_levels();
+	return 0;
+}
+
+static void gpiosim_unmap(struct bcm2835_peripheral *p)
+{
+	munmap(p->map, sizeof(gpiosim_t));
+	gpiosim = NULL;
+}
+
+static void gpiosim_written(unsigned reg, uint32_t value)
+{
+	gpiosim_write_t *w = &gpiosim->log[gpiosim->write_count++ & (GPIOSIM_LOG_SIZE - 1)];
+	w->time_ns = gpiosim_now_ns();
+	w->reg = reg;
+	w->value = value;
+	if (reg == 7)
+		gpiosim->level |= value;
+	else if (reg == 10)
+		gpiosim->level &= ~value;
+	gpiosim_update_levels();
+}
+
+static void gpiosim_delay_ns(long ns)
+{
+	if (gpiosim_on_delay)
+		gpiosim_on_delay(gpiosim_now_ns());
+	if (gpiosim_virtual_time)
+		gpiosim->time_ns += ns;
+	else
+		nanosleep((struct timespec[]) { { 0, ns}}, NULL);
+}
+
+gpio_backend_t gpio_backend_sim =
+{ "sim", gpiosim_map, gpiosim_unmap, gpiosim_written, gpiosim_delay_ns };
@@ -0,0 +1,61 @@
+/* gpiosim.h: simulated GPIO register file, for test and benchmark without a Pi
+
+   Copyright (c) 2026, BlinkenBone contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef GPIOSIM_H_
+#define GPIOSIM_H_
+
+#include <stdint.h>
+
+#include "gpio.h"
+
+#define GPIOSIM_LOG_SIZE	(1 << 20) // ring of register writes, power of 2
+
+typedef struct
+{
+	uint64_t time_ns;
+	uint32_t reg; // word offset in register file
+	uint32_t value;
+} gpiosim_write_t;
+
+// all in one anonymous mmap. regs[] must be first: it is "gpio.addr"
+typedef struct
+{
+	uint32_t regs[BLOCK_SIZE / 4]; // register file, as seen by gpio.c
+	uint32_t level; // output latches of pins 0..31
+	// closed switches: connections[pin] = inputs pulled low, if "pin" is output and low
+	uint32_t connections[32];
+	uint64_t time_ns; // virtual clock
+	uint64_t write_count; // total, log holds the last GPIOSIM_LOG_SIZE
+	gpiosim_write_t log[GPIOSIM_LOG_SIZE];
+} gpiosim_t;
+
+#ifndef GPIOSIM_C_
+extern gpio_backend_t gpio_backend_sim;
+extern gpiosim_t *gpiosim; // valid after gpio_setup()
+extern int gpiosim_virtual_time; // 1: delays only advance the clock, 0: real sleep
+extern void (*gpiosim_on_delay)(uint64_t now_ns); // called before every delay
+#endif
+
+uint64_t gpiosim_now_ns(void);
+int gpiosim_is_output(unsigned pin); // function select of "pin" is output
+void gpiosim_update_levels(void); // recalc GPLEV0, after change of connections[]
+
+#endif
@@ -60,6 +60,7 @@
 #include <pthread.h>
 #include <inttypes.h> 
 #include <unistd.h>
+#include <fcntl.h>
 
 #include "blinkenlight_panels.h"
 #include "blinkenlight_api_server_procs.h"
@@ -77,6 +78,7 @@
 #include "main.h"
 #include "gpio.h"
 #include "gpiopattern.h"
+#include "gpioframe.h"
 
 char program_info[1024];
 char program_name[1024]; // argv[0]
@@ -294,11 +296,56 @@ int blink_thread_terminate = 0;
 pthread_t gpiopattern_thread;
 int gpiopattern_thread_terminate = 0;
 
+/*
+ * Switch events from the mux thread wake up the RPC server loop,
+ * which publishes the new input values to shared memory immediately.
+ */
+typedef struct
+{
+    uint64_t scan_us, detect_us;
+} switch_event_msg_t;
+
+static int switch_event_pipe[2] = { -1, -1 };
+
+// runs in mux thread. Pipe full: event dropped, values are published anyhow
+static void on_gpio_switch_event(uint64_t scan_us, uint64_t detect_us)
+{
+    switch_event_msg_t msg;
+    msg.scan_us = scan_us;
+    msg.detect_us = detect_us;
+    if (write(switch_event_pipe[1], &msg, sizeof(msg)) < 0) {
+        // EAGAIN
+    }
+}
+
+static void switch_event_pipe_create()
+{
+    if (pipe(switch_event_pipe) < 0) {
+        print(LOG_ERR, "Can not create switch event pipe, switches are polled only\n");
+        return;
+    }
+    fcntl(switch_event_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(switch_event_pipe[1], F_SETFL, O_NONBLOCK);
+    gpio_switch_event_callback = on_gpio_switch_event;
+}
+
+// runs in RPC server thread
+static void switch_event_pipe_service()
+{
+    switch_event_msg_t msg;
+    while (read(switch_event_pipe[0], &msg, sizeof(msg)) == sizeof(msg))
+        blinkenlight_api_server_shm_input_event(msg.scan_us, msg.detect_us);
+}
+
 static void gpio_mux_thread_start()
 {
     int res;
 //	printf("\nPiDP FP driver 3\n");
-    res = pthread_create(&blink_thread, NULL, blink, &blink_thread_terminate);
+    if (gpioframe_backend)
+        res = pthread_create(&blink_thread, NULL, (void *(*)(void *)) gpioframe_mux,
+                &blink_thread_terminate);
+    else
+        res = pthread_create(&blink_thread, NULL, blink, &blink_thread_terminate);
     if (res) {
         fprintf(stderr, "Error creating gpio_mux thread, return code %d\n", res);
         exit(EXIT_FAILURE);
@@ -366,6 +413,8 @@ void blinkenlight_api_server(void)
         int dtbsz = getdtablesize();
         for (;;) {
             readfds = svc_fdset;
+            if (switch_event_pipe[0] >= 0)
+                FD_SET(switch_event_pipe[0], &readfds);
             tv.tv_sec = 0;
             tv.tv_usec = 1000 * 2; // every 10 ms*time_slice_ms;
             switch (select(dtbsz, &readfds, NULL, NULL, &tv)) {
@@ -379,9 +428,15 @@ void blinkenlight_api_server(void)
                 // not needed:RPC calls control value get/set callbacks
                 break;
             default:
+                if (switch_event_pipe[0] >= 0 && FD_ISSET(switch_event_pipe[0], &readfds)) {
+                    switch_event_pipe_service();
+                    FD_CLR(switch_event_pipe[0], &readfds);
+                }
                 svc_getreqset(&readfds);
                 break;
             }
+            // exchange control values with clients on this host
+            blinkenlight_api_server_shm_service();
             /**/
         }
     }
@@ -415,7 +470,7 @@ static void help(void)
     fprintf(stderr, "  (compiled " __DATE__ " " __TIME__ ")\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Usage:\n");
-    fprintf(stderr, "  pidp11_blinkenlightd [-h] [-b] [-v] [-t] [-L] [-a 0..7] [-d 0..3] [-s <n>]\n");
+    fprintf(stderr, "  pidp11_blinkenlightd [-h] [-b] [-v] [-t] [-L] [-a 0..7] [-d 0..3] [-s <n>] [-m <mux>]\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "  -h          display this help and exit\n");
 //  fprintf(stderr, "  - <port>    TCP port for RCP access.\n");
@@ -433,6 +488,10 @@ static void help(void)
     fprintf(stderr, "                default is -d%d\n", knobValue[0]);
     fprintf(stderr, "  -s <n>      refresh value for panel updates: use with caution\n");
     fprintf(stderr, "                default is -s%ld\n", gpiopattern_update_period_us);
+    fprintf(stderr, "  -m <mux>    LED/switch multiplexing without real-time thread:\n");
+    fprintf(stderr, "                -m dma[:<channel>]  DMA engine, paced by PWM (no analog audio)\n");
+    fprintf(stderr, "                -m mock[:<logfile>] simulated GPIO, for test without a Pi\n");
+    fprintf(stderr, "                default is the GPIO mux thread\n");
     fprintf(stderr, "\n");
 }
 
@@ -455,7 +514,7 @@ static int parse_commandline(int argc, char **argv)
 
     opterr = 0;
 
-    while ((c = getopt(argc, argv, "hbvtLa:d:s:")) != -1)
+    while ((c = getopt(argc, argv, "hbvtLa:d:s:m:")) != -1)
         switch (c) {
         case 'h':
             help();
@@ -485,6 +544,12 @@ static int parse_commandline(int argc, char **argv)
                 return 0;
             }
             break;
+        case 'm':
+            if (!gpioframe_select_backend(optarg)) {
+                fprintf(stderr, "Illegal value to `-m' (must be dma or mock).\n");
+                return 0;
+            }
+            break;
         case '?': // getopt detected an error. "opterr=0", so own error message here
             if (isprint(optopt))
                 fprintf(stderr, "Unknown option `-%c'.\n", optopt);
@@ -702,9 +767,13 @@ int main(int argc, char *argv[])
         exit(0);
     }
 
+    switch_event_pipe_create();
     gpio_mux_thread_start();
     gpiopattern_start_thread();
 
+    // shared memory transport for SimH on the same Raspberry
+    blinkenlight_api_server_shm_create();
+
     blinkenlight_api_server();
     // does never end!
 